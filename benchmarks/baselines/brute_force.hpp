@@ -0,0 +1,77 @@
+#ifndef _INCLUDED_baselines_brute_force_hpp
+#define _INCLUDED_baselines_brute_force_hpp
+
+#include "lochash/location_hash_algorithm.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief The O(n) per query baseline: a flat array of positions scanned linearly.
+		 *
+		 * Updates are free, every query touches every object.
+		 */
+		template <size_t Dimensions>
+		class BruteForce
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+
+			static constexpr const char * name = "brute_force";
+
+			void build(const std::vector<Point> & points) { points_ = points; }
+
+			void update(uint32_t id, const Point &, const Point & new_position) { points_[id] = new_position; }
+
+			void finish_updates() {}
+
+			void query_box(const Point & lower, const Point & upper, std::vector<uint32_t> & out) const
+			{
+				for (uint32_t id = 0; id < points_.size(); ++id) {
+					bool inside = true;
+					for (size_t i = 0; i < Dimensions; ++i) {
+						inside = inside && lower[i] <= points_[id][i] && points_[id][i] <= upper[i];
+					}
+					if (inside) {
+						out.push_back(id);
+					}
+				}
+			}
+
+			void query_radius(const Point & center, float radius, std::vector<uint32_t> & out) const
+			{
+				const float radius_squared = radius * radius;
+				for (uint32_t id = 0; id < points_.size(); ++id) {
+					if (calculate_distance_squared<float, Dimensions>(points_[id], center) <= radius_squared) {
+						out.push_back(id);
+					}
+				}
+			}
+
+			void query_knn(const Point & center, size_t k, std::vector<uint32_t> & out) const
+			{
+				std::vector<std::pair<float, uint32_t>> candidates;
+				candidates.reserve(points_.size());
+				for (uint32_t id = 0; id < points_.size(); ++id) {
+					candidates.emplace_back(calculate_distance_squared<float, Dimensions>(points_[id], center), id);
+				}
+				const size_t count = std::min(k, candidates.size());
+				std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end());
+				for (size_t i = 0; i < count; ++i) {
+					out.push_back(candidates[i].second);
+				}
+			}
+
+		  private:
+			std::vector<Point> points_;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_baselines_brute_force_hpp
@@ -0,0 +1,180 @@
+#ifndef _INCLUDED_baselines_kd_tree_hpp
+#define _INCLUDED_baselines_kd_tree_hpp
+
+#include "lochash/location_hash_algorithm.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief A balanced, implicit k-d tree built by recursive median partitioning.
+		 *
+		 * The tree is stored as a permutation of object ids: the median of every range is the splitting node, and
+		 * the halves on either side are its subtrees. Like most k-d trees used in practice it is static, so updates
+		 * only record new positions and finish_updates() rebuilds the tree, the usual once-per-tick strategy.
+		 */
+		template <size_t Dimensions>
+		class KdTree
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+
+			static constexpr const char * name = "kd_tree";
+
+			void build(const std::vector<Point> & points)
+			{
+				points_ = points;
+				rebuild();
+			}
+
+			void update(uint32_t id, const Point &, const Point & new_position) { points_[id] = new_position; }
+
+			void finish_updates() { rebuild(); }
+
+			void query_box(const Point & lower, const Point & upper, std::vector<uint32_t> & out) const
+			{
+				query_box(0, order_.size(), 0, lower, upper, out);
+			}
+
+			void query_radius(const Point & center, float radius, std::vector<uint32_t> & out) const
+			{
+				query_radius(0, order_.size(), 0, center, radius, radius * radius, out);
+			}
+
+			void query_knn(const Point & center, size_t k, std::vector<uint32_t> & out) const
+			{
+				if (k == 0) {
+					return;
+				}
+				std::vector<std::pair<float, uint32_t>> best;
+				best.reserve(k + 1);
+				query_knn(0, order_.size(), 0, center, k, best);
+				std::sort_heap(best.begin(), best.end());
+				for (const auto & candidate : best) {
+					out.push_back(candidate.second);
+				}
+			}
+
+		  private:
+			void rebuild()
+			{
+				order_.resize(points_.size());
+				std::iota(order_.begin(), order_.end(), 0u);
+				build(0, order_.size(), 0);
+			}
+
+			void build(size_t begin, size_t end, size_t axis)
+			{
+				if (end - begin <= 1) {
+					return;
+				}
+				const size_t middle = begin + (end - begin) / 2;
+				std::nth_element(order_.begin() + begin, order_.begin() + middle, order_.begin() + end,
+				                 [&](uint32_t a, uint32_t b) { return points_[a][axis] < points_[b][axis]; });
+				const size_t next_axis = (axis + 1) % Dimensions;
+				build(begin, middle, next_axis);
+				build(middle + 1, end, next_axis);
+			}
+
+			void query_box(size_t begin, size_t end, size_t axis, const Point & lower, const Point & upper,
+			               std::vector<uint32_t> & out) const
+			{
+				if (begin >= end) {
+					return;
+				}
+				const size_t   middle = begin + (end - begin) / 2;
+				const uint32_t id     = order_[middle];
+				const Point &  point  = points_[id];
+
+				bool inside = true;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					inside = inside && lower[i] <= point[i] && point[i] <= upper[i];
+				}
+				if (inside) {
+					out.push_back(id);
+				}
+
+				const size_t next_axis = (axis + 1) % Dimensions;
+				if (lower[axis] <= point[axis]) {
+					query_box(begin, middle, next_axis, lower, upper, out);
+				}
+				if (upper[axis] >= point[axis]) {
+					query_box(middle + 1, end, next_axis, lower, upper, out);
+				}
+			}
+
+			void query_radius(size_t begin, size_t end, size_t axis, const Point & center, float radius,
+			                  float radius_squared, std::vector<uint32_t> & out) const
+			{
+				if (begin >= end) {
+					return;
+				}
+				const size_t   middle = begin + (end - begin) / 2;
+				const uint32_t id     = order_[middle];
+				const Point &  point  = points_[id];
+
+				if (calculate_distance_squared<float, Dimensions>(point, center) <= radius_squared) {
+					out.push_back(id);
+				}
+
+				const size_t next_axis = (axis + 1) % Dimensions;
+				if (center[axis] - radius <= point[axis]) {
+					query_radius(begin, middle, next_axis, center, radius, radius_squared, out);
+				}
+				if (center[axis] + radius >= point[axis]) {
+					query_radius(middle + 1, end, next_axis, center, radius, radius_squared, out);
+				}
+			}
+
+			void query_knn(size_t begin, size_t end, size_t axis, const Point & center, size_t k,
+			               std::vector<std::pair<float, uint32_t>> & best) const
+			{
+				if (begin >= end) {
+					return;
+				}
+				const size_t   middle = begin + (end - begin) / 2;
+				const uint32_t id     = order_[middle];
+				const Point &  point  = points_[id];
+
+				const float distance_squared = calculate_distance_squared<float, Dimensions>(point, center);
+				if (best.size() < k) {
+					best.emplace_back(distance_squared, id);
+					std::push_heap(best.begin(), best.end());
+				} else if (distance_squared < best.front().first) {
+					std::pop_heap(best.begin(), best.end());
+					best.back() = {distance_squared, id};
+					std::push_heap(best.begin(), best.end());
+				}
+
+				const size_t next_axis  = (axis + 1) % Dimensions;
+				const float  difference = center[axis] - point[axis];
+				const bool   left_first = difference <= 0.0f;
+
+				if (left_first) {
+					query_knn(begin, middle, next_axis, center, k, best);
+				} else {
+					query_knn(middle + 1, end, next_axis, center, k, best);
+				}
+				if (best.size() < k || difference * difference < best.front().first) {
+					if (left_first) {
+						query_knn(middle + 1, end, next_axis, center, k, best);
+					} else {
+						query_knn(begin, middle, next_axis, center, k, best);
+					}
+				}
+			}
+
+			std::vector<Point>    points_;
+			std::vector<uint32_t> order_;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_baselines_kd_tree_hpp
@@ -0,0 +1,250 @@
+#ifndef _INCLUDED_baselines_r_tree_hpp
+#define _INCLUDED_baselines_r_tree_hpp
+
+#include "lochash/location_hash_algorithm.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief An R-tree bulk loaded with Sort-Tile-Recursive (STR) packing.
+		 *
+		 * STR produces nearly full, well-clustered nodes and is the usual choice for read-heavy R-tree baselines.
+		 * Like the k-d tree, the packed tree is static: updates record new positions and finish_updates() repacks.
+		 */
+		template <size_t Dimensions>
+		class RTree
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+
+			static constexpr const char * name = "r_tree";
+
+			void build(const std::vector<Point> & points)
+			{
+				points_ = points;
+				rebuild();
+			}
+
+			void update(uint32_t id, const Point &, const Point & new_position) { points_[id] = new_position; }
+
+			void finish_updates() { rebuild(); }
+
+			void query_box(const Point & lower, const Point & upper, std::vector<uint32_t> & out) const
+			{
+				if (nodes_.empty()) {
+					return;
+				}
+				stack_.clear();
+				stack_.push_back(root_);
+				while (!stack_.empty()) {
+					const Node & node = nodes_[stack_.back()];
+					stack_.pop_back();
+					if (!overlaps(node, lower, upper)) {
+						continue;
+					}
+					for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+						if (node.leaf) {
+							const Point & point  = points_[entries_[i]];
+							bool          inside = true;
+							for (size_t axis = 0; axis < Dimensions; ++axis) {
+								inside = inside && lower[axis] <= point[axis] && point[axis] <= upper[axis];
+							}
+							if (inside) {
+								out.push_back(entries_[i]);
+							}
+						} else {
+							stack_.push_back(i);
+						}
+					}
+				}
+			}
+
+			void query_radius(const Point & center, float radius, std::vector<uint32_t> & out) const
+			{
+				if (nodes_.empty()) {
+					return;
+				}
+				const float radius_squared = radius * radius;
+				stack_.clear();
+				stack_.push_back(root_);
+				while (!stack_.empty()) {
+					const Node & node = nodes_[stack_.back()];
+					stack_.pop_back();
+					if (min_distance_squared(node, center) > radius_squared) {
+						continue;
+					}
+					for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+						if (node.leaf) {
+							if (calculate_distance_squared<float, Dimensions>(points_[entries_[i]], center) <=
+							    radius_squared) {
+								out.push_back(entries_[i]);
+							}
+						} else {
+							stack_.push_back(i);
+						}
+					}
+				}
+			}
+
+			void query_knn(const Point & center, size_t k, std::vector<uint32_t> & out) const
+			{
+				if (nodes_.empty() || k == 0) {
+					return;
+				}
+
+				// Best-first search: nodes and objects share one queue ordered by (minimum) distance, so objects pop
+				// out in nearest-first order.
+				struct Item {
+					float    distance_squared;
+					uint32_t index;
+					bool     is_object;
+					bool     operator>(const Item & other) const { return distance_squared > other.distance_squared; }
+				};
+				std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+				queue.push({min_distance_squared(nodes_[root_], center), root_, false});
+
+				size_t found = 0;
+				while (!queue.empty() && found < k) {
+					const Item item = queue.top();
+					queue.pop();
+					if (item.is_object) {
+						out.push_back(item.index);
+						++found;
+						continue;
+					}
+					const Node & node = nodes_[item.index];
+					for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+						if (node.leaf) {
+							queue.push({calculate_distance_squared<float, Dimensions>(points_[entries_[i]], center),
+							            entries_[i], true});
+						} else {
+							queue.push({min_distance_squared(nodes_[i], center), i, false});
+						}
+					}
+				}
+			}
+
+		  private:
+			static constexpr size_t node_capacity = 16;
+
+			struct Node {
+				Point    lower;
+				Point    upper;
+				uint32_t first = 0;
+				uint32_t count = 0;
+				bool     leaf  = true;
+			};
+
+			static bool overlaps(const Node & node, const Point & lower, const Point & upper)
+			{
+				for (size_t axis = 0; axis < Dimensions; ++axis) {
+					if (node.upper[axis] < lower[axis] || node.lower[axis] > upper[axis]) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			static float min_distance_squared(const Node & node, const Point & point)
+			{
+				float distance_squared = 0.0f;
+				for (size_t axis = 0; axis < Dimensions; ++axis) {
+					const float gap = std::max({node.lower[axis] - point[axis], 0.0f, point[axis] - node.upper[axis]});
+					distance_squared += gap * gap;
+				}
+				return distance_squared;
+			}
+
+			// Sort-Tile-Recursive: sort by the first axis, cut into vertical slabs, and recurse into each slab on the
+			// next axis. The final axis is simply sorted, after which consecutive runs form the leaves.
+			void sort_tile_recursive(size_t begin, size_t end, size_t axis)
+			{
+				std::sort(entries_.begin() + begin, entries_.begin() + end,
+				          [&](uint32_t a, uint32_t b) { return points_[a][axis] < points_[b][axis]; });
+				if (axis + 1 == Dimensions) {
+					return;
+				}
+				const double pages      = std::ceil(static_cast<double>(end - begin) / node_capacity);
+				const auto   slabs      = static_cast<size_t>(std::ceil(std::pow(pages, 1.0 / (Dimensions - axis))));
+				const size_t slab_pages = static_cast<size_t>(std::ceil(pages / static_cast<double>(slabs)));
+				const size_t slab_size  = std::max<size_t>(1, slab_pages * node_capacity);
+				for (size_t slab = begin; slab < end; slab += slab_size) {
+					sort_tile_recursive(slab, std::min(end, slab + slab_size), axis + 1);
+				}
+			}
+
+			void rebuild()
+			{
+				nodes_.clear();
+				entries_.resize(points_.size());
+				std::iota(entries_.begin(), entries_.end(), 0u);
+				if (points_.empty()) {
+					return;
+				}
+				sort_tile_recursive(0, entries_.size(), 0);
+
+				// leaves over consecutive runs of sorted entries
+				for (size_t first = 0; first < entries_.size(); first += node_capacity) {
+					Node node;
+					node.first = static_cast<uint32_t>(first);
+					node.count = static_cast<uint32_t>(std::min(node_capacity, entries_.size() - first));
+					node.leaf  = true;
+					node.lower = node.upper = points_[entries_[first]];
+					for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+						extend(node, points_[entries_[i]], points_[entries_[i]]);
+					}
+					nodes_.push_back(node);
+				}
+
+				// pack each level into parents until a single root remains
+				size_t level_begin = 0;
+				size_t level_end   = nodes_.size();
+				while (level_end - level_begin > 1) {
+					for (size_t first = level_begin; first < level_end; first += node_capacity) {
+						Node node;
+						node.first = static_cast<uint32_t>(first);
+						node.count = static_cast<uint32_t>(std::min(node_capacity, level_end - first));
+						node.leaf  = false;
+						node.lower = nodes_[first].lower;
+						node.upper = nodes_[first].upper;
+						for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+							const Node child = nodes_[i];
+							extend(node, child.lower, child.upper);
+						}
+						nodes_.push_back(node);
+					}
+					level_begin = level_end;
+					level_end   = nodes_.size();
+				}
+				root_ = static_cast<uint32_t>(level_begin);
+			}
+
+			static void extend(Node & node, const Point & lower, const Point & upper)
+			{
+				for (size_t axis = 0; axis < Dimensions; ++axis) {
+					node.lower[axis] = std::min(node.lower[axis], lower[axis]);
+					node.upper[axis] = std::max(node.upper[axis], upper[axis]);
+				}
+			}
+
+			std::vector<Point>            points_;
+			std::vector<uint32_t>         entries_;
+			std::vector<Node>             nodes_;
+			uint32_t                      root_ = 0;
+			mutable std::vector<uint32_t> stack_;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_baselines_r_tree_hpp
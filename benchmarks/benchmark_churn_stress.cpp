@@ -0,0 +1,312 @@
+// Multi-threaded churn stress benchmark for concurrent LocationHash variants.
+//
+// Every thread runs a weighted mix of moves, box queries and churn (adds and removes) against one shared index for a
+// fixed duration. The report gives throughput, latency percentiles and Jain fairness across threads per operation.
+// Each thread owns a disjoint slice of the objects, so the index state at the end is fully determined by each
+// thread's own sequence of writes. Replaying those logs serially into a plain LocationHash must reproduce it exactly.
+// Run with --help for options.
+
+#include "benchmark_harness.hpp"
+#include "benchmark_statistics.hpp"
+#include "benchmark_workloads.hpp"
+#include "concurrent_location_hash_adapters.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+using namespace lochash::benchmarks;
+
+namespace
+{
+	constexpr size_t dimensions        = 2;
+	constexpr float  query_half_extent = 32.0f;
+	constexpr float  move_step         = 4.0f;
+
+	using Point = std::array<float, dimensions>;
+
+	enum Operation : size_t { move_operation, query_operation, churn_operation, operation_count };
+
+	const char * const operation_names[operation_count] = {"move", "query", "churn"};
+
+	struct StressOptions {
+		std::vector<size_t> threads                  = {1, 2, 4, 8};
+		size_t              duration_ms              = 1000;
+		size_t              objects                  = 20000;
+		size_t              weights[operation_count] = {60, 30, 10}; // move, query, churn
+		std::string         filter                   = "";
+	};
+
+	void print_usage(const char * program)
+	{
+		std::cout << "Usage: " << program << " [options]\n"
+		          << "  --threads N,N,...   thread counts to run (default 1,2,4,8)\n"
+		          << "  --duration-ms N     run time per configuration (default 1000)\n"
+		          << "  --objects N         objects in the index (default 20000)\n"
+		          << "  --mix M,Q,C         relative weights of moves, queries and churn (default 60,30,10)\n"
+		          << "  --filter TEXT       only run variants whose name contains TEXT\n"
+		          << "  --quick             short run with few threads, for smoke testing\n";
+	}
+
+	StressOptions parse_stress_options(int argc, char ** argv)
+	{
+		StressOptions options;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg        = argv[i];
+			const auto        next_value = [&]() -> std::string {
+				if (i + 1 >= argc) {
+					std::cerr << "Missing value for " << arg << "\n";
+					std::exit(2);
+				}
+				return argv[++i];
+			};
+
+			if (arg == "--threads") {
+				options.threads = parse_size_list(next_value());
+			} else if (arg == "--duration-ms") {
+				options.duration_ms = std::stoull(next_value());
+			} else if (arg == "--objects") {
+				options.objects = std::max<size_t>(1, std::stoull(next_value()));
+			} else if (arg == "--mix") {
+				const auto weights = parse_size_list(next_value());
+				if (weights.size() != operation_count) {
+					std::cerr << "--mix takes three weights\n";
+					std::exit(2);
+				}
+				std::copy(weights.begin(), weights.end(), options.weights);
+			} else if (arg == "--filter") {
+				options.filter = next_value();
+			} else if (arg == "--quick") {
+				options.threads     = {1, 2};
+				options.duration_ms = 50;
+				options.objects     = 2000;
+			} else if (arg == "--help" || arg == "-h") {
+				print_usage(argv[0]);
+				std::exit(0);
+			} else {
+				std::cerr << "Unknown option " << arg << "\n";
+				print_usage(argv[0]);
+				std::exit(2);
+			}
+		}
+		return options;
+	}
+
+	/// One write made by a thread, in the order it made them.
+	struct WriteRecord {
+		Operation operation; // move_operation, or churn_operation for an add (present) or remove (!present)
+		bool      present;
+		uint32_t  id;
+		Point     from;
+		Point     to;
+	};
+
+	struct ThreadResult {
+		LatencyHistogram         latency[operation_count];
+		std::vector<WriteRecord> writes;
+	};
+
+	/// Index contents in a canonical order: bucket, id, position.
+	using Snapshot = std::vector<std::tuple<std::array<int64_t, dimensions>, uint32_t, Point>>;
+
+	template <typename Index>
+	void run_thread(Index & index, std::vector<Item> & items, std::vector<Point> & positions, size_t thread,
+	                size_t thread_count, const StressOptions & options, float extent, std::latch & start,
+	                const std::atomic<bool> & stop, ThreadResult & result)
+	{
+		// this thread's objects; three in four start in the index, the rest wait to be added
+		std::vector<uint32_t> present;
+		std::vector<uint32_t> absent;
+		for (size_t id = thread; id < items.size(); id += thread_count) {
+			(id % 4 == 3 ? absent : present).push_back(static_cast<uint32_t>(id));
+		}
+
+		std::mt19937                          rng(static_cast<unsigned>(thread) + 1);
+		std::uniform_real_distribution<float> coordinate(0.0f, extent);
+		std::uniform_real_distribution<float> step(-move_step, move_step);
+		std::discrete_distribution<size_t>    pick_operation(std::begin(options.weights), std::end(options.weights));
+		std::vector<Item *>                   out;
+
+		start.arrive_and_wait();
+		while (!stop.load(std::memory_order_relaxed)) {
+			const auto operation = static_cast<Operation>(pick_operation(rng));
+			const auto begin     = std::chrono::steady_clock::now();
+
+			if (operation == query_operation) {
+				const Point center = {coordinate(rng), coordinate(rng)};
+				index.query_box({center[0] - query_half_extent, center[1] - query_half_extent},
+				                {center[0] + query_half_extent, center[1] + query_half_extent}, out);
+				do_not_optimize(out.size());
+			} else if (operation == move_operation && !present.empty()) {
+				const uint32_t id   = present[rng() % present.size()];
+				const Point    from = positions[id];
+				const Point    to   = {from[0] + step(rng), from[1] + step(rng)};
+				index.move(&items[id], from, to);
+				positions[id] = to;
+				result.writes.push_back({move_operation, true, id, from, to});
+			} else if (operation == churn_operation && (!present.empty() || !absent.empty())) {
+				const bool add  = present.empty() || (!absent.empty() && rng() % 2 == 0);
+				auto &     from = add ? absent : present;
+				auto &     to   = add ? present : absent;
+				const auto slot = rng() % from.size();
+				const auto id   = from[slot];
+				from[slot]      = from.back();
+				from.pop_back();
+				to.push_back(id);
+				if (add) {
+					positions[id] = {coordinate(rng), coordinate(rng)};
+					index.add(&items[id], positions[id]);
+				} else {
+					index.remove(&items[id], positions[id]);
+				}
+				result.writes.push_back({churn_operation, add, id, positions[id], positions[id]});
+			} else {
+				continue;
+			}
+
+			const auto elapsed = std::chrono::steady_clock::now() - begin;
+			result.latency[operation].record(
+			    static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+		}
+	}
+
+	template <typename Visit>
+	Snapshot snapshot(Visit && for_each_entry)
+	{
+		Snapshot entries;
+		for_each_entry([&](const auto & key, const Point & position, const Item * item) {
+			entries.emplace_back(key.quantized_, item->id, position);
+		});
+		std::sort(entries.begin(), entries.end());
+		return entries;
+	}
+
+	/// Applies the initial population and every thread's writes to a plain LocationHash, one thread after another.
+	Snapshot serial_replay(std::vector<Item> & items, const std::vector<Point> & initial,
+	                       const std::vector<ThreadResult> & results)
+	{
+		LocationHashAdapter<dimensions>::Hash hash;
+		for (size_t id = 0; id < items.size(); ++id) {
+			if (id % 4 != 3) {
+				hash.add(&items[id], initial[id]);
+			}
+		}
+		for (const auto & result : results) {
+			for (const auto & write : result.writes) {
+				if (write.operation == move_operation) {
+					hash.move(&items[write.id], write.from, write.to);
+				} else if (write.present) {
+					hash.add(&items[write.id], write.to);
+				} else {
+					hash.remove(&items[write.id], write.from);
+				}
+			}
+		}
+		return snapshot([&](const auto & visitor) {
+			for (const auto & [key, bucket] : hash.get_data()) {
+				for (const auto & [position, item] : bucket) {
+					visitor(key, position, item);
+				}
+			}
+		});
+	}
+
+	template <typename Index>
+	bool run_configuration(const StressOptions & options, size_t thread_count)
+	{
+		const float              extent  = world_extent<dimensions>(options.objects);
+		const std::vector<Point> initial = generate_points<dimensions>(Distribution::uniform, options.objects, 1234);
+
+		std::vector<Item> items(options.objects);
+		auto              positions = initial;
+		auto              index     = std::make_unique<Index>();
+		for (uint32_t id = 0; id < items.size(); ++id) {
+			items[id].id = id;
+			if (id % 4 != 3) {
+				index->add(&items[id], positions[id]);
+			}
+		}
+
+		std::vector<ThreadResult> results(thread_count);
+		std::vector<std::thread>  threads;
+		std::latch                start(static_cast<std::ptrdiff_t>(thread_count) + 1);
+		std::atomic<bool>         stop{false};
+		for (size_t t = 0; t < thread_count; ++t) {
+			threads.emplace_back([&, t]() {
+				run_thread(*index, items, positions, t, thread_count, options, extent, start, stop, results[t]);
+			});
+		}
+		start.arrive_and_wait();
+		const auto begin = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(options.duration_ms));
+		stop.store(true, std::memory_order_relaxed);
+		for (auto & thread : threads) {
+			thread.join();
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		uint64_t total = 0;
+		for (size_t operation = 0; operation < operation_count; ++operation) {
+			LatencyHistogram    merged;
+			std::vector<double> shares;
+			for (const auto & result : results) {
+				merged.merge(result.latency[operation]);
+				shares.push_back(static_cast<double>(result.latency[operation].count()));
+			}
+			total += merged.count();
+			const std::string name = std::string(Index::name) + "/" + std::to_string(thread_count) + "t/" +
+			                         operation_names[operation];
+			std::printf("%-28s %12llu %14.0f %10llu %10llu %10llu %9.3f\n", name.c_str(),
+			            static_cast<unsigned long long>(merged.count()), static_cast<double>(merged.count()) / seconds,
+			            static_cast<unsigned long long>(merged.percentile(0.5)),
+			            static_cast<unsigned long long>(merged.percentile(0.99)),
+			            static_cast<unsigned long long>(merged.percentile(0.999)), jain_fairness(shares));
+		}
+
+		const bool valid = snapshot([&](const auto & visitor) { index->for_each_entry(visitor); }) ==
+		                   serial_replay(items, initial, results);
+		const std::string name = std::string(Index::name) + "/" + std::to_string(thread_count) + "t/total";
+		std::printf("%-28s %12llu %14.0f %10s %10s %10s %9s  replay %s\n", name.c_str(),
+		            static_cast<unsigned long long>(total), static_cast<double>(total) / seconds, "", "", "", "",
+		            valid ? "ok" : "MISMATCH");
+		std::fflush(stdout);
+		return valid;
+	}
+
+	template <typename Index>
+	bool run_variant(const StressOptions & options)
+	{
+		if (!options.filter.empty() && std::string(Index::name).find(options.filter) == std::string::npos) {
+			return true;
+		}
+		bool valid = true;
+		for (const size_t thread_count : options.threads) {
+			if (thread_count > 0) {
+				valid = run_configuration<Index>(options, thread_count) && valid;
+			}
+		}
+		return valid;
+	}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+	const StressOptions options = parse_stress_options(argc, argv);
+	std::printf("%-28s %12s %14s %10s %10s %10s %9s\n", "variant/threads/operation", "ops", "ops/s", "p50 ns",
+	            "p99 ns", "p99.9 ns", "fairness");
+
+	bool valid = run_variant<LockedLocationHash<dimensions>>(options);
+	valid      = run_variant<ShardedLocationHash<dimensions>>(options) && valid;
+	if (!valid) {
+		std::cerr << "VALIDATION FAILED: concurrent index disagrees with the serial replay\n";
+	}
+	return valid ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// A/B comparison of benchmark results with confidence intervals and a significance verdict.
+//
+// Either compares two CSV files written with --csv, or runs two benchmark executables itself, alternating which
+// goes first on every trial so that drift in the host (thermal throttling, other tenants) hits both sides equally.
+// Run with --help for options.
+
+#include "benchmark_statistics.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace lochash::benchmarks;
+
+namespace
+{
+	struct CompareOptions {
+		std::vector<std::string> inputs; // two CSV files, or two executables with --run
+		std::string              benchmark_arguments;
+		size_t                   trials             = 5;
+		bool                     run                = false;
+		bool                     fail_on_regression = false;
+		ComparisonOptions        comparison;
+	};
+
+	void print_usage(const char * program)
+	{
+		std::cout << "Usage: " << program << " [options] BASELINE.csv CANDIDATE.csv\n"
+		          << "       " << program << " [options] --run BASELINE_EXE CANDIDATE_EXE [-- BENCHMARK_ARGS...]\n"
+		          << "  --run                 run both executables and compare their samples\n"
+		          << "  --trials N            interleaved runs of each executable (default 5)\n"
+		          << "  --alpha P             significance level (default 0.05)\n"
+		          << "  --min-effect F        ignore speedups within +/- F of 1 (default 0.01)\n"
+		          << "  --fail-on-regression  exit with 1 if any benchmark is significantly slower\n";
+	}
+
+	CompareOptions parse_compare_options(int argc, char ** argv)
+	{
+		CompareOptions options;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg        = argv[i];
+			const auto        next_value = [&]() -> std::string {
+				if (i + 1 >= argc) {
+					std::cerr << "Missing value for " << arg << "\n";
+					std::exit(2);
+				}
+				return argv[++i];
+			};
+
+			if (arg == "--") {
+				// everything after -- is passed to the benchmark executables
+				for (++i; i < argc; ++i) {
+					options.benchmark_arguments += std::string(" ") + argv[i];
+				}
+			} else if (arg == "--run") {
+				options.run = true;
+			} else if (arg == "--trials") {
+				options.trials = std::max<size_t>(1, std::stoull(next_value()));
+			} else if (arg == "--alpha") {
+				options.comparison.alpha = std::stod(next_value());
+			} else if (arg == "--min-effect") {
+				options.comparison.min_effect = std::stod(next_value());
+			} else if (arg == "--fail-on-regression") {
+				options.fail_on_regression = true;
+			} else if (arg == "--help" || arg == "-h") {
+				print_usage(argv[0]);
+				std::exit(0);
+			} else if (!arg.empty() && arg[0] == '-') {
+				std::cerr << "Unknown option " << arg << "\n";
+				print_usage(argv[0]);
+				std::exit(2);
+			} else {
+				options.inputs.push_back(arg);
+			}
+		}
+		if (options.inputs.size() != 2) {
+			print_usage(argv[0]);
+			std::exit(2);
+		}
+		return options;
+	}
+
+	/// Runs one benchmark executable with --csv into a scratch file and adds its samples to samples. Its own table
+	/// goes to stderr so stdout carries only the comparison.
+	bool run_trial(const std::string & executable, const std::string & arguments, const std::string & csv_path,
+	               SampleSet & samples)
+	{
+		const std::string command = "\"" + executable + "\"" + arguments + " --csv \"" + csv_path + "\" 1>&2";
+		std::cerr << "> " << command << "\n";
+		if (std::system(command.c_str()) != 0) {
+			std::cerr << executable << " failed\n";
+			return false;
+		}
+		const bool read = read_samples_csv(csv_path, samples);
+		std::filesystem::remove(csv_path);
+		return read;
+	}
+
+	bool run_interleaved(const CompareOptions & options, SampleSet & baseline, SampleSet & candidate)
+	{
+		const auto scratch = std::filesystem::temp_directory_path();
+		for (size_t trial = 0; trial < options.trials; ++trial) {
+			const std::string suffix         = std::to_string(trial) + ".csv";
+			const std::string baseline_csv   = (scratch / ("lochash_compare_baseline_" + suffix)).string();
+			const std::string candidate_csv  = (scratch / ("lochash_compare_candidate_" + suffix)).string();
+			const bool        baseline_first = trial % 2 == 0;
+
+			bool ok = true;
+			if (baseline_first) {
+				ok = run_trial(options.inputs[0], options.benchmark_arguments, baseline_csv, baseline) &&
+				     run_trial(options.inputs[1], options.benchmark_arguments, candidate_csv, candidate);
+			} else {
+				ok = run_trial(options.inputs[1], options.benchmark_arguments, candidate_csv, candidate) &&
+				     run_trial(options.inputs[0], options.benchmark_arguments, baseline_csv, baseline);
+			}
+			if (!ok) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void print_report(const std::vector<Comparison> & comparisons, const ComparisonOptions & options)
+	{
+		const int confidence = static_cast<int>(std::lround((1.0 - options.alpha) * 100.0));
+		std::printf("%-56s %8s %12s %12s %8s %19s %8s  %s\n", "benchmark", "n", "base ns/op", "cand ns/op",
+		            "speedup", (std::to_string(confidence) + "% CI").c_str(), "p", "verdict");
+		for (const auto & comparison : comparisons) {
+			const std::string samples =
+			    std::to_string(comparison.baseline_samples) + "/" + std::to_string(comparison.candidate_samples);
+			std::printf("%-56s %8s %12.1f %12.1f %7.3fx [%7.3fx, %7.3fx] %8.4f  %s\n", comparison.name.c_str(),
+			            samples.c_str(), comparison.baseline_median, comparison.candidate_median, comparison.speedup,
+			            comparison.ci_low, comparison.ci_high, comparison.p_value, to_string(comparison.verdict));
+		}
+	}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+	const CompareOptions options = parse_compare_options(argc, argv);
+
+	SampleSet baseline;
+	SampleSet candidate;
+	if (options.run) {
+		if (!run_interleaved(options, baseline, candidate)) {
+			return 2;
+		}
+	} else {
+		for (size_t i = 0; i < 2; ++i) {
+			if (!read_samples_csv(options.inputs[i], i == 0 ? baseline : candidate)) {
+				std::cerr << "Unable to read " << options.inputs[i] << "\n";
+				return 2;
+			}
+		}
+	}
+
+	const auto comparisons = compare_sample_sets(baseline, candidate, options.comparison);
+	if (comparisons.empty()) {
+		std::cerr << "No benchmark appears in both result sets\n";
+		return 2;
+	}
+	print_report(comparisons, options.comparison);
+
+	size_t faster = 0;
+	size_t slower = 0;
+	for (const auto & comparison : comparisons) {
+		faster += comparison.verdict == Verdict::faster ? 1 : 0;
+		slower += comparison.verdict == Verdict::slower ? 1 : 0;
+	}
+	std::printf("\n%zu compared: %zu faster, %zu slower, %zu without a significant difference\n", comparisons.size(),
+	            faster, slower, comparisons.size() - faster - slower);
+	return options.fail_on_regression && slower > 0 ? 1 : 0;
+}
@@ -0,0 +1,186 @@
+// Ingest and query throughput of DiskLocationHash on a local file.
+//
+// Ingest adds every point with a bounded cache, so dirty cells are written back as they are evicted, then flushes.
+// The query phases reopen the file and run spatially local box queries (a random walk, as when scrubbing through
+// an archive): first against a cold cache, then the same queries again against the warm one. Results of the cold
+// pass are cross-checked against brute force. Run with --help for options.
+
+#include "benchmark_harness.hpp"
+#include "benchmark_workloads.hpp"
+#include "lochash/location_hash_disk.hpp"
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lochash::benchmarks;
+
+namespace
+{
+	constexpr size_t dimensions        = 2;
+	constexpr size_t disk_precision    = 64;
+	constexpr float  query_half_extent = 48.0f;
+	constexpr float  query_step        = 32.0f;
+
+	using Point    = std::array<float, dimensions>;
+	using DiskHash = lochash::DiskLocationHash<disk_precision, float, dimensions, uint64_t>;
+
+	struct DiskOptions {
+		size_t      points      = 1000000;
+		size_t      cache_cells = 1024;
+		size_t      queries     = 20000;
+		std::string path        = (std::filesystem::temp_directory_path() / "lochash_disk_benchmark.bin").string();
+		bool        keep        = false;
+		bool        validate    = true;
+	};
+
+	void print_usage(const char * program)
+	{
+		std::cout << "Usage: " << program << " [options]\n"
+		          << "  --points N          points to ingest (default 1000000)\n"
+		          << "  --cache-cells N     cells kept in memory (default 1024)\n"
+		          << "  --queries N         box queries per pass (default 20000)\n"
+		          << "  --file PATH         index file (default in the temp directory)\n"
+		          << "  --keep              do not delete the index file afterwards\n"
+		          << "  --no-validate       skip the brute-force cross-check\n"
+		          << "  --quick             tiny run, for smoke testing\n";
+	}
+
+	DiskOptions parse_disk_options(int argc, char ** argv)
+	{
+		DiskOptions options;
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg        = argv[i];
+			const auto        next_value = [&]() -> std::string {
+				if (i + 1 >= argc) {
+					std::cerr << "Missing value for " << arg << "\n";
+					std::exit(2);
+				}
+				return argv[++i];
+			};
+
+			if (arg == "--points") {
+				options.points = std::max<size_t>(1, std::stoull(next_value()));
+			} else if (arg == "--cache-cells") {
+				options.cache_cells = std::stoull(next_value());
+			} else if (arg == "--queries") {
+				options.queries = std::stoull(next_value());
+			} else if (arg == "--file") {
+				options.path = next_value();
+			} else if (arg == "--keep") {
+				options.keep = true;
+			} else if (arg == "--no-validate") {
+				options.validate = false;
+			} else if (arg == "--quick") {
+				options.points      = 20000;
+				options.cache_cells = 32;
+				options.queries     = 200;
+			} else if (arg == "--help" || arg == "-h") {
+				print_usage(argv[0]);
+				std::exit(0);
+			} else {
+				std::cerr << "Unknown option " << arg << "\n";
+				print_usage(argv[0]);
+				std::exit(2);
+			}
+		}
+		return options;
+	}
+
+	double seconds_since(std::chrono::steady_clock::time_point begin)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	// Prints one phase; the statistics are the difference between the counters after and before it.
+	void print_phase(const char * phase, size_t operations, double seconds, const lochash::DiskCacheStatistics & before,
+	                 const lochash::DiskCacheStatistics & after)
+	{
+		std::printf("%-8s %12zu %14.0f %12llu %12llu %12llu %12.1f %12.1f\n", phase, operations,
+		            static_cast<double>(operations) / seconds,
+		            static_cast<unsigned long long>(after.hits - before.hits),
+		            static_cast<unsigned long long>(after.misses - before.misses),
+		            static_cast<unsigned long long>(after.reads - before.reads),
+		            static_cast<double>(after.bytes_read - before.bytes_read) / 1e6,
+		            static_cast<double>(after.bytes_written - before.bytes_written) / 1e6);
+		std::fflush(stdout);
+	}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+	const DiskOptions options = parse_disk_options(argc, argv);
+	std::filesystem::remove(options.path);
+
+	const auto  points = generate_points<dimensions>(Distribution::clustered, options.points, 1234);
+	const float extent = world_extent<dimensions>(options.points);
+
+	// queries walk across the world in small steps, so consecutive queries share most of their cells
+	std::vector<Point>                    centers(options.queries);
+	std::mt19937                          rng(99);
+	std::uniform_real_distribution<float> step(-query_step, query_step);
+	Point                                 center = {extent / 2.0f, extent / 2.0f};
+	for (auto & query_center : centers) {
+		for (size_t i = 0; i < dimensions; ++i) {
+			center[i] = std::clamp(center[i] + step(rng), 0.0f, extent);
+		}
+		query_center = center;
+	}
+
+	std::printf("%-8s %12s %14s %12s %12s %12s %12s %12s\n", "phase", "operations", "ops/s", "cache hits",
+	            "cache misses", "file reads", "MB read", "MB written");
+
+	{
+		DiskHash   locationHash(options.path, options.cache_cells);
+		const auto begin = std::chrono::steady_clock::now();
+		for (uint64_t id = 0; id < points.size(); ++id) {
+			locationHash.add(id, points[id]);
+		}
+		locationHash.flush();
+		print_phase("ingest", points.size(), seconds_since(begin), {}, locationHash.statistics());
+	}
+
+	bool                         valid = true;
+	std::vector<DiskHash::Entry> result;
+	{
+		DiskHash locationHash(options.path, options.cache_cells);
+		for (const char * phase : {"cold", "warm"}) {
+			const bool cold   = std::string(phase) == "cold";
+			const auto before = locationHash.statistics();
+			const auto begin  = std::chrono::steady_clock::now();
+			size_t     found  = 0;
+			for (const auto & [x, y] : centers) {
+				query_bounding_box(locationHash, {x - query_half_extent, y - query_half_extent},
+				                   {x + query_half_extent, y + query_half_extent}, result);
+				found += result.size();
+			}
+			do_not_optimize(found);
+			print_phase(phase, centers.size(), seconds_since(begin), before, locationHash.statistics());
+
+			if (cold && options.validate) {
+				for (size_t q = 0; q < centers.size(); q += std::max<size_t>(1, centers.size() / 50)) {
+					const Point lower = {centers[q][0] - query_half_extent, centers[q][1] - query_half_extent};
+					const Point upper = {centers[q][0] + query_half_extent, centers[q][1] + query_half_extent};
+					query_bounding_box(locationHash, lower, upper, result);
+					size_t expected = 0;
+					for (const auto & point : points) {
+						expected += lochash::detail::within_bounds(point, lower, upper) ? 1 : 0;
+					}
+					valid = valid && expected == result.size();
+				}
+			}
+		}
+	}
+
+	std::printf("file size: %.1f MB\n", static_cast<double>(std::filesystem::file_size(options.path)) / 1e6);
+	if (!options.keep) {
+		std::filesystem::remove(options.path);
+	}
+	if (!valid) {
+		std::cerr << "VALIDATION FAILED: disk index disagrees with brute force\n";
+	}
+	return valid ? 0 : 1;
+}
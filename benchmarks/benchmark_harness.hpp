@@ -0,0 +1,210 @@
+#ifndef _INCLUDED_benchmark_harness_hpp
+#define _INCLUDED_benchmark_harness_hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief Command line options shared by the benchmark executables.
+		 */
+		struct Options {
+			std::vector<size_t> sizes    = {1000, 10000, 100000};
+			size_t              samples  = 5;
+			size_t              queries  = 1000;
+			std::string         filter   = "";
+			std::string         csv_path = "";
+			bool                validate = true;
+			bool                list     = false;
+		};
+
+		inline std::vector<size_t> parse_size_list(const std::string & text)
+		{
+			std::vector<size_t> sizes;
+			std::stringstream   stream(text);
+			std::string         item;
+			while (std::getline(stream, item, ',')) {
+				if (!item.empty()) {
+					sizes.push_back(static_cast<size_t>(std::stoull(item)));
+				}
+			}
+			return sizes;
+		}
+
+		inline void print_usage(const char * program)
+		{
+			std::cout << "Usage: " << program << " [options]\n"
+			          << "  --sizes N,N,...   object counts to benchmark (default 1000,10000,100000)\n"
+			          << "  --samples N       timed samples per benchmark (default 5)\n"
+			          << "  --queries N       queries per query sample (default 1000)\n"
+			          << "  --filter TEXT     only run benchmarks whose name contains TEXT\n"
+			          << "  --csv PATH        write every sample to PATH as name,sample,ns_per_op\n"
+			          << "  --no-validate     skip cross-checking results against brute force\n"
+			          << "  --quick           tiny sizes and a single sample, for smoke testing\n"
+			          << "  --list            print benchmark names without running them\n";
+		}
+
+		/**
+		 * @brief Parses argv into Options. Exits the process on --help or malformed input, since benchmarks are
+		 * always run from the command line.
+		 */
+		inline Options parse_options(int argc, char ** argv)
+		{
+			Options options;
+			for (int i = 1; i < argc; ++i) {
+				const std::string arg        = argv[i];
+				const auto        next_value = [&]() -> std::string {
+					if (i + 1 >= argc) {
+						std::cerr << "Missing value for " << arg << "\n";
+						std::exit(2);
+					}
+					return argv[++i];
+				};
+
+				if (arg == "--sizes") {
+					options.sizes = parse_size_list(next_value());
+				} else if (arg == "--samples") {
+					options.samples = std::max<size_t>(1, std::stoull(next_value()));
+				} else if (arg == "--queries") {
+					options.queries = std::max<size_t>(1, std::stoull(next_value()));
+				} else if (arg == "--filter") {
+					options.filter = next_value();
+				} else if (arg == "--csv") {
+					options.csv_path = next_value();
+				} else if (arg == "--no-validate") {
+					options.validate = false;
+				} else if (arg == "--quick") {
+					options.sizes   = {500};
+					options.samples = 1;
+					options.queries = 50;
+				} else if (arg == "--list") {
+					options.list = true;
+				} else if (arg == "--help" || arg == "-h") {
+					print_usage(argv[0]);
+					std::exit(0);
+				} else {
+					std::cerr << "Unknown option " << arg << "\n";
+					print_usage(argv[0]);
+					std::exit(2);
+				}
+			}
+			return options;
+		}
+
+		/**
+		 * @brief Keeps the optimizer from discarding benchmark work whose result is otherwise unused.
+		 */
+		template <typename T>
+		inline void do_not_optimize(const T & value)
+		{
+			static volatile size_t sink = 0;
+			sink                        = sink + static_cast<size_t>(value);
+		}
+
+		/**
+		 * @brief Times benchmark samples, prints a summary table and optionally records every sample as CSV.
+		 *
+		 * Each sample times one call of the body after an untimed setup call. Results are normalized to nanoseconds
+		 * per operation so that different sizes and batch lengths can be compared directly.
+		 */
+		class Runner
+		{
+		  public:
+			explicit Runner(const Options & options)
+			    : options_(options)
+			{
+				if (!options_.csv_path.empty()) {
+					csv_.open(options_.csv_path);
+					if (!csv_) {
+						std::cerr << "Unable to open " << options_.csv_path << " for writing\n";
+						std::exit(2);
+					}
+					csv_ << "name,sample,ns_per_op\n";
+				}
+				if (!options_.list) {
+					std::printf("%-56s %8s %14s %14s %14s\n", "benchmark", "samples", "median ns/op", "min ns/op",
+					            "ops/s");
+				}
+			}
+
+			bool enabled(const std::string & name) const
+			{
+				return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+			}
+
+			const Options & options() const { return options_; }
+
+			/**
+			 * @brief Runs `options().samples` timed samples of body.
+			 *
+			 * @param name Unique benchmark name, such as "query_box/location_hash/uniform/10000".
+			 * @param operations Number of operations one body call performs.
+			 * @param setup Untimed preparation run before each sample.
+			 * @param body The timed work.
+			 */
+			void run(const std::string & name, size_t operations, const std::function<void()> & setup,
+			         const std::function<void()> & body)
+			{
+				if (!enabled(name)) {
+					return;
+				}
+				if (options_.list) {
+					std::cout << name << "\n";
+					return;
+				}
+
+				std::vector<double> ns_per_op;
+				ns_per_op.reserve(options_.samples);
+				for (size_t sample = 0; sample < options_.samples; ++sample) {
+					setup();
+					const auto start = std::chrono::steady_clock::now();
+					body();
+					const auto end = std::chrono::steady_clock::now();
+
+					const double elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+					ns_per_op.push_back(elapsed / static_cast<double>(std::max<size_t>(1, operations)));
+					if (csv_.is_open()) {
+						csv_ << name << "," << sample << "," << ns_per_op.back() << "\n";
+					}
+				}
+
+				std::vector<double> sorted = ns_per_op;
+				std::sort(sorted.begin(), sorted.end());
+				const double median = sorted[sorted.size() / 2];
+				std::printf("%-56s %8zu %14.1f %14.1f %14.0f\n", name.c_str(), sorted.size(), median, sorted.front(),
+				            median > 0.0 ? 1e9 / median : 0.0);
+				std::fflush(stdout);
+			}
+
+			/**
+			 * @brief Reports a validation failure. The process exit code reflects any failure once all benchmarks
+			 * have run.
+			 */
+			void fail(const std::string & message)
+			{
+				std::cerr << "VALIDATION FAILED: " << message << "\n";
+				failed_ = true;
+			}
+
+			int exit_code() const { return failed_ ? 1 : 0; }
+
+		  private:
+			Options       options_;
+			std::ofstream csv_;
+			bool          failed_ = false;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_benchmark_harness_hpp
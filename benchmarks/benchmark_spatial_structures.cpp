@@ -0,0 +1,214 @@
+// Comparative benchmarks: LocationHash (flat and nested) against brute force, a k-d tree and an R-tree.
+//
+// Every structure is driven through the same interface over the same generated data, so the numbers are directly
+// comparable. Run with --help for options; --csv writes every sample for offline comparison.
+
+#include "baselines/brute_force.hpp"
+#include "baselines/kd_tree.hpp"
+#include "baselines/r_tree.hpp"
+#include "benchmark_harness.hpp"
+#include "benchmark_workloads.hpp"
+#include "location_hash_adapters.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace lochash::benchmarks;
+
+namespace
+{
+	constexpr float  query_half_extent = 32.0f;
+	constexpr float  query_radius      = 32.0f;
+	constexpr size_t query_k           = 8;
+	constexpr float  update_step       = 4.0f;
+
+	template <size_t Dimensions>
+	struct Workload {
+		using Point = std::array<float, Dimensions>;
+
+		Distribution       distribution;
+		std::vector<Point> points;
+		std::vector<Point> moved;
+		std::vector<Point> query_centers;
+	};
+
+	template <size_t Dimensions>
+	Workload<Dimensions> make_workload(Distribution distribution, size_t count, size_t queries)
+	{
+		Workload<Dimensions> workload;
+		workload.distribution = distribution;
+		workload.points       = generate_points<Dimensions>(distribution, count, 1234);
+		workload.moved        = jitter_points<Dimensions>(workload.points, update_step, 5678);
+
+		// Query where the objects are, so query cost reflects the distribution rather than empty space.
+		std::mt19937                          rng(91011);
+		std::uniform_int_distribution<size_t> pick(0, count - 1);
+		workload.query_centers.reserve(queries);
+		for (size_t i = 0; i < queries; ++i) {
+			workload.query_centers.push_back(workload.points[pick(rng)]);
+		}
+		return workload;
+	}
+
+	template <size_t Dimensions>
+	std::array<float, Dimensions> offset(const std::array<float, Dimensions> & point, float delta)
+	{
+		std::array<float, Dimensions> result = point;
+		for (auto & value : result) {
+			value += delta;
+		}
+		return result;
+	}
+
+	template <typename Structure>
+	std::string benchmark_name(const char * operation, Distribution distribution, size_t dimensions, size_t count)
+	{
+		return std::string(operation) + "/" + Structure::name + "/" + to_string(distribution) + "/" +
+		       std::to_string(dimensions) + "d/" + std::to_string(count);
+	}
+
+	/// Compares a structure's answers against brute force for a handful of queries.
+	template <size_t Dimensions, typename Structure>
+	void validate(Runner & runner, const Structure & structure, const BruteForce<Dimensions> & reference,
+	              const Workload<Dimensions> & workload, const std::string & label)
+	{
+		std::vector<uint32_t> actual;
+		std::vector<uint32_t> expected;
+		const size_t          checks = std::min<size_t>(16, workload.query_centers.size());
+		for (size_t i = 0; i < checks; ++i) {
+			const auto & center = workload.query_centers[i];
+
+			actual.clear();
+			expected.clear();
+			structure.query_box(offset(center, -query_half_extent), offset(center, query_half_extent), actual);
+			reference.query_box(offset(center, -query_half_extent), offset(center, query_half_extent), expected);
+			std::sort(actual.begin(), actual.end());
+			std::sort(expected.begin(), expected.end());
+			if (actual != expected) {
+				runner.fail(label + " box query disagrees with brute force");
+				return;
+			}
+
+			actual.clear();
+			expected.clear();
+			structure.query_radius(center, query_radius, actual);
+			reference.query_radius(center, query_radius, expected);
+			std::sort(actual.begin(), actual.end());
+			std::sort(expected.begin(), expected.end());
+			if (actual != expected) {
+				runner.fail(label + " radius query disagrees with brute force");
+				return;
+			}
+
+			// ties may legitimately pick different objects, so compare the distances instead of ids
+			actual.clear();
+			expected.clear();
+			structure.query_knn(center, query_k, actual);
+			reference.query_knn(center, query_k, expected);
+			if (actual.size() != expected.size()) {
+				runner.fail(label + " kNN query returned the wrong number of objects");
+				return;
+			}
+			for (size_t j = 0; j < actual.size(); ++j) {
+				const float actual_distance =
+				    lochash::calculate_distance_squared<float, Dimensions>(workload.points[actual[j]], center);
+				const float expected_distance =
+				    lochash::calculate_distance_squared<float, Dimensions>(workload.points[expected[j]], center);
+				if (actual_distance != expected_distance) {
+					runner.fail(label + " kNN query disagrees with brute force");
+					return;
+				}
+			}
+		}
+	}
+
+	template <size_t Dimensions, typename Structure>
+	void run_structure(Runner & runner, const Workload<Dimensions> & workload)
+	{
+		const size_t count   = workload.points.size();
+		const auto   name_of = [&](const char * operation) {
+			return benchmark_name<Structure>(operation, workload.distribution, Dimensions, count);
+		};
+
+		Structure             structure;
+		std::vector<uint32_t> out;
+
+		runner.run(
+		    name_of("build"), count, [&]() { structure = Structure(); }, [&]() { structure.build(workload.points); });
+
+		// every object moves one step, then the structure is made queryable again
+		runner.run(
+		    name_of("update"), count, [&]() { structure.build(workload.points); },
+		    [&]() {
+			    for (uint32_t id = 0; id < count; ++id) {
+				    structure.update(id, workload.points[id], workload.moved[id]);
+			    }
+			    structure.finish_updates();
+		    });
+
+		structure.build(workload.points);
+		if (runner.options().validate && !runner.options().list) {
+			BruteForce<Dimensions> reference;
+			reference.build(workload.points);
+			validate(runner, structure, reference, workload, name_of("validate"));
+		}
+
+		const size_t queries = workload.query_centers.size();
+		runner.run(
+		    name_of("query_box"), queries, [&]() {},
+		    [&]() {
+			    for (const auto & center : workload.query_centers) {
+				    out.clear();
+				    structure.query_box(offset(center, -query_half_extent), offset(center, query_half_extent), out);
+				    do_not_optimize(out.size());
+			    }
+		    });
+
+		runner.run(
+		    name_of("query_radius"), queries, [&]() {},
+		    [&]() {
+			    for (const auto & center : workload.query_centers) {
+				    out.clear();
+				    structure.query_radius(center, query_radius, out);
+				    do_not_optimize(out.size());
+			    }
+		    });
+
+		runner.run(
+		    name_of("query_knn"), queries, [&]() {},
+		    [&]() {
+			    for (const auto & center : workload.query_centers) {
+				    out.clear();
+				    structure.query_knn(center, query_k, out);
+				    do_not_optimize(out.size());
+			    }
+		    });
+	}
+
+	template <size_t Dimensions>
+	void run_dimensions(Runner & runner)
+	{
+		for (const auto distribution : {Distribution::uniform, Distribution::clustered, Distribution::skewed}) {
+			for (const size_t count : runner.options().sizes) {
+				if (count == 0) {
+					continue;
+				}
+				const auto workload = make_workload<Dimensions>(distribution, count, runner.options().queries);
+				run_structure<Dimensions, LocationHashAdapter<Dimensions>>(runner, workload);
+				run_structure<Dimensions, NestedLocationHashAdapter<Dimensions>>(runner, workload);
+				run_structure<Dimensions, KdTree<Dimensions>>(runner, workload);
+				run_structure<Dimensions, RTree<Dimensions>>(runner, workload);
+				run_structure<Dimensions, BruteForce<Dimensions>>(runner, workload);
+			}
+		}
+	}
+} // namespace
+
+int main(int argc, char ** argv)
+{
+	Runner runner(parse_options(argc, argv));
+	run_dimensions<2>(runner);
+	run_dimensions<3>(runner);
+	return runner.exit_code();
+}
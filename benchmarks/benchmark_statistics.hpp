@@ -0,0 +1,346 @@
+#ifndef _INCLUDED_benchmark_statistics_hpp
+#define _INCLUDED_benchmark_statistics_hpp
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/// Per-benchmark samples in nanoseconds per operation, keyed by benchmark name.
+		using SampleSet = std::map<std::string, std::vector<double>>;
+
+		/**
+		 * @brief Reads a CSV written by Runner (`name,sample,ns_per_op`) and appends its samples to samples.
+		 *
+		 * @param path The CSV file.
+		 * @param samples Destination; repeated runs can be accumulated into the same set.
+		 * @return false if the file could not be opened.
+		 */
+		inline bool read_samples_csv(const std::string & path, SampleSet & samples)
+		{
+			std::ifstream input(path);
+			if (!input) {
+				return false;
+			}
+			std::string line;
+			while (std::getline(input, line)) {
+				// benchmark names never contain commas, so the value is everything after the last one
+				const size_t first = line.find(',');
+				const size_t last  = line.rfind(',');
+				if (first == std::string::npos || first == last) {
+					continue;
+				}
+				std::stringstream value(line.substr(last + 1));
+				double            ns_per_op = 0.0;
+				if (value >> ns_per_op) {
+					samples[line.substr(0, first)].push_back(ns_per_op);
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Median of values; 0 when empty.
+		 */
+		inline double median(std::vector<double> values)
+		{
+			if (values.empty()) {
+				return 0.0;
+			}
+			std::sort(values.begin(), values.end());
+			const size_t middle = values.size() / 2;
+			return values.size() % 2 == 1 ? values[middle] : (values[middle - 1] + values[middle]) / 2.0;
+		}
+
+		/**
+		 * @brief Two-sided p-value of the Mann-Whitney U test that a and b come from the same distribution.
+		 *
+		 * Rank based, so a few preempted samples cannot drag the result the way they drag a mean. Uses the normal
+		 * approximation with tie and continuity correction, which is adequate from about five samples per side.
+		 *
+		 * @return A p-value in [0, 1]; 1 when either side is empty or every sample is identical.
+		 */
+		inline double mann_whitney_p_value(const std::vector<double> & a, const std::vector<double> & b)
+		{
+			if (a.empty() || b.empty()) {
+				return 1.0;
+			}
+
+			std::vector<std::pair<double, bool>> pooled; // value, is from a
+			pooled.reserve(a.size() + b.size());
+			for (const double value : a) {
+				pooled.emplace_back(value, true);
+			}
+			for (const double value : b) {
+				pooled.emplace_back(value, false);
+			}
+			std::sort(pooled.begin(), pooled.end(),
+			          [](const auto & lhs, const auto & rhs) { return lhs.first < rhs.first; });
+
+			// tied values share the average of their ranks
+			const double n           = static_cast<double>(pooled.size());
+			double       rank_sum_a  = 0.0;
+			double       tie_penalty = 0.0;
+			for (size_t begin = 0; begin < pooled.size();) {
+				size_t end = begin + 1;
+				while (end < pooled.size() && pooled[end].first == pooled[begin].first) {
+					++end;
+				}
+				const double rank = (static_cast<double>(begin + end) + 1.0) / 2.0;
+				for (size_t i = begin; i < end; ++i) {
+					rank_sum_a += pooled[i].second ? rank : 0.0;
+				}
+				const double ties = static_cast<double>(end - begin);
+				tie_penalty += ties * ties * ties - ties;
+				begin = end;
+			}
+
+			const double n_a      = static_cast<double>(a.size());
+			const double n_b      = static_cast<double>(b.size());
+			const double u        = rank_sum_a - n_a * (n_a + 1.0) / 2.0;
+			const double mean     = n_a * n_b / 2.0;
+			const double variance = n_a * n_b / 12.0 * ((n + 1.0) - tie_penalty / (n * (n - 1.0)));
+			if (variance <= 0.0) {
+				return 1.0;
+			}
+			const double z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+			return std::min(1.0, std::erfc(z / std::sqrt(2.0)));
+		}
+
+		/**
+		 * @brief Outcome of comparing a candidate against a baseline.
+		 */
+		enum class Verdict { faster, slower, no_difference };
+
+		inline const char * to_string(Verdict verdict)
+		{
+			switch (verdict) {
+			case Verdict::faster:
+				return "faster";
+			case Verdict::slower:
+				return "slower";
+			default:
+				return "no difference";
+			}
+		}
+
+		/**
+		 * @brief Thresholds for calling a difference real.
+		 */
+		struct ComparisonOptions {
+			double   alpha      = 0.05;  // significance level, also sets the confidence interval to 1 - alpha
+			double   min_effect = 0.01;  // speedups within +/- this fraction of 1 are reported as no difference
+			size_t   resamples  = 2000;  // bootstrap resamples for the confidence interval
+			uint32_t seed       = 12345; // fixed so the same inputs always give the same report
+		};
+
+		/**
+		 * @brief Comparison of one benchmark between a baseline and a candidate.
+		 *
+		 * speedup is baseline median / candidate median, so values above 1 mean the candidate is faster.
+		 */
+		struct Comparison {
+			std::string name;
+			size_t      baseline_samples  = 0;
+			size_t      candidate_samples = 0;
+			double      baseline_median   = 0.0;
+			double      candidate_median  = 0.0;
+			double      speedup           = 1.0;
+			double      ci_low            = 1.0;
+			double      ci_high           = 1.0;
+			double      p_value           = 1.0;
+			Verdict     verdict           = Verdict::no_difference;
+		};
+
+		/**
+		 * @brief Compares two sets of samples of the same benchmark.
+		 *
+		 * The confidence interval of the speedup is a percentile bootstrap of the ratio of medians. A difference is
+		 * only reported when the Mann-Whitney test rejects equality at alpha, the interval excludes 1 and the
+		 * speedup clears min_effect, so noise alone rarely produces a verdict.
+		 */
+		inline Comparison compare_samples(const std::string & name, const std::vector<double> & baseline,
+		                                  const std::vector<double> & candidate, const ComparisonOptions & options = {})
+		{
+			Comparison result;
+			result.name              = name;
+			result.baseline_samples  = baseline.size();
+			result.candidate_samples = candidate.size();
+			if (baseline.empty() || candidate.empty()) {
+				return result;
+			}
+
+			result.baseline_median  = median(baseline);
+			result.candidate_median = median(candidate);
+			if (result.candidate_median <= 0.0) {
+				return result;
+			}
+			result.speedup = result.baseline_median / result.candidate_median;
+			result.p_value = mann_whitney_p_value(baseline, candidate);
+
+			std::mt19937                          rng(options.seed);
+			std::uniform_int_distribution<size_t> pick_baseline(0, baseline.size() - 1);
+			std::uniform_int_distribution<size_t> pick_candidate(0, candidate.size() - 1);
+			std::vector<double>                   resampled_baseline(baseline.size());
+			std::vector<double>                   resampled_candidate(candidate.size());
+			std::vector<double>                   ratios;
+			ratios.reserve(options.resamples);
+			for (size_t i = 0; i < options.resamples; ++i) {
+				for (auto & value : resampled_baseline) {
+					value = baseline[pick_baseline(rng)];
+				}
+				for (auto & value : resampled_candidate) {
+					value = candidate[pick_candidate(rng)];
+				}
+				const double candidate_median = median(resampled_candidate);
+				if (candidate_median > 0.0) {
+					ratios.push_back(median(resampled_baseline) / candidate_median);
+				}
+			}
+			if (!ratios.empty()) {
+				std::sort(ratios.begin(), ratios.end());
+				const auto at = [&](double fraction) {
+					const double position = fraction * static_cast<double>(ratios.size() - 1);
+					return ratios[static_cast<size_t>(std::lround(position))];
+				};
+				result.ci_low  = at(options.alpha / 2.0);
+				result.ci_high = at(1.0 - options.alpha / 2.0);
+			}
+
+			const bool significant = result.p_value < options.alpha;
+			if (significant && result.ci_low > 1.0 && result.speedup >= 1.0 + options.min_effect) {
+				result.verdict = Verdict::faster;
+			} else if (significant && result.ci_high < 1.0 && result.speedup <= 1.0 - options.min_effect) {
+				result.verdict = Verdict::slower;
+			}
+			return result;
+		}
+
+		/**
+		 * @brief Compares every benchmark present in both sets, in name order.
+		 */
+		inline std::vector<Comparison> compare_sample_sets(const SampleSet & baseline, const SampleSet & candidate,
+		                                                   const ComparisonOptions & options = {})
+		{
+			std::vector<Comparison> comparisons;
+			for (const auto & [name, samples] : baseline) {
+				const auto match = candidate.find(name);
+				if (match != candidate.end()) {
+					comparisons.push_back(compare_samples(name, samples, match->second, options));
+				}
+			}
+			return comparisons;
+		}
+
+		/**
+		 * @brief Jain's fairness index of per-thread amounts: 1 when every thread got the same share, 1/n when a
+		 * single thread got everything.
+		 *
+		 * @return The index in [1/n, 1]; 1 for no threads or when nobody got anything.
+		 */
+		inline double jain_fairness(const std::vector<double> & shares)
+		{
+			double sum         = 0.0;
+			double sum_squares = 0.0;
+			for (const double share : shares) {
+				sum += share;
+				sum_squares += share * share;
+			}
+			if (sum_squares <= 0.0) {
+				return 1.0;
+			}
+			return sum * sum / (static_cast<double>(shares.size()) * sum_squares);
+		}
+
+		/**
+		 * @brief Log-linear latency histogram with about 6% resolution over the full uint64_t range.
+		 *
+		 * Recording is a couple of instructions and never allocates, so each thread can keep its own and the
+		 * histograms are merged once the threads have stopped.
+		 */
+		class LatencyHistogram
+		{
+		  public:
+			void record(uint64_t nanoseconds)
+			{
+				++counts_[index_of(nanoseconds)];
+				++total_;
+			}
+
+			void merge(const LatencyHistogram & other)
+			{
+				for (size_t i = 0; i < bucket_count; ++i) {
+					counts_[i] += other.counts_[i];
+				}
+				total_ += other.total_;
+			}
+
+			uint64_t count() const { return total_; }
+
+			/**
+			 * @brief The smallest recorded value's bucket such that at least fraction of all values are at or
+			 * below it, reported as that bucket's lower bound.
+			 *
+			 * @param fraction In [0, 1], such as 0.99 for the 99th percentile.
+			 * @return The percentile in nanoseconds, 0 when nothing was recorded.
+			 */
+			uint64_t percentile(double fraction) const
+			{
+				if (total_ == 0) {
+					return 0;
+				}
+				const double   target = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total_);
+				const uint64_t rank   = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(target)));
+				uint64_t       seen   = 0;
+				size_t         i      = 0;
+				for (; i + 1 < bucket_count; ++i) {
+					seen += counts_[i];
+					if (seen >= rank) {
+						break;
+					}
+				}
+				return lower_bound_of(i);
+			}
+
+		  private:
+			// values below 16 get exact buckets; above that, 16 sub-buckets per power of two
+			static constexpr size_t sub_buckets  = 16;
+			static constexpr size_t bucket_count = (64 - 3) * sub_buckets;
+
+			static size_t index_of(uint64_t value)
+			{
+				if (value < sub_buckets) {
+					return static_cast<size_t>(value);
+				}
+				const size_t top_bit = static_cast<size_t>(std::bit_width(value)) - 1; // >= 4
+				const size_t sub     = static_cast<size_t>(value >> (top_bit - 4)) - sub_buckets;
+				return (top_bit - 3) * sub_buckets + sub;
+			}
+
+			static uint64_t lower_bound_of(size_t index)
+			{
+				if (index < sub_buckets) {
+					return index;
+				}
+				const size_t top_bit = index / sub_buckets + 3;
+				return static_cast<uint64_t>(sub_buckets + index % sub_buckets) << (top_bit - 4);
+			}
+
+			std::array<uint64_t, bucket_count> counts_{};
+			uint64_t                           total_ = 0;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_benchmark_statistics_hpp
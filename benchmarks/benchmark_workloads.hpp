@@ -0,0 +1,117 @@
+#ifndef _INCLUDED_benchmark_workloads_hpp
+#define _INCLUDED_benchmark_workloads_hpp
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief Spatial distributions used to generate benchmark data.
+		 *
+		 * uniform   - evenly spread over the world, the best case for a fixed grid.
+		 * clustered - gaussian blobs, like towns or squads, with dense buckets and large empty areas.
+		 * skewed    - density falls off exponentially from one corner, a mix of crowded and sparse buckets.
+		 */
+		enum class Distribution { uniform, clustered, skewed };
+
+		inline const char * to_string(Distribution distribution)
+		{
+			switch (distribution) {
+			case Distribution::uniform:
+				return "uniform";
+			case Distribution::clustered:
+				return "clustered";
+			case Distribution::skewed:
+				return "skewed";
+			default:
+				return "unknown";
+			}
+		}
+
+		/// Average spacing between objects. The world grows with the object count so density stays fixed.
+		constexpr float object_spacing = 8.0f;
+
+		template <size_t Dimensions>
+		float world_extent(size_t count)
+		{
+			return object_spacing *
+			       std::pow(static_cast<float>(std::max<size_t>(count, 1)), 1.0f / static_cast<float>(Dimensions));
+		}
+
+		template <size_t Dimensions>
+		std::vector<std::array<float, Dimensions>> generate_points(Distribution distribution, size_t count,
+		                                                           uint32_t seed)
+		{
+			std::mt19937                                rng(seed);
+			const float                                 extent = world_extent<Dimensions>(count);
+			std::uniform_real_distribution<float>       uniform(0.0f, extent);
+			std::vector<std::array<float, Dimensions>> points(count);
+
+			switch (distribution) {
+			case Distribution::uniform:
+				for (auto & point : points) {
+					for (auto & value : point) {
+						value = uniform(rng);
+					}
+				}
+				break;
+			case Distribution::clustered: {
+				constexpr size_t                           cluster_count = 16;
+				std::vector<std::array<float, Dimensions>> centers(cluster_count);
+				for (auto & center : centers) {
+					for (auto & value : center) {
+						value = uniform(rng);
+					}
+				}
+				std::normal_distribution<float>       spread(0.0f, extent / 32.0f);
+				std::uniform_int_distribution<size_t> pick(0, cluster_count - 1);
+				for (auto & point : points) {
+					const auto & center = centers[pick(rng)];
+					for (size_t i = 0; i < Dimensions; ++i) {
+						point[i] = std::clamp(center[i] + spread(rng), 0.0f, extent);
+					}
+				}
+				break;
+			}
+			case Distribution::skewed: {
+				std::exponential_distribution<float> falloff(8.0f / extent);
+				for (auto & point : points) {
+					for (auto & value : point) {
+						value = std::min(falloff(rng), extent);
+					}
+				}
+				break;
+			}
+			}
+			return points;
+		}
+
+		/**
+		 * @brief Small per-tick displacements, as if every object moved for one simulation step.
+		 */
+		template <size_t Dimensions>
+		std::vector<std::array<float, Dimensions>> jitter_points(const std::vector<std::array<float, Dimensions>> & points,
+		                                                         float max_step, uint32_t seed)
+		{
+			std::mt19937                               rng(seed);
+			std::uniform_real_distribution<float>      step(-max_step, max_step);
+			std::vector<std::array<float, Dimensions>> moved = points;
+			for (auto & point : moved) {
+				for (auto & value : point) {
+					value += step(rng);
+				}
+			}
+			return moved;
+		}
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_benchmark_workloads_hpp
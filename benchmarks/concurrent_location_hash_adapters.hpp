@@ -0,0 +1,171 @@
+#ifndef _INCLUDED_concurrent_location_hash_adapters_hpp
+#define _INCLUDED_concurrent_location_hash_adapters_hpp
+
+#include "lochash/location_hash_query_bounding_box.hpp"
+#include "lochash/lochash.hpp"
+#include "location_hash_adapters.hpp"
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/**
+		 * @brief LocationHash behind one reader/writer lock. Queries run in parallel, every mutation serializes.
+		 *
+		 * The concurrent adapters share one interface so the churn stress benchmark can drive any of them:
+		 * add, remove, move, query_box and for_each_entry (the latter only once all threads have stopped).
+		 */
+		template <size_t Dimensions>
+		class LockedLocationHash
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+			using Hash  = LocationHash<bucket_precision, float, Dimensions, Item>;
+
+			static constexpr const char * name = "locked";
+
+			void add(Item * item, const Point & position)
+			{
+				std::unique_lock lock(mutex_);
+				hash_.add(item, position);
+			}
+
+			bool remove(Item * item, const Point & position)
+			{
+				std::unique_lock lock(mutex_);
+				return hash_.remove(item, position);
+			}
+
+			void move(Item * item, const Point & from, const Point & to)
+			{
+				std::unique_lock lock(mutex_);
+				hash_.move(item, from, to);
+			}
+
+			void query_box(const Point & lower, const Point & upper, std::vector<Item *> & out) const
+			{
+				std::shared_lock lock(mutex_);
+				query_bounding_box(hash_, lower, upper, out);
+			}
+
+			template <typename Visitor>
+			void for_each_entry(Visitor && visitor) const
+			{
+				for (const auto & [key, bucket] : hash_.get_data()) {
+					for (const auto & [position, item] : bucket) {
+						visitor(key, position, item);
+					}
+				}
+			}
+
+		  private:
+			mutable std::shared_mutex mutex_;
+			Hash                      hash_;
+		};
+
+		/**
+		 * @brief LocationHash split into shards by bucket key, each behind its own reader/writer lock.
+		 *
+		 * Writers to different shards proceed in parallel. A move between shards holds both locks, taken in shard
+		 * order so two crossing moves cannot deadlock. A box query locks one shard at a time as it visits each
+		 * bucket, so it sees every bucket in a consistent state but not the whole box at one instant.
+		 */
+		template <size_t Dimensions, size_t ShardCount = 64>
+		class ShardedLocationHash
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+			using Hash  = LocationHash<bucket_precision, float, Dimensions, Item>;
+			using Key   = typename Hash::QuantizedCoordinateType;
+
+			static constexpr const char * name = "sharded";
+
+			void add(Item * item, const Point & position)
+			{
+				Shard &          shard = shard_of(Key(position));
+				std::unique_lock lock(shard.mutex);
+				shard.hash.add(item, position);
+			}
+
+			bool remove(Item * item, const Point & position)
+			{
+				Shard &          shard = shard_of(Key(position));
+				std::unique_lock lock(shard.mutex);
+				return shard.hash.remove(item, position);
+			}
+
+			void move(Item * item, const Point & from, const Point & to)
+			{
+				const Key from_key(from);
+				const Key to_key(to);
+				if (from_key == to_key) {
+					return;
+				}
+				Shard & source      = shard_of(from_key);
+				Shard & destination = shard_of(to_key);
+				if (&source == &destination) {
+					std::unique_lock lock(source.mutex);
+					source.hash.move(item, from, to);
+					return;
+				}
+				std::unique_lock first(&source < &destination ? source.mutex : destination.mutex);
+				std::unique_lock second(&source < &destination ? destination.mutex : source.mutex);
+				if (source.hash.remove(item, from)) {
+					destination.hash.add(item, to);
+				}
+			}
+
+			void query_box(const Point & lower, const Point & upper, std::vector<Item *> & out) const
+			{
+				out.clear();
+				for_each_quantized_coordinate_within_range<bucket_precision, float, Dimensions>(
+				    lower, upper, [&](const Key & key) {
+					    const Shard &    shard = shard_of(key);
+					    std::shared_lock lock(shard.mutex);
+					    const auto &     data = shard.hash.get_data();
+					    const auto       it   = data.find(key);
+					    if (it != data.end()) {
+						    for (const auto & [position, item] : it->second) {
+							    if (detail::within_bounds(position, lower, upper)) {
+								    out.push_back(item);
+							    }
+						    }
+					    }
+				    });
+			}
+
+			template <typename Visitor>
+			void for_each_entry(Visitor && visitor) const
+			{
+				for (const auto & shard : shards_) {
+					for (const auto & [key, bucket] : shard.hash.get_data()) {
+						for (const auto & [position, item] : bucket) {
+							visitor(key, position, item);
+						}
+					}
+				}
+			}
+
+		  private:
+			// each shard on its own cache line so uncontended locks do not share one
+#pragma warning(push)
+#pragma warning(disable : 4324) // padding is the point
+			struct alignas(64) Shard {
+				mutable std::shared_mutex mutex;
+				Hash                      hash;
+			};
+#pragma warning(pop)
+
+			Shard & shard_of(const Key & key) { return shards_[std::hash<Key>()(key) % ShardCount]; }
+			const Shard & shard_of(const Key & key) const { return shards_[std::hash<Key>()(key) % ShardCount]; }
+
+			std::array<Shard, ShardCount> shards_;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_concurrent_location_hash_adapters_hpp
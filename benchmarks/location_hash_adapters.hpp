@@ -0,0 +1,210 @@
+#ifndef _INCLUDED_location_hash_adapters_hpp
+#define _INCLUDED_location_hash_adapters_hpp
+
+#include "lochash/location_hash_query_bounding_box.hpp"
+#include "lochash/location_hash_query_distance_squared.hpp"
+#include "lochash/location_hash_query_nearest.hpp"
+#include "lochash/lochash.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace lochash
+{
+	namespace benchmarks
+	{
+		/// Payload stored in the location hashes. The id indexes the benchmark's position array.
+		struct Item {
+			uint32_t id;
+		};
+
+		/// Bucket size used by the flat location hash, and by the leaves of the nested variant.
+		constexpr size_t bucket_precision = 16;
+
+		/// Region size of the outer level of the nested variant.
+		constexpr size_t region_precision = 256;
+
+		/**
+		 * @brief Exposes LocationHash through the common benchmark interface using the public query helpers, exactly
+		 * as a caller would use it.
+		 */
+		template <size_t Dimensions>
+		class LocationHashAdapter
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+			using Hash  = LocationHash<bucket_precision, float, Dimensions, Item>;
+
+			static constexpr const char * name = "location_hash";
+
+			void build(const std::vector<Point> & points)
+			{
+				hash_.clear();
+				items_.resize(points.size());
+				for (uint32_t id = 0; id < points.size(); ++id) {
+					items_[id].id = id;
+					hash_.add(&items_[id], points[id]);
+				}
+			}
+
+			void update(uint32_t id, const Point & old_position, const Point & new_position)
+			{
+				hash_.move(&items_[id], old_position, new_position);
+			}
+
+			void finish_updates() {}
+
+			void query_box(const Point & lower, const Point & upper, std::vector<uint32_t> & out) const
+			{
+				for (const Item * item : query_bounding_box(hash_, lower, upper)) {
+					out.push_back(item->id);
+				}
+			}
+
+			void query_radius(const Point & center, float radius, std::vector<uint32_t> & out) const
+			{
+				for (const Item * item : query_within_distance(hash_, center, radius)) {
+					out.push_back(item->id);
+				}
+			}
+
+			void query_knn(const Point & center, size_t k, std::vector<uint32_t> & out) const
+			{
+				for (const Item * item : query_nearest(hash_, center, k)) {
+					out.push_back(item->id);
+				}
+			}
+
+		  private:
+			Hash              hash_;
+			std::vector<Item> items_;
+		};
+
+		/**
+		 * @brief The two level arrangement from test_location_hash_recursion.cpp: an outer LocationHash of large
+		 * regions whose objects are per-region LocationHashes of small buckets.
+		 */
+		template <size_t Dimensions>
+		class NestedLocationHashAdapter
+		{
+		  public:
+			using Point = std::array<float, Dimensions>;
+			using Inner = LocationHash<bucket_precision, float, Dimensions, Item>;
+			using Outer = LocationHash<region_precision, float, Dimensions, Inner>;
+
+			static constexpr const char * name = "nested_location_hash";
+
+			void build(const std::vector<Point> & points)
+			{
+				outer_.clear();
+				regions_.clear();
+				positions_ = points;
+				items_.resize(points.size());
+				for (uint32_t id = 0; id < points.size(); ++id) {
+					items_[id].id = id;
+					region_for(points[id]).add(&items_[id], points[id]);
+				}
+			}
+
+			void update(uint32_t id, const Point & old_position, const Point & new_position)
+			{
+				Inner & old_region = region_for(old_position);
+				Inner & new_region = region_for(new_position);
+				if (&old_region == &new_region) {
+					old_region.move(&items_[id], old_position, new_position);
+				} else {
+					old_region.remove(&items_[id], old_position);
+					new_region.add(&items_[id], new_position);
+				}
+				positions_[id] = new_position;
+			}
+
+			void finish_updates() {}
+
+			void query_box(const Point & lower, const Point & upper, std::vector<uint32_t> & out) const
+			{
+				for_each_region(lower, upper, [&](const Inner & region) {
+					for (const Item * item : query_bounding_box(region, lower, upper)) {
+						out.push_back(item->id);
+					}
+				});
+			}
+
+			void query_radius(const Point & center, float radius, std::vector<uint32_t> & out) const
+			{
+				Point lower;
+				Point upper;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					lower[i] = center[i] - radius;
+					upper[i] = center[i] + radius;
+				}
+				for_each_region(lower, upper, [&](const Inner & region) {
+					for (const Item * item : query_within_distance(region, center, radius)) {
+						out.push_back(item->id);
+					}
+				});
+			}
+
+			/// kNN by doubling a radius search until k objects are inside it, the usual approach with nested grids.
+			void query_knn(const Point & center, size_t k, std::vector<uint32_t> & out) const
+			{
+				if (k == 0 || items_.empty()) {
+					return;
+				}
+				std::vector<uint32_t> candidates;
+				for (float radius = static_cast<float>(bucket_precision);; radius *= 2.0f) {
+					candidates.clear();
+					query_radius(center, radius, candidates);
+					if (candidates.size() >= k || candidates.size() == items_.size()) {
+						break;
+					}
+				}
+				const size_t count = std::min(k, candidates.size());
+				std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+				                  [&](uint32_t a, uint32_t b) { return distance_to(a, center) < distance_to(b, center); });
+				out.insert(out.end(), candidates.begin(), candidates.begin() + count);
+			}
+
+		  private:
+			Inner & region_for(const Point & position)
+			{
+				auto & bucket = outer_.query(position);
+				if (!bucket.empty()) {
+					return *bucket.front().second;
+				}
+				regions_.emplace_back();
+				outer_.add(&regions_.back(), position);
+				return regions_.back();
+			}
+
+			template <typename Visitor>
+			void for_each_region(const Point & lower, const Point & upper, Visitor && visitor) const
+			{
+				const auto & outer_data = outer_.get_data();
+				for (const auto & key :
+				     generate_all_quantized_coordinates_within_range<region_precision, float, Dimensions>(lower, upper)) {
+					const auto it = outer_data.find(key);
+					if (it != outer_data.end()) {
+						for (const auto & entry : it->second) {
+							visitor(*entry.second);
+						}
+					}
+				}
+			}
+
+			float distance_to(uint32_t id, const Point & center) const
+			{
+				return calculate_distance_squared<float, Dimensions>(positions_[id], center);
+			}
+
+			Outer              outer_;
+			std::deque<Inner>  regions_;
+			std::vector<Item>  items_;
+			std::vector<Point> positions_;
+		};
+	} // namespace benchmarks
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_adapters_hpp
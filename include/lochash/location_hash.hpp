@@ -5,6 +5,8 @@
 #include "location_hash_quantized_coordinate.hpp"
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -44,6 +46,7 @@ namespace lochash
             Hash, KeyEqual, Allocator>;
 		using QuantizedCoordinateType =
 		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+		using node_type = typename CoordinateMap::node_type;
 
 		/**
 		 * Adds coordinates and optionally an associated object pointer to the appropriate bucket.
@@ -111,6 +114,21 @@ namespace lochash
 			}
 		}
 
+		/**
+		 * Retrieves the bucket with a quantized key, as the other index types do.
+		 *
+		 * @param key The quantized key of the bucket.
+		 * @return The bucket's entries, empty if the bucket is not occupied.
+		 */
+		std::span<const typename BucketContent::value_type> find(const QuantizedCoordinateType & key) const
+		{
+			const auto it = data_.find(key);
+			if (it == data_.end()) {
+				return {};
+			}
+			return it->second;
+		}
+
 		/**
 		 * Removes a coordinate and optionally an associated object from the appropriate bucket.
 		 *
@@ -301,7 +319,247 @@ namespace lochash
 		 */
 		void clear() { data_.clear(); }
 
+		/**
+		 * @brief Moves every bucket whose cell overlaps a box out of the LocationHash. Buckets are moved as map
+		 *   nodes, so no entries are copied and nothing is rehashed. Regions are cell-aligned: entries in a cell on
+		 *   the edge of the box move with their cell even if they lie outside the box.
+		 *
+		 * @param lower_bounds The lower bounds of the region.
+		 * @param upper_bounds The upper bounds of the region.
+		 * @return The removed buckets, ready to be saved or passed back to load_region.
+		 */
+		CoordinateMap unload_region(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds)
+		{
+			CoordinateMap cells;
+			for_each_cell_in_region(lower_bounds, upper_bounds,
+			                        [&](typename CoordinateMap::iterator it) { cells.insert(data_.extract(it)); });
+			return cells;
+		}
+
+		/**
+		 * @brief Removes every entry within a box. Buckets of cells lying wholly inside the box are dropped without
+		 *   looking at their entries; buckets on the edge of the box are filtered in place.
+		 *
+		 * @param lower_bounds The lower bounds of the box.
+		 * @param upper_bounds The upper bounds of the box.
+		 * @return The number of entries removed.
+		 */
+		size_t clear_region(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds)
+		{
+			const QuantizedCoordinateType lower(lower_bounds);
+			const QuantizedCoordinateType upper(upper_bounds);
+			size_t                        removed = 0;
+			for_each_cell_in_region(lower_bounds, upper_bounds, [&](typename CoordinateMap::iterator it) {
+				auto &       bucket = it->second;
+				const size_t before = bucket.size();
+				if (key_inside(it->first, lower, upper)) {
+					bucket.clear();
+				} else {
+					std::erase_if(bucket, [&](const auto & entry) {
+						return within_box(entry.first, lower_bounds, upper_bounds);
+					});
+				}
+				removed += before - bucket.size();
+				if (bucket.empty()) {
+					data_.erase(it);
+				}
+			});
+			return removed;
+		}
+
+		/**
+		 * @brief Removes every entry for which predicate returns true, compacting each bucket in a single pass and
+		 *   dropping buckets left empty.
+		 *
+		 * @param predicate Called as predicate(coordinates, object) for each entry.
+		 * @return The number of entries removed.
+		 */
+		template <typename Predicate>
+		size_t erase_if(Predicate && predicate)
+		{
+			size_t removed = 0;
+			for (auto it = data_.begin(); it != data_.end();) {
+				removed += std::erase_if(it->second,
+				                         [&](const auto & entry) { return predicate(entry.first, entry.second); });
+				it = it->second.empty() ? data_.erase(it) : std::next(it);
+			}
+			return removed;
+		}
+
+		/**
+		 * @brief Moves buckets into the LocationHash, typically ones returned by unload_region or loaded from a region
+		 *   snapshot. Buckets for unoccupied cells are moved in as map nodes; entries for cells that are already
+		 *   occupied are appended to the existing bucket.
+		 *
+		 * @param cells The buckets to add. Left empty.
+		 */
+		void load_region(CoordinateMap && cells) { splice(cells); }
+
+		/**
+		 * @brief Detaches the bucket of one cell as a map node, without copying its entries.
+		 *
+		 * @param key The cell to detach.
+		 * @return The node, empty if the cell was not occupied.
+		 */
+		node_type extract(const QuantizedCoordinateType & key) { return data_.extract(key); }
+
+		/**
+		 * @brief Splices in a bucket detached by extract(), from this or another LocationHash of the same type. If
+		 *   the cell is already occupied, the node's entries are appended to the existing bucket.
+		 *
+		 * @param node The node to insert. Empty nodes are ignored.
+		 */
+		void insert(node_type && node)
+		{
+			if (node.empty()) {
+				return;
+			}
+			auto result = data_.insert(std::move(node));
+			if (!result.inserted) {
+				append(result.position->second, result.node.mapped());
+			}
+		}
+
+		/**
+		 * @brief Moves every bucket of other into this LocationHash, as map nodes where the cell is unoccupied here.
+		 *
+		 * @param other The LocationHash to empty into this one.
+		 */
+		void merge(LocationHash & other) { splice(other.data_); }
+
+		/**
+		 * @brief Moves the buckets whose keys satisfy predicate into a new LocationHash, as map nodes. Splits are
+		 *   cell-aligned: a bucket moves as a whole.
+		 *
+		 * @param predicate Called as predicate(key) for each occupied cell.
+		 * @return The LocationHash holding the moved buckets.
+		 */
+		template <typename Predicate>
+		LocationHash split_by(Predicate && predicate)
+		{
+			LocationHash split;
+			for (auto it = data_.begin(); it != data_.end();) {
+				const auto next = std::next(it);
+				if (predicate(static_cast<const QuantizedCoordinateType &>(it->first))) {
+					split.data_.insert(data_.extract(it));
+				}
+				it = next;
+			}
+			return split;
+		}
+
+		/**
+		 * @brief Moves the buckets on the far side of an axis-aligned plane into a new LocationHash: the cells whose
+		 *   key along axis is at least that of the cell containing position. Entries in that cell move with it.
+		 *
+		 * @param axis The axis the plane is perpendicular to.
+		 * @param position Where the plane crosses the axis.
+		 * @return The LocationHash holding the moved buckets.
+		 */
+		LocationHash split_by(size_t axis, CoordinateType position)
+		{
+			const auto plane = quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(position);
+			return split_by([&](const QuantizedCoordinateType & key) { return key.quantized_[axis] >= plane; });
+		}
+
+		/**
+		 * @brief Replaces the whole bucket of a cell, erasing the cell when the new bucket is empty.
+		 *
+		 * @param key The cell to replace.
+		 * @param bucket The new contents of the cell.
+		 */
+		void replace_bucket(const QuantizedCoordinateType & key, BucketContent && bucket)
+		{
+			if (bucket.empty()) {
+				data_.erase(key);
+			} else {
+				data_.insert_or_assign(key, std::move(bucket));
+			}
+		}
+
 	  private:
+		// Calls visit(iterator) for each occupied cell overlapping a box, enumerating the cells of the box or scanning
+		// the occupied cells, whichever is fewer. visit may erase or extract the cell it is given.
+		template <typename Visit>
+		void for_each_cell_in_region(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds,
+		                             Visit && visit)
+		{
+			QuantizedCoordinateType lower;
+			QuantizedCoordinateType upper;
+			size_t                  region_cells = 1;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				lower.quantized_[i] =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(lower_bounds[i]);
+				upper.quantized_[i] =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(upper_bounds[i]);
+				if (upper.quantized_[i] < lower.quantized_[i]) {
+					return;
+				}
+				// capped just past the occupied count, so a huge region cannot overflow
+				const auto cap          = data_.size() + 1;
+				const auto cells_across = static_cast<size_t>(upper.quantized_[i] - lower.quantized_[i]) / Precision;
+				region_cells            = std::min(region_cells * std::min(cells_across + 1, cap), cap);
+			}
+
+			if (region_cells <= data_.size()) {
+				for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+				                                           QuantizedCoordinateIntegerType>(
+				    lower_bounds, upper_bounds, [&](const auto & key) {
+					    const auto it = data_.find(key);
+					    if (it != data_.end()) {
+						    visit(it);
+					    }
+				    });
+			} else {
+				for (auto it = data_.begin(); it != data_.end();) {
+					const auto next = std::next(it);
+					if (key_within(it->first, lower, upper)) {
+						visit(it);
+					}
+					it = next;
+				}
+			}
+		}
+
+		// True if the cell is strictly inside the cells of the box, so every point it can hold is within the box.
+		static bool key_inside(const QuantizedCoordinateType & key, const QuantizedCoordinateType & lower,
+		                       const QuantizedCoordinateType & upper)
+		{
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (key.quantized_[i] <= lower.quantized_[i] || upper.quantized_[i] <= key.quantized_[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		static bool within_box(const CoordinateArray & coordinates, const CoordinateArray & lower_bounds,
+		                       const CoordinateArray & upper_bounds)
+		{
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (coordinates[i] < lower_bounds[i] || upper_bounds[i] < coordinates[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		// Moves every bucket of cells in, as map nodes where the cell is unoccupied here. Leaves cells empty.
+		void splice(CoordinateMap & cells)
+		{
+			data_.merge(cells);
+			for (auto & [key, bucket] : cells) {
+				append(data_[key], bucket);
+			}
+			cells.clear();
+		}
+
+		static void append(BucketContent & bucket, BucketContent & entries)
+		{
+			bucket.insert(bucket.end(), std::make_move_iterator(entries.begin()),
+			              std::make_move_iterator(entries.end()));
+		}
+
 		bool buckets_match(const CoordinateArray & coords1, const CoordinateArray & coords2) const
 		{
 			// Keep in mind that these are quantized coordinates. The coordinate arrays can be different
@@ -314,6 +572,17 @@ namespace lochash
 			return false;
 		}
 
+		static bool key_within(const QuantizedCoordinateType & key, const QuantizedCoordinateType & lower,
+		                       const QuantizedCoordinateType & upper)
+		{
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (key.quantized_[i] < lower.quantized_[i] || upper.quantized_[i] < key.quantized_[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
 		bool coordinates_match(const CoordinateArray & coords1, const CoordinateArray & coords2) const
 		{
 			// This has not turned up in profiling as a bottleneck, but it could be optimized
@@ -0,0 +1,165 @@
+#ifndef _INCLUDED_location_hash_all_nearest_hpp
+#define _INCLUDED_location_hash_all_nearest_hpp
+
+#include "location_hash_algorithm.hpp"
+#include "location_hash_cell_grid.hpp"
+#include <algorithm>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief The result of all_nearest_neighbors(): up to k neighbours for each entry of the CellGrid it ran on,
+	 * nearest first. An entry has fewer than k only when the grid holds fewer than k others.
+	 */
+	template <typename CoordinateType>
+	struct NearestNeighbors {
+		size_t k = 0;
+		// Entry i has found[i] neighbours, in slots i * k onwards of neighbor_slots and distance_slots.
+		std::vector<size_t>         found;
+		std::vector<size_t>         neighbor_slots;
+		std::vector<CoordinateType> distance_slots;
+
+		/**
+		 * @brief The entry numbers of the neighbours of an entry, nearest first.
+		 */
+		std::span<const size_t> neighbors(size_t entry) const
+		{
+			return {neighbor_slots.data() + entry * k, found[entry]};
+		}
+
+		/**
+		 * @brief The squared distances to the neighbours of an entry, in the order of neighbors(entry).
+		 */
+		std::span<const CoordinateType> distances_squared(size_t entry) const
+		{
+			return {distance_slots.data() + entry * k, found[entry]};
+		}
+	};
+
+	/**
+	 * @brief Finds the k nearest other entries of every entry of a grid.
+	 *
+	 * Each occupied cell is handled as one: its entries share the candidates from the rings of cells around it,
+	 * probed outward one ring at a time, and the walk stops once every entry's k-th neighbour is closer than any
+	 * point of the next ring can be. Probing is thus shared by all the entries of a cell rather than repeated
+	 * per entry, and in evenly filled space each cell only looks one or two rings out. A cell far from the rest
+	 * stops probing rings once that would cost more than looking at every occupied cell, and looks at those
+	 * instead. Cells are shared out between threads, each writing only the results of its own cells' entries.
+	 *
+	 * @param grid The entries to search.
+	 * @param k The number of neighbours to find for each entry.
+	 * @param threads The number of threads to use, or 0 for one per hardware thread.
+	 * @return A NearestNeighbors with up to k neighbours per entry of grid.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	NearestNeighbors<CoordinateType> all_nearest_neighbors(
+	    const CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> & grid,
+	    size_t k, size_t threads = 0)
+	{
+		using Grid    = CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>;
+		using Cell    = typename Grid::Cell;
+		using Integer = QuantizedCoordinateIntegerType;
+
+		constexpr auto step     = static_cast<Integer>(Precision);
+		constexpr auto infinity = std::numeric_limits<CoordinateType>::has_infinity
+		                              ? std::numeric_limits<CoordinateType>::infinity()
+		                              : std::numeric_limits<CoordinateType>::max();
+
+		NearestNeighbors<CoordinateType> result;
+		result.k = k;
+		result.found.assign(grid.size(), 0);
+		result.neighbor_slots.resize(grid.size() * k);
+		result.distance_slots.resize(grid.size() * k);
+		if (k == 0) {
+			return result;
+		}
+
+		// Keeps the slots of an entry sorted by distance, dropping the farthest when they are full.
+		const auto offer = [&](size_t entry, size_t candidate) {
+			const auto distance_squared =
+			    calculate_distance_squared(grid.coordinates(entry), grid.coordinates(candidate));
+			size_t * neighbors = result.neighbor_slots.data() + entry * k;
+			auto *   distances = result.distance_slots.data() + entry * k;
+			size_t & found     = result.found[entry];
+			if (found == k && distance_squared >= distances[k - 1]) {
+				return;
+			}
+			size_t slot = found < k ? found++ : k - 1;
+			while (slot > 0 && distances[slot - 1] > distance_squared) {
+				neighbors[slot] = neighbors[slot - 1];
+				distances[slot] = distances[slot - 1];
+				--slot;
+			}
+			neighbors[slot] = candidate;
+			distances[slot] = distance_squared;
+		};
+		// The largest distance within which an entry of the cell may still gain a neighbour.
+		const auto reach_squared = [&](const Cell & cell) {
+			CoordinateType reach = 0;
+			for (size_t entry = cell.first; entry < cell.first + cell.count; ++entry) {
+				reach = std::max(reach,
+				                 result.found[entry] < k ? infinity : result.distance_slots[entry * k + k - 1]);
+			}
+			return reach;
+		};
+		const auto offer_cell = [&](const Cell & cell, const Cell & other) {
+			for (size_t entry = cell.first; entry < cell.first + cell.count; ++entry) {
+				for (size_t candidate = other.first; candidate < other.first + other.count; ++candidate) {
+					if (candidate != entry) {
+						offer(entry, candidate);
+					}
+				}
+			}
+		};
+
+		const auto search = [&](const Cell & cell) {
+			size_t seen   = 0;
+			size_t probes = 0;
+			for (Integer ring = 0;; ++ring) {
+				for_each_quantized_coordinate_in_shell<Precision, CoordinateType, Dimensions, Integer>(
+				    cell.key, static_cast<size_t>(ring), [&](const auto & key) {
+					    ++probes;
+					    if (const Cell * other = grid.find(key)) {
+						    offer_cell(cell, *other);
+						    seen += other->count;
+					    }
+				    });
+				if (seen == grid.size()) {
+					return;
+				}
+				// Points ring + 1 cells away or more are at least ring cells apart.
+				const auto gap   = static_cast<CoordinateType>(ring * step);
+				const auto reach = reach_squared(cell);
+				if (reach <= gap * gap) {
+					return;
+				}
+				if (probes >= grid.cell_count()) {
+					// Probing further rings would cost more than looking at every cell beyond them.
+					for (const Cell & other : grid.cells()) {
+						bool beyond = false;
+						for (size_t i = 0; i < Dimensions; ++i) {
+							beyond = beyond ||
+							         std::abs(other.key.quantized_[i] - cell.key.quantized_[i]) > ring * step;
+						}
+						if (beyond && Grid::min_distance_squared(cell, other) < reach) {
+							offer_cell(cell, other);
+						}
+					}
+					return;
+				}
+			}
+		};
+		detail::parallel_for_ranges(grid.cell_count(), 64, threads, [&](size_t first, size_t last) {
+			for (size_t c = first; c < last; ++c) {
+				search(grid.cells()[c]);
+			}
+		});
+		return result;
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_all_nearest_hpp
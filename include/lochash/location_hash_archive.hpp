@@ -0,0 +1,678 @@
+#ifndef _INCLUDED_location_hash_archive_hpp
+#define _INCLUDED_location_hash_archive_hpp
+
+#include "location_hash.hpp"
+#include "location_hash_varint.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	namespace detail
+	{
+		/**
+		 * @brief Orders integer points along a Z-order (Morton) curve without interleaving their bits, so it works
+		 * for any integer width and number of dimensions. Two points compare by their coordinates on the axis where
+		 * they differ in the highest bit.
+		 */
+		template <typename Integer, size_t Dimensions>
+		bool morton_less(const std::array<Integer, Dimensions> & a, const std::array<Integer, Dimensions> & b)
+		{
+			using Unsigned = std::make_unsigned_t<Integer>;
+			// flipping the sign bit orders signed values as their unsigned bit patterns
+			constexpr Unsigned bias =
+			    std::is_signed_v<Integer> ? Unsigned(Unsigned(1) << (std::numeric_limits<Unsigned>::digits - 1)) : 0;
+
+			size_t   axis    = 0;
+			Unsigned highest = 0;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				const auto differing = static_cast<Unsigned>(static_cast<Unsigned>(a[i]) ^ static_cast<Unsigned>(b[i]));
+				if (highest < differing && highest < static_cast<Unsigned>(highest ^ differing)) {
+					axis    = i;
+					highest = differing;
+				}
+			}
+			return static_cast<Unsigned>(static_cast<Unsigned>(a[axis]) ^ bias) <
+			       static_cast<Unsigned>(static_cast<Unsigned>(b[axis]) ^ bias);
+		}
+
+		/**
+		 * @brief Encodes a floating point value as the difference of its magnitude's bit pattern from that of
+		 * reference, zigzag encoded, with its sign moved to the lowest bit. Unlike encode_delta, values of either
+		 * sign near reference stay short. Exact for every value, including negative zero, infinities and NaNs.
+		 *
+		 * @param reference A magnitude: not negative.
+		 */
+		template <typename T>
+		uint64_t encode_sign_and_magnitude(T value, T reference)
+		{
+			using Bits                        = bits_of_t<T>;
+			constexpr unsigned magnitude_bits = std::numeric_limits<Bits>::digits - 1;
+			constexpr uint64_t mask           = (uint64_t{1} << magnitude_bits) - 1;
+
+			const uint64_t base       = std::bit_cast<Bits>(reference);
+			const uint64_t bits       = std::bit_cast<Bits>(value);
+			const uint64_t difference = ((bits & mask) - base) & mask;
+			const uint64_t negative   = difference >> (magnitude_bits - 1);
+			const uint64_t zigzag     = ((difference << 1) & mask) ^ (negative != 0 ? mask : 0);
+			return zigzag << 1 | bits >> magnitude_bits;
+		}
+
+		/**
+		 * @brief The value a result of encode_sign_and_magnitude was taken from.
+		 */
+		template <typename T>
+		T decode_sign_and_magnitude(uint64_t encoded, T reference)
+		{
+			using Bits                        = bits_of_t<T>;
+			constexpr unsigned magnitude_bits = std::numeric_limits<Bits>::digits - 1;
+			constexpr uint64_t mask           = (uint64_t{1} << magnitude_bits) - 1;
+
+			const uint64_t base       = std::bit_cast<Bits>(reference);
+			const uint64_t zigzag     = encoded >> 1 & mask;
+			const uint64_t difference = zigzag >> 1 ^ ((zigzag & 1) != 0 ? mask : 0);
+			const uint64_t magnitude  = (base + difference) & mask;
+			return std::bit_cast<T>(static_cast<Bits>(magnitude | (encoded & 1) << magnitude_bits));
+		}
+
+		/**
+		 * @brief Values per block of a bit-packed column.
+		 */
+		inline constexpr size_t bit_packed_block = 64;
+
+		/**
+		 * @brief Room for a packed block, plus a word of slack so every value can be read or written as one
+		 * unaligned 64-bit word.
+		 */
+		inline constexpr size_t bit_packed_buffer = bit_packed_block * sizeof(uint64_t) + sizeof(uint64_t);
+
+		inline uint64_t load_little_endian(const uint8_t * in)
+		{
+			uint64_t word = 0;
+			if constexpr (std::endian::native == std::endian::little) {
+				std::memcpy(&word, in, sizeof(word));
+			} else {
+				for (unsigned b = 0; b < sizeof(uint64_t); ++b) {
+					word |= static_cast<uint64_t>(in[b]) << (8 * b);
+				}
+			}
+			return word;
+		}
+
+		inline void store_little_endian(uint8_t * out, uint64_t word)
+		{
+			if constexpr (std::endian::native == std::endian::little) {
+				std::memcpy(out, &word, sizeof(word));
+			} else {
+				for (unsigned b = 0; b < sizeof(uint64_t); ++b) {
+					out[b] = static_cast<uint8_t>(word >> (8 * b));
+				}
+			}
+		}
+
+		/**
+		 * @brief Appends unsigned values to a column in blocks of bit_packed_block. Each block is a byte holding a
+		 * bit width, the width of the block's largest value, followed by the block's values at that width, low
+		 * bits first. Call finish() after the last value to write a final, shorter block.
+		 */
+		class BitPackedWriter
+		{
+		  public:
+			explicit BitPackedWriter(std::vector<uint8_t> & out)
+			    : out_(&out)
+			{
+			}
+
+			void push(uint64_t value)
+			{
+				block_[count_++] = value;
+				if (count_ == bit_packed_block) {
+					finish();
+				}
+			}
+
+			void finish()
+			{
+				if (count_ == 0) {
+					return;
+				}
+				uint64_t combined = 0;
+				for (size_t i = 0; i < count_; ++i) {
+					combined |= block_[i];
+				}
+				const auto width = static_cast<unsigned>(std::bit_width(combined));
+
+				std::array<uint8_t, bit_packed_buffer> packed{};
+				if (width <= 56) {
+					// values gather in a word that is stored whole after each one, then advanced past the bytes
+					// it has filled
+					uint8_t * out    = packed.data();
+					uint64_t  word   = 0;
+					unsigned  filled = 0;
+					for (size_t i = 0; i < count_; ++i) {
+						word |= block_[i] << filled;
+						filled += width;
+						store_little_endian(out, word);
+						const unsigned bytes = filled / 8;
+						out += bytes;
+						word >>= 8 * bytes;
+						filled -= 8 * bytes;
+					}
+				} else {
+					// too wide to share a word with the bits before them, so each is ORed in at its first byte
+					for (size_t i = 0; i < count_; ++i) {
+						const size_t   bit   = i * width;
+						uint8_t *      at    = packed.data() + bit / 8;
+						const unsigned shift = bit % 8;
+						store_little_endian(at, load_little_endian(at) | block_[i] << shift);
+						if (shift + width > 64) {
+							at[8] |= static_cast<uint8_t>(block_[i] >> (64 - shift));
+						}
+					}
+				}
+				out_->push_back(static_cast<uint8_t>(width));
+				out_->insert(out_->end(), packed.begin(), packed.begin() + (count_ * width + 7) / 8);
+				count_ = 0;
+			}
+
+		  private:
+			std::vector<uint8_t> *                 out_;
+			std::array<uint64_t, bit_packed_block> block_{};
+			size_t                                 count_ = 0;
+		};
+
+		/**
+		 * @brief Reads a column written by BitPackedWriter, given the number of values it holds. Damaged data makes
+		 * next() fail rather than read outside the column.
+		 */
+		class BitPackedReader
+		{
+		  public:
+			BitPackedReader(const std::vector<uint8_t> & column, uint64_t count)
+			    : in_(column.data())
+			    , end_(column.data() + column.size())
+			    , remaining_(count)
+			{
+			}
+
+			/**
+			 * @return False if the column holds no more values or is damaged.
+			 */
+			bool next(uint64_t & value)
+			{
+				if (next_ == count_ && !load_block()) {
+					return false;
+				}
+				value = block_[next_++];
+				return true;
+			}
+
+			/**
+			 * @brief True once every value has been read and nothing follows them.
+			 */
+			bool finished() const { return next_ == count_ && remaining_ == 0 && in_ == end_; }
+
+		  private:
+			bool load_block()
+			{
+				if (remaining_ == 0 || in_ == end_) {
+					return false;
+				}
+				const unsigned width = *in_++;
+				const auto     count = static_cast<size_t>(std::min<uint64_t>(remaining_, bit_packed_block));
+				const size_t   bytes = (count * width + 7) / 8;
+				if (width > 64 || static_cast<size_t>(end_ - in_) < bytes) {
+					return false;
+				}
+
+				// copied out so that reading a whole word at the last value stays inside the buffer
+				std::array<uint8_t, bit_packed_buffer> packed{};
+				std::copy(in_, in_ + bytes, packed.begin());
+				const uint64_t mask = width == 64 ? ~uint64_t{0} : (uint64_t{1} << width) - 1;
+				for (size_t i = 0; i < count; ++i) {
+					const size_t    bit   = i * width;
+					const uint8_t * at    = packed.data() + bit / 8;
+					const unsigned  shift = bit % 8;
+					uint64_t        value = load_little_endian(at) >> shift;
+					if (shift + width > 64) {
+						value |= static_cast<uint64_t>(at[8]) << (64 - shift);
+					}
+					block_[i] = value & mask;
+				}
+				in_ += bytes;
+				remaining_ -= count;
+				count_ = count;
+				next_  = 0;
+				return true;
+			}
+
+			const uint8_t *                        in_;
+			const uint8_t *                        end_;
+			uint64_t                               remaining_;
+			std::array<uint64_t, bit_packed_block> block_{};
+			size_t                                 count_ = 0;
+			size_t                                 next_  = 0;
+		};
+	} // namespace detail
+
+	/**
+	 * @brief A compact, columnar encoding of the contents of a LocationHash, for keeping many states of an index
+	 * rather than restarting quickly from one. Like RegionSnapshot, each object is stored as an Id produced by a
+	 * caller-supplied serializer and turned back into a pointer by a resolver.
+	 *
+	 * Cells are stored in Morton order of their keys, so consecutive cells are usually neighbours. The data is
+	 * split into columns: the cell keys, in cells, as differences from the previous key; the entry count of each
+	 * cell; one column per axis of coordinates, each the difference of its bit pattern from the cell's origin, with
+	 * the sign split out in the floating point cell at zero; and the Ids, each as the difference from the previous
+	 * Id. Differences are zigzag encoded and bit-packed in blocks of 64 at the width of the block's largest, so
+	 * every value is stored exactly. Keys and Ids handed out in sequence shrink the most; floating point coordinates
+	 * lose only the bits their cell fixes.
+	 *
+	 * Cells are decoded in file order and handed to LocationHash::load_region, so restoring into an empty index
+	 * allocates each bucket once at its final size. Files are only portable between machines of the same
+	 * endianness. An archive is held whole in memory: capture() builds every column before save() writes them,
+	 * and read() loads the whole file, so keeping an archive costs its byte_size().
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam Id What an object is stored as. Must be trivially copyable and 1, 2, 4 or 8 bytes.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename Id,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class ArchiveSnapshot
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+		static_assert(sizeof(CoordinateType) <= sizeof(uint64_t), "Coordinates are packed as at most 64 bits.");
+		static_assert(std::is_trivially_copyable<Id>::value &&
+		                  (sizeof(Id) == 1 || sizeof(Id) == 2 || sizeof(Id) == 4 || sizeof(Id) == 8),
+		              "Ids are packed as the difference of their bit patterns.");
+
+	  public:
+		using CoordinateArray = std::array<CoordinateType, Dimensions>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief Encodes buckets, typically LocationHash::get_data() or the result of unload_region.
+		 *
+		 * @param buckets The buckets to encode.
+		 * @param serializer Called as serializer(object) for each entry, returning its Id.
+		 */
+		template <typename CoordinateMap, typename Serializer>
+		static ArchiveSnapshot capture(const CoordinateMap & buckets, Serializer && serializer)
+		{
+			using Bucket = typename CoordinateMap::mapped_type;
+			std::vector<std::pair<CellIndex, const Bucket *>> cells;
+			cells.reserve(buckets.size());
+			for (const auto & [key, bucket] : buckets) {
+				cells.emplace_back(cell_index(key), &bucket);
+			}
+			std::sort(cells.begin(), cells.end(),
+			          [](const auto & a, const auto & b) { return detail::morton_less(a.first, b.first); });
+
+			ArchiveSnapshot snapshot;
+			auto            columns = writers(snapshot.columns_, std::make_index_sequence<column_count>());
+			CellIndex       previous_cell{};
+			Id              previous_id{};
+			for (const auto & [cell, bucket] : cells) {
+				const QuantizedCoordinateType key = key_of(cell);
+				CoordinateArray               origin;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					columns[key_column].push(detail::encode_delta(cell[i], previous_cell[i]));
+					origin[i] = static_cast<CoordinateType>(key.quantized_[i]);
+				}
+				columns[count_column].push(bucket->size());
+				for (const auto & [coordinates, object] : *bucket) {
+					for (size_t i = 0; i < Dimensions; ++i) {
+						columns[first_coordinate_column + i].push(encode_coordinate(coordinates[i], origin[i]));
+					}
+					const Id id = serializer(object);
+					columns[id_column].push(detail::encode_delta(id, previous_id));
+					previous_id = id;
+				}
+				snapshot.entry_count_ += bucket->size();
+				previous_cell = cell;
+			}
+			for (auto & column : columns) {
+				column.finish();
+			}
+			snapshot.cell_count_ = cells.size();
+			return snapshot;
+		}
+
+		/**
+		 * @brief Writes the archive to path. The data is written to a temporary file which then replaces path, so
+		 * a reader never sees a partly written archive.
+		 *
+		 * @throws std::system_error if the file cannot be written.
+		 */
+		void save(const std::string & path) const
+		{
+			const std::string temporary = path + ".partial";
+			{
+				std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+				FileHeader    header = expected_header();
+				header.cell_count    = cell_count_;
+				header.entry_count   = entry_count_;
+				for (size_t c = 0; c < column_count; ++c) {
+					header.column_bytes[c] = columns_[c].size();
+				}
+				out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+				for (const auto & column : columns_) {
+					out.write(reinterpret_cast<const char *>(column.data()),
+					          static_cast<std::streamsize>(column.size()));
+				}
+				out.flush();
+				if (!out) {
+					throw std::system_error(std::make_error_code(std::errc::io_error), "unable to write " + temporary);
+				}
+			}
+			std::filesystem::rename(temporary, path);
+		}
+
+		/**
+		 * @brief Reads an archive written by save(). Damage inside the columns is found when they are decoded.
+		 *
+		 * @throws std::system_error if the file cannot be read, or holds an archive of a different type.
+		 */
+		static ArchiveSnapshot read(const std::string & path)
+		{
+			std::ifstream in(path, std::ios::binary);
+			if (!in) {
+				throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory),
+				                        "unable to open " + path);
+			}
+			FileHeader       header{};
+			const FileHeader expected = expected_header();
+			in.read(reinterpret_cast<char *>(&header), sizeof(header));
+			if (!in || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+			    header.version != expected.version || header.dimensions != expected.dimensions ||
+			    header.precision != expected.precision || header.coordinate_bytes != expected.coordinate_bytes ||
+			    header.key_bytes != expected.key_bytes || header.id_bytes != expected.id_bytes) {
+				throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+				                        path + " does not hold a matching ArchiveSnapshot");
+			}
+
+			// Checked before allocating, so damaged sizes cannot ask for more memory than the file could fill. Every
+			// block of values takes at least its width byte, which bounds the counts too.
+			const uint64_t file_bytes = std::filesystem::file_size(path);
+			uint64_t       total      = sizeof(FileHeader);
+			for (const uint64_t bytes : header.column_bytes) {
+				total += std::min(bytes, file_bytes);
+			}
+			if (total != file_bytes || header.cell_count > file_bytes * detail::bit_packed_block ||
+			    header.entry_count > file_bytes * detail::bit_packed_block) {
+				throw std::system_error(std::make_error_code(std::errc::io_error), path + " is truncated");
+			}
+
+			ArchiveSnapshot snapshot;
+			snapshot.cell_count_  = header.cell_count;
+			snapshot.entry_count_ = header.entry_count;
+			for (size_t c = 0; c < column_count; ++c) {
+				snapshot.columns_[c].resize(static_cast<size_t>(header.column_bytes[c]));
+				in.read(reinterpret_cast<char *>(snapshot.columns_[c].data()),
+				        static_cast<std::streamsize>(snapshot.columns_[c].size()));
+			}
+			if (!in) {
+				throw std::system_error(std::make_error_code(std::errc::io_error), path + " is truncated");
+			}
+			return snapshot;
+		}
+
+		/**
+		 * @brief Decodes every entry in file order, as visitor(key, coordinates, id), without building an index.
+		 *
+		 * @throws std::system_error if the archive is damaged. Entries before the damage have been visited.
+		 */
+		template <typename Visitor>
+		void for_each(Visitor && visitor) const
+		{
+			const QuantizedCoordinateType * current = nullptr;
+			walk([&](const QuantizedCoordinateType & key, size_t) { current = &key; },
+			     [&](const CoordinateArray & coordinates, const Id & id) { visitor(*current, coordinates, id); });
+		}
+
+		/**
+		 * @brief Builds the archived buckets, calling resolver(id) for each entry to get its object.
+		 *
+		 * @throws std::system_error if the archive is damaged.
+		 */
+		template <typename CoordinateMap, typename Resolver>
+		CoordinateMap decode(Resolver && resolver) const
+		{
+			CoordinateMap buckets;
+			buckets.reserve(static_cast<size_t>(cell_count_));
+			typename CoordinateMap::mapped_type * bucket = nullptr;
+			walk(
+			    [&](const QuantizedCoordinateType & key, size_t count) {
+				    bucket = &buckets[key];
+				    bucket->reserve(bucket->size() + count);
+			    },
+			    [&](const CoordinateArray & coordinates, const Id & id) {
+				    bucket->emplace_back(coordinates, resolver(id));
+			    });
+			return buckets;
+		}
+
+		/**
+		 * @brief Adds the archive's entries to a LocationHash, calling resolver(id) for each to get its object.
+		 * Nothing is added if the archive is damaged.
+		 *
+		 * @throws std::system_error if the archive is damaged.
+		 */
+		template <typename ObjectType, typename... Rest, typename Resolver>
+		void restore(LocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType,
+		                          Rest...> & locationHash,
+		             Resolver &&             resolver) const
+		{
+			using CoordinateMap = typename std::remove_reference_t<decltype(locationHash)>::CoordinateMap;
+			locationHash.load_region(decode<CoordinateMap>(resolver));
+		}
+
+		size_t cell_count() const { return static_cast<size_t>(cell_count_); }
+
+		/**
+		 * @brief The number of entries.
+		 */
+		size_t size() const { return static_cast<size_t>(entry_count_); }
+
+		bool empty() const { return entry_count_ == 0; }
+
+		/**
+		 * @brief The size of the file save() writes.
+		 */
+		size_t byte_size() const
+		{
+			size_t bytes = sizeof(FileHeader);
+			for (const auto & column : columns_) {
+				bytes += column.size();
+			}
+			return bytes;
+		}
+
+	  private:
+		using CellIndex = std::array<QuantizedCoordinateIntegerType, Dimensions>;
+
+		enum Column : size_t {
+			key_column,
+			count_column,
+			id_column,
+			first_coordinate_column,
+		};
+
+		static constexpr size_t   column_count        = first_coordinate_column + Dimensions;
+		static constexpr uint32_t file_version        = 2;
+		static constexpr auto     step                = static_cast<QuantizedCoordinateIntegerType>(Precision);
+		static constexpr auto     middle_of_zero_cell = static_cast<CoordinateType>(Precision) / 2;
+
+		using Columns = std::array<std::vector<uint8_t>, column_count>;
+
+		struct FileHeader {
+			char                               magic[8];
+			uint32_t                           version;
+			uint32_t                           dimensions;
+			uint64_t                           precision;
+			uint64_t                           coordinate_bytes;
+			uint64_t                           key_bytes;
+			uint64_t                           id_bytes;
+			uint64_t                           cell_count;
+			uint64_t                           entry_count;
+			std::array<uint64_t, column_count> column_bytes;
+		};
+
+		static FileHeader expected_header()
+		{
+			FileHeader header{};
+			std::memcpy(header.magic, "LOCHASHA", sizeof(header.magic));
+			header.version          = file_version;
+			header.dimensions       = static_cast<uint32_t>(Dimensions);
+			header.precision        = Precision;
+			header.coordinate_bytes = sizeof(CoordinateType);
+			header.key_bytes        = sizeof(QuantizedCoordinateIntegerType);
+			header.id_bytes         = sizeof(Id);
+			return header;
+		}
+
+		template <size_t... Indices>
+		static std::array<detail::BitPackedWriter, column_count> writers(Columns & columns,
+		                                                                  std::index_sequence<Indices...>)
+		{
+			return {detail::BitPackedWriter(columns[Indices])...};
+		}
+
+		// Keys are multiples of Precision, so they are stored divided by it.
+		static CellIndex cell_index(const QuantizedCoordinateType & key)
+		{
+			CellIndex cell;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				cell[i] = static_cast<QuantizedCoordinateIntegerType>(key.quantized_[i] / step);
+			}
+			return cell;
+		}
+
+		static QuantizedCoordinateType key_of(const CellIndex & cell)
+		{
+			// unsigned arithmetic, so a damaged archive cannot overflow
+			using Unsigned = std::make_unsigned_t<QuantizedCoordinateIntegerType>;
+			QuantizedCoordinateType key;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				key.quantized_[i] =
+				    static_cast<QuantizedCoordinateIntegerType>(static_cast<Unsigned>(cell[i]) * Unsigned(Precision));
+			}
+			return key;
+		}
+
+		// Coordinates are stored as the difference of their bit pattern from their cell's origin, which for
+		// integers is their numeric difference. In the floating point cell at zero, which holds values of both signs,
+		// that difference is as long as the values themselves, so there the sign is split out instead and the
+		// magnitude stored relative to the middle of the cell.
+		static uint64_t encode_coordinate(CoordinateType value, CoordinateType origin)
+		{
+			if constexpr (std::is_floating_point_v<CoordinateType>) {
+				if (origin == 0) {
+					return detail::encode_sign_and_magnitude(value, middle_of_zero_cell);
+				}
+			}
+			return detail::encode_delta(value, origin);
+		}
+
+		static CoordinateType decode_coordinate(uint64_t encoded, CoordinateType origin)
+		{
+			if constexpr (std::is_floating_point_v<CoordinateType>) {
+				if (origin == 0) {
+					return detail::decode_sign_and_magnitude(encoded, middle_of_zero_cell);
+				}
+			}
+			return detail::decode_delta(encoded, origin);
+		}
+
+		[[noreturn]] static void damaged()
+		{
+			throw std::system_error(std::make_error_code(std::errc::io_error), "ArchiveSnapshot is damaged");
+		}
+
+		template <size_t... Axes>
+		std::array<detail::BitPackedReader, Dimensions> coordinate_readers(std::index_sequence<Axes...>) const
+		{
+			return {detail::BitPackedReader(columns_[first_coordinate_column + Axes], entry_count_)...};
+		}
+
+		// Decodes the columns in step, calling cell_visitor(key, count) before each cell's entries and
+		// entry_visitor(coordinates, id) for each entry.
+		template <typename CellVisitor, typename EntryVisitor>
+		void walk(CellVisitor && cell_visitor, EntryVisitor && entry_visitor) const
+		{
+			detail::BitPackedReader keys(columns_[key_column], cell_count_ * Dimensions);
+			detail::BitPackedReader counts(columns_[count_column], cell_count_);
+			detail::BitPackedReader ids(columns_[id_column], entry_count_);
+			auto                    coordinate_columns = coordinate_readers(std::make_index_sequence<Dimensions>());
+
+			CellIndex cell{};
+			Id        id{};
+			uint64_t  encoded   = 0;
+			uint64_t  remaining = entry_count_;
+			for (uint64_t c = 0; c < cell_count_; ++c) {
+				for (size_t i = 0; i < Dimensions; ++i) {
+					if (!keys.next(encoded)) {
+						damaged();
+					}
+					cell[i] = detail::decode_delta(encoded, cell[i]);
+				}
+				uint64_t count;
+				if (!counts.next(count) || count > remaining) {
+					damaged();
+				}
+				remaining -= count;
+
+				const QuantizedCoordinateType key = key_of(cell);
+				CoordinateArray               origin;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					origin[i] = static_cast<CoordinateType>(key.quantized_[i]);
+				}
+				cell_visitor(key, static_cast<size_t>(count));
+				for (uint64_t e = 0; e < count; ++e) {
+					CoordinateArray coordinates;
+					for (size_t i = 0; i < Dimensions; ++i) {
+						if (!coordinate_columns[i].next(encoded)) {
+							damaged();
+						}
+						coordinates[i] = decode_coordinate(encoded, origin[i]);
+					}
+					if (!ids.next(encoded)) {
+						damaged();
+					}
+					id = detail::decode_delta(encoded, id);
+					entry_visitor(coordinates, id);
+				}
+			}
+
+			bool finished = remaining == 0 && keys.finished() && counts.finished() && ids.finished();
+			for (const auto & column : coordinate_columns) {
+				finished = finished && column.finished();
+			}
+			if (!finished) {
+				damaged();
+			}
+		}
+
+		Columns  columns_;
+		uint64_t cell_count_  = 0;
+		uint64_t entry_count_ = 0;
+	};
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_archive_hpp
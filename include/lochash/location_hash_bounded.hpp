@@ -0,0 +1,425 @@
+#ifndef _INCLUDED_location_hash_bounded_hpp
+#define _INCLUDED_location_hash_bounded_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief A LocationHash with an entry and memory budget, for cache-style data such as recent sightings. When an
+	 * update takes it over budget, whole cells are evicted: lowest priority first, least recently touched first
+	 * within a priority.
+	 *
+	 * Every cell sits in an intrusive recency list for its priority, and a bit mask records which priorities have
+	 * cells, so touching a cell and picking a victim are O(1). Adds, moves, find() and the queries touch the cells
+	 * they use. A cell's priority is the highest given when adding to it, or whatever set_priority() set last.
+	 *
+	 * The memory figure is an estimate: bucket capacity plus a fixed cost per cell for the map node. It does not
+	 * include the map's bucket array. Not thread safe: queries reorder the recency lists.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class BoundedLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t   dimension_count = Dimensions;
+		static constexpr unsigned priority_levels = 64; // priorities are 0 (evicted first) to 63
+		using CoordinateArray                     = std::array<CoordinateType, Dimensions>;
+		using Entry                               = std::pair<CoordinateArray, ObjectType *>;
+		using BucketContent                       = std::vector<Entry>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief Called with the key and entries of each evicted cell, just before it is dropped. Must not
+		 * modify the index.
+		 */
+		using EvictionCallback = std::function<void(const QuantizedCoordinateType &, const BucketContent &)>;
+
+		/**
+		 * @param max_entries The most entries to keep.
+		 * @param max_bytes The most memory to use, as estimated by memory_bytes().
+		 */
+		explicit BoundedLocationHash(size_t max_entries, size_t max_bytes = std::numeric_limits<size_t>::max())
+		    : max_entries_(max_entries)
+		    , max_bytes_(max_bytes)
+		{
+		}
+
+		BoundedLocationHash(const BoundedLocationHash &)             = delete;
+		BoundedLocationHash & operator=(const BoundedLocationHash &) = delete;
+
+		void set_eviction_callback(EvictionCallback callback) { on_evict_ = std::move(callback); }
+
+		/**
+		 * @brief Changes the budget, evicting at once if the index is over the new one.
+		 */
+		void set_budget(size_t max_entries, size_t max_bytes = std::numeric_limits<size_t>::max())
+		{
+			max_entries_ = max_entries;
+			max_bytes_   = max_bytes;
+			enforce_budget(nullptr);
+		}
+
+		/**
+		 * @brief Adds an entry and touches its cell, raising the cell's priority to priority if it is lower. May
+		 * evict other cells, but never the one added to, so a single cell can exceed the budget.
+		 */
+		void add(ObjectType * object, const CoordinateArray & coordinates, unsigned priority = 0)
+		{
+			const auto [slot, inserted] = cells_.try_emplace(QuantizedCoordinateType(coordinates));
+			Cell & cell                 = slot->second;
+			if (inserted) {
+				bytes_ += cell_overhead;
+				cell.priority = clamp_priority(priority);
+				link(&*slot);
+			} else {
+				relink(&*slot, std::max(cell.priority, clamp_priority(priority)));
+			}
+			push(cell, Entry(coordinates, object));
+			enforce_budget(&*slot);
+		}
+
+		/**
+		 * @brief Removes object from the bucket containing coordinates. Does not call the eviction callback.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const auto it = cells_.find(QuantizedCoordinateType(coordinates));
+			if (it == cells_.end()) {
+				return false;
+			}
+			auto &     entries = it->second.entries;
+			const auto entry   = std::find_if(entries.begin(), entries.end(),
+			                                  [&](const Entry & candidate) { return candidate.second == object; });
+			if (entry == entries.end()) {
+				return false;
+			}
+			entries.erase(entry);
+			--size_;
+			if (entries.empty()) {
+				drop(it);
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Moves an object, keeping the priority of its old cell. Unlike LocationHash::move, a move within a
+		 * bucket updates the stored coordinates.
+		 *
+		 * @return True if the object was found and moved.
+		 */
+		bool move(ObjectType * object, const CoordinateArray & old_coordinates, const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			const auto                    it = cells_.find(old_key);
+			if (it == cells_.end()) {
+				return false;
+			}
+			const unsigned priority = it->second.priority;
+			if (old_key == QuantizedCoordinateType(new_coordinates)) {
+				for (auto & entry : it->second.entries) {
+					if (entry.second == object) {
+						entry.first = new_coordinates;
+						touch(&*it);
+						return true;
+					}
+				}
+				return false;
+			}
+			if (!remove(object, old_coordinates)) {
+				return false;
+			}
+			add(object, new_coordinates, priority);
+			return true;
+		}
+
+		/**
+		 * @brief Sets the priority of the cell containing coordinates and touches it.
+		 *
+		 * @return False if the cell is not occupied.
+		 */
+		bool set_priority(const CoordinateArray & coordinates, unsigned priority)
+		{
+			const auto it = cells_.find(QuantizedCoordinateType(coordinates));
+			if (it == cells_.end()) {
+				return false;
+			}
+			relink(&*it, clamp_priority(priority));
+			return true;
+		}
+
+		/**
+		 * @brief The entries of a bucket, touching it. Empty if the cell is not occupied. The span is valid until
+		 * the next update.
+		 */
+		std::span<const Entry> find(const QuantizedCoordinateType & key)
+		{
+			const auto it = cells_.find(key);
+			if (it == cells_.end()) {
+				return {};
+			}
+			touch(&*it);
+			return it->second.entries;
+		}
+
+		/**
+		 * @brief The entries of the bucket containing coordinates. See find().
+		 */
+		std::span<const Entry> query(const CoordinateArray & coordinates)
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Visits every occupied bucket as visitor(key, bucket), in no particular order, without touching it.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor) const
+		{
+			for (const auto & [key, cell] : cells_) {
+				visitor(key, std::span<const Entry>(cell.entries));
+			}
+		}
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		size_t cell_count() const { return cells_.size(); }
+
+		/**
+		 * @brief The estimated memory used by cells and their buckets, in bytes.
+		 */
+		size_t memory_bytes() const { return bytes_; }
+
+		uint64_t evicted_cells() const { return evicted_cells_; }
+
+		uint64_t evicted_entries() const { return evicted_entries_; }
+
+		/**
+		 * @brief Drops every cell without calling the eviction callback.
+		 */
+		void clear()
+		{
+			cells_.clear();
+			heads_.fill(nullptr);
+			tails_.fill(nullptr);
+			occupied_levels_ = 0;
+			size_            = 0;
+			bytes_           = 0;
+		}
+
+	  private:
+		struct Cell;
+		using CellMap = std::unordered_map<QuantizedCoordinateType, Cell>;
+		using Slot    = typename CellMap::value_type;
+
+		struct Cell {
+			BucketContent entries;
+			Slot *        newer    = nullptr; // toward the head of the recency list for this priority
+			Slot *        older    = nullptr;
+			unsigned      priority = 0;
+		};
+
+		// the map node, its key and the cell, plus the next pointer and a bucket slot in the map
+		static constexpr size_t cell_overhead = sizeof(Slot) + 2 * sizeof(void *);
+
+		static unsigned clamp_priority(unsigned priority) { return std::min(priority, priority_levels - 1); }
+
+		void push(Cell & cell, Entry && entry)
+		{
+			const size_t capacity = cell.entries.capacity();
+			cell.entries.push_back(std::move(entry));
+			bytes_ += (cell.entries.capacity() - capacity) * sizeof(Entry);
+			++size_;
+		}
+
+		void link(Slot * slot)
+		{
+			Cell &         cell  = slot->second;
+			const unsigned level = cell.priority;
+			cell.newer           = nullptr;
+			cell.older           = heads_[level];
+			if (heads_[level] != nullptr) {
+				heads_[level]->second.newer = slot;
+			} else {
+				tails_[level] = slot;
+			}
+			heads_[level] = slot;
+			occupied_levels_ |= uint64_t(1) << level;
+		}
+
+		void unlink(Slot * slot)
+		{
+			Cell &         cell  = slot->second;
+			const unsigned level = cell.priority;
+			if (cell.newer != nullptr) {
+				cell.newer->second.older = cell.older;
+			} else {
+				heads_[level] = cell.older;
+			}
+			if (cell.older != nullptr) {
+				cell.older->second.newer = cell.newer;
+			} else {
+				tails_[level] = cell.newer;
+			}
+			if (heads_[level] == nullptr) {
+				occupied_levels_ &= ~(uint64_t(1) << level);
+			}
+		}
+
+		void touch(Slot * slot)
+		{
+			if (heads_[slot->second.priority] != slot) {
+				unlink(slot);
+				link(slot);
+			}
+		}
+
+		void relink(Slot * slot, unsigned priority)
+		{
+			unlink(slot);
+			slot->second.priority = priority;
+			link(slot);
+		}
+
+		void drop(typename CellMap::iterator it)
+		{
+			unlink(&*it);
+			bytes_ -= cell_overhead + it->second.entries.capacity() * sizeof(Entry);
+			cells_.erase(it);
+		}
+
+		// The least recently touched cell of the lowest occupied priority, other than keep.
+		Slot * victim(const Slot * keep) const
+		{
+			for (uint64_t levels = occupied_levels_; levels != 0; levels &= levels - 1) {
+				Slot * candidate = tails_[static_cast<size_t>(std::countr_zero(levels))];
+				if (candidate == keep) {
+					candidate = candidate->second.newer;
+				}
+				if (candidate != nullptr) {
+					return candidate;
+				}
+			}
+			return nullptr;
+		}
+
+		void enforce_budget(const Slot * keep)
+		{
+			while (size_ > max_entries_ || bytes_ > max_bytes_) {
+				Slot * slot = victim(keep);
+				if (slot == nullptr) {
+					return;
+				}
+				if (on_evict_) {
+					on_evict_(slot->first, slot->second.entries);
+				}
+				++evicted_cells_;
+				evicted_entries_ += slot->second.entries.size();
+				size_ -= slot->second.entries.size();
+				drop(cells_.find(slot->first));
+			}
+		}
+
+		CellMap                             cells_;
+		std::array<Slot *, priority_levels> heads_{}; // most recently touched cell of each priority
+		std::array<Slot *, priority_levels> tails_{}; // least recently touched
+		uint64_t                            occupied_levels_ = 0;
+		size_t                              max_entries_;
+		size_t                              max_bytes_;
+		size_t                              size_            = 0;
+		size_t                              bytes_           = 0;
+		uint64_t                            evicted_cells_   = 0;
+		uint64_t                            evicted_entries_ = 0;
+		EvictionCallback                    on_evict_;
+	};
+
+	/**
+	 * Query objects within a bounding box in a BoundedLocationHash, touching the occupied cells it overlaps.
+	 *
+	 * @param locationHash The BoundedLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(
+	    BoundedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds, std::vector<ObjectType *> & result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a BoundedLocationHash, touching the occupied cells the search
+	 * overlaps.
+	 *
+	 * @param locationHash The BoundedLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(
+	    BoundedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	    std::vector<ObjectType *> &                    result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a BoundedLocationHash, nearest first, touching the occupied cells
+	 * the search visits. See query_nearest for LocationHash.
+	 *
+	 * @param locationHash The BoundedLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *> query_nearest(
+	    BoundedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) { locationHash.for_each_bucket(visitor); }, locationHash.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_bounded_hpp
@@ -0,0 +1,284 @@
+#ifndef _INCLUDED_location_hash_cell_grid_hpp
+#define _INCLUDED_location_hash_cell_grid_hpp
+
+#include "location_hash.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lochash
+{
+	namespace detail
+	{
+		/**
+		 * @brief Calls body(first, last) over consecutive ranges of 0 to count - 1 on up to threads threads, the
+		 * calling thread included. Ranges of grain items are handed out in order as threads become free, so uneven
+		 * work evens out. The first exception thrown by body is rethrown here after every thread has stopped.
+		 * @param threads The number of threads to use, or 0 for one per hardware thread.
+		 */
+		template <typename Body>
+		void parallel_for_ranges(size_t count, size_t grain, size_t threads, Body && body)
+		{
+			if (threads == 0) {
+				threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+			}
+			grain   = std::max<size_t>(grain, 1);
+			threads = std::min(threads, (count + grain - 1) / grain);
+
+			std::atomic<size_t> next{0};
+			std::exception_ptr  error;
+			std::mutex          error_mutex;
+
+			const auto work = [&] {
+				try {
+					for (size_t first = next.fetch_add(grain); first < count; first = next.fetch_add(grain)) {
+						body(first, std::min(first + grain, count));
+					}
+				} catch (...) {
+					const std::lock_guard lock(error_mutex);
+					if (!error) {
+						error = std::current_exception();
+					}
+					next = count;
+				}
+			};
+
+			std::vector<std::thread> workers;
+			workers.reserve(threads);
+			try {
+				for (size_t t = 1; t < threads; ++t) {
+					workers.emplace_back(work);
+				}
+			} catch (const std::system_error &) {
+				// carry on with the threads that did start
+			}
+			work();
+			for (auto & worker : workers) {
+				worker.join();
+			}
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	} // namespace detail
+
+	/**
+	 * @brief A read-only copy of the contents of a LocationHash laid out for whole-index passes such as clustering.
+	 * The entries of each cell are stored contiguously, cell after cell, and numbered in that order, so an
+	 * algorithm can keep its per-entry results in a plain vector indexed by entry number.
+	 *
+	 * for_each_cell_pair() visits every pair of occupied cells that could hold two points within a distance of
+	 * each other, each pair once, by looking up a precomputed half stencil of cell offsets around every cell.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class CellGrid
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+		using PairStencil = std::vector<std::array<QuantizedCoordinateIntegerType, Dimensions>>;
+
+		/**
+		 * @brief An occupied cell: its entries are numbered first to first + count - 1.
+		 */
+		struct Cell {
+			QuantizedCoordinateType key;
+			size_t                  first;
+			size_t                  count;
+		};
+
+		template <typename... Rest>
+		explicit CellGrid(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType,
+		                                     QuantizedCoordinateIntegerType, Rest...> & locationHash)
+		{
+			const auto & data = locationHash.get_data();
+			cells_.reserve(data.size());
+			index_.reserve(data.size());
+			for (const auto & [key, bucket] : data) {
+				index_.emplace(key, cells_.size());
+				cells_.push_back(Cell{key, coordinates_.size(), bucket.size()});
+				for (const auto & [coordinates, object] : bucket) {
+					coordinates_.push_back(coordinates);
+					objects_.push_back(object);
+				}
+			}
+		}
+
+		/**
+		 * @brief The number of entries.
+		 */
+		size_t size() const { return coordinates_.size(); }
+
+		bool empty() const { return coordinates_.empty(); }
+
+		size_t cell_count() const { return cells_.size(); }
+
+		std::span<const Cell> cells() const { return cells_; }
+
+		const CoordinateArray & coordinates(size_t entry) const { return coordinates_[entry]; }
+
+		ObjectType * object(size_t entry) const { return objects_[entry]; }
+
+		/**
+		 * @brief The cell with this key, or nullptr if it is not occupied.
+		 */
+		const Cell * find(const QuantizedCoordinateType & key) const
+		{
+			const auto it = index_.find(key);
+			return it != index_.end() ? &cells_[it->second] : nullptr;
+		}
+
+		/**
+		 * @brief Visits every unordered pair of occupied cells close enough to hold two points within distance of
+		 * each other, as visitor(a, b). Each cell is paired with itself first, then with the neighbours ahead of
+		 * it in the stencil, so every pair is visited exactly once. The stencil has about (2 * distance /
+		 * Precision + 3) ^ Dimensions / 2 offsets, so a distance of a few cells is cheapest.
+		 */
+		template <typename Visitor>
+		void for_each_cell_pair(CoordinateType distance, Visitor && visitor) const
+		{
+			for_each_cell_pair(pair_stencil(distance), 0, cells_.size(), visitor);
+		}
+
+		/**
+		 * @brief The key offsets for_each_cell_pair() pairs a cell with at a distance: those of the cells within
+		 * reach that come after it in lexicographic order. Build it once and share it between calls over ranges of
+		 * cells.
+		 */
+		static PairStencil pair_stencil(CoordinateType distance)
+		{
+			// Points in cells r apart are at least (r - 1) * Precision apart, so cells more than
+			// distance / Precision + 1 apart are out of reach.
+			const auto reach = static_cast<QuantizedCoordinateIntegerType>(
+			                       std::floor(static_cast<double>(distance) / static_cast<double>(Precision))) +
+			                   1;
+			const double limit = static_cast<double>(distance) * static_cast<double>(distance);
+
+			PairStencil                                            stencil;
+			std::array<QuantizedCoordinateIntegerType, Dimensions> cells;
+			cells.fill(-reach);
+			while (true) {
+				bool   ahead = false;
+				double gap   = 0.0;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					if (cells[i] != 0) {
+						ahead = cells[i] > 0;
+						break;
+					}
+				}
+				for (size_t i = 0; i < Dimensions; ++i) {
+					const auto apart = static_cast<double>(std::max<QuantizedCoordinateIntegerType>(
+					                       std::abs(cells[i]) - 1, 0)) *
+					                   static_cast<double>(Precision);
+					gap += apart * apart;
+				}
+				if (ahead && gap <= limit) {
+					std::array<QuantizedCoordinateIntegerType, Dimensions> offset;
+					for (size_t i = 0; i < Dimensions; ++i) {
+						offset[i] = cells[i] * step;
+					}
+					stencil.push_back(offset);
+				}
+
+				size_t i = 0;
+				while (i < Dimensions && cells[i] == reach) {
+					cells[i] = -reach;
+					++i;
+				}
+				if (i == Dimensions) {
+					return stencil;
+				}
+				++cells[i];
+			}
+		}
+
+		/**
+		 * @brief Visits the pairs of for_each_cell_pair() whose first cell is one of cells()[first_cell] to
+		 * cells()[last_cell - 1], using a stencil from pair_stencil(). Disjoint ranges of cells visit disjoint sets
+		 * of pairs, so they can be handed to different threads.
+		 */
+		template <typename Visitor>
+		void for_each_cell_pair(const PairStencil & stencil, size_t first_cell, size_t last_cell,
+		                        Visitor && visitor) const
+		{
+			for (size_t c = first_cell; c < last_cell; ++c) {
+				const Cell & cell = cells_[c];
+				visitor(cell, cell);
+				for (const auto & offset : stencil) {
+					QuantizedCoordinateType key;
+					for (size_t i = 0; i < Dimensions; ++i) {
+						key.quantized_[i] = cell.key.quantized_[i] + offset[i];
+					}
+					if (const Cell * neighbour = find(key)) {
+						visitor(cell, *neighbour);
+					}
+				}
+			}
+		}
+
+		/**
+		 * @brief The position of a cell in cells().
+		 */
+		size_t index_of(const Cell & cell) const { return static_cast<size_t>(&cell - cells_.data()); }
+
+		/**
+		 * @brief A lower bound on the squared distance between a point in one cell and a point in another.
+		 */
+		static CoordinateType min_distance_squared(const Cell & a, const Cell & b)
+		{
+			CoordinateType result = 0;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				const auto cells = std::abs(a.key.quantized_[i] - b.key.quantized_[i]) / step;
+				const auto gap   = static_cast<CoordinateType>(cells > 0 ? (cells - 1) * step : 0);
+				result += gap * gap;
+			}
+			return result;
+		}
+
+		/**
+		 * @brief An upper bound on the squared distance between a point in one cell and a point in another,
+		 * including a cell and itself.
+		 */
+		static CoordinateType max_distance_squared(const Cell & a, const Cell & b)
+		{
+			CoordinateType result = 0;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				const auto span =
+				    static_cast<CoordinateType>(std::abs(a.key.quantized_[i] - b.key.quantized_[i]) + step);
+				result += span * span;
+			}
+			return result;
+		}
+
+	  private:
+		static constexpr auto step = static_cast<QuantizedCoordinateIntegerType>(Precision);
+
+		std::vector<Cell>                                   cells_;
+		std::vector<CoordinateArray>                        coordinates_;
+		std::vector<ObjectType *>                           objects_;
+		std::unordered_map<QuantizedCoordinateType, size_t> index_;
+	};
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_cell_grid_hpp
@@ -0,0 +1,407 @@
+#ifndef _INCLUDED_location_hash_change_tracking_hpp
+#define _INCLUDED_location_hash_change_tracking_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief A LocationHash that records when each cell last changed, so replication can ask what changed in a
+	 * region since a version without scanning every object.
+	 *
+	 * Every modification advances version() and stamps the cell it touched. Cells are also grouped into blocks of
+	 * BlockCells cells per axis, and each block keeps the newest stamp of its cells. changed_since() skips blocks
+	 * that have not changed, then reports the changed cells inside the rest. A cell that becomes empty stays behind
+	 * as a tombstone with its stamp, so removals are reported too. forget_before() drops old tombstones; after that,
+	 * changes since an older version can no longer be told apart and changed_since() falls back to a full resync.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 * @tparam BlockCells Cells per block along each axis. Must be a power of two.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t, size_t BlockCells = 8>
+	class ChangeTrackingLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert((BlockCells & (BlockCells - 1)) == 0, "BlockCells must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using Entry                             = std::pair<CoordinateArray, ObjectType *>;
+		using BucketContent                     = std::vector<Entry>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		void add(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			auto [it, inserted] = cells_.try_emplace(key);
+			if (inserted) {
+				blocks_[block_of(key)].cells.push_back(key);
+			}
+			if (it->second.entries.empty()) {
+				++occupied_;
+			}
+			it->second.entries.emplace_back(coordinates, object);
+			++size_;
+			stamp(key, it->second);
+		}
+
+		/**
+		 * @brief Removes object from the bucket containing coordinates.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			const auto                    it = cells_.find(key);
+			if (it == cells_.end()) {
+				return false;
+			}
+			auto &     entries = it->second.entries;
+			const auto entry   = std::find_if(entries.begin(), entries.end(),
+			                                  [&](const Entry & candidate) { return candidate.second == object; });
+			if (entry == entries.end()) {
+				return false;
+			}
+			entries.erase(entry);
+			if (entries.empty()) {
+				--occupied_;
+			}
+			--size_;
+			stamp(key, it->second);
+			return true;
+		}
+
+		/**
+		 * @brief Moves an object. Unlike LocationHash::move, a move within a bucket updates the stored coordinates,
+		 * and so counts as a change to the cell.
+		 *
+		 * @return True if the object was found and moved.
+		 */
+		bool move(ObjectType * object, const CoordinateArray & old_coordinates, const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			if (old_key != QuantizedCoordinateType(new_coordinates)) {
+				if (!remove(object, old_coordinates)) {
+					return false;
+				}
+				add(object, new_coordinates);
+				return true;
+			}
+			const auto it = cells_.find(old_key);
+			if (it == cells_.end()) {
+				return false;
+			}
+			for (auto & entry : it->second.entries) {
+				if (entry.second == object) {
+					entry.first = new_coordinates;
+					stamp(old_key, it->second);
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/**
+		 * @brief The entries of a bucket, empty if the cell is not occupied.
+		 */
+		std::span<const Entry> find(const QuantizedCoordinateType & key) const
+		{
+			const auto it = cells_.find(key);
+			return it != cells_.end() ? std::span<const Entry>(it->second.entries) : std::span<const Entry>();
+		}
+
+		/**
+		 * @brief The entries of the bucket containing coordinates. See find().
+		 */
+		std::span<const Entry> query(const CoordinateArray & coordinates) const
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Visits every occupied bucket as visitor(key, bucket), in no particular order. Tombstones are
+		 * skipped.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor) const
+		{
+			for (const auto & [key, cell] : cells_) {
+				if (!cell.entries.empty()) {
+					visitor(key, std::span<const Entry>(cell.entries));
+				}
+			}
+		}
+
+		/**
+		 * @brief Visits the cells overlapping a box that changed after version since, as
+		 * visitor(key, entries, modified). A cell whose entries are empty was emptied. Cells are visited whole, like
+		 * unload_region, so a cell on the edge of the box is reported even if its changed entries lie outside it.
+		 *
+		 * If since predates the horizon, removals may have been forgotten. Then every occupied cell in the box is
+		 * visited instead, and the caller should replace its copy of the region rather than patch it.
+		 *
+		 * @param lower_bounds The lower bounds of the region.
+		 * @param upper_bounds The upper bounds of the region.
+		 * @param since The version the caller last synchronized at, typically a value of version().
+		 * @param visitor Called for each reported cell.
+		 * @return True if only changes were reported, false if this was a full resync.
+		 */
+		template <typename Visitor>
+		bool changed_since(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds, uint64_t since,
+		                   Visitor && visitor) const
+		{
+			const bool incremental = since >= horizon_;
+			const auto report      = [&](const QuantizedCoordinateType & key, const Cell & cell) {
+				if (incremental ? cell.modified > since : !cell.entries.empty()) {
+					visitor(key, std::span<const Entry>(cell.entries), cell.modified);
+				}
+			};
+
+			QuantizedCoordinateType lower;
+			QuantizedCoordinateType upper;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				lower.quantized_[i] =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(lower_bounds[i]);
+				upper.quantized_[i] =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(upper_bounds[i]);
+				if (upper.quantized_[i] < lower.quantized_[i]) {
+					return incremental;
+				}
+			}
+			const auto scan_block = [&](const Block & block) {
+				if (incremental && block.modified <= since) {
+					return;
+				}
+				for (const auto & key : block.cells) {
+					if (key_within(key, lower, upper)) {
+						report(key, cells_.find(key)->second);
+					}
+				}
+			};
+
+			// visit whichever is smaller: the blocks of the region or the tracked blocks
+			const QuantizedCoordinateType lower_block   = block_of(lower);
+			const QuantizedCoordinateType upper_block   = block_of(upper);
+			const size_t                  cap           = blocks_.size() + 1;
+			size_t                        region_blocks = 1;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				const auto across = static_cast<size_t>(upper_block.quantized_[i] - lower_block.quantized_[i]) + 1;
+				region_blocks     = std::min(region_blocks * std::min(across, cap), cap);
+			}
+			if (region_blocks <= blocks_.size()) {
+				QuantizedCoordinateType block = lower_block;
+				for (bool done = false; !done;) {
+					const auto it = blocks_.find(block);
+					if (it != blocks_.end()) {
+						scan_block(it->second);
+					}
+					done = true;
+					for (size_t i = 0; i < Dimensions && done; ++i) {
+						if (block.quantized_[i] < upper_block.quantized_[i]) {
+							++block.quantized_[i];
+							done = false;
+						} else {
+							block.quantized_[i] = lower_block.quantized_[i];
+						}
+					}
+				}
+			} else {
+				for (const auto & [block_key, block] : blocks_) {
+					if (key_within(block_key, lower_block, upper_block)) {
+						scan_block(block);
+					}
+				}
+			}
+			return incremental;
+		}
+
+		/**
+		 * @brief Drops tombstones of cells emptied at or before version, moving the horizon up to it. Call it with
+		 * the oldest version any client still needs to resynchronize from.
+		 */
+		void forget_before(uint64_t version)
+		{
+			horizon_ = std::max(horizon_, version);
+			for (auto block = blocks_.begin(); block != blocks_.end();) {
+				auto & keys = block->second.cells;
+				keys.erase(std::remove_if(keys.begin(), keys.end(),
+				                          [&](const QuantizedCoordinateType & key) {
+					                          const auto it = cells_.find(key);
+					                          if (it->second.entries.empty() && it->second.modified <= horizon_) {
+						                          cells_.erase(it);
+						                          return true;
+					                          }
+					                          return false;
+				                          }),
+				           keys.end());
+				block = keys.empty() ? blocks_.erase(block) : std::next(block);
+			}
+		}
+
+		/**
+		 * @brief The version of the latest modification, or 0 before any.
+		 */
+		uint64_t version() const { return version_; }
+
+		/**
+		 * @brief The oldest version changed_since() can answer incrementally.
+		 */
+		uint64_t horizon() const { return horizon_; }
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		/**
+		 * @brief The number of occupied cells, not counting tombstones.
+		 */
+		size_t cell_count() const { return occupied_; }
+
+		/**
+		 * @brief The number of cells tracked, including tombstones.
+		 */
+		size_t tracked_cell_count() const { return cells_.size(); }
+
+		/**
+		 * @brief Removes everything. The version keeps counting, and the horizon moves up to it, since the removals
+		 * are not recorded.
+		 */
+		void clear()
+		{
+			cells_.clear();
+			blocks_.clear();
+			size_     = 0;
+			occupied_ = 0;
+			horizon_  = version_;
+		}
+
+	  private:
+		struct Cell {
+			BucketContent entries;
+			uint64_t      modified = 0;
+		};
+
+		struct Block {
+			std::vector<QuantizedCoordinateType> cells; // tracked cells, including tombstones
+			uint64_t                             modified = 0;
+		};
+
+		static constexpr int block_shift = std::countr_zero(Precision * BlockCells);
+
+		// Block keys reuse QuantizedCoordinate for its hash; each value is a block index, floored.
+		static QuantizedCoordinateType block_of(const QuantizedCoordinateType & key)
+		{
+			QuantizedCoordinateType block;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				block.quantized_[i] = key.quantized_[i] >> block_shift;
+			}
+			return block;
+		}
+
+		static bool key_within(const QuantizedCoordinateType & key, const QuantizedCoordinateType & lower,
+		                       const QuantizedCoordinateType & upper)
+		{
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (key.quantized_[i] < lower.quantized_[i] || upper.quantized_[i] < key.quantized_[i]) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+		void stamp(const QuantizedCoordinateType & key, Cell & cell)
+		{
+			cell.modified                   = ++version_;
+			blocks_[block_of(key)].modified = version_;
+		}
+
+		std::unordered_map<QuantizedCoordinateType, Cell>  cells_;
+		std::unordered_map<QuantizedCoordinateType, Block> blocks_;
+		size_t                                             size_     = 0;
+		size_t                                             occupied_ = 0;
+		uint64_t                                           version_  = 0;
+		uint64_t                                           horizon_  = 0;
+	};
+
+	/**
+	 * Query objects within a bounding box in a ChangeTrackingLocationHash.
+	 *
+	 * @param locationHash The ChangeTrackingLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType, size_t BlockCells>
+	void query_bounding_box(const ChangeTrackingLocationHash<Precision, CoordinateType, Dimensions, ObjectType,
+	                                                         QuantizedCoordinateIntegerType, BlockCells> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &                              lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &                              upper_bounds,
+	                        std::vector<ObjectType *> &                                                 result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a ChangeTrackingLocationHash.
+	 *
+	 * @param locationHash The ChangeTrackingLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType, size_t BlockCells>
+	void
+	query_within_distance(const ChangeTrackingLocationHash<Precision, CoordinateType, Dimensions, ObjectType,
+	                                                       QuantizedCoordinateIntegerType, BlockCells> & locationHash,
+	                      const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                      std::vector<ObjectType *> & result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a ChangeTrackingLocationHash, nearest first. See query_nearest for
+	 * LocationHash.
+	 *
+	 * @param locationHash The ChangeTrackingLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType, size_t BlockCells>
+	std::vector<ObjectType *>
+	query_nearest(const ChangeTrackingLocationHash<Precision, CoordinateType, Dimensions, ObjectType,
+	                                               QuantizedCoordinateIntegerType, BlockCells> & locationHash,
+	              const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) { locationHash.for_each_bucket(visitor); }, locationHash.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_change_tracking_hpp
@@ -0,0 +1,431 @@
+#ifndef _INCLUDED_location_hash_clustering_hpp
+#define _INCLUDED_location_hash_clustering_hpp
+
+#include "location_hash_algorithm.hpp"
+#include "location_hash_cell_grid.hpp"
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+namespace lochash
+{
+	namespace detail
+	{
+		/**
+		 * @brief Union-find over the numbers 0 to size - 1 with path halving and union by index.
+		 */
+		class DisjointSets
+		{
+		  public:
+			explicit DisjointSets(size_t size)
+			    : parent_(size)
+			{
+				std::iota(parent_.begin(), parent_.end(), size_t(0));
+			}
+
+			size_t find(size_t element)
+			{
+				while (parent_[element] != element) {
+					parent_[element] = parent_[parent_[element]];
+					element          = parent_[element];
+				}
+				return element;
+			}
+
+			/**
+			 * @brief Joins the sets of a and b. The smaller root becomes the root of both, so each set is named by
+			 * its first element.
+			 * @return false if they were already in the same set.
+			 */
+			bool unite(size_t a, size_t b)
+			{
+				a = find(a);
+				b = find(b);
+				if (a == b) {
+					return false;
+				}
+				if (a < b) {
+					parent_[b] = a;
+				} else {
+					parent_[a] = b;
+				}
+				return true;
+			}
+
+		  private:
+			std::vector<size_t> parent_;
+		};
+
+		/**
+		 * @brief DisjointSets that many threads can unite at once without locks. A root is only ever linked below
+		 * a smaller root, by a compare-and-swap that fails if another thread linked it first, so the forest stays
+		 * acyclic and each set is still named by its first element.
+		 */
+		class ConcurrentDisjointSets
+		{
+		  public:
+			explicit ConcurrentDisjointSets(size_t size)
+			    : parent_(size)
+			{
+				for (size_t i = 0; i < size; ++i) {
+					parent_[i].store(i, std::memory_order_relaxed);
+				}
+			}
+
+			size_t find(size_t element)
+			{
+				size_t parent = parent_[element].load();
+				while (parent != element) {
+					// Path halving. Losing the race to another thread only leaves the path a little longer.
+					size_t grandparent = parent_[parent].load();
+					parent_[element].compare_exchange_weak(parent, grandparent);
+					element = grandparent;
+					parent  = parent_[element].load();
+				}
+				return element;
+			}
+
+			bool unite(size_t a, size_t b)
+			{
+				while (true) {
+					a = find(a);
+					b = find(b);
+					if (a == b) {
+						return false;
+					}
+					if (a > b) {
+						std::swap(a, b);
+					}
+					size_t expected = b;
+					if (parent_[b].compare_exchange_strong(expected, a)) {
+						return true;
+					}
+				}
+			}
+
+		  private:
+			std::vector<std::atomic<size_t>> parent_;
+		};
+	} // namespace detail
+
+	/**
+	 * @brief The result of a clustering: a label per entry of the CellGrid it ran on.
+	 */
+	struct Clustering {
+		static constexpr int32_t noise = -1;
+
+		// The cluster of each entry, numbered from 0 in order of each cluster's first entry, or noise.
+		std::vector<int32_t> labels;
+		// Whether each entry is a core point, i.e. has at least min_points entries within eps.
+		std::vector<bool> core;
+		size_t            cluster_count = 0;
+	};
+
+	/**
+	 * @brief The result of connected_components(): a label per entry of the CellGrid it ran on.
+	 */
+	struct Components {
+		// The component of each entry, numbered from 0 in order of each component's first entry.
+		std::vector<uint32_t> labels;
+		size_t                component_count = 0;
+	};
+
+	/**
+	 * @brief Clusters the entries of a grid with DBSCAN. An entry with at least min_points entries, itself
+	 * included, within eps is a core point. Core points within eps of each other share a cluster, a non-core
+	 * entry within eps of a core point joins the cluster of one of them, and every other entry is noise.
+	 *
+	 * Work is done per pair of cells from CellGrid::for_each_cell_pair(). When a cell's diagonal is at most eps,
+	 * i.e. eps >= Precision * sqrt(Dimensions), every two entries of a cell are neighbours: a cell holding
+	 * min_points entries is all core without counting, a core cell is one piece of a cluster without testing its
+	 * pairs, and joining two cells stops at the first pair of core points found. Neighbouring cells whose farthest
+	 * points are within eps are counted whole. With eps between one and two cell diagonals most of the work is
+	 * these cell-level steps, so the run time grows close to linearly with the number of entries.
+	 *
+	 * @param grid The entries to cluster.
+	 * @param eps The neighbourhood radius.
+	 * @param min_points The number of entries within eps, including the entry itself, that makes a core point.
+	 * @return A Clustering with one label per entry of grid.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	Clustering
+	dbscan(const CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> & grid,
+	       CoordinateType eps, size_t min_points)
+	{
+		using Grid = CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>;
+		using Cell = typename Grid::Cell;
+
+		constexpr size_t none        = std::numeric_limits<size_t>::max();
+		const auto       eps_squared = eps * eps;
+		const bool       small_cells = static_cast<double>(Precision) * static_cast<double>(Precision) *
+		                                   static_cast<double>(Dimensions) <=
+		                               static_cast<double>(eps_squared);
+
+		const auto within = [&](size_t a, size_t b) {
+			return calculate_distance_squared(grid.coordinates(a), grid.coordinates(b)) <= eps_squared;
+		};
+		const auto cell_entries = [](const Cell & cell) {
+			return std::views::iota(cell.first, cell.first + cell.count);
+		};
+
+		// Count the neighbours of each entry until it is known to be core.
+		std::vector<size_t> counts(grid.size(), 0);
+		if (small_cells) {
+			for (const Cell & cell : grid.cells()) {
+				for (size_t i : cell_entries(cell)) {
+					counts[i] = cell.count;
+				}
+			}
+		}
+		grid.for_each_cell_pair(eps, [&](const Cell & a, const Cell & b) {
+			if (&a == &b) {
+				if (!small_cells) {
+					for (size_t i : cell_entries(a)) {
+						for (size_t j = i; j < a.first + a.count; ++j) {
+							if (within(i, j)) {
+								++counts[i];
+								counts[j] += i != j;
+							}
+						}
+					}
+				}
+				return;
+			}
+			const bool a_core = small_cells && a.count >= min_points;
+			const bool b_core = small_cells && b.count >= min_points;
+			if ((a_core && b_core) || Grid::min_distance_squared(a, b) > eps_squared) {
+				return;
+			}
+			if (Grid::max_distance_squared(a, b) <= eps_squared) {
+				for (size_t i : cell_entries(a)) {
+					counts[i] += b.count;
+				}
+				for (size_t j : cell_entries(b)) {
+					counts[j] += a.count;
+				}
+				return;
+			}
+			for (size_t i : cell_entries(a)) {
+				for (size_t j : cell_entries(b)) {
+					if ((counts[i] < min_points || counts[j] < min_points) && within(i, j)) {
+						++counts[i];
+						++counts[j];
+					}
+				}
+			}
+		});
+
+		Clustering result;
+		result.core.resize(grid.size());
+		for (size_t i = 0; i < grid.size(); ++i) {
+			result.core[i] = counts[i] >= min_points;
+		}
+
+		// Join core points within eps of each other, and give each border point a core point to follow.
+		detail::DisjointSets sets(grid.size());
+		std::vector<size_t>  follows(grid.size(), none);
+
+		const auto connect = [&](size_t i, size_t j) {
+			if (result.core[i] && result.core[j]) {
+				sets.unite(i, j);
+			} else if (result.core[i] && !result.core[j] && follows[j] == none) {
+				follows[j] = i;
+			} else if (result.core[j] && !result.core[i] && follows[i] == none) {
+				follows[i] = j;
+			}
+		};
+		// The first core point of each cell, found once rather than for every pair the cell is in.
+		std::vector<size_t> anchors(small_cells ? grid.cell_count() : 0, none);
+		for (size_t c = 0; c < anchors.size(); ++c) {
+			const Cell & cell = grid.cells()[c];
+			for (size_t i : cell_entries(cell)) {
+				if (result.core[i]) {
+					anchors[c] = i;
+					break;
+				}
+			}
+		}
+		const auto anchor_of = [&](const Cell & cell) { return anchors[grid.index_of(cell)]; };
+		grid.for_each_cell_pair(eps, [&](const Cell & a, const Cell & b) {
+			if (!small_cells) {
+				if (&a == &b) {
+					for (size_t i : cell_entries(a)) {
+						for (size_t j = i + 1; j < a.first + a.count; ++j) {
+							if (within(i, j)) {
+								connect(i, j);
+							}
+						}
+					}
+				} else if (Grid::min_distance_squared(a, b) <= eps_squared) {
+					for (size_t i : cell_entries(a)) {
+						for (size_t j : cell_entries(b)) {
+							if (within(i, j)) {
+								connect(i, j);
+							}
+						}
+					}
+				}
+				return;
+			}
+
+			const size_t a_anchor = anchor_of(a);
+			if (&a == &b) {
+				// Every entry of the cell is within eps of every other.
+				if (a_anchor != none) {
+					for (size_t i : cell_entries(a)) {
+						connect(a_anchor, i);
+					}
+				}
+				return;
+			}
+			const size_t b_anchor = anchor_of(b);
+			if (a_anchor == none && b_anchor == none) {
+				return;
+			}
+			if (a_anchor != none && b_anchor != none && sets.find(a_anchor) != sets.find(b_anchor)) {
+				// One pair of core points within eps joins both cells.
+				bool joined = false;
+				for (size_t i : cell_entries(a)) {
+					for (size_t j : cell_entries(b)) {
+						if (result.core[i] && result.core[j] && within(i, j)) {
+							sets.unite(i, j);
+							joined = true;
+							break;
+						}
+					}
+					if (joined) {
+						break;
+					}
+				}
+			}
+			for (size_t i : cell_entries(a)) {
+				for (size_t j : cell_entries(b)) {
+					if (result.core[i] != result.core[j] && follows[result.core[i] ? j : i] == none && within(i, j)) {
+						connect(i, j);
+					}
+				}
+			}
+		});
+
+		// Number the clusters in order of their first entry.
+		result.labels.assign(grid.size(), Clustering::noise);
+		for (size_t i = 0; i < grid.size(); ++i) {
+			const size_t root = result.core[i] ? sets.find(i) : follows[i] != none ? sets.find(follows[i]) : none;
+			if (root == none) {
+				continue;
+			}
+			// The root is a member of its cluster, so its label names the cluster even before the root is reached.
+			if (result.labels[root] == Clustering::noise) {
+				result.labels[root] = static_cast<int32_t>(result.cluster_count++);
+			}
+			result.labels[i] = result.labels[root];
+		}
+		return result;
+	}
+
+	/**
+	 * @brief Finds the connected components of the graph joining every two entries of a grid within distance of
+	 * each other, e.g. islands of touching bodies or squads of nearby players.
+	 *
+	 * The cells are shared out between threads, and each thread unites entries through a lock-free union-find as
+	 * it walks the pairs of its cells from CellGrid::for_each_cell_pair(). When a cell's diagonal is at most
+	 * distance, i.e. distance >= Precision * sqrt(Dimensions), each cell is one piece of a component before any
+	 * pair is looked at, two cells whose farthest points are within distance join without testing their entries,
+	 * and two other cells join at the first close pair found. Pairs of cells already in the same component are
+	 * skipped.
+	 *
+	 * @param grid The entries to group.
+	 * @param distance The distance within which two entries are connected.
+	 * @param threads The number of threads to use, or 0 for one per hardware thread.
+	 * @return A Components with one label per entry of grid.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	Components connected_components(
+	    const CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> & grid,
+	    CoordinateType distance, size_t threads = 0)
+	{
+		using Grid = CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>;
+		using Cell = typename Grid::Cell;
+
+		const auto distance_squared = distance * distance;
+		const bool small_cells      = static_cast<double>(Precision) * static_cast<double>(Precision) *
+		                                 static_cast<double>(Dimensions) <=
+		                             static_cast<double>(distance_squared);
+
+		const auto within = [&](size_t a, size_t b) {
+			return calculate_distance_squared(grid.coordinates(a), grid.coordinates(b)) <= distance_squared;
+		};
+
+		detail::ConcurrentDisjointSets sets(grid.size());
+		if (small_cells) {
+			for (const Cell & cell : grid.cells()) {
+				for (size_t i = cell.first + 1; i < cell.first + cell.count; ++i) {
+					sets.unite(cell.first, i);
+				}
+			}
+		}
+
+		const auto join = [&](const Cell & a, const Cell & b) {
+			if (&a == &b) {
+				if (!small_cells) {
+					for (size_t i = a.first; i < a.first + a.count; ++i) {
+						for (size_t j = i + 1; j < a.first + a.count; ++j) {
+							if (within(i, j)) {
+								sets.unite(i, j);
+							}
+						}
+					}
+				}
+				return;
+			}
+			if (Grid::min_distance_squared(a, b) > distance_squared) {
+				return;
+			}
+			if (small_cells) {
+				if (sets.find(a.first) == sets.find(b.first)) {
+					return;
+				}
+				if (Grid::max_distance_squared(a, b) <= distance_squared) {
+					sets.unite(a.first, b.first);
+					return;
+				}
+				for (size_t i = a.first; i < a.first + a.count; ++i) {
+					for (size_t j = b.first; j < b.first + b.count; ++j) {
+						if (within(i, j)) {
+							sets.unite(i, j);
+							return;
+						}
+					}
+				}
+				return;
+			}
+			for (size_t i = a.first; i < a.first + a.count; ++i) {
+				for (size_t j = b.first; j < b.first + b.count; ++j) {
+					if (within(i, j)) {
+						sets.unite(i, j);
+					}
+				}
+			}
+		};
+		const auto stencil = Grid::pair_stencil(distance);
+		detail::parallel_for_ranges(grid.cell_count(), 256, threads, [&](size_t first, size_t last) {
+			grid.for_each_cell_pair(stencil, first, last, join);
+		});
+
+		// Number the components in order of their first entry, which is also their root.
+		Components result;
+		result.labels.resize(grid.size());
+		for (size_t i = 0; i < grid.size(); ++i) {
+			const size_t root = sets.find(i);
+			result.labels[i]  = root == i ? static_cast<uint32_t>(result.component_count++) : result.labels[root];
+		}
+		return result;
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_clustering_hpp
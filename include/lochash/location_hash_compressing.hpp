@@ -0,0 +1,363 @@
+#ifndef _INCLUDED_location_hash_compressing_hpp
+#define _INCLUDED_location_hash_compressing_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include "location_hash_varint.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Counters for a CompressingLocationHash, to weigh the memory saved against the cost of expanding cells
+	 * that turn out not to be cold.
+	 */
+	struct CompressionStatistics {
+		uint64_t compressions              = 0; // cells compressed
+		uint64_t decompressions            = 0; // compressed cells expanded again because they were accessed
+		uint64_t decompression_nanoseconds = 0; // time spent expanding them
+		size_t   compressed_cells          = 0; // cells compressed now
+		size_t   raw_bytes                 = 0; // bucket storage the compressed cells would take expanded
+		size_t   packed_bytes              = 0; // bucket storage they take compressed
+
+		size_t bytes_saved() const { return raw_bytes - packed_bytes; }
+	};
+
+	/**
+	 * @brief A LocationHash that compresses the buckets of cells nobody has touched for a while.
+	 *
+	 * Every access stamps the cell with the current epoch, which the caller advances, e.g. once per second.
+	 * compress_cold() packs the buckets of cells idle for a given number of epochs: each coordinate is stored as
+	 * the difference from the previous entry's (the first from the cell's origin) and each object pointer as the
+	 * difference from the previous pointer, as zigzag varints. Nearby points share their high bits, so this is
+	 * lossless and typically well under half the size. Cells are expanded again the next time they are accessed,
+	 * by an update or by a query, so the rest of the interface works as on an uncompressed index.
+	 *
+	 * Not thread safe: queries may expand cells.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class CompressingLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+		static_assert(sizeof(CoordinateType) <= sizeof(uint64_t), "Coordinates are packed as at most 64 bits.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using Entry                             = std::pair<CoordinateArray, ObjectType *>;
+		using BucketContent                     = std::vector<Entry>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		void add(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			auto & cell = access(QuantizedCoordinateType(coordinates));
+			cell.entries.emplace_back(coordinates, object);
+			++size_;
+		}
+
+		/**
+		 * @brief Removes object from the bucket containing coordinates.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const auto it = cells_.find(QuantizedCoordinateType(coordinates));
+			if (it == cells_.end()) {
+				return false;
+			}
+			auto &     entries = expand(*it).entries;
+			const auto entry   = std::find_if(entries.begin(), entries.end(),
+			                                  [&](const Entry & candidate) { return candidate.second == object; });
+			if (entry == entries.end()) {
+				return false;
+			}
+			entries.erase(entry);
+			--size_;
+			if (entries.empty()) {
+				cells_.erase(it);
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Moves an object. Unlike LocationHash::move, a move within a bucket updates the stored coordinates.
+		 *
+		 * @return True if the object was found and moved.
+		 */
+		bool move(ObjectType * object, const CoordinateArray & old_coordinates, const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			if (old_key == QuantizedCoordinateType(new_coordinates)) {
+				const auto it = cells_.find(old_key);
+				if (it == cells_.end()) {
+					return false;
+				}
+				for (auto & entry : expand(*it).entries) {
+					if (entry.second == object) {
+						entry.first = new_coordinates;
+						return true;
+					}
+				}
+				return false;
+			}
+			if (!remove(object, old_coordinates)) {
+				return false;
+			}
+			add(object, new_coordinates);
+			return true;
+		}
+
+		/**
+		 * @brief The entries of a bucket, expanding it if it was compressed. Empty if the cell is not occupied.
+		 * The span is valid until the next update or compress_cold().
+		 */
+		std::span<const Entry> find(const QuantizedCoordinateType & key)
+		{
+			const auto it = cells_.find(key);
+			if (it == cells_.end()) {
+				return {};
+			}
+			return expand(*it).entries;
+		}
+
+		/**
+		 * @brief The entries of the bucket containing coordinates. See find().
+		 */
+		std::span<const Entry> query(const CoordinateArray & coordinates)
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Visits every occupied bucket as visitor(key, bucket), in no particular order, expanding the ones
+		 * that were compressed like find() does.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor)
+		{
+			for (auto & slot : cells_) {
+				visitor(slot.first, std::span<const Entry>(expand(slot).entries));
+			}
+		}
+
+		/**
+		 * @brief Starts a new access epoch. Cells accessed from now on count as used in it.
+		 */
+		void advance_epoch() { ++epoch_; }
+
+		uint64_t epoch() const { return epoch_; }
+
+		/**
+		 * @brief Compresses every cell that has not been accessed in the last idle_epochs epochs, skipping cells
+		 * that would not get smaller. Visits every cell, so call it at the rate epochs advance, not per frame.
+		 *
+		 * @return The number of cells compressed.
+		 */
+		size_t compress_cold(uint64_t idle_epochs)
+		{
+			size_t compressed = 0;
+			for (auto & [key, cell] : cells_) {
+				if (!cell.compressed && epoch_ - cell.last_access >= idle_epochs && compress(key, cell)) {
+					++compressed;
+				}
+			}
+			return compressed;
+		}
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		size_t cell_count() const { return cells_.size(); }
+
+		const CompressionStatistics & statistics() const { return statistics_; }
+
+		void clear()
+		{
+			cells_.clear();
+			size_                        = 0;
+			statistics_.compressed_cells = 0;
+			statistics_.raw_bytes        = 0;
+			statistics_.packed_bytes     = 0;
+		}
+
+	  private:
+		struct Cell {
+			BucketContent        entries;
+			std::vector<uint8_t> packed; // entries while compressed
+			size_t               packed_count = 0;
+			uint64_t             last_access  = 0;
+			bool                 compressed   = false;
+		};
+
+		using CellMap = std::unordered_map<QuantizedCoordinateType, Cell>;
+
+		Cell & access(const QuantizedCoordinateType & key) { return expand(*cells_.try_emplace(key).first); }
+
+		// Stamps a cell as used in this epoch and makes sure its entries are expanded.
+		Cell & expand(typename CellMap::value_type & slot)
+		{
+			auto & [key, cell] = slot;
+			cell.last_access   = epoch_;
+			if (cell.compressed) {
+				decompress(key, cell);
+			}
+			return cell;
+		}
+
+		bool compress(const QuantizedCoordinateType & key, Cell & cell)
+		{
+			std::vector<uint8_t> packed;
+			CoordinateArray      previous        = origin(key);
+			uintptr_t            previous_object = 0;
+			for (const auto & [coordinates, object] : cell.entries) {
+				for (size_t i = 0; i < Dimensions; ++i) {
+					detail::append_delta(packed, coordinates[i], previous[i]);
+				}
+				detail::append_delta(packed, reinterpret_cast<uintptr_t>(object), previous_object);
+				previous        = coordinates;
+				previous_object = reinterpret_cast<uintptr_t>(object);
+			}
+
+			const size_t raw_bytes = cell.entries.size() * sizeof(Entry);
+			if (packed.size() >= raw_bytes) {
+				return false;
+			}
+			packed.shrink_to_fit();
+			cell.packed       = std::move(packed);
+			cell.packed_count = cell.entries.size();
+			cell.compressed   = true;
+			BucketContent().swap(cell.entries);
+
+			++statistics_.compressions;
+			++statistics_.compressed_cells;
+			statistics_.raw_bytes += raw_bytes;
+			statistics_.packed_bytes += cell.packed.size();
+			return true;
+		}
+
+		void decompress(const QuantizedCoordinateType & key, Cell & cell)
+		{
+			const auto      begin           = std::chrono::steady_clock::now();
+			CoordinateArray previous        = origin(key);
+			uintptr_t       previous_object = 0;
+			const uint8_t * in              = cell.packed.data();
+			cell.entries.reserve(cell.packed_count);
+			for (size_t e = 0; e < cell.packed_count; ++e) {
+				for (size_t i = 0; i < Dimensions; ++i) {
+					previous[i] = detail::read_delta(in, previous[i]);
+				}
+				previous_object = detail::read_delta(in, previous_object);
+				cell.entries.emplace_back(previous, reinterpret_cast<ObjectType *>(previous_object));
+			}
+
+			--statistics_.compressed_cells;
+			statistics_.raw_bytes -= cell.packed_count * sizeof(Entry);
+			statistics_.packed_bytes -= cell.packed.size();
+			++statistics_.decompressions;
+			statistics_.decompression_nanoseconds += static_cast<uint64_t>(
+			    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+
+			std::vector<uint8_t>().swap(cell.packed);
+			cell.packed_count = 0;
+			cell.compressed   = false;
+		}
+
+		static CoordinateArray origin(const QuantizedCoordinateType & key)
+		{
+			CoordinateArray corner;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				corner[i] = static_cast<CoordinateType>(key.quantized_[i]);
+			}
+			return corner;
+		}
+
+		CellMap               cells_;
+		size_t                size_  = 0;
+		uint64_t              epoch_ = 0;
+		CompressionStatistics statistics_;
+	};
+
+	/**
+	 * Query objects within a bounding box in a CompressingLocationHash. Compressed cells the box overlaps are
+	 * expanded.
+	 *
+	 * @param locationHash The CompressingLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(
+	    CompressingLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds, std::vector<ObjectType *> & result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a CompressingLocationHash. Compressed cells the search
+	 * overlaps are expanded.
+	 *
+	 * @param locationHash The CompressingLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(
+	    CompressingLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	    std::vector<ObjectType *> &                    result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a CompressingLocationHash, nearest first. See query_nearest for
+	 * LocationHash. Compressed cells the search visits are expanded.
+	 *
+	 * @param locationHash The CompressingLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *> query_nearest(
+	    CompressingLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) { locationHash.for_each_bucket(visitor); }, locationHash.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_compressing_hpp
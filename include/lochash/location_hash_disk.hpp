@@ -0,0 +1,815 @@
+#ifndef _INCLUDED_location_hash_disk_hpp
+#define _INCLUDED_location_hash_disk_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lochash
+{
+	namespace detail
+	{
+		/**
+		 * @brief Positioned reads and writes on a file that is created if it does not exist. Uses pread/pwrite on
+		 * POSIX systems and a file stream elsewhere. Failures throw std::system_error.
+		 */
+		class PagedFile
+		{
+		  public:
+			explicit PagedFile(const std::string & path)
+			{
+#if defined(_WIN32)
+				{
+					std::ofstream create(path, std::ios::binary | std::ios::app);
+				}
+				stream_.open(path, std::ios::binary | std::ios::in | std::ios::out);
+				if (!stream_) {
+					throw std::system_error(std::make_error_code(std::errc::io_error), "unable to open " + path);
+				}
+#else
+				fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+				if (fd_ < 0) {
+					throw std::system_error(errno, std::generic_category(), "unable to open " + path);
+				}
+#endif
+			}
+
+			~PagedFile()
+			{
+#if !defined(_WIN32)
+				::close(fd_);
+#endif
+			}
+
+			PagedFile(const PagedFile &)             = delete;
+			PagedFile & operator=(const PagedFile &) = delete;
+
+			uint64_t size()
+			{
+#if defined(_WIN32)
+				stream_.seekg(0, std::ios::end);
+				return static_cast<uint64_t>(stream_.tellg());
+#else
+				struct stat status;
+				if (::fstat(fd_, &status) != 0) {
+					throw std::system_error(errno, std::generic_category(), "unable to stat file");
+				}
+				return static_cast<uint64_t>(status.st_size);
+#endif
+			}
+
+			void read(uint64_t offset, void * data, size_t bytes)
+			{
+#if defined(_WIN32)
+				stream_.seekg(static_cast<std::streamoff>(offset));
+				stream_.read(static_cast<char *>(data), static_cast<std::streamsize>(bytes));
+				if (!stream_) {
+					stream_.clear();
+					throw std::system_error(std::make_error_code(std::errc::io_error), "short read");
+				}
+#else
+				auto * bytes_out = static_cast<char *>(data);
+				while (bytes > 0) {
+					const auto got = ::pread(fd_, bytes_out, bytes, static_cast<off_t>(offset));
+					if (got <= 0) {
+						if (got < 0 && errno == EINTR) {
+							continue;
+						}
+						throw std::system_error(got < 0 ? errno : EIO, std::generic_category(), "short read");
+					}
+					bytes_out += got;
+					offset += static_cast<uint64_t>(got);
+					bytes -= static_cast<size_t>(got);
+				}
+#endif
+			}
+
+			void write(uint64_t offset, const void * data, size_t bytes)
+			{
+#if defined(_WIN32)
+				stream_.seekp(static_cast<std::streamoff>(offset));
+				stream_.write(static_cast<const char *>(data), static_cast<std::streamsize>(bytes));
+				if (!stream_) {
+					stream_.clear();
+					throw std::system_error(std::make_error_code(std::errc::io_error), "short write");
+				}
+#else
+				const auto * bytes_in = static_cast<const char *>(data);
+				while (bytes > 0) {
+					const auto put = ::pwrite(fd_, bytes_in, bytes, static_cast<off_t>(offset));
+					if (put < 0) {
+						if (errno == EINTR) {
+							continue;
+						}
+						throw std::system_error(errno, std::generic_category(), "short write");
+					}
+					bytes_in += put;
+					offset += static_cast<uint64_t>(put);
+					bytes -= static_cast<size_t>(put);
+				}
+#endif
+			}
+
+			void sync()
+			{
+#if defined(_WIN32)
+				stream_.flush();
+#else
+				if (::fsync(fd_) != 0) {
+					throw std::system_error(errno, std::generic_category(), "unable to sync file");
+				}
+#endif
+			}
+
+		  private:
+#if defined(_WIN32)
+			std::fstream stream_;
+#else
+			int fd_ = -1;
+#endif
+		};
+	} // namespace detail
+
+	/**
+	 * @brief Counters for a DiskLocationHash cache, for tuning its size and checking prefetch.
+	 */
+	struct DiskCacheStatistics {
+		uint64_t hits          = 0; // cell lookups served from memory
+		uint64_t misses        = 0; // cells read from the file
+		uint64_t reads         = 0; // read calls made to the file, after coalescing adjacent cells
+		uint64_t writes        = 0; // dirty cells written back
+		uint64_t bytes_read    = 0;
+		uint64_t bytes_written = 0;
+	};
+
+	/**
+	 * @brief A LocationHash for data sets larger than memory. Cells are stored in a file and a bounded number of
+	 * them are cached in memory, least recently used first out.
+	 *
+	 * Each cell occupies one contiguous extent of fixed-size pages, so loading a cell is a single read. A directory
+	 * of every cell's key, extent and entry count stays in memory, which lets queries skip empty cells without
+	 * touching the file and lets them prefetch: before scanning, a query reads every cell it will touch that is not
+	 * cached, in file order, merging reads of adjacent extents.
+	 *
+	 * Changes are made in the cache and written back when a dirty cell is evicted or on flush(). flush() also
+	 * writes the directory, and is the point at which the file is consistent. The destructor flushes. A cell that
+	 * outgrows its extent is moved to a larger one and its old extent is reused for later cells. The directory is
+	 * written to pages of its own, then the header that points at it, and neither the pages of the directory in
+	 * the file nor the extents released since it was written are reused before the next flush. A crash between
+	 * flushes can thus lose updates made since the last one, but leaves a directory that only points at pages of
+	 * the cells it lists.
+	 *
+	 * Entries are stored as raw bytes, so Payload must be trivially copyable (an id or handle rather than a
+	 * pointer), and files are only portable between machines of the same endianness. Not thread safe: queries
+	 * update the cache.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam Payload The data stored with each point.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 * @tparam PageEntries Entries per page, the unit in which extents are allocated.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename Payload,
+	          typename QuantizedCoordinateIntegerType = int64_t, size_t PageEntries = 64>
+	class DiskLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+		static_assert(std::is_trivially_copyable<Payload>::value, "Payload is stored as raw bytes.");
+		static_assert(PageEntries > 0, "Pages must hold at least one entry.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		struct Entry {
+			CoordinateArray coordinates;
+			Payload         payload;
+		};
+
+		/**
+		 * @brief Opens the index stored at path, or creates an empty one.
+		 *
+		 * @param path The file holding the index.
+		 * @param cache_cells The most cells kept in memory at once.
+		 * @throws std::system_error if the file cannot be read, or holds an index of a different type.
+		 */
+		explicit DiskLocationHash(const std::string & path, size_t cache_cells = 4096)
+		    : file_(path)
+		    , cache_capacity_(std::max<size_t>(1, cache_cells))
+		{
+			if (file_.size() != 0) {
+				load_directory();
+			}
+		}
+
+		~DiskLocationHash()
+		{
+			try {
+				flush();
+			} catch (...) {
+				// Destructors must not throw. Call flush() first to see write errors.
+			}
+		}
+
+		DiskLocationHash(const DiskLocationHash &)             = delete;
+		DiskLocationHash & operator=(const DiskLocationHash &) = delete;
+
+		void add(const Payload & payload, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			auto &                        cell = load(key);
+			cell.entries.push_back(Entry{coordinates, payload});
+			cell.dirty = true;
+			++directory_[key].count;
+			++size_;
+			changed_ = true;
+		}
+
+		/**
+		 * @brief Removes the first entry with this payload from the bucket containing coordinates.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(const Payload & payload, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			const auto                    location = directory_.find(key);
+			if (location == directory_.end()) {
+				return false;
+			}
+			auto &     cell = load(key);
+			const auto it   = std::find_if(cell.entries.begin(), cell.entries.end(),
+			                               [&](const Entry & entry) { return entry.payload == payload; });
+			if (it == cell.entries.end()) {
+				return false;
+			}
+			cell.entries.erase(it);
+			--size_;
+			changed_ = true;
+			if (cell.entries.empty()) {
+				// nothing left to write back; the extent is free for other cells
+				release(location->second.extent);
+				directory_.erase(location);
+				recency_.erase(cell.recency);
+				cache_.erase(key);
+			} else {
+				cell.dirty = true;
+				--location->second.count;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Moves an entry. Unlike LocationHash::move, a move within a bucket updates the stored coordinates.
+		 *
+		 * @return True if the entry was found and moved.
+		 */
+		bool move(const Payload & payload, const CoordinateArray & old_coordinates,
+		          const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			if (old_key == QuantizedCoordinateType(new_coordinates)) {
+				if (directory_.find(old_key) == directory_.end()) {
+					return false;
+				}
+				auto & cell = load(old_key);
+				for (auto & entry : cell.entries) {
+					if (entry.payload == payload) {
+						entry.coordinates = new_coordinates;
+						cell.dirty        = true;
+						changed_          = true;
+						return true;
+					}
+				}
+				return false;
+			}
+			if (!remove(payload, old_coordinates)) {
+				return false;
+			}
+			add(payload, new_coordinates);
+			return true;
+		}
+
+		/**
+		 * @brief The entries in the bucket containing coordinates. The reference is valid until the next call
+		 * that may load another cell.
+		 */
+		const std::vector<Entry> & query(const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			if (directory_.find(key) == directory_.end()) {
+				static const std::vector<Entry> empty_bucket;
+				return empty_bucket;
+			}
+			return load(key).entries;
+		}
+
+		/**
+		 * @brief Visits every occupied cell in the box as visitor(key, entries), after prefetching the cells that
+		 * are not cached. Cells are visited in key order.
+		 */
+		template <typename Visitor>
+		void for_each_cell_within_range(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds,
+		                                Visitor && visitor)
+		{
+			std::vector<QuantizedCoordinateType> keys;
+			for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+			                                           QuantizedCoordinateIntegerType>(
+			    lower_bounds, upper_bounds, [&](const QuantizedCoordinateType & key) {
+				    if (directory_.find(key) != directory_.end()) {
+					    keys.push_back(key);
+				    }
+			    });
+			std::sort(keys.begin(), keys.end());
+
+			// Prefetch at most a cache's worth at a time, so a large query cannot evict its own cells.
+			for (size_t first = 0; first < keys.size(); first += cache_capacity_) {
+				const size_t last = std::min(keys.size(), first + cache_capacity_);
+				prefetch(keys.data() + first, keys.data() + last);
+				for (size_t i = first; i < last; ++i) {
+					visitor(keys[i], static_cast<const std::vector<Entry> &>(load(keys[i]).entries));
+				}
+			}
+		}
+
+		/**
+		 * @brief Writes every dirty cell and the directory, then syncs the file. Does nothing if nothing changed
+		 * since the last flush.
+		 */
+		void flush()
+		{
+			if (!changed_) {
+				return;
+			}
+			for (auto & [key, cell] : cache_) {
+				write_back(key, cell);
+			}
+			write_directory();
+			changed_ = false;
+		}
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		size_t cell_count() const { return directory_.size(); }
+
+		size_t cached_cell_count() const { return cache_.size(); }
+
+		const DiskCacheStatistics & statistics() const { return statistics_; }
+
+	  private:
+		static constexpr uint32_t file_version = 2;
+		static constexpr size_t   page_bytes   = PageEntries * sizeof(Entry);
+		static constexpr uint64_t no_extent    = ~uint64_t{0};
+
+		struct FileHeader {
+			char     magic[8];
+			uint32_t version;
+			uint32_t dimensions;
+			uint64_t precision;
+			uint64_t coordinate_bytes;
+			uint64_t entry_bytes;
+			uint64_t page_entries;
+			uint64_t page_count;
+			uint64_t directory_page;
+			uint64_t cell_count;
+			uint64_t free_extent_count;
+		};
+
+		struct Extent {
+			uint64_t first_page = no_extent;
+			uint64_t pages      = 0;
+		};
+
+		struct CellLocation {
+			Extent   extent;
+			uint64_t count  = 0; // entries, including changes not yet written
+			uint64_t stored = 0; // entries in the file
+		};
+
+		struct DirectoryRecord {
+			std::array<QuantizedCoordinateIntegerType, Dimensions> key;
+			uint64_t                                               first_page;
+			uint64_t                                               pages;
+			uint64_t                                               count;
+		};
+
+		struct CachedCell {
+			std::vector<Entry>                                    entries;
+			bool                                                  dirty = false;
+			typename std::list<QuantizedCoordinateType>::iterator recency;
+		};
+
+		static uint64_t page_offset(uint64_t page) { return sizeof(FileHeader) + page * page_bytes; }
+
+		static uint64_t pages_for(uint64_t entries) { return (entries + PageEntries - 1) / PageEntries; }
+
+		static uint64_t directory_bytes(uint64_t cells, uint64_t free_extents)
+		{
+			return cells * sizeof(DirectoryRecord) + free_extents * sizeof(Extent);
+		}
+
+		FileHeader expected_header() const
+		{
+			FileHeader header{};
+			std::memcpy(header.magic, "LOCHASHD", sizeof(header.magic));
+			header.version          = file_version;
+			header.dimensions       = static_cast<uint32_t>(Dimensions);
+			header.precision        = Precision;
+			header.coordinate_bytes = sizeof(CoordinateType);
+			header.entry_bytes      = sizeof(Entry);
+			header.page_entries     = PageEntries;
+			return header;
+		}
+
+		void load_directory()
+		{
+			FileHeader header;
+			file_.read(0, &header, sizeof(header));
+			const FileHeader expected = expected_header();
+			if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+			    header.version != expected.version || header.dimensions != expected.dimensions ||
+			    header.precision != expected.precision || header.coordinate_bytes != expected.coordinate_bytes ||
+			    header.entry_bytes != expected.entry_bytes || header.page_entries != expected.page_entries) {
+				throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+				                        "file does not hold a matching DiskLocationHash");
+			}
+
+			// Counts that do not fit in the file would make the reads below throw, but only after allocating for them.
+			page_count_ = header.page_count;
+			if (header.cell_count > file_.size() / sizeof(DirectoryRecord) ||
+			    header.free_extent_count > file_.size() / sizeof(Extent)) {
+				throw_corrupt();
+			}
+			const uint64_t bytes = directory_bytes(header.cell_count, header.free_extent_count);
+			directory_extent_    = Extent{header.directory_page, (bytes + page_bytes - 1) / page_bytes};
+			if (!within_pages(directory_extent_) || header.directory_page > file_.size() / page_bytes ||
+			    page_offset(header.directory_page) + bytes > file_.size()) {
+				throw_corrupt();
+			}
+
+			std::vector<DirectoryRecord> records(header.cell_count);
+			std::vector<Extent>          free_extents(header.free_extent_count);
+			uint64_t                     offset = page_offset(header.directory_page);
+			if (!records.empty()) {
+				file_.read(offset, records.data(), records.size() * sizeof(DirectoryRecord));
+				offset += records.size() * sizeof(DirectoryRecord);
+			}
+			if (!free_extents.empty()) {
+				file_.read(offset, free_extents.data(), free_extents.size() * sizeof(Extent));
+			}
+
+			for (const auto & record : records) {
+				const Extent extent{record.first_page, record.pages};
+				if (record.count == 0 || record.pages < pages_for(record.count) || !within_pages(extent)) {
+					throw_corrupt();
+				}
+				QuantizedCoordinateType key;
+				key.quantized_  = record.key;
+				directory_[key] = CellLocation{extent, record.count, record.count};
+				size_ += record.count;
+			}
+			for (const auto & extent : free_extents) {
+				if (extent.pages == 0 || !within_pages(extent)) {
+					throw_corrupt();
+				}
+				add_free_extent(free_extents_, extent);
+			}
+		}
+
+		bool within_pages(const Extent & extent) const
+		{
+			return extent.first_page <= page_count_ && extent.pages <= page_count_ - extent.first_page;
+		}
+
+		[[noreturn]] static void throw_corrupt()
+		{
+			throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+			                        "file holds a corrupt DiskLocationHash directory");
+		}
+
+		// Writes the directory to pages the one in the file does not use, then the header that points at it. Until
+		// the header is written, a crash leaves the previous flush intact. Only then do the old directory's pages and
+		// the extents released since become free.
+		void write_directory()
+		{
+			// Taking the pages can remove a free extent but not add one, and the released extents and the old
+			// directory's pages add at most one each, so this bounds the size of the free list written.
+			const uint64_t largest =
+			    directory_bytes(directory_.size(), free_extents_.size() + released_extents_.size() + 1);
+			const Extent extent = allocate((largest + page_bytes - 1) / page_bytes);
+
+			std::vector<Extent> free_extents = free_extents_;
+			for (const auto & released : released_extents_) {
+				add_free_extent(free_extents, released);
+			}
+			add_free_extent(free_extents, directory_extent_);
+
+			std::vector<DirectoryRecord> records;
+			records.reserve(directory_.size());
+			for (const auto & [key, location] : directory_) {
+				records.push_back(DirectoryRecord{key.quantized_, location.extent.first_page, location.extent.pages,
+				                                  location.stored});
+			}
+
+			uint64_t offset = page_offset(extent.first_page);
+			if (!records.empty()) {
+				file_.write(offset, records.data(), records.size() * sizeof(DirectoryRecord));
+				offset += records.size() * sizeof(DirectoryRecord);
+			}
+			if (!free_extents.empty()) {
+				file_.write(offset, free_extents.data(), free_extents.size() * sizeof(Extent));
+			}
+			file_.sync();
+
+			FileHeader header        = expected_header();
+			header.page_count        = page_count_;
+			header.directory_page    = extent.first_page;
+			header.cell_count        = directory_.size();
+			header.free_extent_count = free_extents.size();
+			file_.write(0, &header, sizeof(header));
+			file_.sync();
+
+			free_extents_     = std::move(free_extents);
+			directory_extent_ = extent;
+			released_extents_.clear();
+		}
+
+		// First fit from the free extents, else new pages at the end of the file.
+		Extent allocate(uint64_t pages)
+		{
+			for (auto it = free_extents_.begin(); it != free_extents_.end(); ++it) {
+				if (it->pages >= pages) {
+					const Extent extent{it->first_page, pages};
+					it->first_page += pages;
+					it->pages -= pages;
+					if (it->pages == 0) {
+						free_extents_.erase(it);
+					}
+					return extent;
+				}
+			}
+			const Extent extent{page_count_, pages};
+			page_count_ += pages;
+			return extent;
+		}
+
+		// The directory in the file may still point at the extent, so it is only reused after the next flush.
+		void release(Extent & extent)
+		{
+			add_free_extent(released_extents_, extent);
+			extent = Extent{};
+		}
+
+		// Adds an extent to a list kept in page order, merging it with the extents next to it.
+		static void add_free_extent(std::vector<Extent> & extents, const Extent & extent)
+		{
+			if (extent.pages == 0) {
+				return;
+			}
+			const auto before = [](const Extent & a, const Extent & b) { return a.first_page < b.first_page; };
+			auto       next   = std::lower_bound(extents.begin(), extents.end(), extent, before);
+			if (next != extents.begin()) {
+				auto previous = std::prev(next);
+				if (previous->first_page + previous->pages == extent.first_page) {
+					previous->pages += extent.pages;
+					if (next != extents.end() && previous->first_page + previous->pages == next->first_page) {
+						previous->pages += next->pages;
+						extents.erase(next);
+					}
+					return;
+				}
+			}
+			if (next != extents.end() && extent.first_page + extent.pages == next->first_page) {
+				next->first_page = extent.first_page;
+				next->pages += extent.pages;
+				return;
+			}
+			extents.insert(next, extent);
+		}
+
+		void write_back(const QuantizedCoordinateType & key, CachedCell & cell)
+		{
+			if (!cell.dirty) {
+				return;
+			}
+			// cells are dropped as soon as they empty, so a cached cell always has entries
+			auto &   location = directory_.find(key)->second;
+			Extent & extent   = location.extent;
+			if (extent.pages < pages_for(cell.entries.size())) {
+				release(extent);
+				extent = allocate(pages_for(cell.entries.size()));
+			}
+			const size_t bytes = cell.entries.size() * sizeof(Entry);
+			file_.write(page_offset(extent.first_page), cell.entries.data(), bytes);
+			location.stored = cell.entries.size();
+			cell.dirty      = false;
+			++statistics_.writes;
+			statistics_.bytes_written += bytes;
+		}
+
+		void touch(CachedCell & cell) { recency_.splice(recency_.begin(), recency_, cell.recency); }
+
+		// Makes room for one more cell.
+		void evict_for_one()
+		{
+			while (cache_.size() >= cache_capacity_) {
+				const auto victim = cache_.find(recency_.back());
+				write_back(victim->first, victim->second);
+				recency_.pop_back();
+				cache_.erase(victim);
+			}
+		}
+
+		CachedCell & insert(const QuantizedCoordinateType & key, std::vector<Entry> && entries)
+		{
+			evict_for_one();
+			recency_.push_front(key);
+			CachedCell & cell = cache_[key];
+			cell.entries      = std::move(entries);
+			cell.recency      = recency_.begin();
+			return cell;
+		}
+
+		// The cached cell for key, read from the file if needed, or created empty if the key is new.
+		CachedCell & load(const QuantizedCoordinateType & key)
+		{
+			const auto cached = cache_.find(key);
+			if (cached != cache_.end()) {
+				++statistics_.hits;
+				touch(cached->second);
+				return cached->second;
+			}
+
+			std::vector<Entry> entries;
+			const auto         location = directory_.find(key);
+			if (location != directory_.end() && location->second.stored != 0) {
+				entries.resize(location->second.stored);
+				read_entries(location->second.extent, entries.data(), entries.size());
+				++statistics_.misses;
+			}
+			return insert(key, std::move(entries));
+		}
+
+		void read_entries(const Extent & extent, Entry * entries, size_t count)
+		{
+			const size_t bytes = count * sizeof(Entry);
+			file_.read(page_offset(extent.first_page), entries, bytes);
+			++statistics_.reads;
+			statistics_.bytes_read += bytes;
+		}
+
+		// Loads the uncached cells among [first, last) in file order, one read per run of adjacent extents.
+		void prefetch(const QuantizedCoordinateType * first, const QuantizedCoordinateType * last)
+		{
+			std::vector<std::pair<Extent, QuantizedCoordinateType>> missing;
+			for (auto key = first; key != last; ++key) {
+				const auto cached = cache_.find(*key);
+				if (cached != cache_.end()) {
+					touch(cached->second); // so loading the rest does not evict it
+				} else {
+					missing.emplace_back(directory_.find(*key)->second.extent, *key);
+				}
+			}
+			std::sort(missing.begin(), missing.end(),
+			          [](const auto & a, const auto & b) { return a.first.first_page < b.first.first_page; });
+
+			std::vector<Entry> run;
+			for (size_t begin = 0; begin < missing.size();) {
+				const uint64_t run_start = missing[begin].first.first_page;
+				size_t         end       = begin + 1;
+				while (end < missing.size() && missing[end - 1].first.first_page + missing[end - 1].first.pages ==
+				                                   missing[end].first.first_page) {
+					++end;
+				}
+
+				// one read from the start of the first extent to the last entry of the final one
+				const auto & last_extent = missing[end - 1].first;
+				run.resize(static_cast<size_t>((last_extent.first_page - run_start) * PageEntries +
+				                               directory_.find(missing[end - 1].second)->second.stored));
+				read_entries(missing[begin].first, run.data(), run.size());
+
+				for (size_t i = begin; i < end; ++i) {
+					const auto & [extent, key] = missing[i];
+					const auto offset          = static_cast<ptrdiff_t>((extent.first_page - run_start) * PageEntries);
+					const auto stored          = static_cast<ptrdiff_t>(directory_.find(key)->second.stored);
+					insert(key, std::vector<Entry>(run.begin() + offset, run.begin() + offset + stored));
+					++statistics_.misses;
+				}
+				begin = end;
+			}
+		}
+
+		detail::PagedFile                                         file_;
+		size_t                                                    cache_capacity_;
+		std::unordered_map<QuantizedCoordinateType, CellLocation> directory_;
+		std::unordered_map<QuantizedCoordinateType, CachedCell>   cache_;
+		std::list<QuantizedCoordinateType>                        recency_; // most recently used first
+		std::vector<Extent>                                       free_extents_;     // in page order
+		std::vector<Extent>                                       released_extents_; // free after the next flush
+		Extent                                                    directory_extent_; // of the directory in the file
+		uint64_t                                                  page_count_ = 0;
+		size_t                                                    size_       = 0;
+		bool                                                      changed_    = false; // since the last flush
+		DiskCacheStatistics                                       statistics_;
+	};
+
+	/**
+	 * Query entries within a bounding box of a DiskLocationHash. The cells the box touches are prefetched first.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam Payload The data stored with each point.
+	 * @param locationHash The DiskLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives copies of the entries within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename Payload,
+	          typename QuantizedCoordinateIntegerType, size_t PageEntries>
+	void query_bounding_box(
+	    DiskLocationHash<Precision, CoordinateType, Dimensions, Payload, QuantizedCoordinateIntegerType, PageEntries> &
+	        locationHash,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds,
+	    std::vector<typename DiskLocationHash<Precision, CoordinateType, Dimensions, Payload,
+	                                          QuantizedCoordinateIntegerType, PageEntries>::Entry> & result)
+	{
+		result.clear();
+		locationHash.for_each_cell_within_range(lower_bounds, upper_bounds, [&](const auto &, const auto & entries) {
+			for (const auto & entry : entries) {
+				if (detail::within_bounds(entry.coordinates, lower_bounds, upper_bounds)) {
+					result.push_back(entry);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Query entries within a distance of a point in a DiskLocationHash. The cells the search touches are
+	 * prefetched first.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam Payload The data stored with each point.
+	 * @param locationHash The DiskLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives copies of the entries within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename Payload,
+	          typename QuantizedCoordinateIntegerType, size_t PageEntries>
+	void query_within_distance(
+	    DiskLocationHash<Precision, CoordinateType, Dimensions, Payload, QuantizedCoordinateIntegerType, PageEntries> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	    std::vector<typename DiskLocationHash<Precision, CoordinateType, Dimensions, Payload,
+	                                          QuantizedCoordinateIntegerType, PageEntries>::Entry> & result)
+	{
+		result.clear();
+		const CoordinateType radius_squared = radius * radius;
+
+		std::array<CoordinateType, Dimensions> lower_bounds;
+		std::array<CoordinateType, Dimensions> upper_bounds;
+		for (size_t i = 0; i < Dimensions; ++i) {
+			lower_bounds[i] = center[i] - radius;
+			upper_bounds[i] = center[i] + radius;
+		}
+
+		locationHash.for_each_cell_within_range(lower_bounds, upper_bounds, [&](const auto &, const auto & entries) {
+			for (const auto & entry : entries) {
+				if (calculate_distance_squared<CoordinateType, Dimensions>(entry.coordinates, center) <=
+				    radius_squared) {
+					result.push_back(entry);
+				}
+			}
+		});
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_disk_hpp
@@ -0,0 +1,444 @@
+#ifndef _INCLUDED_location_hash_fixed_hpp
+#define _INCLUDED_location_hash_fixed_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Outcome of a FixedLocationHash update.
+	 */
+	enum class FixedCapacityResult {
+		ok,                       // the update was applied
+		not_found,                // no matching entry at the given coordinates
+		cell_capacity_exhausted,  // the update needs a new cell and all MaxCells are in use; nothing changed
+		entry_capacity_exhausted, // all MaxEntries are in use; nothing changed
+	};
+
+	/**
+	 * @brief A LocationHash that never allocates, for threads where heap use is forbidden.
+	 *
+	 * All storage is inline, sized by MaxCells and MaxEntries at compile time, so the object can live in static
+	 * storage, on a thread's stack, or in any buffer the caller constructs it in. Running out of cells or entries
+	 * is reported by the return value and leaves the index unchanged.
+	 *
+	 * Cells live in an open-addressed table, at least twice MaxCells in size, with linear probing and
+	 * backward-shift deletion, so there are no tombstones and probe lengths stay short under churn. Entries come
+	 * from a pool with a free list and are chained per cell in insertion order. Every operation is bounded by the
+	 * table size plus the length of the buckets it touches.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated objects.
+	 * @tparam MaxCells The most occupied buckets at once.
+	 * @tparam MaxEntries The most entries at once.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t MaxCells,
+	          size_t MaxEntries, typename QuantizedCoordinateIntegerType = int64_t>
+	class FixedLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+		static_assert(MaxCells > 0 && MaxEntries > 0, "FixedLocationHash needs room for at least one entry.");
+
+		static constexpr uint32_t npos       = ~uint32_t{0};
+		static constexpr size_t   table_size = std::bit_ceil(MaxCells * 2);
+		static_assert(MaxEntries < npos, "MaxEntries must fit a 32 bit index.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		static constexpr size_t max_cells       = MaxCells;
+		static constexpr size_t max_entries     = MaxEntries;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using Entry                             = std::pair<CoordinateArray, ObjectType *>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief The entries of one bucket, in insertion order. Iterates as a range of Entry.
+		 */
+		class BucketView
+		{
+		  public:
+			class iterator
+			{
+			  public:
+				using iterator_category = std::forward_iterator_tag;
+				using value_type        = Entry;
+				using difference_type   = std::ptrdiff_t;
+				using pointer           = const Entry *;
+				using reference         = const Entry &;
+
+				iterator() = default;
+
+				reference operator*() const { return owner_->entries_[index_]; }
+				pointer   operator->() const { return &owner_->entries_[index_]; }
+
+				iterator & operator++()
+				{
+					index_ = owner_->next_[index_];
+					return *this;
+				}
+
+				iterator operator++(int)
+				{
+					iterator previous = *this;
+					++*this;
+					return previous;
+				}
+
+				bool operator==(const iterator & other) const { return index_ == other.index_; }
+				bool operator!=(const iterator & other) const { return index_ != other.index_; }
+
+			  private:
+				friend class BucketView;
+				iterator(const FixedLocationHash * owner, uint32_t index)
+				    : owner_(owner)
+				    , index_(index)
+				{
+				}
+
+				const FixedLocationHash * owner_ = nullptr;
+				uint32_t                  index_ = npos;
+			};
+
+			BucketView() = default;
+
+			iterator begin() const { return iterator(owner_, head_); }
+			iterator end() const { return iterator(owner_, npos); }
+			size_t   size() const { return count_; }
+			bool     empty() const { return count_ == 0; }
+
+		  private:
+			friend class FixedLocationHash;
+			BucketView(const FixedLocationHash * owner, uint32_t head, uint32_t count)
+			    : owner_(owner)
+			    , head_(head)
+			    , count_(count)
+			{
+			}
+
+			const FixedLocationHash * owner_ = nullptr;
+			uint32_t                  head_  = npos;
+			uint32_t                  count_ = 0;
+		};
+
+		FixedLocationHash() { clear(); }
+
+		/**
+		 * @brief Adds coordinates and an associated object to the appropriate bucket.
+		 *
+		 * @return ok, or which capacity ran out. The index is unchanged on failure.
+		 */
+		FixedCapacityResult add(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			if (free_ == npos) {
+				return FixedCapacityResult::entry_capacity_exhausted;
+			}
+			const QuantizedCoordinateType key(coordinates);
+			size_t                        slot = find_slot(key);
+			if (slots_[slot].count == 0) {
+				if (cell_count_ == MaxCells) {
+					return FixedCapacityResult::cell_capacity_exhausted;
+				}
+				occupy(slot, key);
+			}
+
+			const uint32_t entry = free_;
+			free_                = next_[entry];
+			entries_[entry]      = Entry(coordinates, object);
+			link(slots_[slot], entry);
+			++size_;
+			return FixedCapacityResult::ok;
+		}
+
+		/**
+		 * @brief Removes an object from the bucket containing coordinates.
+		 *
+		 * @return ok, or not_found if the object is not in that bucket.
+		 */
+		FixedCapacityResult remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const size_t slot = find_slot(QuantizedCoordinateType(coordinates));
+			if (slots_[slot].count == 0) {
+				return FixedCapacityResult::not_found;
+			}
+			const uint32_t entry = unlink(slots_[slot], object);
+			if (entry == npos) {
+				return FixedCapacityResult::not_found;
+			}
+			if (slots_[slot].count == 0) {
+				vacate(slot);
+			}
+			next_[entry] = free_;
+			free_        = entry;
+			--size_;
+			return FixedCapacityResult::ok;
+		}
+
+		/**
+		 * @brief Moves an object from one position to another. Unlike LocationHash::move, a move within a bucket
+		 * updates the stored coordinates, so queries see the new position.
+		 *
+		 * @return ok, not_found if the object is not in the bucket of old_coordinates, or
+		 * cell_capacity_exhausted if the new bucket is empty and no cell can be spared. The index is unchanged on
+		 * failure.
+		 */
+		FixedCapacityResult move(ObjectType * object, const CoordinateArray & old_coordinates,
+		                         const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			const QuantizedCoordinateType new_key(new_coordinates);
+			const size_t                  old_slot = find_slot(old_key);
+			if (slots_[old_slot].count == 0) {
+				return FixedCapacityResult::not_found;
+			}
+
+			if (old_key == new_key) {
+				for (uint32_t entry = slots_[old_slot].head; entry != npos; entry = next_[entry]) {
+					if (entries_[entry].second == object) {
+						entries_[entry].first = new_coordinates;
+						return FixedCapacityResult::ok;
+					}
+				}
+				return FixedCapacityResult::not_found;
+			}
+
+			// Check everything that can fail before changing anything.
+			bool found = false;
+			for (uint32_t entry = slots_[old_slot].head; entry != npos && !found; entry = next_[entry]) {
+				found = entries_[entry].second == object;
+			}
+			if (!found) {
+				return FixedCapacityResult::not_found;
+			}
+			const bool frees_cell = slots_[old_slot].count == 1;
+			if (slots_[find_slot(new_key)].count == 0 && cell_count_ == MaxCells && !frees_cell) {
+				return FixedCapacityResult::cell_capacity_exhausted;
+			}
+
+			const uint32_t entry = unlink(slots_[old_slot], object);
+			if (frees_cell) {
+				vacate(old_slot); // may shift other cells, so the new slot is found afterwards
+			}
+			const size_t new_slot = find_slot(new_key);
+			if (slots_[new_slot].count == 0) {
+				occupy(new_slot, new_key);
+			}
+			entries_[entry].first = new_coordinates;
+			link(slots_[new_slot], entry);
+			return FixedCapacityResult::ok;
+		}
+
+		/**
+		 * @brief The entries in the bucket containing coordinates.
+		 */
+		BucketView query(const CoordinateArray & coordinates) const
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief The entries in the bucket with the given key, empty if the bucket is not occupied.
+		 */
+		BucketView find(const QuantizedCoordinateType & key) const
+		{
+			const Slot & slot = slots_[find_slot(key)];
+			return slot.count == 0 ? BucketView() : BucketView(this, slot.head, slot.count);
+		}
+
+		/**
+		 * @brief Visits every occupied bucket as visitor(key, bucket), in no particular order.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor) const
+		{
+			for (const Slot & slot : slots_) {
+				if (slot.count != 0) {
+					visitor(slot.key, BucketView(this, slot.head, slot.count));
+				}
+			}
+		}
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		size_t cell_count() const { return cell_count_; }
+
+		/**
+		 * @brief Removes everything. Bounded by MaxCells and MaxEntries.
+		 */
+		void clear()
+		{
+			for (Slot & slot : slots_) {
+				slot.count = 0;
+			}
+			for (uint32_t i = 0; i < MaxEntries; ++i) {
+				next_[i] = i + 1 < MaxEntries ? i + 1 : npos;
+			}
+			free_       = 0;
+			size_       = 0;
+			cell_count_ = 0;
+		}
+
+	  private:
+		struct Slot {
+			QuantizedCoordinateType key;
+			uint32_t                head  = npos;
+			uint32_t                tail  = npos;
+			uint32_t                count = 0; // 0 marks an empty slot
+		};
+
+		static size_t home_slot(const QuantizedCoordinateType & key)
+		{
+			return std::hash<QuantizedCoordinateType>()(key) & (table_size - 1);
+		}
+
+		// The slot holding key, or the empty slot where it would go.
+		size_t find_slot(const QuantizedCoordinateType & key) const
+		{
+			size_t slot = home_slot(key);
+			while (slots_[slot].count != 0 && !(slots_[slot].key == key)) {
+				slot = (slot + 1) & (table_size - 1);
+			}
+			return slot;
+		}
+
+		void occupy(size_t slot, const QuantizedCoordinateType & key)
+		{
+			slots_[slot] = Slot{key, npos, npos, 0};
+			++cell_count_;
+		}
+
+		// Empties a slot and shifts later members of its probe run back, so lookups never cross a gap.
+		void vacate(size_t slot)
+		{
+			size_t hole = slot;
+			for (size_t next = (hole + 1) & (table_size - 1); slots_[next].count != 0;
+			     next        = (next + 1) & (table_size - 1)) {
+				// distance from a slot's home to where it sits, and to the hole, along the probe direction
+				const size_t home = home_slot(slots_[next].key);
+				if (((hole - home) & (table_size - 1)) < ((next - home) & (table_size - 1))) {
+					slots_[hole] = slots_[next];
+					hole         = next;
+				}
+			}
+			slots_[hole].count = 0;
+			--cell_count_;
+		}
+
+		void link(Slot & slot, uint32_t entry)
+		{
+			next_[entry] = npos;
+			if (slot.count == 0) {
+				slot.head = entry;
+			} else {
+				next_[slot.tail] = entry;
+			}
+			slot.tail = entry;
+			++slot.count;
+		}
+
+		// Unlinks the object's entry from the bucket and returns it, or npos if it is not there.
+		uint32_t unlink(Slot & slot, ObjectType * object)
+		{
+			uint32_t previous = npos;
+			for (uint32_t entry = slot.head; entry != npos; previous = entry, entry = next_[entry]) {
+				if (entries_[entry].second == object) {
+					(previous == npos ? slot.head : next_[previous]) = next_[entry];
+					if (slot.tail == entry) {
+						slot.tail = previous;
+					}
+					--slot.count;
+					return entry;
+				}
+			}
+			return npos;
+		}
+
+		std::array<Slot, table_size>     slots_;
+		std::array<Entry, MaxEntries>    entries_;
+		std::array<uint32_t, MaxEntries> next_; // next entry in a bucket, or in the free list
+		uint32_t                         free_       = 0;
+		size_t                           size_       = 0;
+		size_t                           cell_count_ = 0;
+	};
+
+	/**
+	 * Query objects within a bounding box of a FixedLocationHash. Does not allocate once result has the capacity
+	 * for the answer.
+	 *
+	 * @param locationHash The FixedLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t MaxCells,
+	          size_t MaxEntries, typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(const FixedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, MaxCells,
+	                                                MaxEntries, QuantizedCoordinateIntegerType> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &                      lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &                      upper_bounds,
+	                        std::vector<ObjectType *> &                                         result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a FixedLocationHash. Does not allocate once result has the
+	 * capacity for the answer.
+	 *
+	 * @param locationHash The FixedLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t MaxCells,
+	          size_t MaxEntries, typename QuantizedCoordinateIntegerType>
+	void query_within_distance(const FixedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, MaxCells,
+	                                                   MaxEntries, QuantizedCoordinateIntegerType> & locationHash,
+	                           const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                           std::vector<ObjectType *> & result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a FixedLocationHash, nearest first. See query_nearest for
+	 * LocationHash. The search keeps its best candidates so far in candidates, so it does not allocate once result
+	 * and candidates each have the capacity for k.
+	 *
+	 * @param locationHash The FixedLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @param result Receives pointers to the nearest objects, ordered nearest first.
+	 * @param candidates Working storage for the search.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t MaxCells,
+	          size_t MaxEntries, typename QuantizedCoordinateIntegerType>
+	void query_nearest(const FixedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, MaxCells, MaxEntries,
+	                                           QuantizedCoordinateIntegerType> & locationHash,
+	                   const std::array<CoordinateType, Dimensions> & center, size_t k,
+	                   std::vector<ObjectType *> & result, NearestCandidates<CoordinateType, ObjectType> & candidates)
+	{
+		detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) { locationHash.for_each_bucket(visitor); }, locationHash.cell_count(), center, k,
+		    result, candidates);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_fixed_hpp
@@ -0,0 +1,344 @@
+#ifndef _INCLUDED_location_hash_hotspots_hpp
+#define _INCLUDED_location_hash_hotspots_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Kinds of activity a HotspotTracker counts.
+	 */
+	enum class Activity : size_t { add, move, query };
+
+	/// Number of Activity kinds.
+	constexpr size_t activity_count = 3;
+
+	/**
+	 * @brief Exponentially decaying per-cell activity counters, for finding hot regions by add, move and query rate
+	 * rather than by object count.
+	 *
+	 * Time is measured in ticks that the caller advances, typically once per frame or simulation step, so the decay
+	 * is deterministic. Each cell stores its counters and the tick they were last brought up to date; decay is
+	 * applied lazily when a cell is touched or read, so advancing time costs nothing and recording an event is one
+	 * hash lookup. A counter loses half its value every half_life ticks, so a steady rate of r events per tick
+	 * settles at about r / (1 - 0.5^(1 / half_life)).
+	 *
+	 * Cells are tracked at their own Precision, independent of any LocationHash. A coarser precision than the index
+	 * gives per-region numbers that suit rebalancing; the same precision gives per-bucket numbers for tuning
+	 * subdivision.
+	 *
+	 * @tparam Precision The size of a tracked cell. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the cell keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class HotspotTracker
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		using CoordinateArray = std::array<CoordinateType, Dimensions>;
+		using Key             = QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+		using ActivityArray   = std::array<double, activity_count>;
+
+		/**
+		 * @brief A cell and its decayed activity at the time top_hotspots was called.
+		 */
+		struct Hotspot {
+			Key           key; // lower corner of the cell; the cell spans Precision along each axis
+			ActivityArray activity;
+			double        score;
+		};
+
+		/**
+		 * @param half_life Ticks for a counter to lose half its value. Must be positive.
+		 */
+		explicit HotspotTracker(double half_life = 60.0)
+		    : decay_per_tick_(std::pow(0.5, 1.0 / half_life))
+		{
+		}
+
+		/**
+		 * @brief Advances time. Counters decay lazily, so this is constant time.
+		 */
+		void advance(uint64_t ticks = 1) { now_ += ticks; }
+
+		uint64_t now() const { return now_; }
+
+		void record_add(const CoordinateArray & coordinates) { record(Key(coordinates), Activity::add); }
+
+		/**
+		 * @brief Counts a move against the cell the object moved into.
+		 */
+		void record_move(const CoordinateArray & new_coordinates) { record(Key(new_coordinates), Activity::move); }
+
+		/**
+		 * @brief Counts one query against the cells it found occupied. run(count) performs the query and calls
+		 * count(coordinates) with the lower corner of each occupied bucket it reads. A cell is counted once however
+		 * many of its buckets the query reads, and cells the query overlaps but finds empty are not tracked, so a large
+		 * query box does not fill the tracker with cold cells. A tracker finer than the index counts each bucket
+		 * against the cell at its lower corner.
+		 */
+		template <typename Run>
+		void record_query(Run && run)
+		{
+			++query_serial_;
+			run([&](const CoordinateArray & coordinates) {
+				Cell & cell = cells_[Key(coordinates)];
+				if (cell.last_query != query_serial_) {
+					cell.last_query = query_serial_;
+					bring_up_to_date(cell);
+					cell.activity[static_cast<size_t>(Activity::query)] += 1.0;
+				}
+			});
+		}
+
+		/**
+		 * @brief Counts events of one kind against a cell, such as a batch of moves applied together.
+		 */
+		void record(const Key & key, Activity activity, double events = 1.0)
+		{
+			Cell & cell = cells_[key];
+			bring_up_to_date(cell);
+			cell.activity[static_cast<size_t>(activity)] += events;
+		}
+
+		/**
+		 * @brief Decayed activity of the cell containing coordinates; all zero if it was never recorded.
+		 */
+		ActivityArray activity(const CoordinateArray & coordinates) const
+		{
+			const auto it = cells_.find(Key(coordinates));
+			if (it == cells_.end()) {
+				return {};
+			}
+			return decayed(it->second);
+		}
+
+		/**
+		 * @brief The n cells with the highest weighted activity, hottest first. Ties are broken by key so the
+		 * ranking is deterministic.
+		 *
+		 * @param n How many cells to return at most.
+		 * @param weights Weight of each Activity in the score, in Activity order. Defaults to counting every
+		 * event equally.
+		 */
+		std::vector<Hotspot> top_hotspots(size_t n, const ActivityArray & weights = {1.0, 1.0, 1.0}) const
+		{
+			std::vector<Hotspot> hotspots;
+			hotspots.reserve(cells_.size());
+			for (const auto & [key, cell] : cells_) {
+				Hotspot hotspot{key, decayed(cell), 0.0};
+				for (size_t i = 0; i < activity_count; ++i) {
+					hotspot.score += weights[i] * hotspot.activity[i];
+				}
+				hotspots.push_back(hotspot);
+			}
+
+			const auto hotter = [](const Hotspot & a, const Hotspot & b) {
+				return a.score != b.score ? a.score > b.score : a.key < b.key;
+			};
+			n = std::min(n, hotspots.size());
+			std::partial_sort(hotspots.begin(), hotspots.begin() + static_cast<ptrdiff_t>(n), hotspots.end(), hotter);
+			hotspots.resize(n);
+			return hotspots;
+		}
+
+		/**
+		 * @brief Forgets cells whose total decayed activity has fallen below threshold, bounding memory to the
+		 * cells that are still warm. Call it occasionally, for instance every few half-lives.
+		 *
+		 * @return The number of cells forgotten.
+		 */
+		size_t prune(double threshold)
+		{
+			size_t pruned = 0;
+			for (auto it = cells_.begin(); it != cells_.end();) {
+				const auto values = decayed(it->second);
+				double     total  = 0.0;
+				for (const double value : values) {
+					total += value;
+				}
+				if (total < threshold) {
+					it = cells_.erase(it);
+					++pruned;
+				} else {
+					++it;
+				}
+			}
+			return pruned;
+		}
+
+		size_t cell_count() const { return cells_.size(); }
+
+		void clear() { cells_.clear(); }
+
+	  private:
+		struct Cell {
+			ActivityArray activity{};
+			uint64_t      updated    = 0;
+			uint64_t      last_query = 0; // query_serial_ of the last query counted here
+		};
+
+		double decay_since(uint64_t tick) const
+		{
+			return now_ == tick ? 1.0 : std::pow(decay_per_tick_, static_cast<double>(now_ - tick));
+		}
+
+		void bring_up_to_date(Cell & cell) const
+		{
+			if (cell.updated != now_) {
+				const double decay = decay_since(cell.updated);
+				for (auto & value : cell.activity) {
+					value *= decay;
+				}
+				cell.updated = now_;
+			}
+		}
+
+		ActivityArray decayed(const Cell & cell) const
+		{
+			Cell copy = cell;
+			bring_up_to_date(copy);
+			return copy.activity;
+		}
+
+		std::unordered_map<Key, Cell> cells_;
+		double                        decay_per_tick_;
+		uint64_t                      now_          = 0;
+		uint64_t                      query_serial_ = 0;
+	};
+
+	namespace detail
+	{
+		// Wraps an index's find so that every occupied bucket a query reads is passed to count by its lower corner.
+		template <typename CoordinateType, size_t Dimensions, typename Find, typename Count>
+		auto counting_find(Find && find, Count && count)
+		{
+			return [&find, &count](const auto & key) {
+				const auto bucket = find(key);
+				if (!bucket.empty()) {
+					std::array<CoordinateType, Dimensions> corner;
+					for (size_t i = 0; i < Dimensions; ++i) {
+						corner[i] = static_cast<CoordinateType>(key.quantized_[i]);
+					}
+					count(corner);
+				}
+				return bucket;
+			};
+		}
+	} // namespace detail
+
+	/**
+	 * Add an object to a LocationHash and count the add against the cell of hotspots that holds it.
+	 *
+	 * @param locationHash The LocationHash to add to.
+	 * @param object The object to add.
+	 * @param coordinates Where to add it.
+	 * @param hotspots The tracker that counts the add.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          size_t TrackerPrecision>
+	void tracked_add(LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                 ObjectType * object, const std::array<CoordinateType, Dimensions> & coordinates,
+	                 HotspotTracker<TrackerPrecision, CoordinateType, Dimensions> & hotspots)
+	{
+		locationHash.add(object, coordinates);
+		hotspots.record_add(coordinates);
+	}
+
+	/**
+	 * Move an object in a LocationHash and, if it was found, count the move against the cell of hotspots it moved
+	 * into. A move within one bucket leaves the index as it is but is still counted, as the object did move.
+	 *
+	 * @param locationHash The LocationHash to update.
+	 * @param object The object to move.
+	 * @param old_coordinates Where the object was.
+	 * @param new_coordinates Where the object is now.
+	 * @param hotspots The tracker that counts the move.
+	 * @return true if the object was found at old_coordinates, whether or not it changed bucket.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          size_t TrackerPrecision>
+	bool tracked_move(LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                  ObjectType * object, const std::array<CoordinateType, Dimensions> & old_coordinates,
+	                  const std::array<CoordinateType, Dimensions> &                 new_coordinates,
+	                  HotspotTracker<TrackerPrecision, CoordinateType, Dimensions> & hotspots)
+	{
+		using Key = typename LocationHash<Precision, CoordinateType, Dimensions, ObjectType>::QuantizedCoordinateType;
+
+		const Key old_key(old_coordinates);
+		if (old_key == Key(new_coordinates)) {
+			// LocationHash::move reports false for a move within one bucket, so look for the object instead
+			const auto bucket = locationHash.find(old_key);
+			if (std::none_of(bucket.begin(), bucket.end(), [&](const auto & entry) { return entry.second == object; })) {
+				return false;
+			}
+		} else if (!locationHash.move(object, old_coordinates, new_coordinates)) {
+			return false;
+		}
+		hotspots.record_move(new_coordinates);
+		return true;
+	}
+
+	/**
+	 * Query objects within a bounding box, like query_bounding_box, and count the query against the cells of
+	 * hotspots where it found occupied buckets.
+	 *
+	 * @param locationHash The LocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 * @param hotspots The tracker that counts the query.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          size_t TrackerPrecision>
+	void query_bounding_box(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &                          lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &                          upper_bounds,
+	                        std::vector<ObjectType *> &                                             result,
+	                        HotspotTracker<TrackerPrecision, CoordinateType, Dimensions> &          hotspots)
+	{
+		const auto find = [&](const auto & key) { return locationHash.find(key); };
+		hotspots.record_query([&](const auto & count) {
+			detail::query_bounding_box<Precision, int64_t>(
+			    detail::counting_find<CoordinateType, Dimensions>(find, count), lower_bounds, upper_bounds, result);
+		});
+	}
+
+	/**
+	 * Query objects within a distance of a point, like query_within_distance, and count the query against the
+	 * cells of hotspots where it found occupied buckets.
+	 *
+	 * @param locationHash The LocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 * @param hotspots The tracker that counts the query.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          size_t TrackerPrecision>
+	void query_within_distance(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                           const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                           std::vector<ObjectType *> &                                    result,
+	                           HotspotTracker<TrackerPrecision, CoordinateType, Dimensions> & hotspots)
+	{
+		const auto find = [&](const auto & key) { return locationHash.find(key); };
+		hotspots.record_query([&](const auto & count) {
+			detail::query_within_distance<Precision, int64_t>(
+			    detail::counting_find<CoordinateType, Dimensions>(find, count), center, radius, result);
+		});
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_hotspots_hpp
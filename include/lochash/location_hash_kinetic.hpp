@@ -0,0 +1,302 @@
+#ifndef _INCLUDED_location_hash_kinetic_hpp
+#define _INCLUDED_location_hash_kinetic_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief A location index for objects that move in straight lines. Each entry stores a position, a velocity
+	 * and the time they were measured, and is indexed in every cell it sweeps through during the next horizon
+	 * time units. Queries take a time and test the extrapolated positions, so an object is re-indexed only when
+	 * its velocity changes or its horizon runs out, not every tick. Stationary objects never expire.
+	 *
+	 * A query at time t is exact for entries with t between their reference time and the end of their horizon.
+	 * Call refresh(t) first to re-index the entries whose horizon has ended. Each entry is reported only from the
+	 * cell its extrapolated position falls in, so results have no duplicates even though entries span cells.
+	 *
+	 * A longer horizon means fewer refreshes but more cells per moving entry: about (speed * horizon / Precision
+	 * + 1) per axis.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates, velocities and times. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class KineticLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief The motion of an entry: it was at position at time, moving by velocity per time unit.
+		 */
+		struct Motion {
+			CoordinateArray position;
+			CoordinateArray velocity;
+			CoordinateType  time;
+
+			CoordinateArray position_at(CoordinateType when) const
+			{
+				CoordinateArray result;
+				for (size_t i = 0; i < Dimensions; ++i) {
+					result[i] = static_cast<CoordinateType>(position[i] + velocity[i] * (when - time));
+				}
+				return result;
+			}
+		};
+
+		/**
+		 * @param horizon How far ahead of its reference time each entry is indexed.
+		 */
+		explicit KineticLocationHash(CoordinateType horizon)
+		    : horizon_(horizon)
+		{
+		}
+
+		KineticLocationHash(const KineticLocationHash &)             = delete;
+		KineticLocationHash & operator=(const KineticLocationHash &) = delete;
+
+		/**
+		 * @brief Adds an object, or replaces its motion if it is already indexed. Call this when the object's
+		 * velocity changes; its position needs no updates while it keeps moving as predicted.
+		 */
+		void update(ObjectType * object, const CoordinateArray & position, const CoordinateArray & velocity,
+		            CoordinateType time)
+		{
+			auto [it, inserted] = records_.try_emplace(object);
+			Record & record     = it->second;
+			if (!inserted) {
+				unlink(record);
+			}
+			record.object = object;
+			record.motion = Motion{position, velocity, time};
+			link(record);
+		}
+
+		/**
+		 * @brief Removes an object.
+		 *
+		 * @return True if the object was indexed.
+		 */
+		bool remove(ObjectType * object)
+		{
+			const auto it = records_.find(object);
+			if (it == records_.end()) {
+				return false;
+			}
+			unlink(it->second);
+			records_.erase(it);
+			return true;
+		}
+
+		/**
+		 * @brief Re-indexes every entry whose horizon ended before now from its extrapolated position at now.
+		 *
+		 * @return The number of entries re-indexed.
+		 */
+		size_t refresh(CoordinateType now)
+		{
+			size_t refreshed = 0;
+			while (!expiries_.empty() && std::get<0>(expiries_.top()) < now) {
+				const auto [expiry, object, generation] = expiries_.top();
+				expiries_.pop();
+				const auto it = records_.find(object);
+				if (it == records_.end() || it->second.generation != generation) {
+					continue; // removed or updated since this expiry was queued
+				}
+				Record & record = it->second;
+				unlink(record);
+				record.motion = Motion{record.motion.position_at(now), record.motion.velocity, now};
+				link(record);
+				++refreshed;
+			}
+			return refreshed;
+		}
+
+		/**
+		 * @brief The motion of an object, or nullptr if it is not indexed.
+		 */
+		const Motion * motion(ObjectType * object) const
+		{
+			const auto it = records_.find(object);
+			return it != records_.end() ? &it->second.motion : nullptr;
+		}
+
+		/**
+		 * @brief Visits every object whose position at time lies within a box, as visitor(object, position).
+		 */
+		template <typename Visitor>
+		void for_each_within(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds,
+		                     CoordinateType time, Visitor && visitor) const
+		{
+			for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+			                                           QuantizedCoordinateIntegerType>(
+			    lower_bounds, upper_bounds, [&](const QuantizedCoordinateType & key) {
+				    const auto it = cells_.find(key);
+				    if (it == cells_.end()) {
+					    return;
+				    }
+				    for (const Record * record : it->second) {
+					    const auto position = record->motion.position_at(time);
+					    if (QuantizedCoordinateType(position) == key &&
+					        detail::within_bounds(position, lower_bounds, upper_bounds)) {
+						    visitor(record->object, position);
+					    }
+				    }
+			    });
+		}
+
+		CoordinateType horizon() const { return horizon_; }
+
+		size_t size() const { return records_.size(); }
+
+		bool empty() const { return records_.empty(); }
+
+		/**
+		 * @brief The number of occupied cells, counting every cell an entry sweeps through.
+		 */
+		size_t cell_count() const { return cells_.size(); }
+
+		void clear()
+		{
+			records_.clear();
+			cells_.clear();
+			expiries_ = ExpiryQueue();
+		}
+
+	  private:
+		struct Record {
+			ObjectType *    object = nullptr;
+			Motion          motion{};
+			CoordinateArray swept_lower{}; // box covering the positions from the reference time to the horizon
+			CoordinateArray swept_upper{};
+			uint64_t        generation = 0;
+		};
+
+		using Expiry      = std::tuple<CoordinateType, ObjectType *, uint64_t>;
+		using ExpiryQueue = std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>>;
+
+		template <typename Visitor>
+		static void for_each_swept_cell(const Record & record, Visitor && visitor)
+		{
+			for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+			                                           QuantizedCoordinateIntegerType>(record.swept_lower,
+			                                                                           record.swept_upper, visitor);
+		}
+
+		void link(Record & record)
+		{
+			const auto end    = record.motion.position_at(record.motion.time + horizon_);
+			bool       moving = false;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				record.swept_lower[i] = std::min(record.motion.position[i], end[i]);
+				record.swept_upper[i] = std::max(record.motion.position[i], end[i]);
+				moving                = moving || record.motion.velocity[i] != CoordinateType(0);
+			}
+			for_each_swept_cell(record, [&](const QuantizedCoordinateType & key) { cells_[key].push_back(&record); });
+
+			record.generation = ++generation_;
+			if (moving) {
+				expiries_.emplace(static_cast<CoordinateType>(record.motion.time + horizon_), record.object,
+				                  record.generation);
+			}
+		}
+
+		void unlink(const Record & record)
+		{
+			for_each_swept_cell(record, [&](const QuantizedCoordinateType & key) {
+				const auto it     = cells_.find(key);
+				auto &     bucket = it->second;
+				*std::find(bucket.begin(), bucket.end(), &record) = bucket.back();
+				bucket.pop_back();
+				if (bucket.empty()) {
+					cells_.erase(it);
+				}
+			});
+		}
+
+		CoordinateType                                                    horizon_;
+		std::unordered_map<ObjectType *, Record>                          records_;
+		std::unordered_map<QuantizedCoordinateType, std::vector<Record *>> cells_;
+		ExpiryQueue                                                       expiries_;
+		uint64_t                                                          generation_ = 0;
+	};
+
+	/**
+	 * Query objects whose position at a time lies within a bounding box.
+	 *
+	 * @param locationHash The KineticLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param time The time to evaluate positions at.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(
+	    const KineticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds, CoordinateType time,
+	    std::vector<ObjectType *> & result)
+	{
+		result.clear();
+		locationHash.for_each_within(lower_bounds, upper_bounds, time,
+		                             [&](ObjectType * object, const auto &) { result.push_back(object); });
+	}
+
+	/**
+	 * Query objects whose position at a time lies within a distance of a point.
+	 *
+	 * @param locationHash The KineticLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param time The time to evaluate positions at.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(
+	    const KineticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius, CoordinateType time,
+	    std::vector<ObjectType *> & result)
+	{
+		result.clear();
+		const CoordinateType radius_squared = radius * radius;
+
+		std::array<CoordinateType, Dimensions> lower_bounds;
+		std::array<CoordinateType, Dimensions> upper_bounds;
+		for (size_t i = 0; i < Dimensions; ++i) {
+			lower_bounds[i] = center[i] - radius;
+			upper_bounds[i] = center[i] + radius;
+		}
+
+		locationHash.for_each_within(lower_bounds, upper_bounds, time, [&](ObjectType * object, const auto & position) {
+			if (calculate_distance_squared<CoordinateType, Dimensions>(position, center) <= radius_squared) {
+				result.push_back(object);
+			}
+		});
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_kinetic_hpp
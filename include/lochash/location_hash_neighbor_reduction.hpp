@@ -0,0 +1,66 @@
+#ifndef _INCLUDED_location_hash_neighbor_reduction_hpp
+#define _INCLUDED_location_hash_neighbor_reduction_hpp
+
+#include "location_hash_algorithm.hpp"
+#include "location_hash_cell_grid.hpp"
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Sums a kernel over the neighbours of every entry of a grid, for flocking, particle densities, force
+	 * sums and the like, without building a list of neighbours for any entry.
+	 *
+	 * The kernel is called once for each unordered pair of distinct entries within radius of each other, as
+	 * kernel(i, j, distance_squared, at_i, at_j), where i and j are entry numbers of grid and at_i and at_j are
+	 * their accumulators. It adds the pair's contribution to both, e.g. a force to one and its opposite to the
+	 * other, so symmetric terms are evaluated once instead of twice. An entry is never paired with itself.
+	 *
+	 * Pairs are generated per pair of cells from CellGrid::for_each_cell_pair(), so the entries compared are
+	 * those of nearby cells, stored next to each other, and cells too far apart to hold a close pair are skipped
+	 * without looking at their entries.
+	 *
+	 * @param grid The entries to reduce over.
+	 * @param radius The distance within which two entries are neighbours.
+	 * @param initial The value every accumulator starts from.
+	 * @param kernel Called as kernel(i, j, distance_squared, at_i, at_j) for each close pair.
+	 * @return The accumulator of each entry of grid.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType, typename Accumulator, typename Kernel>
+	std::vector<Accumulator> reduce_neighbors(
+	    const CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> & grid,
+	    CoordinateType radius, const Accumulator & initial, Kernel && kernel)
+	{
+		using Grid = CellGrid<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>;
+		using Cell = typename Grid::Cell;
+
+		const auto               radius_squared = radius * radius;
+		std::vector<Accumulator> accumulators(grid.size(), initial);
+
+		const auto visit = [&](size_t i, size_t j) {
+			const auto distance_squared = calculate_distance_squared(grid.coordinates(i), grid.coordinates(j));
+			if (distance_squared <= radius_squared) {
+				kernel(i, j, distance_squared, accumulators[i], accumulators[j]);
+			}
+		};
+		grid.for_each_cell_pair(radius, [&](const Cell & a, const Cell & b) {
+			if (&a == &b) {
+				for (size_t i = a.first; i < a.first + a.count; ++i) {
+					for (size_t j = i + 1; j < a.first + a.count; ++j) {
+						visit(i, j);
+					}
+				}
+			} else if (Grid::min_distance_squared(a, b) <= radius_squared) {
+				for (size_t i = a.first; i < a.first + a.count; ++i) {
+					for (size_t j = b.first; j < b.first + b.count; ++j) {
+						visit(i, j);
+					}
+				}
+			}
+		});
+		return accumulators;
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_neighbor_reduction_hpp
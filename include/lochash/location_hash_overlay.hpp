@@ -0,0 +1,272 @@
+#ifndef _INCLUDED_location_hash_overlay_hpp
+#define _INCLUDED_location_hash_overlay_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief A set of pending changes layered over a LocationHash, for trying out hypothetical moves without
+	 * touching the real index. Queries through the overlay see the base with the changes applied.
+	 *
+	 * The first change to a cell copies that cell's bucket from the base into the overlay, and later changes edit
+	 * the copy. Queries read the copy for touched cells and the base for the rest. commit() swaps the copies into
+	 * the base, and discard() drops them, both in O(touched cells).
+	 *
+	 * The base must not be modified while the overlay holds changes, since the copies would then be stale. Only
+	 * point entries are supported, not entries added with a radius.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class LocationHashOverlay
+	{
+	  public:
+		using Base = LocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>;
+		using CoordinateArray         = typename Base::CoordinateArray;
+		using BucketContent           = typename Base::BucketContent;
+		using Entry                   = typename BucketContent::value_type;
+		using QuantizedCoordinateType = typename Base::QuantizedCoordinateType;
+
+		explicit LocationHashOverlay(Base & base)
+		    : base_(&base)
+		{
+		}
+
+		void add(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			auto & bucket = touch(QuantizedCoordinateType(coordinates));
+			if (bucket.empty()) {
+				++occupied_change_;
+			}
+			bucket.emplace_back(coordinates, object);
+		}
+
+		/**
+		 * @brief Removes object from the bucket containing coordinates.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			if (!contains(find(key), object)) {
+				return false; // checked first, so a miss does not copy the cell
+			}
+			auto & bucket = touch(key);
+			bucket.erase(std::find_if(bucket.begin(), bucket.end(),
+			                          [&](const Entry & entry) { return entry.second == object; }));
+			if (bucket.empty()) {
+				--occupied_change_;
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Moves an object. Unlike LocationHash::move, a move within a bucket updates the stored coordinates.
+		 *
+		 * @return True if the object was found and moved.
+		 */
+		bool move(ObjectType * object, const CoordinateArray & old_coordinates, const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			if (old_key != QuantizedCoordinateType(new_coordinates)) {
+				if (!remove(object, old_coordinates)) {
+					return false;
+				}
+				add(object, new_coordinates);
+				return true;
+			}
+			if (!contains(find(old_key), object)) {
+				return false;
+			}
+			for (auto & entry : touch(old_key)) {
+				if (entry.second == object) {
+					entry.first = new_coordinates;
+					break;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * @brief The entries of a bucket with the pending changes applied, empty if the cell is not occupied.
+		 */
+		std::span<const Entry> find(const QuantizedCoordinateType & key) const
+		{
+			const auto touched = cells_.find(key);
+			if (touched != cells_.end()) {
+				return touched->second;
+			}
+			const auto & data = base_->get_data();
+			const auto   it   = data.find(key);
+			return it != data.end() ? std::span<const Entry>(it->second) : std::span<const Entry>();
+		}
+
+		/**
+		 * @brief The entries of the bucket containing coordinates. See find().
+		 */
+		std::span<const Entry> query(const CoordinateArray & coordinates) const
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Visits every occupied bucket as visitor(key, bucket) with the pending changes applied, in no
+		 * particular order.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor) const
+		{
+			for (const auto & [key, entries] : base_->get_data()) {
+				if (cells_.find(key) == cells_.end()) {
+					visitor(key, std::span<const Entry>(entries));
+				}
+			}
+			for (const auto & [key, entries] : cells_) {
+				if (!entries.empty()) {
+					visitor(key, std::span<const Entry>(entries));
+				}
+			}
+		}
+
+		/**
+		 * @brief The number of occupied cells with the pending changes applied.
+		 */
+		size_t cell_count() const
+		{
+			return static_cast<size_t>(static_cast<std::ptrdiff_t>(base_->get_data().size()) + occupied_change_);
+		}
+
+		/**
+		 * @brief The number of cells the pending changes touch.
+		 */
+		size_t touched_cell_count() const { return cells_.size(); }
+
+		bool has_changes() const { return !cells_.empty(); }
+
+		/**
+		 * @brief Applies the pending changes to the base and clears the overlay.
+		 */
+		void commit()
+		{
+			for (auto & [key, bucket] : cells_) {
+				base_->replace_bucket(key, std::move(bucket));
+			}
+			discard();
+		}
+
+		/**
+		 * @brief Drops the pending changes, leaving the base as it was.
+		 */
+		void discard()
+		{
+			cells_.clear();
+			occupied_change_ = 0;
+		}
+
+		const Base & base() const { return *base_; }
+
+	  private:
+		static bool contains(std::span<const Entry> bucket, const ObjectType * object)
+		{
+			return std::any_of(bucket.begin(), bucket.end(),
+			                   [&](const Entry & entry) { return entry.second == object; });
+		}
+
+		// The overlay's copy of a cell, taken from the base on first touch.
+		BucketContent & touch(const QuantizedCoordinateType & key)
+		{
+			const auto [it, inserted] = cells_.try_emplace(key);
+			if (inserted) {
+				const auto & data  = base_->get_data();
+				const auto   found = data.find(key);
+				if (found != data.end()) {
+					it->second = found->second;
+				}
+			}
+			return it->second;
+		}
+
+		Base *                                                     base_;
+		std::unordered_map<QuantizedCoordinateType, BucketContent> cells_;
+		std::ptrdiff_t                                             occupied_change_ = 0;
+	};
+
+	/**
+	 * Query objects within a bounding box through a LocationHashOverlay.
+	 *
+	 * @param overlay The LocationHashOverlay to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(
+	    const LocationHashOverlay<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   overlay,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds, std::vector<ObjectType *> & result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return overlay.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point through a LocationHashOverlay.
+	 *
+	 * @param overlay The LocationHashOverlay to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(
+	    const LocationHashOverlay<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   overlay,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	    std::vector<ObjectType *> &                    result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return overlay.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point through a LocationHashOverlay, nearest first. See query_nearest for
+	 * LocationHash.
+	 *
+	 * @param overlay The LocationHashOverlay to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *> query_nearest(
+	    const LocationHashOverlay<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   overlay,
+	    const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return overlay.find(key); },
+		    [&](const auto & visitor) { overlay.for_each_bucket(visitor); }, overlay.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_overlay_hpp
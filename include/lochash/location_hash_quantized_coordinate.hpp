@@ -45,12 +45,21 @@ namespace lochash
 	          typename QuantizedCoordinateIntegerType = int64_t>
 	struct QuantizedCoordinate {
 
+		/**
+		 * @brief Construct a Quantized Coordinate at the origin. Useful when the quantized values are computed
+		 * directly, such as when stepping through neighboring cells.
+		 */
+		constexpr QuantizedCoordinate()
+		    : quantized_{}
+		{
+		}
+
 		/**
 		 * @brief Construct a new Quantized Coordinate object and provide implicit conversion for CoordinateType arrays.
 		 *
 		 * @param coordinates
 		 */
-		QuantizedCoordinate(const std::array<CoordinateType, Dimensions> & coordinates)
+		constexpr QuantizedCoordinate(const std::array<CoordinateType, Dimensions> & coordinates)
 		{
 			for (size_t i = 0; i < Dimensions; ++i) {
 				quantized_[i] =
@@ -152,7 +161,7 @@ namespace lochash
 		 * @return true
 		 * @return false
 		 */
-		bool operator<(const QuantizedCoordinate & other) const
+		constexpr bool operator<(const QuantizedCoordinate & other) const
 		{
 			for (size_t i = 0; i < Dimensions; ++i) {
 				if (quantized_[i] < other.quantized_[i]) {
@@ -186,6 +195,60 @@ namespace std
 
 namespace lochash
 {
+	/**
+	 * @brief Visits every quantized coordinate within the range specified by min_coords and max_coords, in the same
+	 *   order as generate_all_quantized_coordinates_within_range, without allocating. Query helpers use this so a
+	 *   query does not need to materialize its list of keys.
+	 *
+	 *   An empty range (any max below its min) visits nothing.
+	 *
+	 * @tparam Precision
+	 * @tparam CoordinateType
+	 * @tparam Dimensions
+	 * @param min_coords
+	 * @param max_coords
+	 * @param visitor Callable invoked with each QuantizedCoordinate in the range.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions,
+	          typename QuantizedCoordinateIntegerType = int64_t, typename Visitor>
+	void for_each_quantized_coordinate_within_range(const std::array<CoordinateType, Dimensions> & min_coords,
+	                                                const std::array<CoordinateType, Dimensions> & max_coords,
+	                                                Visitor &&                                     visitor)
+	{
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+
+		QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType> lower;
+		QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType> upper;
+		for (size_t i = 0; i < Dimensions; ++i) {
+			lower.quantized_[i] = quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(min_coords[i]);
+			upper.quantized_[i] = quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(max_coords[i]);
+			if (upper.quantized_[i] < lower.quantized_[i]) {
+				return;
+			}
+		}
+
+		// Step the quantized values directly rather than re-quantizing each coordinate.
+		constexpr auto step    = static_cast<QuantizedCoordinateIntegerType>(Precision);
+		auto           current = lower;
+		bool           done    = false;
+		while (!done) {
+			visitor(current);
+
+			// Increment the coordinate to the next one in the range, odometer style.
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (current.quantized_[i] < upper.quantized_[i]) {
+					current.quantized_[i] += step;
+					break;
+				}
+				current.quantized_[i] = lower.quantized_[i];
+				if (i == Dimensions - 1) {
+					done = true;
+				}
+			}
+		}
+	}
+
 	/**
 	 * @brief Quantizes the lower and upper bounds specficied by min_coords and max_coords respectively
 	 *   to return a vector of all quantized coordinates within the specified range. These may be used
@@ -213,45 +276,20 @@ namespace lochash
 		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
 
 		std::vector<QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>>
-		                               quantized_coords;
-		std::array<size_t, Dimensions> steps;
-		constexpr size_t               precision_shift = calculate_precision_shift<Precision>();
+		                 quantized_coords;
+		constexpr size_t precision_shift = calculate_precision_shift<Precision>();
 
-		// Calculate the number of steps required for each dimension
+		// reserve space in the vector to avoid reallocations
 		size_t total_steps = 1;
 		for (size_t i = 0; i < Dimensions; ++i) {
-			steps[i] = ((quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(max_coords[i]) -
-			             quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(min_coords[i])) >>
-			            precision_shift) +
-			           1;
-			total_steps *= steps[i];
+			const auto span = quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(max_coords[i]) -
+			                  quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(min_coords[i]);
+			total_steps *= span < 0 ? 0 : (static_cast<size_t>(span) >> precision_shift) + 1;
 		}
-
-		// reserve space in the vector to avoid reallocations
 		quantized_coords.reserve(total_steps);
 
-		std::array<size_t, Dimensions> indices = {0};
-		bool                           done    = false;
-
-		while (!done) {
-			std::array<CoordinateType, Dimensions> current_coords;
-			for (size_t i = 0; i < Dimensions; ++i) {
-				current_coords[i] = min_coords[i] + static_cast<CoordinateType>(indices[i] << precision_shift);
-			}
-
-			quantized_coords.emplace_back(current_coords);
-
-			// Increment the indices array to generate the next coordinate in the range.
-			for (size_t i = 0; i < Dimensions; ++i) {
-				if (++indices[i] < steps[i]) {
-					break;
-				}
-				indices[i] = 0;
-				if (i == Dimensions - 1) {
-					done = true;
-				}
-			}
-		}
+		for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>(
+		    min_coords, max_coords, [&](const auto & key) { quantized_coords.push_back(key); });
 
 		return quantized_coords;
 	}
@@ -289,6 +327,94 @@ namespace lochash
 		                                                       QuantizedCoordinateIntegerType>(lower_bounds,
 		                                                                                       upper_bounds);
 	}
+
+	namespace detail
+	{
+		// Bounds, in cells from the center, of one of the 2 * Dimensions faces that partition the shell ring cells
+		// out. face / 2 is the first axis on the surface and face % 2 picks its side; axes before it lie strictly
+		// inside the shell and axes after it span its full width, so each cell of the shell is in exactly one face.
+		// Returns false if the face is empty, which happens only in ring 0, whose one cell is in face 0.
+		template <typename Integer, size_t Dimensions>
+		bool shell_face_bounds(Integer ring, size_t face, std::array<Integer, Dimensions> & lower,
+		                       std::array<Integer, Dimensions> & upper)
+		{
+			const size_t  axis = face / 2;
+			const Integer side = face % 2 == 0 ? -ring : ring;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (i < axis) {
+					lower[i] = -ring + 1;
+					upper[i] = ring - 1;
+				} else if (i == axis) {
+					lower[i] = side;
+					upper[i] = side;
+				} else {
+					lower[i] = -ring;
+					upper[i] = ring;
+				}
+			}
+			return axis == 0 || ring > 0;
+		}
+	} // namespace detail
+
+	/**
+	 * @brief Visits every quantized coordinate on the surface of the hypercube "shell" that is exactly `ring` cells
+	 *  away (Chebyshev distance) from `center`. Ring 0 is the center cell itself, ring 1 is the 3^n - 1 cells
+	 *  surrounding it, and so on. Each cell is visited exactly once without materializing the interior of the shell,
+	 *  so expanding searches (nearest neighbor, nearest-first traversal) can grow outward one ring at a time.
+	 *
+	 * @tparam Precision
+	 * @tparam CoordinateType
+	 * @tparam Dimensions
+	 * @param center The quantized coordinate at the center of the shell.
+	 * @param ring The Chebyshev distance, in cells, from the center.
+	 * @param visitor Callable invoked with each QuantizedCoordinate on the shell.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions,
+	          typename QuantizedCoordinateIntegerType = int64_t, typename Visitor>
+	void for_each_quantized_coordinate_in_shell(
+	    const QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType> & center,
+	    size_t ring, Visitor && visitor)
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+
+		QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType> current = center;
+		if (ring == 0) {
+			visitor(current);
+			return;
+		}
+
+		const auto r    = static_cast<QuantizedCoordinateIntegerType>(ring);
+		const auto step = static_cast<QuantizedCoordinateIntegerType>(Precision);
+
+		// Partition the shell by the first axis that sits on a face (offset == +/- ring). This visits each cell
+		// exactly once.
+		for (size_t face = 0; face < 2 * Dimensions; ++face) {
+			std::array<QuantizedCoordinateIntegerType, Dimensions> lower;
+			std::array<QuantizedCoordinateIntegerType, Dimensions> upper;
+			if (!detail::shell_face_bounds(r, face, lower, upper)) {
+				continue;
+			}
+
+			std::array<QuantizedCoordinateIntegerType, Dimensions> offsets = lower;
+			bool                                                   done    = false;
+			while (!done) {
+				for (size_t i = 0; i < Dimensions; ++i) {
+					current.quantized_[i] = center.quantized_[i] + offsets[i] * step;
+				}
+				visitor(current);
+
+				for (size_t i = 0; i < Dimensions; ++i) {
+					if (++offsets[i] <= upper[i]) {
+						break;
+					}
+					offsets[i] = lower[i];
+					if (i == Dimensions - 1) {
+						done = true;
+					}
+				}
+			}
+		}
+	}
 } // namespace lochash
 
 #endif //_INCLUDED_location_hash_quantized_coordinate_hpp
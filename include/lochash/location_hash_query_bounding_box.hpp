@@ -34,8 +34,55 @@ namespace lochash
 			}
 			return true;
 		}
+
+		// Bounding box query shared by the index types. find(key) returns the entries of a bucket as a range, empty
+		// when the bucket is not occupied.
+		template <size_t Precision, typename QuantizedCoordinateIntegerType, typename Find, typename CoordinateType,
+		          size_t Dimensions, typename ObjectType>
+		void query_bounding_box(Find && find, const std::array<CoordinateType, Dimensions> & lower_bounds,
+		                        const std::array<CoordinateType, Dimensions> & upper_bounds,
+		                        std::vector<ObjectType *> &                    result)
+		{
+			static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+			static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+
+			result.clear();
+			for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+			                                           QuantizedCoordinateIntegerType>(
+			    lower_bounds, upper_bounds, [&](const auto & key) {
+				    for (const auto & [coordinates, object] : find(key)) {
+					    if (within_bounds(coordinates, lower_bounds, upper_bounds)) {
+						    result.push_back(object);
+					    }
+				    }
+			    });
+		}
 	} // namespace detail
 
+	/**
+	 * Query objects within a bounding box defined by lower and upper bounds, writing them into a caller-owned
+	 * vector. The vector is cleared first; its capacity is reused, so a warmed-up vector makes the query
+	 * allocation free.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @param locationHash The LocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType>
+	void query_bounding_box(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &                          lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &                          upper_bounds,
+	                        std::vector<ObjectType *> &                                             result)
+	{
+		detail::query_bounding_box<Precision, int64_t>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
 	/**
 	 * Query objects within a bounding box defined by lower and upper bounds.
 	 *
@@ -54,27 +101,8 @@ namespace lochash
 	                   const std::array<CoordinateType, Dimensions> &                          lower_bounds,
 	                   const std::array<CoordinateType, Dimensions> &                          upper_bounds)
 	{
-		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
-		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
-
 		std::vector<ObjectType *> result;
-
-		// Generate all hash keys within the specified range
-		auto keys = generate_all_quantized_coordinates_within_range<Precision, CoordinateType, Dimensions>(
-		    lower_bounds, upper_bounds);
-
-		const auto & locationHashData = locationHash.get_data();
-		for (const auto & key : keys) {
-			const auto it = locationHashData.find(key);
-			if (it != locationHashData.end()) {
-				for (const auto & [coordinates, object] : it->second) {
-					if (detail::within_bounds(coordinates, lower_bounds, upper_bounds)) {
-						result.push_back(object);
-					}
-				}
-			}
-		}
-
+		query_bounding_box(locationHash, lower_bounds, upper_bounds, result);
 		return result;
 	}
 } // namespace lochash
@@ -7,6 +7,63 @@
 
 namespace lochash
 {
+	namespace detail
+	{
+		// Distance query shared by the index types. find(key) returns the entries of a bucket as a range, empty
+		// when the bucket is not occupied.
+		template <size_t Precision, typename QuantizedCoordinateIntegerType, typename Find, typename CoordinateType,
+		          size_t Dimensions, typename ObjectType>
+		void query_within_distance(Find && find, const std::array<CoordinateType, Dimensions> & center,
+		                           CoordinateType radius, std::vector<ObjectType *> & result)
+		{
+			static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+			static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+			result.clear();
+			const CoordinateType radius_squared = radius * radius;
+
+			std::array<CoordinateType, Dimensions> lower_bounds;
+			std::array<CoordinateType, Dimensions> upper_bounds;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				lower_bounds[i] = center[i] - radius;
+				upper_bounds[i] = center[i] + radius;
+			}
+
+			// Visit all hash keys within the specified distance
+			for_each_quantized_coordinate_within_range<Precision, CoordinateType, Dimensions,
+			                                           QuantizedCoordinateIntegerType>(
+			    lower_bounds, upper_bounds, [&](const auto & hash_key) {
+				    for (const auto & [coordinates, object] : find(hash_key)) {
+					    if (calculate_distance_squared<CoordinateType, Dimensions>(coordinates, center) <=
+					        radius_squared) {
+						    result.push_back(object);
+					    }
+				    }
+			    });
+		}
+	} // namespace detail
+
+	/***
+	 * Query objects within a certain distance from a point, writing them into a caller-owned vector. The vector is
+	 * cleared first; its capacity is reused, so a warmed-up vector makes the query allocation free.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @param locationHash The LocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType>
+	void query_within_distance(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                           const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                           std::vector<ObjectType *> & result)
+	{
+		detail::query_within_distance<Precision, int64_t>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
 
 	/***
 	 * Query objects within a certain distance from a point.
@@ -25,28 +82,8 @@ namespace lochash
 	query_within_distance(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
 	                      const std::array<CoordinateType, Dimensions> & center, CoordinateType radius)
 	{
-		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
-		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
-
 		std::vector<ObjectType *> result;
-		CoordinateType            radius_squared = radius * radius;
-
-		// Generate all hash keys within the specified distance
-		const auto hash_keys =
-		    generate_all_quantized_coordinates_within_distance<Precision, CoordinateType, Dimensions>(center, radius);
-
-		const auto & locationHashData = locationHash.get_data();
-		for (const auto & hash_key : hash_keys) {
-			const auto it = locationHashData.find(hash_key);
-			if (it != locationHashData.end()) {
-				for (const auto & [coordinates, object] : it->second) {
-					if (calculate_distance_squared<CoordinateType, Dimensions>(coordinates, center) <= radius_squared) {
-						result.push_back(object);
-					}
-				}
-			}
-		}
-
+		query_within_distance(locationHash, center, radius, result);
 		return result;
 	}
 } // namespace lochash
@@ -0,0 +1,305 @@
+#ifndef _INCLUDED_location_hash_query_log_hpp
+#define _INCLUDED_location_hash_query_log_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <source_location>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Which query produced a QueryRecord.
+	 */
+	enum class QueryShape { bounding_box, within_distance };
+
+	/**
+	 * @brief Cost breakdown of one query, as captured by the slow-query log.
+	 *
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 */
+	template <typename CoordinateType, size_t Dimensions>
+	struct QueryRecord {
+		QueryShape                             shape = QueryShape::bounding_box;
+		std::array<CoordinateType, Dimensions> lower_bounds{}; // the box whose cells were enumerated
+		std::array<CoordinateType, Dimensions> upper_bounds{};
+		CoordinateType                         radius = 0; // within_distance only
+
+		size_t                   cells_enumerated  = 0; // bucket keys generated for the box
+		size_t                   cells_hit         = 0; // of those, buckets that exist
+		size_t                   candidates_tested = 0; // entries in the hit buckets
+		size_t                   results_returned  = 0; // entries that passed the exact test
+		std::chrono::nanoseconds duration{0};
+
+		// where the query was issued
+		const char *  file     = "";
+		const char *  function = "";
+		uint_least32_t line    = 0;
+	};
+
+	/**
+	 * @brief Opt-in log of queries that exceed a latency or probe-count threshold.
+	 *
+	 * Records go into a fixed-size lock-free ring buffer, so any number of threads can log while another drains,
+	 * without allocating or blocking. When the ring is full new records are dropped and counted rather than waiting
+	 * for the drainer. The ring is a bounded multi-producer multi-consumer queue in the style of Dmitry Vyukov's,
+	 * where each slot carries a sequence number that says whose turn it is.
+	 *
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam Capacity Slots in the ring. Must be a power of two.
+	 *
+	 * @code
+	 *   SlowQueryLog<float, 2> slowQueries;
+	 *   slowQueries.set_thresholds(std::chrono::milliseconds(2), 10000);
+	 *   query_bounding_box(locationHash, lower, upper, result, slowQueries);
+	 *   slowQueries.drain([](const auto & record) { report(record); });
+	 * @endcode
+	 */
+	template <typename CoordinateType, size_t Dimensions, size_t Capacity = 256>
+	class SlowQueryLog
+	{
+		static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	  public:
+		using Record = QueryRecord<CoordinateType, Dimensions>;
+
+		SlowQueryLog()
+		{
+			for (size_t i = 0; i < Capacity; ++i) {
+				slots_[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		SlowQueryLog(const SlowQueryLog &)             = delete;
+		SlowQueryLog & operator=(const SlowQueryLog &) = delete;
+
+		/**
+		 * @brief Sets when a query is slow: it took at least duration, or enumerated at least cells_enumerated
+		 * bucket keys. Either threshold alone is enough. Safe to call while queries are logging.
+		 */
+		void set_thresholds(std::chrono::nanoseconds duration, size_t cells_enumerated)
+		{
+			duration_threshold_.store(duration.count(), std::memory_order_relaxed);
+			cells_threshold_.store(cells_enumerated, std::memory_order_relaxed);
+		}
+
+		std::chrono::nanoseconds duration_threshold() const
+		{
+			return std::chrono::nanoseconds(duration_threshold_.load(std::memory_order_relaxed));
+		}
+
+		size_t cells_threshold() const { return cells_threshold_.load(std::memory_order_relaxed); }
+
+		/**
+		 * @brief Logs record if it crosses either threshold.
+		 *
+		 * @return true if the record was logged, false if it was fast enough or the ring was full.
+		 */
+		bool record_if_slow(const Record & record)
+		{
+			if (record.duration < duration_threshold() && record.cells_enumerated < cells_threshold()) {
+				return false;
+			}
+			return push(record);
+		}
+
+		/**
+		 * @brief Removes every logged record, oldest first, and passes each to visitor.
+		 *
+		 * @return The number of records drained.
+		 */
+		template <typename Visitor>
+		size_t drain(Visitor && visitor)
+		{
+			size_t drained = 0;
+			Record record;
+			while (pop(record)) {
+				visitor(record);
+				++drained;
+			}
+			return drained;
+		}
+
+		/**
+		 * @brief Slow queries that were not logged because the ring was full.
+		 */
+		size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+	  private:
+		struct Slot {
+			std::atomic<size_t> sequence;
+			Record              record;
+		};
+
+		bool push(const Record & record)
+		{
+			size_t position = tail_.load(std::memory_order_relaxed);
+			for (;;) {
+				Slot &         slot     = slots_[position & (Capacity - 1)];
+				const size_t   sequence = slot.sequence.load(std::memory_order_acquire);
+				const intptr_t lag      = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+				if (lag == 0) {
+					if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						slot.record = record;
+						slot.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (lag < 0) {
+					// the slot still holds a record from one lap ago: full
+					dropped_.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				} else {
+					position = tail_.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		bool pop(Record & record)
+		{
+			size_t position = head_.load(std::memory_order_relaxed);
+			for (;;) {
+				Slot &         slot     = slots_[position & (Capacity - 1)];
+				const size_t   sequence = slot.sequence.load(std::memory_order_acquire);
+				const intptr_t lag      = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+				if (lag == 0) {
+					if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						record = slot.record;
+						slot.sequence.store(position + Capacity, std::memory_order_release);
+						return true;
+					}
+				} else if (lag < 0) {
+					return false; // empty
+				} else {
+					position = head_.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		std::array<Slot, Capacity> slots_;
+		std::atomic<size_t>        tail_{0};
+		std::atomic<size_t>        head_{0};
+		std::atomic<size_t>        dropped_{0};
+		std::atomic<int64_t>       duration_threshold_{std::chrono::nanoseconds(std::chrono::milliseconds(1)).count()};
+		std::atomic<size_t>        cells_threshold_{4096};
+	};
+
+	namespace detail
+	{
+		template <typename CoordinateType, size_t Dimensions>
+		QueryRecord<CoordinateType, Dimensions> make_query_record(QueryShape                                     shape,
+		                                                          const std::array<CoordinateType, Dimensions> & lower,
+		                                                          const std::array<CoordinateType, Dimensions> & upper,
+		                                                          const std::source_location & caller)
+		{
+			QueryRecord<CoordinateType, Dimensions> record;
+			record.shape        = shape;
+			record.lower_bounds = lower;
+			record.upper_bounds = upper;
+			record.file         = caller.file_name();
+			record.function     = caller.function_name();
+			record.line         = caller.line();
+			return record;
+		}
+
+		// Wraps an index's find so that every bucket key a query generates is counted in record.
+		template <typename CoordinateType, size_t Dimensions, typename Find>
+		auto recording_find(Find && find, QueryRecord<CoordinateType, Dimensions> & record)
+		{
+			return [&find, &record](const auto & key) {
+				++record.cells_enumerated;
+				const auto bucket = find(key);
+				if (!bucket.empty()) {
+					++record.cells_hit;
+					record.candidates_tested += bucket.size();
+				}
+				return bucket;
+			};
+		}
+	} // namespace detail
+
+	/**
+	 * Query objects within a bounding box, like query_bounding_box, and log the query's cost to slowQueries if it
+	 * crosses the log's thresholds. The caller's location is captured automatically.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @tparam Capacity Slots in the slow-query log.
+	 * @param locationHash The LocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 * @param slowQueries The log that receives the query if it is slow.
+	 * @param caller Defaults to the call site.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity>
+	void query_bounding_box(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &                          lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &                          upper_bounds,
+	                        std::vector<ObjectType *> &                                             result,
+	                        SlowQueryLog<CoordinateType, Dimensions, Capacity> &                    slowQueries,
+	                        const std::source_location caller = std::source_location::current())
+	{
+		const auto start  = std::chrono::steady_clock::now();
+		auto       record = detail::make_query_record(QueryShape::bounding_box, lower_bounds, upper_bounds, caller);
+
+		const auto find = [&](const auto & key) { return locationHash.find(key); };
+		detail::query_bounding_box<Precision, int64_t>(detail::recording_find(find, record), lower_bounds,
+		                                               upper_bounds, result);
+
+		record.results_returned = result.size();
+		record.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		slowQueries.record_if_slow(record);
+	}
+
+	/**
+	 * Query objects within a distance of a point, like query_within_distance, and log the query's cost to
+	 * slowQueries if it crosses the log's thresholds. The caller's location is captured automatically.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @tparam Capacity Slots in the slow-query log.
+	 * @param locationHash The LocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 * @param slowQueries The log that receives the query if it is slow.
+	 * @param caller Defaults to the call site.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity>
+	void query_within_distance(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                           const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                           std::vector<ObjectType *> &                          result,
+	                           SlowQueryLog<CoordinateType, Dimensions, Capacity> & slowQueries,
+	                           const std::source_location caller = std::source_location::current())
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		std::array<CoordinateType, Dimensions> lower_bounds;
+		std::array<CoordinateType, Dimensions> upper_bounds;
+		for (size_t i = 0; i < Dimensions; ++i) {
+			lower_bounds[i] = center[i] - radius;
+			upper_bounds[i] = center[i] + radius;
+		}
+		auto record   = detail::make_query_record(QueryShape::within_distance, lower_bounds, upper_bounds, caller);
+		record.radius = radius;
+
+		const auto find = [&](const auto & key) { return locationHash.find(key); };
+		detail::query_within_distance<Precision, int64_t>(detail::recording_find(find, record), center, radius,
+		                                                  result);
+
+		record.results_returned = result.size();
+		record.duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+		slowQueries.record_if_slow(record);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_query_log_hpp
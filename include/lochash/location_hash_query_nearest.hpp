@@ -0,0 +1,154 @@
+#ifndef _INCLUDED_location_hash_query_nearest_hpp
+#define _INCLUDED_location_hash_query_nearest_hpp
+
+#include "location_hash.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief Working storage for a k-nearest search: the best candidates so far, each with its squared distance.
+	 * Passing one in lets the search run without allocating once it has capacity for k candidates.
+	 */
+	template <typename CoordinateType, typename ObjectType>
+	using NearestCandidates = std::vector<std::pair<CoordinateType, ObjectType *>>;
+
+	namespace detail
+	{
+		// Ring-by-ring k-nearest search shared by the index types. find(key) returns the entries of a bucket as a
+		// range, empty when the bucket is not occupied; for_each_bucket(visitor) calls visitor(key, bucket) for
+		// every occupied bucket; occupied is the number of occupied buckets. result and best are cleared first,
+		// and neither allocates when it already has capacity for k.
+		template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+		          typename QuantizedCoordinateIntegerType, typename Find, typename ForEachBucket>
+		void query_nearest(Find && find, ForEachBucket && for_each_bucket, size_t occupied,
+		                   const std::array<CoordinateType, Dimensions> & center, size_t k,
+		                   std::vector<ObjectType *> & result, NearestCandidates<CoordinateType, ObjectType> & best)
+		{
+			using Candidate   = std::pair<CoordinateType, ObjectType *>;
+			const auto closer = [](const Candidate & a, const Candidate & b) { return a.first < b.first; };
+
+			result.clear();
+			best.clear();
+			if (k == 0 || occupied == 0) {
+				return;
+			}
+
+			// max-heap on distance, so the current k-th nearest is always at the front
+			best.reserve(k);
+			const auto offer = [&](const auto & bucket) {
+				for (const auto & [coordinates, object] : bucket) {
+					const auto distance_squared =
+					    calculate_distance_squared<CoordinateType, Dimensions>(coordinates, center);
+					if (best.size() < k) {
+						best.emplace_back(distance_squared, object);
+						std::push_heap(best.begin(), best.end(), closer);
+					} else if (distance_squared < best.front().first) {
+						std::pop_heap(best.begin(), best.end(), closer);
+						best.back() = Candidate(distance_squared, object);
+						std::push_heap(best.begin(), best.end(), closer);
+					}
+				}
+			};
+
+			const QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType> center_key(
+			    center);
+			size_t buckets_visited = 0;
+			size_t probes          = 0;
+			for (size_t ring = 0; buckets_visited < occupied; ++ring) {
+				for_each_quantized_coordinate_in_shell<Precision, CoordinateType, Dimensions>(
+				    center_key, ring, [&](const auto & key) {
+					    ++probes;
+					    const auto bucket = find(key);
+					    if (!bucket.empty()) {
+						    ++buckets_visited;
+						    offer(bucket);
+					    }
+				    });
+
+				// Anything in the next ring is at least `ring` whole buckets away from the center.
+				if (best.size() == k) {
+					const auto next_ring_distance = static_cast<CoordinateType>(ring * Precision);
+					if (best.front().first <= next_ring_distance * next_ring_distance) {
+						break;
+					}
+				}
+
+				// Probing further rings, most of them empty when the center is far from everything, would cost more
+				// than looking at every occupied bucket beyond them.
+				if (probes >= occupied && buckets_visited < occupied) {
+					const auto reach = static_cast<QuantizedCoordinateIntegerType>(ring * Precision);
+					for_each_bucket([&](const auto & key, const auto & bucket) {
+						for (size_t i = 0; i < Dimensions; ++i) {
+							if (std::abs(key.quantized_[i] - center_key.quantized_[i]) > reach) {
+								offer(bucket);
+								return;
+							}
+						}
+					});
+					break;
+				}
+			}
+
+			std::sort_heap(best.begin(), best.end(), closer);
+			result.reserve(best.size());
+			for (const auto & candidate : best) {
+				result.push_back(candidate.second);
+			}
+		}
+
+		template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+		          typename QuantizedCoordinateIntegerType, typename Find, typename ForEachBucket>
+		std::vector<ObjectType *> query_nearest(Find && find, ForEachBucket && for_each_bucket, size_t occupied,
+		                                        const std::array<CoordinateType, Dimensions> & center, size_t k)
+		{
+			std::vector<ObjectType *>                     result;
+			NearestCandidates<CoordinateType, ObjectType> best;
+			query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+			    find, for_each_bucket, occupied, center, k, result, best);
+			return result;
+		}
+	} // namespace detail
+
+	/**
+	 * Query the k objects nearest to a point.
+	 *
+	 * Buckets are searched outward from the bucket containing the center, one ring of cells at a time. The search
+	 * stops once k candidates have been found and the next ring cannot contain anything closer, or once every
+	 * occupied bucket has been visited. When it has probed as many cells as there are occupied buckets, the
+	 * occupied buckets outside the rings searched so far are scanned instead, so a center far from everything
+	 * costs O(occupied buckets) rather than a probe per cell of every ring out to the nearest object.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @param locationHash The LocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType>
+	std::vector<ObjectType *>
+	query_nearest(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	              const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+		const auto & locationHashData = locationHash.get_data();
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, int64_t>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) {
+			    for (const auto & [key, bucket] : locationHashData) {
+				    visitor(key, bucket);
+			    }
+		    },
+		    locationHashData.size(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_query_nearest_hpp
@@ -0,0 +1,282 @@
+#ifndef _INCLUDED_location_hash_query_resumable_hpp
+#define _INCLUDED_location_hash_query_resumable_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief How much work a resumable query may do before it returns. A probe is one cell lookup. The deadline is
+	 * checked every few probes, so a query can overrun it by a handful of lookups.
+	 */
+	struct QueryBudget {
+		size_t                                max_probes = std::numeric_limits<size_t>::max();
+		std::chrono::steady_clock::time_point deadline   = std::chrono::steady_clock::time_point::max();
+	};
+
+	/**
+	 * @brief The position of a query over a box that may take several calls to finish. Cells are visited ring by
+	 * ring outward from the cell holding an origin point, so the nearest results come first, and only cells inside
+	 * the box are generated. The cursor records where the walk stopped, down to the cell, so a later call carries
+	 * on without revisiting or re-enumerating anything.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class QueryCursor
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		using CoordinateArray = std::array<CoordinateType, Dimensions>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief A cursor over the cells overlapping a box, nearest to origin first. The origin may lie outside the
+		 * box.
+		 */
+		QueryCursor(const CoordinateArray & lower_bounds, const CoordinateArray & upper_bounds,
+		            const CoordinateArray & origin)
+		    : lower_bounds_(lower_bounds)
+		    , upper_bounds_(upper_bounds)
+		    , origin_(origin)
+		    , center_(origin)
+		{
+			for (size_t i = 0; i < Dimensions; ++i) {
+				const auto lower =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(lower_bounds[i]);
+				const auto upper =
+				    quantize_value<CoordinateType, Precision, QuantizedCoordinateIntegerType>(upper_bounds[i]);
+				if (upper < lower) {
+					last_ring_ = 0;
+					ring_      = 1; // nothing to visit
+					return;
+				}
+				lowest_[i]  = (lower - center_.quantized_[i]) / step;
+				highest_[i] = (upper - center_.quantized_[i]) / step;
+				last_ring_  = std::max({last_ring_, std::abs(lowest_[i]), std::abs(highest_[i])});
+			}
+		}
+
+		/**
+		 * @brief A cursor for the points within radius of center, nearest cells first. See query_within_distance.
+		 */
+		static QueryCursor around(const CoordinateArray & center, CoordinateType radius)
+		{
+			CoordinateArray lower_bounds;
+			CoordinateArray upper_bounds;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				lower_bounds[i] = center[i] - radius;
+				upper_bounds[i] = center[i] + radius;
+			}
+			QueryCursor cursor(lower_bounds, upper_bounds, center);
+			cursor.radius_     = radius;
+			cursor.has_radius_ = true;
+			return cursor;
+		}
+
+		/**
+		 * @brief Continues the walk, calling visitor(key, bucket) for each occupied cell, until every cell has been
+		 * visited or the budget runs out.
+		 *
+		 * @param find Returns the entries of a cell as a range, empty if the cell is not occupied.
+		 * @param budget The work allowed for this call.
+		 * @param visitor Called with each occupied cell.
+		 * @return True once the walk is complete.
+		 */
+		template <typename Find, typename Visitor>
+		bool resume(Find && find, const QueryBudget & budget, Visitor && visitor)
+		{
+			constexpr size_t clock_interval = 16;
+			const bool       timed          = budget.deadline != std::chrono::steady_clock::time_point::max();
+			for (size_t probes = 0; probes < budget.max_probes; ++probes) {
+				if (timed && probes % clock_interval == 0 && probes != 0 &&
+				    std::chrono::steady_clock::now() >= budget.deadline) {
+					return false;
+				}
+				QuantizedCoordinateType key;
+				if (!next(key)) {
+					return true;
+				}
+				++probes_;
+				const auto bucket = find(key);
+				if (!bucket.empty()) {
+					visitor(key, bucket);
+				}
+			}
+			return done();
+		}
+
+		/**
+		 * @brief True once every cell has been visited.
+		 */
+		bool done() const { return !in_partition_ && ring_ > last_ring_; }
+
+		/**
+		 * @brief The number of cells probed so far, over all calls.
+		 */
+		size_t probes() const { return probes_; }
+
+		const CoordinateArray & lower_bounds() const { return lower_bounds_; }
+
+		const CoordinateArray & upper_bounds() const { return upper_bounds_; }
+
+		const CoordinateArray & origin() const { return origin_; }
+
+		/**
+		 * @brief The radius given to around(), or the largest CoordinateType for a box cursor.
+		 */
+		CoordinateType radius() const { return radius_; }
+
+		/**
+		 * @brief True if the cursor came from around(), so radius() bounds a distance query.
+		 */
+		bool has_radius() const { return has_radius_; }
+
+	  private:
+		using Offsets = std::array<QuantizedCoordinateIntegerType, Dimensions>;
+
+		static constexpr auto   step       = static_cast<QuantizedCoordinateIntegerType>(Precision);
+		static constexpr size_t partitions = 2 * Dimensions;
+
+		// The next cell of the walk. Each ring is split into the faces of detail::shell_face_bounds, as in
+		// for_each_quantized_coordinate_in_shell, and each face is clipped to the box before it is walked.
+		bool next(QuantizedCoordinateType & key)
+		{
+			while (!in_partition_) {
+				if (!open_next_partition()) {
+					return false;
+				}
+			}
+			for (size_t i = 0; i < Dimensions; ++i) {
+				key.quantized_[i] = center_.quantized_[i] + offsets_[i] * step;
+			}
+			in_partition_ = false;
+			for (size_t i = 0; i < Dimensions; ++i) {
+				if (offsets_[i] < upper_[i]) {
+					++offsets_[i];
+					in_partition_ = true;
+					break;
+				}
+				offsets_[i] = lower_[i];
+			}
+			return true;
+		}
+
+		bool open_next_partition()
+		{
+			while (ring_ <= last_ring_) {
+				if (partition_ >= (ring_ == 0 ? 1 : partitions)) {
+					++ring_;
+					partition_ = 0;
+					continue;
+				}
+				const size_t face = partition_++;
+
+				bool empty = !detail::shell_face_bounds(ring_, face, lower_, upper_);
+				for (size_t i = 0; i < Dimensions; ++i) {
+					lower_[i] = std::max(lower_[i], lowest_[i]);
+					upper_[i] = std::min(upper_[i], highest_[i]);
+					empty     = empty || upper_[i] < lower_[i];
+				}
+				if (!empty) {
+					offsets_      = lower_;
+					in_partition_ = true;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		CoordinateArray                lower_bounds_;
+		CoordinateArray                upper_bounds_;
+		CoordinateArray                origin_;
+		CoordinateType                 radius_     = std::numeric_limits<CoordinateType>::max();
+		bool                           has_radius_ = false;
+		QuantizedCoordinateType        center_;
+		Offsets                        lowest_{};  // the box, in cells from the center
+		Offsets                        highest_{};
+		QuantizedCoordinateIntegerType last_ring_ = 0;
+		QuantizedCoordinateIntegerType ring_      = 0;
+		size_t                         partition_ = 0;
+		Offsets                        lower_{}; // the current face, clipped to the box
+		Offsets                        upper_{};
+		Offsets                        offsets_{};
+		bool                           in_partition_ = false;
+		size_t                         probes_       = 0;
+	};
+
+	/**
+	 * Continues a bounding box query, nearest cells first, within a budget.
+	 *
+	 * @param locationHash The LocationHash to query. Must not be modified between calls for the same cursor.
+	 * @param cursor Where the query stopped; advanced by this call.
+	 * @param budget The work allowed for this call.
+	 * @param result Receives the objects within the box found by this call.
+	 * @return True once the query is complete.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType>
+	bool query_bounding_box(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                        QueryCursor<Precision, CoordinateType, Dimensions> & cursor, const QueryBudget & budget,
+	                        std::vector<ObjectType *> & result)
+	{
+		result.clear();
+		return cursor.resume(
+		    [&](const auto & key) { return locationHash.find(key); }, budget,
+		    [&](const auto &, const auto & bucket) {
+			    for (const auto & [coordinates, object] : bucket) {
+				    if (detail::within_bounds(coordinates, cursor.lower_bounds(), cursor.upper_bounds())) {
+					    result.push_back(object);
+				    }
+			    }
+		    });
+	}
+
+	/**
+	 * Continues a distance query, nearest cells first, within a budget. The cursor must come from
+	 * QueryCursor::around; a box cursor has no radius and throws std::invalid_argument.
+	 *
+	 * @param locationHash The LocationHash to query. Must not be modified between calls for the same cursor.
+	 * @param cursor Where the query stopped; advanced by this call.
+	 * @param budget The work allowed for this call.
+	 * @param result Receives the objects within the distance found by this call.
+	 * @return True once the query is complete.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType>
+	bool query_within_distance(const LocationHash<Precision, CoordinateType, Dimensions, ObjectType> & locationHash,
+	                           QueryCursor<Precision, CoordinateType, Dimensions> & cursor, const QueryBudget & budget,
+	                           std::vector<ObjectType *> & result)
+	{
+		if (!cursor.has_radius()) {
+			throw std::invalid_argument("query_within_distance needs a cursor from QueryCursor::around");
+		}
+		const CoordinateType radius_squared = cursor.radius() * cursor.radius();
+		result.clear();
+		return cursor.resume(
+		    [&](const auto & key) { return locationHash.find(key); }, budget,
+		    [&](const auto &, const auto & bucket) {
+			    for (const auto & [coordinates, object] : bucket) {
+				    if (calculate_distance_squared<CoordinateType, Dimensions>(coordinates, cursor.origin()) <=
+				        radius_squared) {
+					    result.push_back(object);
+				    }
+			    }
+		    });
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_query_resumable_hpp
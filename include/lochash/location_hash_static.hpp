@@ -0,0 +1,239 @@
+#ifndef _INCLUDED_location_hash_static_hpp
+#define _INCLUDED_location_hash_static_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <algorithm>
+#include <array>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief An immutable, fixed-capacity LocationHash that can be built at compile time.
+	 *
+	 * Level data such as spawn points and waypoints is known when the game is built. Declared as a
+	 * `static constexpr` object, a StaticLocationHash is quantized, sorted and bucketed by the compiler and lands in
+	 * read-only data, so there is nothing to build at startup and no heap use. It can also be built at run time from
+	 * the same entries.
+	 *
+	 * Entries are stored sorted by bucket key, with a parallel table of the occupied cells. Finding a bucket is a
+	 * binary search over the cells instead of a hash lookup. Within a bucket, entries keep the order they were given
+	 * in, as LocationHash keeps insertion order.
+	 *
+	 * Objects are referenced by pointer, so for a constexpr index they must have static storage duration, for
+	 * example elements of a `static constexpr` array. Use a const ObjectType for those.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated objects.
+	 * @tparam Capacity The number of entries.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class StaticLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using Entry                             = std::pair<CoordinateArray, ObjectType *>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		/**
+		 * @brief An occupied bucket: its key and the range of entries_ it holds.
+		 */
+		struct Cell {
+			QuantizedCoordinateType key;
+			size_t                  first = 0;
+			size_t                  count = 0;
+		};
+
+		/**
+		 * @brief Buckets the entries.
+		 *
+		 * @param entries Coordinates and associated objects, in any order.
+		 */
+		constexpr explicit StaticLocationHash(const std::array<Entry, Capacity> & entries)
+		{
+			// Sort positions by key, and by position within a key so buckets keep the given order.
+			std::array<QuantizedCoordinateType, Capacity> keys{};
+			std::array<size_t, Capacity>                  order{};
+			for (size_t i = 0; i < Capacity; ++i) {
+				keys[i]  = QuantizedCoordinateType(entries[i].first);
+				order[i] = i;
+			}
+			std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+				return keys[a] < keys[b] || (!(keys[b] < keys[a]) && a < b);
+			});
+
+			for (size_t i = 0; i < Capacity; ++i) {
+				entries_[i] = entries[order[i]];
+				if (cell_count_ == 0 || cells_[cell_count_ - 1].key < keys[order[i]]) {
+					cells_[cell_count_++] = Cell{keys[order[i]], i, 0};
+				}
+				++cells_[cell_count_ - 1].count;
+			}
+		}
+
+		/**
+		 * @brief Finds the bucket with the given key.
+		 *
+		 * @return The entries in the bucket, or an empty span if it is not occupied.
+		 */
+		constexpr std::span<const Entry> find(const QuantizedCoordinateType & key) const
+		{
+			const auto end = cells_.begin() + static_cast<ptrdiff_t>(cell_count_);
+			const auto it  = std::lower_bound(cells_.begin(), end, key,
+			                                  [](const Cell & cell, const QuantizedCoordinateType & value) {
+				                                  return cell.key < value;
+			                                  });
+			if (it == end || key < it->key) {
+				return {};
+			}
+			return std::span<const Entry>(entries_.data() + it->first, it->count);
+		}
+
+		/**
+		 * @brief Retrieves all coordinates and associated objects within a certain bucket, like
+		 * LocationHash::query.
+		 *
+		 * @param coordinates Coordinates that determine the bucket.
+		 */
+		constexpr std::span<const Entry> query(const CoordinateArray & coordinates) const
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Every entry, ordered by bucket.
+		 */
+		constexpr std::span<const Entry> entries() const { return entries_; }
+
+		/**
+		 * @brief The occupied buckets, ordered by key.
+		 */
+		constexpr std::span<const Cell> cells() const { return std::span<const Cell>(cells_.data(), cell_count_); }
+
+		constexpr size_t size() const { return Capacity; }
+
+		constexpr bool empty() const { return Capacity == 0; }
+
+		constexpr size_t cell_count() const { return cell_count_; }
+
+	  private:
+		std::array<Entry, Capacity> entries_{};
+		std::array<Cell, Capacity>  cells_{};
+		size_t                      cell_count_ = 0;
+	};
+
+	/**
+	 * Query objects within a bounding box of a StaticLocationHash.
+	 *
+	 * @param locationHash The StaticLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(const StaticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, Capacity,
+	                                                 QuantizedCoordinateIntegerType> & locationHash,
+	                        const std::array<CoordinateType, Dimensions> &            lower_bounds,
+	                        const std::array<CoordinateType, Dimensions> &            upper_bounds,
+	                        std::vector<ObjectType *> &                               result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a bounding box of a StaticLocationHash.
+	 *
+	 * @return A vector of pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *>
+	query_bounding_box(const StaticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, Capacity,
+	                                            QuantizedCoordinateIntegerType> & locationHash,
+	                   const std::array<CoordinateType, Dimensions> & lower_bounds,
+	                   const std::array<CoordinateType, Dimensions> & upper_bounds)
+	{
+		std::vector<ObjectType *> result;
+		query_bounding_box(locationHash, lower_bounds, upper_bounds, result);
+		return result;
+	}
+
+	/**
+	 * Query objects within a distance of a point in a StaticLocationHash.
+	 *
+	 * @param locationHash The StaticLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(const StaticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, Capacity,
+	                                                    QuantizedCoordinateIntegerType> & locationHash,
+	                           const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	                           std::vector<ObjectType *> & result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a StaticLocationHash.
+	 *
+	 * @return A vector of pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *>
+	query_within_distance(const StaticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, Capacity,
+	                                               QuantizedCoordinateIntegerType> & locationHash,
+	                      const std::array<CoordinateType, Dimensions> & center, CoordinateType radius)
+	{
+		std::vector<ObjectType *> result;
+		query_within_distance(locationHash, center, radius, result);
+		return result;
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a StaticLocationHash, nearest first. See query_nearest for
+	 * LocationHash.
+	 *
+	 * @param locationHash The StaticLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, size_t Capacity,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *>
+	query_nearest(const StaticLocationHash<Precision, CoordinateType, Dimensions, ObjectType, Capacity,
+	                                       QuantizedCoordinateIntegerType> & locationHash,
+	              const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) {
+			    for (const auto & cell : locationHash.cells()) {
+				    visitor(cell.key, locationHash.entries().subspan(cell.first, cell.count));
+			    }
+		    },
+		    locationHash.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_static_hpp
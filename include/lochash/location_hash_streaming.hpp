@@ -0,0 +1,428 @@
+#ifndef _INCLUDED_location_hash_streaming_hpp
+#define _INCLUDED_location_hash_streaming_hpp
+
+#include "location_hash.hpp"
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief The contents of a region of a LocationHash in a form that can be written to a file. Object pointers
+	 * do not survive a save and load, so each object is stored as an Id produced by a caller-supplied serializer
+	 * and turned back into a pointer by a resolver on the way in.
+	 *
+	 * The file is a fixed header followed by the cell keys with their entry counts, then every entry. Files are
+	 * only portable between machines of the same endianness.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam Id What an object is stored as. Must be trivially copyable.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename Id,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	struct RegionSnapshot {
+		static_assert(std::is_trivially_copyable<Id>::value, "Id is stored as raw bytes.");
+
+		struct Cell {
+			std::array<QuantizedCoordinateIntegerType, Dimensions> key;
+			uint64_t                                               count;
+		};
+
+		struct Entry {
+			std::array<CoordinateType, Dimensions> coordinates;
+			Id                                     id;
+		};
+
+		/**
+		 * @brief Where the entries of one cell went when the snapshot was decoded into buckets, so their objects
+		 * can be resolved later.
+		 */
+		template <typename BucketContent>
+		struct DecodedCell {
+			BucketContent * bucket;
+			size_t          first;
+		};
+
+		std::vector<Cell>  cells;
+		std::vector<Entry> entries; // grouped by cell, in the order of cells
+
+		/**
+		 * @brief Encodes buckets, typically ones returned by LocationHash::unload_region.
+		 *
+		 * @param buckets The buckets to encode.
+		 * @param serializer Called as serializer(object) for each entry, returning its Id.
+		 */
+		template <typename CoordinateMap, typename Serializer>
+		static RegionSnapshot capture(const CoordinateMap & buckets, Serializer && serializer)
+		{
+			RegionSnapshot snapshot;
+			snapshot.cells.reserve(buckets.size());
+			for (const auto & [key, bucket] : buckets) {
+				snapshot.cells.push_back(Cell{key.quantized_, bucket.size()});
+				for (const auto & [coordinates, object] : bucket) {
+					snapshot.entries.push_back(Entry{coordinates, serializer(object)});
+				}
+			}
+			return snapshot;
+		}
+
+		/**
+		 * @brief Writes the snapshot to path. The data is written to a temporary file which then replaces path,
+		 * so a reader never sees a partly written region.
+		 *
+		 * @throws std::system_error if the file cannot be written.
+		 */
+		void save(const std::string & path) const
+		{
+			const std::string temporary = path + ".partial";
+			{
+				std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+				FileHeader    header  = expected_header();
+				header.cell_count     = cells.size();
+				header.entry_count    = entries.size();
+				out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+				out.write(reinterpret_cast<const char *>(cells.data()),
+				          static_cast<std::streamsize>(cells.size() * sizeof(Cell)));
+				out.write(reinterpret_cast<const char *>(entries.data()),
+				          static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+				out.flush();
+				if (!out) {
+					throw std::system_error(std::make_error_code(std::errc::io_error), "unable to write " + temporary);
+				}
+			}
+			std::filesystem::rename(temporary, path);
+		}
+
+		/**
+		 * @brief Reads a snapshot written by save().
+		 *
+		 * @throws std::system_error if the file cannot be read, or holds a snapshot of a different type.
+		 */
+		static RegionSnapshot read(const std::string & path)
+		{
+			std::ifstream in(path, std::ios::binary);
+			if (!in) {
+				throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory),
+				                        "unable to open " + path);
+			}
+			FileHeader       header{};
+			const FileHeader expected = expected_header();
+			in.read(reinterpret_cast<char *>(&header), sizeof(header));
+			if (!in || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+			    header.version != expected.version || header.dimensions != expected.dimensions ||
+			    header.precision != expected.precision || header.cell_bytes != expected.cell_bytes ||
+			    header.entry_bytes != expected.entry_bytes) {
+				throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+				                        path + " does not hold a matching RegionSnapshot");
+			}
+
+			// checked before allocating, so a damaged count cannot ask for more memory than the file could fill
+			if (std::filesystem::file_size(path) !=
+			    sizeof(FileHeader) + header.cell_count * sizeof(Cell) + header.entry_count * sizeof(Entry)) {
+				throw std::system_error(std::make_error_code(std::errc::io_error), path + " is truncated");
+			}
+
+			RegionSnapshot snapshot;
+			snapshot.cells.resize(header.cell_count);
+			snapshot.entries.resize(header.entry_count);
+			in.read(reinterpret_cast<char *>(snapshot.cells.data()),
+			        static_cast<std::streamsize>(snapshot.cells.size() * sizeof(Cell)));
+			in.read(reinterpret_cast<char *>(snapshot.entries.data()),
+			        static_cast<std::streamsize>(snapshot.entries.size() * sizeof(Entry)));
+			uint64_t counted = 0;
+			for (const auto & cell : snapshot.cells) {
+				counted += cell.count;
+			}
+			if (!in || counted != header.entry_count) {
+				throw std::system_error(std::make_error_code(std::errc::io_error), path + " is truncated");
+			}
+			return snapshot;
+		}
+
+		/**
+		 * @brief Builds buckets for the snapshot with null objects, recording in decoded where each cell's entries
+		 * went. This is the expensive part of a load, and does not touch any LocationHash.
+		 */
+		template <typename CoordinateMap>
+		CoordinateMap decode(std::vector<DecodedCell<typename CoordinateMap::mapped_type>> & decoded) const
+		{
+			CoordinateMap buckets;
+			buckets.reserve(cells.size());
+			decoded.clear();
+			decoded.reserve(cells.size());
+			size_t next = 0;
+			for (const auto & cell : cells) {
+				typename CoordinateMap::key_type key;
+				key.quantized_ = cell.key;
+				auto & bucket  = buckets[key];
+				const auto count = static_cast<size_t>(cell.count);
+				decoded.push_back({&bucket, bucket.size()});
+				bucket.reserve(bucket.size() + count);
+				for (size_t i = 0; i < count; ++i, ++next) {
+					bucket.emplace_back(entries[next].coordinates, nullptr);
+				}
+			}
+			return buckets;
+		}
+
+		/**
+		 * @brief Fills in the objects of buckets built by decode(), calling resolver(id) for each entry.
+		 */
+		template <typename BucketContent, typename Resolver>
+		void resolve(const std::vector<DecodedCell<BucketContent>> & decoded, Resolver && resolver) const
+		{
+			size_t next = 0;
+			for (size_t c = 0; c < cells.size(); ++c) {
+				auto &     bucket = *decoded[c].bucket;
+				const auto count  = static_cast<size_t>(cells[c].count);
+				for (size_t i = 0; i < count; ++i, ++next) {
+					bucket[decoded[c].first + i].second = resolver(entries[next].id);
+				}
+			}
+		}
+
+		/**
+		 * @brief Adds the snapshot's entries to a LocationHash, calling resolver(id) for each to get its object.
+		 */
+		template <typename ObjectType, typename... Rest, typename Resolver>
+		void restore(LocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType,
+		                          Rest...> & locationHash,
+		             Resolver &&             resolver) const
+		{
+			using CoordinateMap = typename std::remove_reference_t<decltype(locationHash)>::CoordinateMap;
+			std::vector<DecodedCell<typename CoordinateMap::mapped_type>> decoded;
+			auto buckets = decode<CoordinateMap>(decoded);
+			resolve(decoded, resolver);
+			locationHash.load_region(std::move(buckets));
+		}
+
+	  private:
+		static constexpr uint32_t file_version = 1;
+
+		struct FileHeader {
+			char     magic[8];
+			uint32_t version;
+			uint32_t dimensions;
+			uint64_t precision;
+			uint64_t cell_bytes;
+			uint64_t entry_bytes;
+			uint64_t cell_count;
+			uint64_t entry_count;
+		};
+
+		static FileHeader expected_header()
+		{
+			FileHeader header{};
+			std::memcpy(header.magic, "LOCHASHR", sizeof(header.magic));
+			header.version     = file_version;
+			header.dimensions  = static_cast<uint32_t>(Dimensions);
+			header.precision   = Precision;
+			header.cell_bytes  = sizeof(Cell);
+			header.entry_bytes = sizeof(Entry);
+			return header;
+		}
+	};
+
+	/**
+	 * @brief Streams regions of a LocationHash to and from snapshot files without stalling the thread that owns
+	 * the index.
+	 *
+	 * unload_region() detaches the region's buckets (a node move per cell), encodes them and hands the write to a
+	 * loader thread. request_load() queues a file to be read and decoded into buckets on that thread, and
+	 * apply_loaded(), called from the owning thread, resolves the ids of finished loads and splices their buckets
+	 * in. The owning thread only ever does work proportional to the region, never I/O or per-entry hashing.
+	 *
+	 * Jobs run in the order they were queued, so a load queued after an unload of the same file sees the new
+	 * contents. The LocationHash itself is only touched by the calling thread.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates.
+	 * @tparam Dimensions The number of dimensions.
+	 * @tparam ObjectType The type of the objects associated with the coordinates.
+	 * @tparam Id What an object is stored as in snapshot files. Must be trivially copyable.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType, typename Id>
+	class RegionStreamer
+	{
+	  public:
+		using Index           = LocationHash<Precision, CoordinateType, Dimensions, ObjectType>;
+		using Snapshot        = RegionSnapshot<Precision, CoordinateType, Dimensions, Id>;
+		using CoordinateArray = typename Index::CoordinateArray;
+
+		RegionStreamer()
+		    : worker_([this] { run(); })
+		{
+		}
+
+		/**
+		 * @brief Finishes queued saves, abandons queued loads and stops the loader thread.
+		 */
+		~RegionStreamer()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				stopping_ = true;
+			}
+			wake_.notify_all();
+			worker_.join();
+		}
+
+		RegionStreamer(const RegionStreamer &)             = delete;
+		RegionStreamer & operator=(const RegionStreamer &) = delete;
+
+		/**
+		 * @brief Removes the cells overlapping a box from the index and saves them to path in the background. Once
+		 * this returns, the index no longer refers to the region's objects.
+		 *
+		 * @param serializer Called as serializer(object) for each entry, on this thread, returning its Id.
+		 * @return The number of entries unloaded.
+		 */
+		template <typename Serializer>
+		size_t unload_region(Index & locationHash, const CoordinateArray & lower_bounds,
+		                     const CoordinateArray & upper_bounds, const std::string & path, Serializer && serializer)
+		{
+			Job job{path, true, Snapshot::capture(locationHash.unload_region(lower_bounds, upper_bounds), serializer)};
+			const size_t entries = job.snapshot.entries.size();
+			submit(std::move(job));
+			return entries;
+		}
+
+		/**
+		 * @brief Queues path to be read and decoded in the background. Call apply_loaded() to add it to the index.
+		 */
+		void request_load(const std::string & path) { submit(Job{path, false, {}}); }
+
+		/**
+		 * @brief Adds regions whose loads have finished to the index. Errors from background saves and loads are
+		 * rethrown here, one per call, after the regions completed before them have been added.
+		 *
+		 * @param resolver Called as resolver(id) for each loaded entry, on this thread, returning its object.
+		 * @param max_regions The most regions to add, to spread large loads over several ticks.
+		 * @return The number of regions added.
+		 */
+		template <typename Resolver>
+		size_t apply_loaded(Index & locationHash, Resolver && resolver,
+		                    size_t max_regions = std::numeric_limits<size_t>::max())
+		{
+			size_t applied = 0;
+			while (applied < max_regions) {
+				Loaded loaded;
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					if (loaded_.empty()) {
+						break;
+					}
+					loaded = std::move(loaded_.front());
+					loaded_.pop_front();
+				}
+				if (loaded.error) {
+					std::rethrow_exception(loaded.error);
+				}
+				loaded.snapshot.resolve(loaded.decoded, resolver);
+				locationHash.load_region(std::move(loaded.buckets));
+				++applied;
+			}
+			return applied;
+		}
+
+		/**
+		 * @brief Blocks until the loader thread has finished every queued job.
+		 */
+		void wait_idle()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			idle_.wait(lock, [this] { return jobs_.empty() && !busy_; });
+		}
+
+	  private:
+		using CoordinateMap = typename Index::CoordinateMap;
+		using DecodedCell   = typename Snapshot::template DecodedCell<typename Index::BucketContent>;
+
+		struct Job {
+			std::string path;
+			bool        save;
+			Snapshot    snapshot;
+		};
+
+		struct Loaded {
+			Snapshot                 snapshot;
+			CoordinateMap            buckets;
+			std::vector<DecodedCell> decoded;
+			std::exception_ptr       error;
+		};
+
+		void submit(Job && job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				jobs_.push_back(std::move(job));
+			}
+			wake_.notify_one();
+		}
+
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for (;;) {
+				wake_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+				if (jobs_.empty()) {
+					return;
+				}
+				Job job = std::move(jobs_.front());
+				jobs_.pop_front();
+				if (stopping_ && !job.save) {
+					continue;
+				}
+				busy_ = true;
+				lock.unlock();
+
+				Loaded result;
+				try {
+					if (job.save) {
+						job.snapshot.save(job.path);
+					} else {
+						result.snapshot = Snapshot::read(job.path);
+						result.buckets  = result.snapshot.template decode<CoordinateMap>(result.decoded);
+					}
+				} catch (...) {
+					result.error = std::current_exception();
+				}
+
+				lock.lock();
+				if (!job.save || result.error) {
+					loaded_.push_back(std::move(result));
+				}
+				busy_ = false;
+				if (jobs_.empty()) {
+					idle_.notify_all();
+				}
+			}
+		}
+
+		std::mutex              mutex_;
+		std::condition_variable wake_;
+		std::condition_variable idle_;
+		std::deque<Job>         jobs_;
+		std::deque<Loaded>      loaded_;
+		bool                    busy_     = false;
+		bool                    stopping_ = false;
+		std::thread             worker_; // last, so it starts after the state it uses
+	};
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_streaming_hpp
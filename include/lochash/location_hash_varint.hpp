@@ -0,0 +1,106 @@
+#ifndef _INCLUDED_location_hash_varint_hpp
+#define _INCLUDED_location_hash_varint_hpp
+
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace lochash
+{
+	namespace detail
+	{
+		/**
+		 * @brief The unsigned integer type with the same size as T, for handling values of T as raw bits.
+		 */
+		template <typename T>
+		using bits_of_t = std::conditional_t<
+		    sizeof(T) == 1, uint8_t,
+		    std::conditional_t<sizeof(T) == 2, uint16_t, std::conditional_t<sizeof(T) == 4, uint32_t, uint64_t>>>;
+
+		/**
+		 * @brief Maps signed values to unsigned ones so that values near zero, of either sign, stay small.
+		 */
+		constexpr uint64_t zigzag_encode(int64_t value)
+		{
+			return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+		}
+
+		constexpr int64_t zigzag_decode(uint64_t value)
+		{
+			return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+		}
+
+		/**
+		 * @brief Appends value in LEB128 form: seven bits per byte, low bits first, high bit set on all but the
+		 * last byte.
+		 */
+		inline void append_varint(std::vector<uint8_t> & out, uint64_t value)
+		{
+			while (value >= 0x80) {
+				out.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		/**
+		 * @brief Reads a value written by append_varint and advances in past it.
+		 */
+		inline uint64_t read_varint(const uint8_t *& in)
+		{
+			uint64_t value = 0;
+			for (unsigned shift = 0;; shift += 7) {
+				const uint8_t byte = *in++;
+				value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+		}
+
+		/**
+		 * @brief The difference between two values of T, zigzag encoded: the difference of their bit patterns, so
+		 * it is exact for any T, including floating point, and small when the values are close.
+		 */
+		template <typename T>
+		uint64_t encode_delta(T value, T previous)
+		{
+			using Bits       = bits_of_t<T>;
+			const auto delta = static_cast<Bits>(std::bit_cast<Bits>(value) - std::bit_cast<Bits>(previous));
+			return zigzag_encode(static_cast<std::make_signed_t<Bits>>(delta));
+		}
+
+		/**
+		 * @brief The value a difference returned by encode_delta was taken from.
+		 */
+		template <typename T>
+		T decode_delta(uint64_t encoded, T previous)
+		{
+			using Bits       = bits_of_t<T>;
+			const auto delta = static_cast<Bits>(zigzag_decode(encoded));
+			return std::bit_cast<T>(static_cast<Bits>(std::bit_cast<Bits>(previous) + delta));
+		}
+
+		/**
+		 * @brief Appends the difference between two values of T, as a varint of encode_delta. Short when the
+		 * values are close.
+		 */
+		template <typename T>
+		void append_delta(std::vector<uint8_t> & out, T value, T previous)
+		{
+			append_varint(out, encode_delta(value, previous));
+		}
+
+		/**
+		 * @brief Reads a difference written by append_delta and returns the value it was taken from.
+		 */
+		template <typename T>
+		T read_delta(const uint8_t *& in, T previous)
+		{
+			return decode_delta(read_varint(in), previous);
+		}
+	} // namespace detail
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_varint_hpp
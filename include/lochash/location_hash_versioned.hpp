@@ -0,0 +1,408 @@
+#ifndef _INCLUDED_location_hash_versioned_hpp
+#define _INCLUDED_location_hash_versioned_hpp
+
+#include "location_hash_query_bounding_box.hpp"
+#include "location_hash_query_distance_squared.hpp"
+#include "location_hash_query_nearest.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace lochash
+{
+	/**
+	 * @brief A LocationHash whose copies share structure, so keeping old versions for rollback is cheap. Copying
+	 * or assigning one is O(1), and a modification copies only the bucket it touches and the path of trie nodes
+	 * above it. Memory is proportional to the index plus the changes between the versions that are kept.
+	 *
+	 * Cells live in a hash array mapped trie: each node branches 32 ways on the next five bits of the key's hash,
+	 * and holds either buckets or child nodes in dense arrays indexed by a bitmap. Nodes and buckets are reference
+	 * counted. One that is referenced only by the version being modified is changed in place, so an index with no
+	 * live copies runs without copying at all.
+	 *
+	 * @code
+	 * std::deque<VersionedLocationHash<...>> history;
+	 * history.push_back(world);       // every tick, O(1)
+	 * world = history[history.size() - 1 - ticks_back]; // rollback, O(1)
+	 * @endcode
+	 *
+	 * Not thread safe, and copies must not be modified on different threads, since they share nodes.
+	 *
+	 * @tparam Precision The precision value for quantization. Must be a power of two.
+	 * @tparam CoordinateType The type of the coordinates. Must be an arithmetic type.
+	 * @tparam Dimensions The number of dimensions for the coordinates.
+	 * @tparam ObjectType The type of the associated object.
+	 * @tparam QuantizedCoordinateIntegerType The integer type of the bucket keys.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType = int64_t>
+	class VersionedLocationHash
+	{
+		static_assert((Precision & (Precision - 1)) == 0, "Precision must be a power of two");
+		static_assert(std::is_arithmetic<CoordinateType>::value, "CoordinateType must be an arithmetic type.");
+
+	  public:
+		static constexpr size_t dimension_count = Dimensions;
+		using CoordinateArray                   = std::array<CoordinateType, Dimensions>;
+		using Entry                             = std::pair<CoordinateArray, ObjectType *>;
+		using BucketContent                     = std::vector<Entry>;
+		using QuantizedCoordinateType =
+		    QuantizedCoordinate<Precision, CoordinateType, Dimensions, QuantizedCoordinateIntegerType>;
+
+		void add(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			edit(root_, mix(key), key, 0)->emplace_back(coordinates, object);
+			++size_;
+		}
+
+		/**
+		 * @brief Removes object from the bucket containing coordinates.
+		 *
+		 * @return True if an entry was removed.
+		 */
+		bool remove(ObjectType * object, const CoordinateArray & coordinates)
+		{
+			const QuantizedCoordinateType key(coordinates);
+			const uint64_t                hash = mix(key);
+			if (!contains(find_bucket(hash, key), object)) {
+				return false; // checked first, so a miss does not copy anything
+			}
+			auto & bucket = *edit(root_, hash, key, 0);
+			bucket.erase(std::find_if(bucket.begin(), bucket.end(),
+			                          [&](const Entry & entry) { return entry.second == object; }));
+			--size_;
+			if (bucket.empty()) {
+				erase(*root_, hash, key, 0);
+			}
+			return true;
+		}
+
+		/**
+		 * @brief Moves an object. Unlike LocationHash::move, a move within a bucket updates the stored coordinates.
+		 *
+		 * @return True if the object was found and moved.
+		 */
+		bool move(ObjectType * object, const CoordinateArray & old_coordinates, const CoordinateArray & new_coordinates)
+		{
+			const QuantizedCoordinateType old_key(old_coordinates);
+			if (old_key == QuantizedCoordinateType(new_coordinates)) {
+				const uint64_t hash = mix(old_key);
+				if (!contains(find_bucket(hash, old_key), object)) {
+					return false;
+				}
+				for (auto & entry : *edit(root_, hash, old_key, 0)) {
+					if (entry.second == object) {
+						entry.first = new_coordinates;
+						break;
+					}
+				}
+				return true;
+			}
+			if (!remove(object, old_coordinates)) {
+				return false;
+			}
+			add(object, new_coordinates);
+			return true;
+		}
+
+		/**
+		 * @brief The entries of a bucket, empty if the cell is not occupied. The span is valid until this version
+		 * is next modified or destroyed.
+		 */
+		std::span<const Entry> find(const QuantizedCoordinateType & key) const
+		{
+			const BucketContent * bucket = find_bucket(mix(key), key);
+			return bucket != nullptr ? std::span<const Entry>(*bucket) : std::span<const Entry>();
+		}
+
+		/**
+		 * @brief The entries of the bucket containing coordinates. See find().
+		 */
+		std::span<const Entry> query(const CoordinateArray & coordinates) const
+		{
+			return find(QuantizedCoordinateType(coordinates));
+		}
+
+		/**
+		 * @brief Visits every occupied cell as visitor(key, bucket), in no particular order.
+		 */
+		template <typename Visitor>
+		void for_each_bucket(Visitor && visitor) const
+		{
+			if (root_) {
+				visit(*root_, visitor);
+			}
+		}
+
+		size_t size() const { return size_; }
+
+		bool empty() const { return size_ == 0; }
+
+		size_t cell_count() const { return cell_count_; }
+
+		/**
+		 * @brief True if the two versions share the same root, i.e. one is an unmodified copy of the other.
+		 */
+		bool shares_root_with(const VersionedLocationHash & other) const { return root_ == other.root_; }
+
+		void clear()
+		{
+			root_.reset();
+			size_       = 0;
+			cell_count_ = 0;
+		}
+
+	  private:
+		struct Node;
+		using NodePtr   = std::shared_ptr<Node>;
+		using BucketPtr = std::shared_ptr<BucketContent>;
+
+		static constexpr unsigned bits_per_level = 5;
+		static constexpr unsigned hash_bits      = 64; // at or past this shift, nodes hold a plain list of leaves
+
+		struct Leaf {
+			QuantizedCoordinateType key;
+			uint64_t                hash;
+			BucketPtr               bucket;
+		};
+
+		struct Node {
+			uint32_t             leaf_map = 0; // branches holding a leaf
+			uint32_t             node_map = 0; // branches holding a child node
+			std::vector<Leaf>    leaves;       // in branch order
+			std::vector<NodePtr> nodes;        // in branch order
+		};
+
+		// std::hash of a key mixes its coordinates only lightly, so finish it with the splitmix64 finalizer to
+		// spread it over all the bits the trie branches on.
+		static uint64_t mix(const QuantizedCoordinateType & key)
+		{
+			uint64_t hash = static_cast<uint64_t>(std::hash<QuantizedCoordinateType>()(key));
+			hash          = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			hash          = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+			return hash ^ (hash >> 31);
+		}
+
+		static uint32_t branch_bit(uint64_t hash, unsigned shift) { return uint32_t(1) << ((hash >> shift) & 31); }
+
+		static size_t index_of(uint32_t map, uint32_t bit)
+		{
+			return static_cast<size_t>(std::popcount(map & (bit - 1)));
+		}
+
+		static bool contains(const BucketContent * bucket, const ObjectType * object)
+		{
+			return bucket != nullptr && std::any_of(bucket->begin(), bucket->end(),
+			                                        [&](const Entry & entry) { return entry.second == object; });
+		}
+
+		const BucketContent * find_bucket(uint64_t hash, const QuantizedCoordinateType & key) const
+		{
+			const Node * node = root_.get();
+			for (unsigned shift = 0; node != nullptr; shift += bits_per_level) {
+				if (shift >= hash_bits) {
+					for (const auto & leaf : node->leaves) {
+						if (leaf.key == key) {
+							return leaf.bucket.get();
+						}
+					}
+					return nullptr;
+				}
+				const uint32_t bit = branch_bit(hash, shift);
+				if ((node->leaf_map & bit) != 0) {
+					const Leaf & leaf = node->leaves[index_of(node->leaf_map, bit)];
+					return leaf.key == key ? leaf.bucket.get() : nullptr;
+				}
+				node = (node->node_map & bit) != 0 ? node->nodes[index_of(node->node_map, bit)].get() : nullptr;
+			}
+			return nullptr;
+		}
+
+		// Makes slot point to a node only this version references, copying it if it is shared.
+		static Node & own(NodePtr & slot)
+		{
+			if (!slot) {
+				slot = std::make_shared<Node>();
+			} else if (slot.use_count() > 1) {
+				slot = std::make_shared<Node>(*slot);
+			}
+			return *slot;
+		}
+
+		static BucketContent * own(Leaf & leaf)
+		{
+			if (leaf.bucket.use_count() > 1) {
+				leaf.bucket = std::make_shared<BucketContent>(*leaf.bucket);
+			}
+			return leaf.bucket.get();
+		}
+
+		static void insert_leaf(Node & node, Leaf && leaf, unsigned shift)
+		{
+			if (shift >= hash_bits) {
+				node.leaves.push_back(std::move(leaf));
+				return;
+			}
+			const uint32_t bit = branch_bit(leaf.hash, shift);
+			node.leaves.insert(node.leaves.begin() + static_cast<std::ptrdiff_t>(index_of(node.leaf_map, bit)),
+			                   std::move(leaf));
+			node.leaf_map |= bit;
+		}
+
+		// The bucket for key, owned by this version and created if missing, copying the path to it as needed.
+		BucketContent * edit(NodePtr & slot, uint64_t hash, const QuantizedCoordinateType & key, unsigned shift)
+		{
+			Node & node = own(slot);
+			if (shift >= hash_bits) {
+				for (auto & leaf : node.leaves) {
+					if (leaf.key == key) {
+						return own(leaf);
+					}
+				}
+				node.leaves.push_back(Leaf{key, hash, std::make_shared<BucketContent>()});
+				++cell_count_;
+				return node.leaves.back().bucket.get();
+			}
+
+			const uint32_t bit = branch_bit(hash, shift);
+			if ((node.node_map & bit) != 0) {
+				return edit(node.nodes[index_of(node.node_map, bit)], hash, key, shift + bits_per_level);
+			}
+			if ((node.leaf_map & bit) == 0) {
+				insert_leaf(node, Leaf{key, hash, std::make_shared<BucketContent>()}, shift);
+				++cell_count_;
+				return node.leaves[index_of(node.leaf_map, bit)].bucket.get();
+			}
+
+			const size_t leaf_index = index_of(node.leaf_map, bit);
+			if (node.leaves[leaf_index].key == key) {
+				return own(node.leaves[leaf_index]);
+			}
+			// another key on the same branch: push the existing leaf down into a new child node
+			auto child = std::make_shared<Node>();
+			insert_leaf(*child, std::move(node.leaves[leaf_index]), shift + bits_per_level);
+			node.leaves.erase(node.leaves.begin() + static_cast<std::ptrdiff_t>(leaf_index));
+			node.leaf_map &= ~bit;
+			const size_t node_index = index_of(node.node_map, bit);
+			node.nodes.insert(node.nodes.begin() + static_cast<std::ptrdiff_t>(node_index), std::move(child));
+			node.node_map |= bit;
+			return edit(node.nodes[node_index], hash, key, shift + bits_per_level);
+		}
+
+		// Removes the leaf for key from below node, whose path edit() has already made owned. Child nodes left
+		// with a single leaf are folded back into their parent, so the trie stays as shallow as its keys need.
+		void erase(Node & node, uint64_t hash, const QuantizedCoordinateType & key, unsigned shift)
+		{
+			if (shift >= hash_bits) {
+				node.leaves.erase(std::find_if(node.leaves.begin(), node.leaves.end(),
+				                               [&](const Leaf & leaf) { return leaf.key == key; }));
+				--cell_count_;
+				return;
+			}
+
+			const uint32_t bit = branch_bit(hash, shift);
+			if ((node.leaf_map & bit) != 0) {
+				node.leaves.erase(node.leaves.begin() + static_cast<std::ptrdiff_t>(index_of(node.leaf_map, bit)));
+				node.leaf_map &= ~bit;
+				--cell_count_;
+				return;
+			}
+
+			const size_t node_index = index_of(node.node_map, bit);
+			Node &       child      = *node.nodes[node_index];
+			erase(child, hash, key, shift + bits_per_level);
+			if (child.nodes.empty() && child.leaves.size() <= 1) {
+				std::vector<Leaf> remaining = std::move(child.leaves);
+				node.nodes.erase(node.nodes.begin() + static_cast<std::ptrdiff_t>(node_index));
+				node.node_map &= ~bit;
+				for (auto & leaf : remaining) {
+					insert_leaf(node, std::move(leaf), shift);
+				}
+			}
+		}
+
+		template <typename Visitor>
+		static void visit(const Node & node, Visitor & visitor)
+		{
+			for (const auto & leaf : node.leaves) {
+				visitor(leaf.key, static_cast<const BucketContent &>(*leaf.bucket));
+			}
+			for (const auto & child : node.nodes) {
+				visit(*child, visitor);
+			}
+		}
+
+		NodePtr root_;
+		size_t  size_       = 0;
+		size_t  cell_count_ = 0;
+	};
+
+	/**
+	 * Query objects within a bounding box in a VersionedLocationHash.
+	 *
+	 * @param locationHash The VersionedLocationHash to query.
+	 * @param lower_bounds The lower bounds of the bounding box.
+	 * @param upper_bounds The upper bounds of the bounding box.
+	 * @param result Receives pointers to objects within the bounding box.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_bounding_box(
+	    const VersionedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & lower_bounds,
+	    const std::array<CoordinateType, Dimensions> & upper_bounds, std::vector<ObjectType *> & result)
+	{
+		detail::query_bounding_box<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, lower_bounds, upper_bounds, result);
+	}
+
+	/**
+	 * Query objects within a distance of a point in a VersionedLocationHash.
+	 *
+	 * @param locationHash The VersionedLocationHash to query.
+	 * @param center The center point to calculate distance from.
+	 * @param radius The distance from the center point.
+	 * @param result Receives pointers to objects within the specified distance.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	void query_within_distance(
+	    const VersionedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, CoordinateType radius,
+	    std::vector<ObjectType *> &                    result)
+	{
+		detail::query_within_distance<Precision, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); }, center, radius, result);
+	}
+
+	/**
+	 * Query the k objects nearest to a point in a VersionedLocationHash, nearest first. See query_nearest for
+	 * LocationHash.
+	 *
+	 * @param locationHash The VersionedLocationHash to query.
+	 * @param center The point to measure distance from.
+	 * @param k The maximum number of objects to return.
+	 * @return A vector of pointers to the nearest objects, ordered nearest first.
+	 */
+	template <size_t Precision, typename CoordinateType, size_t Dimensions, typename ObjectType,
+	          typename QuantizedCoordinateIntegerType>
+	std::vector<ObjectType *> query_nearest(
+	    const VersionedLocationHash<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType> &
+	                                                   locationHash,
+	    const std::array<CoordinateType, Dimensions> & center, size_t k)
+	{
+		return detail::query_nearest<Precision, CoordinateType, Dimensions, ObjectType, QuantizedCoordinateIntegerType>(
+		    [&](const auto & key) { return locationHash.find(key); },
+		    [&](const auto & visitor) { locationHash.for_each_bucket(visitor); }, locationHash.cell_count(), center, k);
+	}
+} // namespace lochash
+
+#endif //_INCLUDED_location_hash_versioned_hpp
@@ -1,7 +1,7 @@
 #ifndef _INCLUDED_real_to_int_hpp
 #define _INCLUDED_real_to_int_hpp
 
-#include <emmintrin.h> // SSE2 intrinsics including _mm_cvtsd_si64
+#include <emmintrin.h> // SSE2 intrinsics including _mm_cvtss_si64 and _mm_cvtsd_si64
 #include <type_traits>
 
 
@@ -12,6 +12,29 @@
 #define USE_SIMD 0
 #endif
 
+/**
+ * Rounds a floating-point value to the nearest integer, ties to even, as the SSE conversions do in the default
+ * rounding mode. Used when real_to_int is evaluated at compile time, where the intrinsics are not available.
+ *
+ * @tparam RealType The floating-point type to convert from.
+ * @tparam IntType The integer type to convert to.
+ * @param value The value to convert.
+ * @return The converted integer value.
+ */
+template <typename RealType, typename IntType>
+constexpr IntType round_half_to_even(RealType value)
+{
+	const auto     truncated = static_cast<IntType>(value);
+	const RealType fraction  = value - static_cast<RealType>(truncated);
+	if (fraction > RealType(0.5) || (fraction == RealType(0.5) && (truncated & 1) != 0)) {
+		return static_cast<IntType>(truncated + 1);
+	}
+	if (fraction < RealType(-0.5) || (fraction == RealType(-0.5) && (truncated & 1) != 0)) {
+		return static_cast<IntType>(truncated - 1);
+	}
+	return truncated;
+}
+
 /**
  * Converts a floating-point value to an integer using SSE or SSE2 instructions.
  * This function is faster than using std::round or casting to an integer type.
@@ -28,11 +51,17 @@ inline constexpr IntType real_to_int(RealType value)
 
 #if USE_SIMD
 	if constexpr (std::is_floating_point_v<RealType>) {
+		if (std::is_constant_evaluated()) {
+			return round_half_to_even<RealType, IntType>(value);
+		}
 		if constexpr (std::is_same_v<RealType, float>) {
 			if constexpr (sizeof(IntType) == 4) {
 				// Convert float to int32 using SSE
 				__m128 val = _mm_set_ss(value); // Load the float into an SSE register
 				return _mm_cvtss_si32(val);     // Convert it to int32
+			} else if constexpr (sizeof(IntType) == 8) {
+				// Convert float to int64 using SSE, so values beyond the int32 range round as at compile time
+				return _mm_cvtss_si64(_mm_set_ss(value));
 			} else {
 				// Convert float to int32 using SSE, then cast to smaller or larger type
 				__m128  val  = _mm_set_ss(value);
@@ -45,7 +74,7 @@ inline constexpr IntType real_to_int(RealType value)
 				__m128d val = _mm_set_sd(value); // Load the double into an SSE2 register
 				return _mm_cvtsd_si32(val);      // Convert it to int32
 			} else if constexpr (sizeof(IntType) == 8) {
-				// Convert double to int64 using SSE2
+				// Convert double to int64 using SSE2, so values beyond the int32 range round as at compile time
 				return _mm_cvtsd_si64(_mm_set_sd(value));
 			} else {
 				// Convert double to int32 using SSE2, then cast to smaller or larger type
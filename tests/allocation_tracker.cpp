@@ -0,0 +1,90 @@
+#include "allocation_tracker.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global (non-aligned) operator new and delete so every heap allocation made through them is counted.
+// Each block carries a small header recording its size, so frees can be subtracted from the live byte count.
+
+namespace
+{
+	std::atomic<size_t> allocations{0};
+	std::atomic<size_t> deallocations{0};
+	std::atomic<size_t> bytes{0};
+	std::atomic<size_t> live_bytes{0};
+
+	// keeps the returned pointer aligned for any fundamental type
+	constexpr size_t header_size = alignof(std::max_align_t);
+
+	void * tracked_allocate(size_t size) noexcept
+	{
+		void * block = std::malloc(size + header_size);
+		if (block == nullptr) {
+			return nullptr;
+		}
+		*static_cast<size_t *>(block) = size;
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+		live_bytes.fetch_add(size, std::memory_order_relaxed);
+		return static_cast<char *>(block) + header_size;
+	}
+
+	void tracked_free(void * pointer) noexcept
+	{
+		if (pointer == nullptr) {
+			return;
+		}
+		void *       block = static_cast<char *>(pointer) - header_size;
+		const size_t size  = *static_cast<size_t *>(block);
+		deallocations.fetch_add(1, std::memory_order_relaxed);
+		live_bytes.fetch_sub(size, std::memory_order_relaxed);
+		std::free(block);
+	}
+
+	void * tracked_allocate_or_throw(size_t size)
+	{
+		void * pointer = tracked_allocate(size == 0 ? 1 : size);
+		if (pointer == nullptr) {
+			throw std::bad_alloc();
+		}
+		return pointer;
+	}
+} // namespace
+
+void * operator new(size_t size) { return tracked_allocate_or_throw(size); }
+void * operator new[](size_t size) { return tracked_allocate_or_throw(size); }
+void * operator new(size_t size, const std::nothrow_t &) noexcept { return tracked_allocate(size == 0 ? 1 : size); }
+void * operator new[](size_t size, const std::nothrow_t &) noexcept { return tracked_allocate(size == 0 ? 1 : size); }
+
+void operator delete(void * pointer) noexcept { tracked_free(pointer); }
+void operator delete[](void * pointer) noexcept { tracked_free(pointer); }
+void operator delete(void * pointer, size_t) noexcept { tracked_free(pointer); }
+void operator delete[](void * pointer, size_t) noexcept { tracked_free(pointer); }
+void operator delete(void * pointer, const std::nothrow_t &) noexcept { tracked_free(pointer); }
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept { tracked_free(pointer); }
+
+AllocationCounters current_allocation_counters()
+{
+	AllocationCounters counters;
+	counters.allocations   = allocations.load(std::memory_order_relaxed);
+	counters.deallocations = deallocations.load(std::memory_order_relaxed);
+	counters.bytes         = bytes.load(std::memory_order_relaxed);
+	counters.live_bytes    = live_bytes.load(std::memory_order_relaxed);
+	return counters;
+}
+
+AllocationScope::AllocationScope()
+    : start_(current_allocation_counters())
+{
+}
+
+AllocationCounters AllocationScope::delta() const
+{
+	const AllocationCounters now = current_allocation_counters();
+	AllocationCounters       difference;
+	difference.allocations   = now.allocations - start_.allocations;
+	difference.deallocations = now.deallocations - start_.deallocations;
+	difference.bytes         = now.bytes - start_.bytes;
+	difference.live_bytes    = now.live_bytes > start_.live_bytes ? now.live_bytes - start_.live_bytes : 0;
+	return difference;
+}
@@ -0,0 +1,48 @@
+#ifndef _INCLUDED_allocation_tracker_hpp
+#define _INCLUDED_allocation_tracker_hpp
+
+#include <cstddef>
+
+/**
+ * @brief Counters maintained by the replacement global operator new/delete in allocation_tracker.cpp.
+ *
+ * Only executables that compile allocation_tracker.cpp get the replacements, so they are kept out of the main unit
+ * test binary.
+ */
+struct AllocationCounters {
+	size_t allocations   = 0; // number of calls to operator new
+	size_t deallocations = 0; // number of calls to operator delete with a non-null pointer
+	size_t bytes         = 0; // total bytes requested from operator new
+	size_t live_bytes    = 0; // bytes currently allocated and not yet freed
+};
+
+/**
+ * @brief Snapshot of the process-wide counters.
+ */
+AllocationCounters current_allocation_counters();
+
+/**
+ * @brief Measures allocations made between construction and a call to delta().
+ *
+ * @code
+ *   AllocationScope scope;
+ *   locationHash.query({1.0f, 2.0f});
+ *   EXPECT_EQ(scope.delta().allocations, 0u);
+ * @endcode
+ */
+class AllocationScope
+{
+  public:
+	AllocationScope();
+
+	/**
+	 * @brief Allocation activity since construction. live_bytes is the net change, which saturates at zero when
+	 * more was freed than allocated.
+	 */
+	AllocationCounters delta() const;
+
+  private:
+	AllocationCounters start_;
+};
+
+#endif // _INCLUDED_allocation_tracker_hpp
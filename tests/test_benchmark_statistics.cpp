@@ -0,0 +1,159 @@
+#include "benchmark_statistics.hpp"
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+using namespace lochash::benchmarks;
+
+namespace
+{
+	// Deterministic noisy samples around center, with the occasional preempted outlier.
+	std::vector<double> noisy_samples(double center, size_t count, uint32_t seed)
+	{
+		std::mt19937                     rng(seed);
+		std::normal_distribution<double> noise(0.0, center * 0.02);
+		std::vector<double>              samples(count);
+		for (size_t i = 0; i < count; ++i) {
+			samples[i] = center + noise(rng) + (i % 10 == 9 ? center : 0.0);
+		}
+		return samples;
+	}
+} // namespace
+
+TEST(BenchmarkStatisticsTest, Median)
+{
+	EXPECT_EQ(median({}), 0.0);
+	EXPECT_EQ(median({3.0, 1.0, 2.0}), 2.0);
+	EXPECT_EQ(median({4.0, 1.0, 3.0, 2.0}), 2.5);
+}
+
+TEST(BenchmarkStatisticsTest, MannWhitneyPValue)
+{
+	// Every baseline sample is slower than every candidate sample.
+	const std::vector<double> slow = {10, 11, 12, 13, 14, 15, 16, 17};
+	const std::vector<double> fast = {1, 2, 3, 4, 5, 6, 7, 8};
+	EXPECT_LT(mann_whitney_p_value(slow, fast), 0.01);
+	EXPECT_DOUBLE_EQ(mann_whitney_p_value(slow, fast), mann_whitney_p_value(fast, slow));
+
+	// Interleaved values are indistinguishable.
+	const std::vector<double> odd  = {1, 3, 5, 7, 9, 11};
+	const std::vector<double> even = {2, 4, 6, 8, 10, 12};
+	EXPECT_GT(mann_whitney_p_value(odd, even), 0.5);
+
+	// Degenerate inputs carry no evidence.
+	EXPECT_EQ(mann_whitney_p_value({}, fast), 1.0);
+	EXPECT_EQ(mann_whitney_p_value({5, 5, 5}, {5, 5}), 1.0);
+}
+
+TEST(BenchmarkStatisticsTest, DetectsRealDifferences)
+{
+	const auto baseline = noisy_samples(100.0, 30, 1);
+
+	const auto faster = compare_samples("faster", baseline, noisy_samples(80.0, 30, 2));
+	EXPECT_EQ(faster.verdict, Verdict::faster);
+	EXPECT_NEAR(faster.speedup, 1.25, 0.05);
+	EXPECT_LT(faster.ci_low, faster.speedup);
+	EXPECT_GT(faster.ci_high, faster.speedup);
+	EXPECT_GT(faster.ci_low, 1.0);
+
+	const auto slower = compare_samples("slower", baseline, noisy_samples(120.0, 30, 3));
+	EXPECT_EQ(slower.verdict, Verdict::slower);
+	EXPECT_LT(slower.ci_high, 1.0);
+	EXPECT_EQ(std::string(to_string(slower.verdict)), "slower");
+}
+
+TEST(BenchmarkStatisticsTest, IgnoresNoiseAndSmallEffects)
+{
+	const auto baseline = noisy_samples(100.0, 30, 4);
+
+	const auto same = compare_samples("same", baseline, noisy_samples(100.0, 30, 5));
+	EXPECT_EQ(same.verdict, Verdict::no_difference);
+	EXPECT_LE(same.ci_low, 1.0);
+	EXPECT_GE(same.ci_high, 1.0);
+	EXPECT_EQ(std::string(to_string(same.verdict)), "no difference");
+
+	// Consistently faster, but by less than the minimum effect worth reporting.
+	ComparisonOptions strict;
+	strict.min_effect  = 0.5;
+	const auto shifted = compare_samples("shifted", baseline, noisy_samples(80.0, 30, 6), strict);
+	EXPECT_EQ(shifted.verdict, Verdict::no_difference);
+	EXPECT_EQ(std::string(to_string(Verdict::faster)), "faster");
+
+	// Missing or zero samples produce a neutral result rather than dividing by zero.
+	const auto empty = compare_samples("empty", baseline, {});
+	EXPECT_EQ(empty.candidate_samples, 0u);
+	EXPECT_EQ(empty.verdict, Verdict::no_difference);
+	const auto zero = compare_samples("zero", baseline, {0.0, 0.0});
+	EXPECT_EQ(zero.speedup, 1.0);
+	EXPECT_EQ(zero.verdict, Verdict::no_difference);
+}
+
+TEST(BenchmarkStatisticsTest, ReadsRunnerCsvAndPairsBenchmarks)
+{
+	const auto path = (std::filesystem::temp_directory_path() / "lochash_test_benchmark_statistics.csv").string();
+	{
+		std::ofstream csv(path);
+		csv << "name,sample,ns_per_op\n"
+		    << "query_box/location_hash/uniform/2d/500,0,12.5\n"
+		    << "query_box/location_hash/uniform/2d/500,1,13.5\n"
+		    << "build/location_hash/uniform/2d/500,0,40\n"
+		    << "malformed line\n";
+	}
+
+	SampleSet baseline;
+	ASSERT_TRUE(read_samples_csv(path, baseline));
+	ASSERT_TRUE(read_samples_csv(path, baseline)); // a second run accumulates
+	std::filesystem::remove(path);
+	EXPECT_FALSE(read_samples_csv(path, baseline));
+
+	ASSERT_EQ(baseline.size(), 2u);
+	EXPECT_EQ(baseline["query_box/location_hash/uniform/2d/500"].size(), 4u);
+	EXPECT_EQ(baseline["build/location_hash/uniform/2d/500"].size(), 2u);
+
+	SampleSet candidate;
+	candidate["build/location_hash/uniform/2d/500"] = {20, 20};
+	candidate["only/in/candidate"]                  = {1};
+
+	const auto comparisons = compare_sample_sets(baseline, candidate);
+	ASSERT_EQ(comparisons.size(), 1u);
+	EXPECT_EQ(comparisons[0].name, "build/location_hash/uniform/2d/500");
+	EXPECT_DOUBLE_EQ(comparisons[0].speedup, 2.0);
+}
+
+TEST(BenchmarkStatisticsTest, JainFairness)
+{
+	EXPECT_DOUBLE_EQ(jain_fairness({}), 1.0);
+	EXPECT_DOUBLE_EQ(jain_fairness({0, 0}), 1.0);
+	EXPECT_DOUBLE_EQ(jain_fairness({5, 5, 5, 5}), 1.0);
+	EXPECT_DOUBLE_EQ(jain_fairness({8, 0, 0, 0}), 0.25);
+}
+
+TEST(BenchmarkStatisticsTest, LatencyHistogramPercentiles)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.percentile(0.5), 0u);
+
+	// 1..1000 ns once each
+	for (uint64_t value = 1; value <= 1000; ++value) {
+		histogram.record(value);
+	}
+	EXPECT_EQ(histogram.count(), 1000u);
+	EXPECT_EQ(histogram.percentile(0.0), 1u);
+	EXPECT_EQ(histogram.percentile(0.01), 10u); // exact below 16
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 500.0, 500.0 / 16);
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.99)), 990.0, 990.0 / 16);
+	EXPECT_LE(histogram.percentile(1.0), 1000u);
+
+	// merging a slow tail moves the high percentiles only
+	LatencyHistogram tail;
+	for (size_t i = 0; i < 20; ++i) {
+		tail.record(1'000'000'000);
+	}
+	tail.record(~uint64_t{0});
+	histogram.merge(tail);
+	EXPECT_EQ(histogram.count(), 1021u);
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 510.0, 510.0 / 16);
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.999)), 1e9, 1e9 / 16);
+	EXPECT_GT(histogram.percentile(1.0), uint64_t{1} << 63);
+}
@@ -101,6 +101,61 @@ double linear_regression(const std::vector<double> & x, const std::vector<double
 	return r2;
 }
 
+bool is_constant_time(const std::vector<double> & x, const std::vector<double> & y)
+{
+	const size_t n = x.size();
+	if (n != y.size() || n < 2) {
+		return false;
+	}
+
+	const double meanX = std::accumulate(x.begin(), x.end(), 0.0) / n;
+	const double meanY = std::accumulate(y.begin(), y.end(), 0.0) / n;
+
+	double num = 0;
+	double den = 0;
+	for (size_t i = 0; i < n; ++i) {
+		const double dx = x[i] - meanX;
+		num += dx * (y[i] - meanY);
+		den += dx * dx;
+	}
+	if (den == 0 || !std::isfinite(num) || !std::isfinite(meanY) || meanY < 0) {
+		return false;
+	}
+	if (meanY == 0) {
+		return num == 0; // every time was zero
+	}
+
+	const auto [minX, maxX] = std::minmax_element(x.begin(), x.end());
+	const double growth     = (num / den) * (*maxX - *minX) / meanY;
+	return growth < constant_time_growth_tolerance;
+}
+
+double growth_exponent(const std::vector<double> & x, const std::vector<double> & y)
+{
+	if (x.size() != y.size() || x.size() < 2) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+	std::vector<double> log_x;
+	std::vector<double> log_y;
+	for (size_t i = 0; i < x.size(); ++i) {
+		if (!(x[i] > 0) || !(y[i] > 0)) {
+			return std::numeric_limits<double>::quiet_NaN();
+		}
+		log_x.push_back(std::log(x[i]));
+		log_y.push_back(std::log(y[i]));
+	}
+
+	const double meanX = std::accumulate(log_x.begin(), log_x.end(), 0.0) / log_x.size();
+	const double meanY = std::accumulate(log_y.begin(), log_y.end(), 0.0) / log_y.size();
+	double       num   = 0;
+	double       den   = 0;
+	for (size_t i = 0; i < log_x.size(); ++i) {
+		num += (log_x[i] - meanX) * (log_y[i] - meanY);
+		den += (log_x[i] - meanX) * (log_x[i] - meanX);
+	}
+	return den == 0 ? std::numeric_limits<double>::quiet_NaN() : num / den;
+}
+
 Complexity determine_complexity(const std::vector<size_t> & input_sizes, const std::vector<double> & times)
 {
 	if (input_sizes.size() != times.size() || input_sizes.empty()) {
@@ -111,10 +166,29 @@ Complexity determine_complexity(const std::vector<size_t> & input_sizes, const s
 	std::transform(input_sizes.begin(), input_sizes.end(), input_sizes_double.begin(),
 	               [](size_t val) { return static_cast<double>(val); });
 
+	// O(1) cannot be found by regression: a constant has nothing to correlate with, so its R^2 is undefined and
+	// measurement noise would "fit" some growing model instead. Classify it directly from how much the times grow
+	// across the measured range relative to their mean.
+	if (is_constant_time(input_sizes_double, times)) {
+		return Complexity::O1;
+	}
+
+	// Real measurements of sub-linear operations grow a little with size as the data outgrows the caches, and
+	// the R^2 of such a small, noisy rise does not tell O(log n) from O(n) reliably. Their growth exponent does.
+	// Faster growth, such as O(sqrt n), is not logarithmic however well a log curve happens to fit it over a short
+	// range, so once the exponent is known, only the polynomial models below remain candidates.
+	const double exponent = growth_exponent(input_sizes_double, times);
+	if (std::isfinite(exponent) && exponent < sublinear_growth_exponent) {
+		return Complexity::OLogN;
+	}
+	const bool sublinear_ruled_out = std::isfinite(exponent);
+
 	std::vector<std::pair<double, Complexity>> fits;
 
 	// O(1)
-	fits.emplace_back(linear_regression(std::vector<double>(input_sizes.size(), 1.0), times), Complexity::O1);
+	if (!sublinear_ruled_out) {
+		fits.emplace_back(linear_regression(std::vector<double>(input_sizes.size(), 1.0), times), Complexity::O1);
+	}
 
 	// O(log n)
 	std::vector<double> log_input_sizes;
@@ -126,10 +200,12 @@ Complexity determine_complexity(const std::vector<size_t> & input_sizes, const s
 		}
 		log_input_sizes.push_back(std::log2(val));
 	}
-	if (validLogX) {
-		fits.emplace_back(linear_regression(log_input_sizes, times), Complexity::OLogN);
-	} else {
-		fits.emplace_back(-std::numeric_limits<double>::infinity(), Complexity::OLogN);
+	if (!sublinear_ruled_out) {
+		if (validLogX) {
+			fits.emplace_back(linear_regression(log_input_sizes, times), Complexity::OLogN);
+		} else {
+			fits.emplace_back(-std::numeric_limits<double>::infinity(), Complexity::OLogN);
+		}
 	}
 
 	// O(n)
@@ -193,20 +269,55 @@ Complexity measure_time_complexity(const std::function<void(size_t input_size)>
                                    const std::function<void(size_t input_size)> & lambda,
                                    const std::vector<size_t> & input_sizes, size_t repetitions)
 {
-	std::vector<double> times;
-
-	// Take three measurements, record the lowest time and return that.
-	Complexity bestComplexity = Complexity::OUnknown;
-	for (size_t i = 0; i < 3; ++i) {
-		for (const auto & input_size : input_sizes) {
-			double avg_time = measure_execution_time(setup, lambda, input_size, repetitions);
-			times.push_back(avg_time);
-		}
-		Complexity complexity = determine_complexity(input_sizes, times);
-		if (complexity < bestComplexity) {
-			bestComplexity = complexity;
+	if (input_sizes.empty()) {
+		return Complexity::ERROR;
+	}
+
+	// Time every size several times, over three interleaved passes, and classify the fastest time seen for each
+	// size. Noise (scheduling, cache state, frequency changes) only ever makes an operation look slower, so the
+	// fastest run is the best estimate of its real cost, and interleaving the passes spreads any slow period over
+	// all sizes instead of a single one.
+	std::vector<double> times(input_sizes.size(), std::numeric_limits<double>::infinity());
+	for (size_t pass = 0; pass < 3; ++pass) {
+		for (size_t i = 0; i < input_sizes.size(); ++i) {
+			for (size_t repetition = 0; repetition < std::max<size_t>(1, repetitions); ++repetition) {
+				times[i] = std::min(times[i], measure_execution_time(setup, lambda, input_sizes[i], 1));
+			}
 		}
 	}
+	return determine_complexity(input_sizes, times);
+}
 
-	return bestComplexity;
+Complexity measure_time_complexity(const std::function<void(size_t input_size)> & setup,
+                                   const std::function<void(size_t input_size)> & lambda,
+                                   const std::function<void(size_t input_size)> & baseline,
+                                   const std::vector<size_t> & input_sizes, size_t repetitions)
+{
+	if (input_sizes.empty()) {
+		return Complexity::ERROR;
+	}
+
+	// Timed like the overload above, but the baseline runs right before the lambda on the same state, and the
+	// fastest time of each is kept. What the two share, such as caches missing more often in a larger index,
+	// divides out of the ratio.
+	const auto          no_setup = [](size_t) {};
+	std::vector<double> times(input_sizes.size(), std::numeric_limits<double>::infinity());
+	std::vector<double> baseline_times(input_sizes.size(), std::numeric_limits<double>::infinity());
+	for (size_t pass = 0; pass < 3; ++pass) {
+		for (size_t i = 0; i < input_sizes.size(); ++i) {
+			for (size_t repetition = 0; repetition < std::max<size_t>(1, repetitions); ++repetition) {
+				setup(input_sizes[i]);
+				baseline_times[i] =
+				    std::min(baseline_times[i], measure_execution_time(no_setup, baseline, input_sizes[i], 1));
+				times[i] = std::min(times[i], measure_execution_time(no_setup, lambda, input_sizes[i], 1));
+			}
+		}
+	}
+	for (size_t i = 0; i < times.size(); ++i) {
+		if (!(baseline_times[i] > 0)) {
+			return Complexity::ERROR;
+		}
+		times[i] /= baseline_times[i];
+	}
+	return determine_complexity(input_sizes, times);
 }
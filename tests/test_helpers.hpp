@@ -1,6 +1,11 @@
 #ifndef _INCLUDED_test_helpers_hpp
 #define _INCLUDED_test_helpers_hpp
+#include "lochash/location_hash_quantized_coordinate.hpp"
 #include "gtest/gtest.h"
+#include <array>
+#include <filesystem>
+#include <map>
+#include <string>
 #include <vector>
 
 /**
@@ -98,7 +103,130 @@ measure_time_complexity(const std::function<void(size_t input_size)> &setup,
                         const std::vector<size_t> &input_sizes,
                         size_t repetitions = 10);
 
+/**
+ * @brief Like measure_time_complexity() above, but classifies how the lambda's
+ * time grows relative to a baseline timed on the same state. With a baseline
+ * that is O(1) on the structure being measured, costs that grow with the size
+ * of the structure for both, such as cache misses, cancel out and only growth
+ * of the lambda's own work is left.
+ *
+ * @param setup Prepares the state for an input size, before each timing.
+ * @param lambda The operation to classify.
+ * @param baseline An O(1) operation on the same state, timed right before lambda.
+ * @param input_sizes The input sizes to measure.
+ * @param repetitions How many times each size is timed in each pass.
+ * @return The complexity of lambda relative to baseline, or ERROR when the
+ * baseline took no measurable time.
+ */
+Complexity
+measure_time_complexity(const std::function<void(size_t input_size)> &setup,
+                        const std::function<void(size_t input_size)> &lambda,
+                        const std::function<void(size_t input_size)> &baseline,
+                        const std::vector<size_t> &input_sizes,
+                        size_t repetitions);
+
+/**
+ * @brief A baseline for measure_time_complexity() when timing a query over a
+ * region: finds each cell of the region in the map underneath a LocationHash,
+ * without collecting anything. What the query and the baseline share, such as
+ * more cache misses in a larger map, divides out, and a query that scanned the
+ * index still shows as O(n).
+ *
+ * @param locationHash The index being queried.
+ * @param lower_bounds The lower corner of the region the query covers.
+ * @param upper_bounds The upper corner of the region the query covers.
+ * @return The number of cells found, for the caller to accumulate so the
+ * lookups are not optimised away.
+ */
+template <size_t Precision, typename CoordinateType, size_t Dimensions,
+          typename LocationHashType>
+size_t
+find_cells_in_range(const LocationHashType &locationHash,
+                    const std::array<CoordinateType, Dimensions> &lower_bounds,
+                    const std::array<CoordinateType, Dimensions> &upper_bounds) {
+  size_t found = 0;
+  lochash::for_each_quantized_coordinate_within_range<Precision, CoordinateType,
+                                                      Dimensions>(
+      lower_bounds, upper_bounds, [&](const auto &key) {
+        found += locationHash.get_data().count(key);
+      });
+  return found;
+}
+
+/**
+ * @brief A fresh path in the temp directory, removed again when the test ends.
+ */
+class TempFile {
+public:
+  explicit TempFile(const std::string &name)
+      : path_((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove(path_);
+  }
+  ~TempFile() { std::filesystem::remove(path_); }
+
+  const std::string &path() const { return path_; }
+
+private:
+  std::string path_;
+};
+
+/**
+ * @brief Every entry of a LocationHash as (object, coordinates), so two
+ * indexes can be compared regardless of bucket order.
+ */
+template <typename LocationHashType>
+auto contents_of(const LocationHashType &locationHash) {
+  using Entry = typename LocationHashType::BucketContent::value_type;
+  std::multimap<typename Entry::second_type, typename Entry::first_type>
+      contents;
+  for (const auto &[key, bucket] : locationHash.get_data()) {
+    for (const auto &[coordinates, object] : bucket) {
+      contents.emplace(object, coordinates);
+    }
+  }
+  return contents;
+}
+
 double linear_regression(const std::vector<double> &x,
                          const std::vector<double> &y);
 
+/**
+ * @brief How much measured times may grow across the whole range of input
+ * sizes, relative to their mean, and still be classified as O(1). Growth is
+ * taken from the linear fit, so single noisy samples have limited influence.
+ * An O(n) operation measured over a 16x range of sizes grows by well over 100%.
+ */
+constexpr double constant_time_growth_tolerance = 0.5;
+
+/**
+ * @brief Returns true when times do not grow meaningfully with input size.
+ *
+ * @param x Input sizes.
+ * @param y Times measured for each input size.
+ */
+bool is_constant_time(const std::vector<double> &x,
+                      const std::vector<double> &y);
+
+/**
+ * @brief Growth exponents below this are classified as O(log n) by
+ * determine_complexity, and those above it as at least polynomial. Over a 16x
+ * range of sizes, log n itself grows with an exponent of about 0.12 and
+ * sqrt(n) with 0.5, so this leaves room for noise without letting O(sqrt n)
+ * pass. Cache effects can push real O(1) operations past it; measure those
+ * against a baseline, see measure_time_complexity().
+ */
+constexpr double sublinear_growth_exponent = 0.25;
+
+/**
+ * @brief The exponent b of the best power-law fit y = a * x^b, from a linear
+ * fit of log y against log x.
+ *
+ * @param x Input sizes.
+ * @param y Times measured for each input size.
+ * @return b, or NaN when any value is not positive or there are fewer than
+ * two distinct sizes.
+ */
+double growth_exponent(const std::vector<double> &x,
+                       const std::vector<double> &y);
+
 #endif // _INCLUDED_test_helpers_hpp
@@ -132,3 +132,62 @@ TEST_F(DetermineComplexityTest, LinearRegression) {
   const auto result = linear_regression(x, y);
   EXPECT_EQ(result, -std::numeric_limits<double>::infinity());
 }
+
+TEST_F(DetermineComplexityTest, NoisyConstantTimeIsO1) {
+  // flat times with +/- 10% jitter over a 16x range of input sizes
+  std::vector<size_t> input_sizes = {1000, 2000, 4000, 8000, 16000};
+  std::vector<double> times = {1.0e-6, 1.1e-6, 0.9e-6, 1.05e-6, 0.95e-6};
+  EXPECT_EQ(determine_complexity(input_sizes, times), Complexity::O1);
+}
+
+TEST_F(DetermineComplexityTest, LinearWithOverheadIsNotO1) {
+  // a fixed cost plus a linear term still grows far beyond the tolerance
+  std::vector<size_t> input_sizes = {1000, 2000, 4000, 8000, 16000};
+  std::vector<double> times;
+  for (const auto n : input_sizes) {
+    times.push_back(1.0e-3 + static_cast<double>(n) * 1.0e-6);
+  }
+  EXPECT_GE(determine_complexity(input_sizes, times), Complexity::ON);
+}
+
+TEST_F(DetermineComplexityTest, IsConstantTimeEdgeCases) {
+  EXPECT_FALSE(is_constant_time({1.0}, {1.0}));
+  EXPECT_FALSE(is_constant_time({1.0, 2.0}, {1.0}));
+  EXPECT_FALSE(is_constant_time({2.0, 2.0}, {1.0, 3.0}));
+  EXPECT_FALSE(is_constant_time({1.0, 2.0}, {-1.0, -2.0}));
+  EXPECT_TRUE(is_constant_time({1.0, 2.0}, {0.0, 0.0}));
+  EXPECT_FALSE(is_constant_time({1.0, 2.0}, {1.0, 100.0}));
+}
+
+TEST_F(DetermineComplexityTest, LogarithmicGrowthIsOLogN) {
+  // a fixed cost per halving of the search space, too much growth for O(1)
+  std::vector<size_t> input_sizes = {1000, 2000, 4000, 8000, 16000};
+  std::vector<double> times = {1.0e-6, 1.2e-6, 1.4e-6, 1.6e-6, 1.8e-6};
+  EXPECT_EQ(determine_complexity(input_sizes, times), Complexity::OLogN);
+}
+
+TEST_F(DetermineComplexityTest, SquareRootGrowthIsNotOLogN) {
+  // a log curve fits sqrt(n), and even n^0.3, better than a line over this
+  // range, but neither is logarithmic
+  std::vector<size_t> input_sizes = {1000, 2000, 4000, 8000, 16000};
+  for (const double exponent : {0.3, 0.5}) {
+    std::vector<double> times;
+    for (const auto n : input_sizes) {
+      times.push_back(1.0e-8 * std::pow(static_cast<double>(n), exponent));
+    }
+    EXPECT_GT(determine_complexity(input_sizes, times), Complexity::OLogN)
+        << "n^" << exponent;
+  }
+}
+
+TEST_F(DetermineComplexityTest, GrowthExponent) {
+  EXPECT_NEAR(growth_exponent({1.0, 10.0, 100.0}, {2.0, 20.0, 200.0}), 1.0,
+              1e-9);
+  EXPECT_NEAR(growth_exponent({1.0, 10.0, 100.0}, {3.0, 300.0, 30000.0}),
+              2.0, 1e-9);
+  EXPECT_NEAR(growth_exponent({1.0, 10.0}, {5.0, 5.0}), 0.0, 1e-9);
+  EXPECT_TRUE(std::isnan(growth_exponent({1.0}, {1.0})));
+  EXPECT_TRUE(std::isnan(growth_exponent({1.0, 2.0}, {1.0})));
+  EXPECT_TRUE(std::isnan(growth_exponent({1.0, 2.0}, {0.0, 1.0})));
+  EXPECT_TRUE(std::isnan(growth_exponent({2.0, 2.0}, {1.0, 3.0})));
+}
@@ -83,3 +83,33 @@ TEST(MeasureTimeComplexityTest, CubicTimeComplexity)
 
 	EXPECT_LE(complexity, Complexity::O2N);
 }
+
+// No input sizes means nothing can be measured
+TEST(MeasureTimeComplexityTest, EmptyInputSizes)
+{
+	auto setup  = [](size_t) {};
+	auto lambda = [](size_t) {};
+
+	EXPECT_EQ(measure_time_complexity(setup, lambda, {}), Complexity::ERROR);
+}
+
+// Growth shared with the baseline divides out, growth of the lambda's own work does not
+TEST(MeasureTimeComplexityTest, RelativeToBaseline)
+{
+	auto setup  = [](size_t) {};
+	auto linear = [](size_t input_size) {
+		for (size_t i = 0; i < input_size; ++i) {
+			std::this_thread::yield();
+		}
+	};
+	auto constant = [](size_t) {
+		for (size_t i = 0; i < 100; ++i) {
+			std::this_thread::yield();
+		}
+	};
+
+	std::vector<size_t> input_sizes = {100, 200, 400, 800, 1600};
+	EXPECT_LE(measure_time_complexity(setup, linear, linear, input_sizes, 3), Complexity::OLogN);
+	EXPECT_GE(measure_time_complexity(setup, linear, constant, input_sizes, 3), Complexity::ON);
+	EXPECT_EQ(measure_time_complexity(setup, linear, constant, {}, 3), Complexity::ERROR);
+}
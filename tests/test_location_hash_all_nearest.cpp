@@ -0,0 +1,100 @@
+#include "lochash/location_hash_all_nearest.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Grid                 = CellGrid<precision, float, 2, Entity>;
+
+	// Checks each entry's neighbours against the sorted distances to every other entry.
+	template <typename GridType, typename Result>
+	void expect_nearest(const GridType & grid, const Result & result, size_t k)
+	{
+		ASSERT_EQ(result.found.size(), grid.size());
+		for (size_t i = 0; i < grid.size(); ++i) {
+			std::vector<typename GridType::CoordinateArray::value_type> distances;
+			for (size_t j = 0; j < grid.size(); ++j) {
+				if (j != i) {
+					distances.push_back(calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)));
+				}
+			}
+			std::sort(distances.begin(), distances.end());
+			distances.resize(std::min(k, distances.size()));
+
+			const auto neighbors = result.neighbors(i);
+			const auto found     = result.distances_squared(i);
+			ASSERT_EQ(found.size(), distances.size());
+			EXPECT_TRUE(std::equal(found.begin(), found.end(), distances.begin()));
+			EXPECT_EQ(std::set<size_t>(neighbors.begin(), neighbors.end()).size(), neighbors.size());
+			for (size_t n = 0; n < neighbors.size(); ++n) {
+				EXPECT_NE(neighbors[n], i);
+				EXPECT_EQ(calculate_distance_squared(grid.coordinates(i), grid.coordinates(neighbors[n])), found[n]);
+			}
+		}
+	}
+} // namespace
+
+TEST(AllNearestNeighborsTest, MatchesAScanOfEveryEntry)
+{
+	std::vector<Entity>                   entities(1200);
+	std::mt19937                          rng(59);
+	std::uniform_real_distribution<float> coordinate(-300.0f, 300.0f);
+	std::normal_distribution<float>       around(0.0f, 5.0f);
+	Index                                 locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		// a dense patch, sparse surroundings and a few outliers far away from everything
+		const std::array<float, 2> position = i % 3 == 0    ? std::array<float, 2>{around(rng), around(rng)}
+		                                      : i % 200 == 1 ? std::array<float, 2>{coordinate(rng) * 40.0f, 9000.0f}
+		                                                     : std::array<float, 2>{coordinate(rng), coordinate(rng)};
+		locationHash.add(&entities[i], position);
+	}
+	const Grid grid(locationHash);
+
+	for (const size_t k : {size_t(1), size_t(4), size_t(20)}) {
+		SCOPED_TRACE(k);
+		for (const size_t threads : {size_t(1), size_t(3)}) {
+			expect_nearest(grid, all_nearest_neighbors(grid, k, threads), k);
+		}
+	}
+
+	const auto none = all_nearest_neighbors(grid, 0);
+	EXPECT_TRUE(std::all_of(none.found.begin(), none.found.end(), [](size_t found) { return found == 0; }));
+	EXPECT_TRUE(all_nearest_neighbors(Grid{Index()}, 3).found.empty());
+}
+
+TEST(AllNearestNeighborsTest, FewerEntriesThanKAndIntegerCoordinates)
+{
+	using Index3 = LocationHash<4, int, 3, Entity>;
+	using Grid3  = CellGrid<4, int, 3, Entity>;
+	std::vector<Entity>                entities(400);
+	std::mt19937                       rng(61);
+	std::uniform_int_distribution<int> coordinate(-40, 40);
+	Index3                             locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		locationHash.add(&entities[i], {coordinate(rng), coordinate(rng), coordinate(rng)});
+	}
+	const Grid3 grid(locationHash);
+	expect_nearest(grid, all_nearest_neighbors(grid, 6, 2), 6);
+
+	// with fewer than k others every entry gets all of them
+	Index3 few;
+	for (size_t i = 0; i < 5; ++i) {
+		few.add(&entities[i], {static_cast<int>(i) * 100, 0, 0});
+	}
+	const Grid3 few_grid(few);
+	const auto  all = all_nearest_neighbors(few_grid, 10);
+	expect_nearest(few_grid, all, 10);
+	EXPECT_EQ(all.neighbors(0).size(), 4u);
+}
@@ -0,0 +1,212 @@
+#include "allocation_tracker.hpp"
+#include "lochash/location_hash_fixed.hpp"
+#include "lochash/location_hash_query_bounding_box.hpp"
+#include "lochash/location_hash_query_distance_squared.hpp"
+#include "lochash/lochash.hpp"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace lochash;
+
+// ----------------------------------------------------------------------------
+// Allocation budgets. These are regression gates: when a change makes one of
+// these tests fail, either the change added heap traffic to a hot path or the
+// budget needs a deliberate, reviewed increase.
+
+// A query against a warmed-up index and a warmed-up result vector.
+constexpr size_t query_allocation_budget = 0;
+
+// A move that stays inside its bucket is a no-op for the index.
+constexpr size_t same_bucket_move_allocation_budget = 0;
+
+// Moving back and forth between two occupied buckets reuses their capacity.
+constexpr size_t steady_state_move_allocation_budget = 0;
+
+// Moving into an empty bucket allocates its map node and its vector.
+constexpr size_t new_bucket_move_allocation_budget = 2;
+
+// Average allocations per add while filling an index, including rehashing.
+constexpr double add_allocation_budget = 2.0;
+
+// Heap bytes per entry once an index is populated, for 2D float coordinates and an object pointer
+// (a 16 byte entry). Dense packs many entries per bucket, sparse has roughly one per bucket.
+constexpr double dense_bytes_per_entry_budget  = 48.0;
+constexpr double sparse_bytes_per_entry_budget = 112.0;
+// ----------------------------------------------------------------------------
+
+namespace
+{
+	struct TrackedObject {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using TrackedHash          = LocationHash<precision, float, 2, TrackedObject>;
+
+	// Fills locationHash with objects spread over a square world of the given side length.
+	std::vector<std::array<float, 2>> populate(TrackedHash & locationHash, std::vector<TrackedObject> & objects,
+	                                           float world_size)
+	{
+		std::mt19937                          rng(7);
+		std::uniform_real_distribution<float> dist(0.0f, world_size);
+		std::vector<std::array<float, 2>>     positions(objects.size());
+		for (size_t i = 0; i < objects.size(); ++i) {
+			objects[i].id = i;
+			positions[i]  = {dist(rng), dist(rng)};
+			locationHash.add(&objects[i], positions[i]);
+		}
+		return positions;
+	}
+} // namespace
+
+TEST(LocationHashAllocationTest, SteadyStateQueriesDoNotAllocate)
+{
+	TrackedHash                locationHash;
+	std::vector<TrackedObject> objects(2000);
+	const auto                 positions = populate(locationHash, objects, 512.0f);
+
+	std::vector<TrackedObject *> result;
+	result.reserve(objects.size());
+
+	AllocationScope scope;
+	size_t          found = 0;
+	for (const auto & position : positions) {
+		found += locationHash.query(position).size();
+
+		query_bounding_box(locationHash, {position[0] - 24.0f, position[1] - 24.0f},
+		                   {position[0] + 24.0f, position[1] + 24.0f}, result);
+		found += result.size();
+
+		query_within_distance(locationHash, position, 24.0f, result);
+		found += result.size();
+	}
+	const auto delta = scope.delta();
+
+	EXPECT_GT(found, 0u);
+	EXPECT_LE(delta.allocations, query_allocation_budget * positions.size())
+	    << "steady-state queries allocated " << delta.allocations << " times (" << delta.bytes << " bytes)";
+}
+
+TEST(LocationHashAllocationTest, MovesStayWithinBudget)
+{
+	TrackedHash   locationHash;
+	TrackedObject mover{0};
+	TrackedObject anchor_a{1};
+	TrackedObject anchor_b{2};
+
+	// two occupied buckets, so the mover never empties or creates a bucket
+	locationHash.add(&anchor_a, {1.0f, 1.0f});
+	locationHash.add(&anchor_b, {33.0f, 1.0f});
+	locationHash.add(&mover, {2.0f, 2.0f});
+	// warm-up round trip grows both buckets to their steady-state capacity
+	locationHash.move(&mover, {2.0f, 2.0f}, {34.0f, 2.0f});
+	locationHash.move(&mover, {34.0f, 2.0f}, {2.0f, 2.0f});
+
+	{
+		AllocationScope scope;
+		EXPECT_FALSE(locationHash.move(&mover, {2.0f, 2.0f}, {3.0f, 3.0f}));
+		EXPECT_LE(scope.delta().allocations, same_bucket_move_allocation_budget);
+	}
+
+	{
+		constexpr size_t round_trips = 100;
+		AllocationScope  scope;
+		for (size_t i = 0; i < round_trips; ++i) {
+			EXPECT_TRUE(locationHash.move(&mover, {2.0f, 2.0f}, {34.0f, 2.0f}));
+			EXPECT_TRUE(locationHash.move(&mover, {34.0f, 2.0f}, {2.0f, 2.0f}));
+		}
+		EXPECT_LE(scope.delta().allocations, steady_state_move_allocation_budget * round_trips * 2);
+	}
+
+	{
+		AllocationScope scope;
+		EXPECT_TRUE(locationHash.move(&mover, {2.0f, 2.0f}, {200.0f, 200.0f}));
+		EXPECT_LE(scope.delta().allocations, new_bucket_move_allocation_budget);
+	}
+}
+
+TEST(LocationHashAllocationTest, AddsStayWithinBudget)
+{
+	TrackedHash                locationHash;
+	std::vector<TrackedObject> objects(10000);
+
+	AllocationScope scope;
+	populate(locationHash, objects, 1024.0f);
+	const auto delta = scope.delta();
+
+	const double per_add = static_cast<double>(delta.allocations) / static_cast<double>(objects.size());
+	EXPECT_LE(per_add, add_allocation_budget) << "adds averaged " << per_add << " allocations each";
+}
+
+TEST(LocationHashAllocationTest, BytesPerEntryStayWithinBudget)
+{
+	// ~40 entries per bucket
+	{
+		std::vector<TrackedObject> objects(10000);
+		AllocationScope            scope;
+		TrackedHash                locationHash;
+		populate(locationHash, objects, 256.0f);
+
+		const double per_entry = static_cast<double>(scope.delta().live_bytes) / static_cast<double>(objects.size());
+		EXPECT_LE(per_entry, dense_bytes_per_entry_budget) << "dense index uses " << per_entry << " bytes per entry";
+	}
+
+	// ~1 entry per bucket
+	{
+		std::vector<TrackedObject> objects(10000);
+		AllocationScope            scope;
+		TrackedHash                locationHash;
+		populate(locationHash, objects, 1600.0f);
+
+		const double per_entry = static_cast<double>(scope.delta().live_bytes) / static_cast<double>(objects.size());
+		EXPECT_LE(per_entry, sparse_bytes_per_entry_budget) << "sparse index uses " << per_entry << " bytes per entry";
+	}
+}
+
+TEST(LocationHashAllocationTest, FixedLocationHashNeverAllocates)
+{
+	using FixedHash = FixedLocationHash<precision, float, 2, TrackedObject, 1024, 2000>;
+	std::vector<TrackedObject>              objects(2000);
+	std::vector<std::array<float, 2>>       positions(objects.size());
+	std::vector<TrackedObject *>            result;
+	NearestCandidates<float, TrackedObject> candidates;
+	std::mt19937                            rng(7);
+	std::uniform_real_distribution<float>   dist(0.0f, 512.0f);
+	std::uniform_real_distribution<float>   step(-8.0f, 8.0f);
+	for (auto & position : positions) {
+		position = {dist(rng), dist(rng)};
+	}
+	auto locationHash = std::make_unique<FixedHash>();
+	result.reserve(objects.size());
+	candidates.reserve(8);
+
+	AllocationScope scope;
+	for (size_t i = 0; i < objects.size(); ++i) {
+		ASSERT_EQ(locationHash->add(&objects[i], positions[i]), FixedCapacityResult::ok);
+	}
+	for (size_t i = 0; i < objects.size(); ++i) {
+		const std::array<float, 2> to = {positions[i][0] + step(rng), positions[i][1] + step(rng)};
+		ASSERT_EQ(locationHash->move(&objects[i], positions[i], to), FixedCapacityResult::ok);
+		positions[i] = to;
+		query_bounding_box(*locationHash, {to[0] - 24.0f, to[1] - 24.0f}, {to[0] + 24.0f, to[1] + 24.0f}, result);
+		query_within_distance(*locationHash, to, 24.0f, result);
+		query_nearest(*locationHash, to, 8, result, candidates);
+	}
+	for (size_t i = 0; i < objects.size(); i += 2) {
+		ASSERT_EQ(locationHash->remove(&objects[i], positions[i]), FixedCapacityResult::ok);
+	}
+	EXPECT_EQ(scope.delta().allocations, 0u);
+}
+
+TEST(LocationHashAllocationTest, TrackerCountsAllocations)
+{
+	AllocationScope scope;
+	auto            value = std::make_unique<std::array<char, 100>>();
+	const auto      delta = scope.delta();
+	EXPECT_EQ(delta.allocations, 1u);
+	EXPECT_GE(delta.bytes, 100u);
+	EXPECT_GE(delta.live_bytes, 100u);
+	value.reset();
+	EXPECT_EQ(scope.delta().live_bytes, 0u);
+	EXPECT_EQ(scope.delta().deallocations, 1u);
+}
@@ -0,0 +1,211 @@
+#include "lochash/location_hash_archive.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <bit>
+#include <limits>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		uint32_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Archive              = ArchiveSnapshot<precision, float, 2, uint32_t>;
+	using Point                = std::array<float, 2>;
+
+	const auto id_of = [](const Entity * entity) { return entity->id; };
+} // namespace
+
+TEST(ArchiveSnapshotTest, MortonOrderInterleavesTheAxes)
+{
+	using Cell = std::array<int64_t, 2>;
+	std::vector<Cell> cells;
+	for (int64_t y = -2; y < 2; ++y) {
+		for (int64_t x = -2; x < 2; ++x) {
+			cells.push_back({x, y});
+		}
+	}
+	std::sort(cells.begin(), cells.end(), detail::morton_less<int64_t, 2>);
+
+	// negative cells come first, and each 2x2 quadrant is finished before the next starts
+	EXPECT_EQ(cells.front(), (Cell{-2, -2}));
+	EXPECT_EQ(cells.back(), (Cell{1, 1}));
+	for (size_t quadrant = 0; quadrant < 4; ++quadrant) {
+		for (size_t i = quadrant * 4; i < quadrant * 4 + 4; ++i) {
+			EXPECT_EQ(cells[i][0] >> 1, cells[quadrant * 4][0] >> 1);
+			EXPECT_EQ(cells[i][1] >> 1, cells[quadrant * 4][1] >> 1);
+		}
+	}
+
+	std::vector<uint8_t>    column;
+	detail::BitPackedWriter writer(column);
+	for (uint64_t value = 0; value < 100; ++value) {
+		writer.push(value % 3 == 0 ? value : 1);
+	}
+	writer.push(std::numeric_limits<uint64_t>::max());
+	writer.finish();
+	// a block of 64 values below 64 takes 6 bits each, then the last 37 take 64 bits because of the largest
+	EXPECT_EQ(column.size(), 1u + 48u + 1u + 37u * 8u);
+
+	detail::BitPackedReader reader(column, 101);
+	uint64_t                value = 0;
+	for (uint64_t expected = 0; expected < 100; ++expected) {
+		ASSERT_TRUE(reader.next(value));
+		EXPECT_EQ(value, expected % 3 == 0 ? expected : 1);
+	}
+	ASSERT_TRUE(reader.next(value));
+	EXPECT_EQ(value, std::numeric_limits<uint64_t>::max());
+	EXPECT_TRUE(reader.finished());
+	EXPECT_FALSE(reader.next(value));
+}
+
+TEST(ArchiveSnapshotTest, RoundTripsThroughAFileIntoALocationHash)
+{
+	std::vector<Entity>                   entities(5000);
+	std::mt19937                          rng(31);
+	std::normal_distribution<float>       cluster(0.0f, 300.0f);
+	std::uniform_real_distribution<float> spread(-20.0f, 20.0f);
+	Index                                 locationHash;
+	Point                                 position{};
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<uint32_t>(i);
+		// groups of ten entities stand close together
+		position = i % 10 == 0 ? Point{cluster(rng), cluster(rng)}
+		                       : Point{position[0] + spread(rng), position[1] + spread(rng)};
+		locationHash.add(&entities[i], position);
+	}
+
+	TempFile file("lochash_test_archive.bin");
+	{
+		const Archive archive = Archive::capture(locationHash.get_data(), id_of);
+		EXPECT_EQ(archive.size(), entities.size());
+		EXPECT_EQ(archive.cell_count(), locationHash.get_data().size());
+		archive.save(file.path());
+		EXPECT_EQ(std::filesystem::file_size(file.path()), archive.byte_size());
+
+		// a raw dump takes a key and count per cell, and coordinates and an id per entry
+		const size_t raw_bytes = archive.cell_count() * (sizeof(Index::QuantizedCoordinateType) + sizeof(uint64_t)) +
+		                         archive.size() * (sizeof(Point) + sizeof(uint32_t));
+		EXPECT_LT(archive.byte_size(), raw_bytes * 3 / 4);
+	}
+
+	const Archive archive = Archive::read(file.path());
+	Index         restored;
+	archive.restore(restored, [&](uint32_t id) { return &entities[id]; });
+	EXPECT_EQ(restored.get_data().size(), locationHash.get_data().size());
+	EXPECT_EQ(contents_of(restored), contents_of(locationHash));
+
+	size_t visited = 0;
+	archive.for_each([&](const auto & key, const Point & coordinates, uint32_t id) {
+		EXPECT_EQ(key, Index::QuantizedCoordinateType(coordinates));
+		EXPECT_LT(id, entities.size());
+		++visited;
+	});
+	EXPECT_EQ(visited, entities.size());
+
+	const Archive empty = Archive::capture(Index().get_data(), id_of);
+	EXPECT_TRUE(empty.empty());
+	Index nothing;
+	empty.restore(nothing, [&](uint32_t id) { return &entities[id]; });
+	EXPECT_TRUE(nothing.get_data().empty());
+}
+
+TEST(ArchiveSnapshotTest, CellAtZeroStaysShort)
+{
+	// the same offsets in the cell at the origin, which holds values of both signs, and in the cell next to it
+	std::vector<Entity>                   entities(2048);
+	std::mt19937                          rng(43);
+	std::uniform_real_distribution<float> offset(-0.5f, precision - 0.5f);
+	Index                                 at_zero;
+	Index                                 beside;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<uint32_t>(i);
+		const Point position{offset(rng), offset(rng)};
+		at_zero.add(&entities[i], position);
+		beside.add(&entities[i], {position[0] + precision, position[1] + precision});
+	}
+	ASSERT_EQ(at_zero.get_data().size(), 1u);
+	ASSERT_EQ(beside.get_data().size(), 1u);
+	const Archive zero_archive   = Archive::capture(at_zero.get_data(), id_of);
+	const Archive beside_archive = Archive::capture(beside.get_data(), id_of);
+	EXPECT_LT(zero_archive.byte_size(), beside_archive.byte_size() * 5 / 4);
+
+	// values that only the cell at zero holds come back exactly
+	Index edges;
+	for (const float value : {-0.5f, -0.0f, 0.0f, -1e-40f, 1e-40f, -std::numeric_limits<float>::min(), 0.25f}) {
+		edges.add(&entities[0], {value, -value});
+	}
+	Index restored;
+	Archive::capture(edges.get_data(), id_of).restore(restored, [&](uint32_t id) { return &entities[id]; });
+	const auto & original = edges.get_data().begin()->second;
+	const auto & decoded  = restored.get_data().begin()->second;
+	ASSERT_EQ(decoded.size(), original.size());
+	for (size_t i = 0; i < original.size(); ++i) {
+		for (size_t axis = 0; axis < 2; ++axis) {
+			EXPECT_EQ(std::bit_cast<uint32_t>(decoded[i].first[axis]), std::bit_cast<uint32_t>(original[i].first[axis]));
+		}
+	}
+
+	using IntegerArchive = ArchiveSnapshot<precision, int32_t, 2, uint32_t>;
+	LocationHash<precision, int32_t, 2, Entity> integers;
+	for (const int32_t value : {-1, 0, 7, std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::max()}) {
+		integers.add(&entities[0], {value, -value - 1});
+	}
+	LocationHash<precision, int32_t, 2, Entity> integers_restored;
+	IntegerArchive::capture(integers.get_data(), id_of)
+	    .restore(integers_restored, [&](uint32_t id) { return &entities[id]; });
+	for (const auto & [key, bucket] : integers.get_data()) {
+		EXPECT_EQ(integers_restored.get_data().at(key), bucket);
+	}
+}
+
+TEST(ArchiveSnapshotTest, RejectsDamagedAndMismatchedFiles)
+{
+	std::vector<Entity> entities(300);
+	Index               locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<uint32_t>(i);
+		locationHash.add(&entities[i], {static_cast<float>(i % 17) * 9.0f, static_cast<float>(i / 17) * 7.0f});
+	}
+	TempFile file("lochash_test_archive_damaged.bin");
+	Archive::capture(locationHash.get_data(), id_of).save(file.path());
+	const auto resolve = [&](uint32_t id) { return &entities[id % entities.size()]; };
+
+	EXPECT_THROW((ArchiveSnapshot<precision, double, 2, uint32_t>::read(file.path())), std::system_error);
+	EXPECT_THROW(Archive::read(file.path() + ".missing"), std::system_error);
+
+	// Flipping bits in the columns either changes values or is caught when decoding, never reads out of bounds.
+	// The columns follow a header of 13 words.
+	const auto size   = std::filesystem::file_size(file.path());
+	size_t     caught = 0;
+	for (uint64_t offset = 13 * sizeof(uint64_t); offset < size; offset += 5) {
+		std::vector<char> bytes(size);
+		{
+			std::ifstream in(file.path(), std::ios::binary);
+			in.read(bytes.data(), static_cast<std::streamsize>(size));
+		}
+		TempFile damaged("lochash_test_archive_flipped.bin");
+		bytes[offset] = static_cast<char>(bytes[offset] ^ 0xa5);
+		{
+			std::ofstream out(damaged.path(), std::ios::binary);
+			out.write(bytes.data(), static_cast<std::streamsize>(size));
+		}
+		const Archive archive = Archive::read(damaged.path());
+		Index         restored;
+		try {
+			archive.restore(restored, resolve);
+		} catch (const std::system_error &) {
+			EXPECT_TRUE(restored.get_data().empty());
+			++caught;
+		}
+	}
+	EXPECT_GT(caught, 0u);
+
+	std::filesystem::resize_file(file.path(), size - 3);
+	EXPECT_THROW(Archive::read(file.path()), std::system_error);
+}
@@ -0,0 +1,192 @@
+#include "lochash/location_hash_bounded.hpp"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Sighting {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using Bounded              = BoundedLocationHash<precision, float, 2, Sighting>;
+
+	// the x coordinate of the center of cell i along the x axis
+	float cell_x(size_t i) { return static_cast<float>(i * precision); }
+} // namespace
+
+TEST(BoundedLocationHashTest, EvictsLeastRecentlyTouchedCells)
+{
+	std::vector<Sighting> sightings(5);
+	Bounded               locationHash(3);
+	std::vector<size_t>   evicted;
+	locationHash.set_eviction_callback([&](const auto &, const auto & entries) {
+		for (const auto & [coordinates, object] : entries) {
+			evicted.push_back(object->id);
+		}
+	});
+
+	for (size_t i = 0; i < 3; ++i) {
+		sightings[i].id = i;
+		locationHash.add(&sightings[i], {cell_x(i), 0.0f});
+	}
+	EXPECT_EQ(locationHash.query({cell_x(0), 0.0f}).size(), 1u); // cell 0 is now the most recent
+
+	sightings[3].id = 3;
+	locationHash.add(&sightings[3], {cell_x(3), 0.0f});
+	EXPECT_EQ(evicted, std::vector<size_t>{1});
+	EXPECT_EQ(locationHash.size(), 3u);
+	EXPECT_EQ(locationHash.cell_count(), 3u);
+	EXPECT_TRUE(locationHash.query({cell_x(1), 0.0f}).empty());
+
+	// a same-cell move touches the cell too
+	EXPECT_TRUE(locationHash.move(&sightings[2], {cell_x(2), 0.0f}, {cell_x(2) + 1.0f, 0.0f}));
+	sightings[4].id = 4;
+	locationHash.add(&sightings[4], {cell_x(4), 0.0f});
+	EXPECT_EQ(evicted, (std::vector<size_t>{1, 0}));
+	EXPECT_EQ(locationHash.evicted_cells(), 2u);
+	EXPECT_EQ(locationHash.evicted_entries(), 2u);
+
+	// removing is not evicting
+	EXPECT_TRUE(locationHash.remove(&sightings[4], {cell_x(4), 0.0f}));
+	EXPECT_FALSE(locationHash.remove(&sightings[4], {cell_x(4), 0.0f}));
+	EXPECT_FALSE(locationHash.remove(&sightings[4], {cell_x(2), 0.0f}));
+	EXPECT_EQ(evicted.size(), 2u);
+	EXPECT_EQ(locationHash.size(), 2u);
+}
+
+TEST(BoundedLocationHashTest, EvictsLowerPrioritiesFirst)
+{
+	std::vector<Sighting> sightings(4);
+	Bounded               locationHash(3);
+	locationHash.add(&sightings[0], {cell_x(0), 0.0f}, 2);
+	locationHash.add(&sightings[1], {cell_x(1), 0.0f}, 1);
+	locationHash.add(&sightings[2], {cell_x(2), 0.0f}, 1000); // clamped to the highest priority
+	EXPECT_TRUE(locationHash.set_priority({cell_x(1), 0.0f}, 5));
+	EXPECT_FALSE(locationHash.set_priority({cell_x(9), 0.0f}, 5));
+
+	// the newest cell has the lowest priority, but is never evicted by its own add
+	locationHash.add(&sightings[3], {cell_x(3), 0.0f});
+	EXPECT_TRUE(locationHash.query({cell_x(0), 0.0f}).empty());
+	EXPECT_EQ(locationHash.query({cell_x(3), 0.0f}).size(), 1u);
+
+	// tightening the budget evicts the rest in order: priority 0, 5, then 63
+	locationHash.set_budget(1);
+	EXPECT_EQ(locationHash.size(), 1u);
+	EXPECT_EQ(locationHash.query({cell_x(2), 0.0f}).size(), 1u);
+	locationHash.set_budget(0);
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.memory_bytes(), 0u);
+}
+
+TEST(BoundedLocationHashTest, KeepsAStandaloneCellOverBudget)
+{
+	std::vector<Sighting> sightings(4);
+	Bounded               locationHash(2);
+	for (auto & sighting : sightings) {
+		locationHash.add(&sighting, {1.0f, 1.0f});
+	}
+	EXPECT_EQ(locationHash.size(), 4u);
+	EXPECT_EQ(locationHash.evicted_cells(), 0u);
+
+	// moving into a new cell keeps the old cell's priority, and leaves the old cell less recently touched
+	locationHash.set_budget(10);
+	EXPECT_TRUE(locationHash.set_priority({1.0f, 1.0f}, 3));
+	EXPECT_TRUE(locationHash.move(&sightings[0], {1.0f, 1.0f}, {cell_x(5), 1.0f}));
+	EXPECT_FALSE(locationHash.move(&sightings[0], {1.0f, 1.0f}, {cell_x(6), 1.0f}));
+	EXPECT_FALSE(locationHash.move(&sightings[0], {1.0f, 1.0f}, {2.0f, 1.0f}));
+	EXPECT_FALSE(locationHash.move(&sightings[0], {cell_x(9), 1.0f}, {2.0f, 1.0f}));
+	locationHash.set_budget(3);
+	EXPECT_EQ(locationHash.size(), 1u);
+	EXPECT_EQ(locationHash.query({cell_x(5), 1.0f}).size(), 1u);
+	EXPECT_TRUE(locationHash.query({1.0f, 1.0f}).empty());
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+	EXPECT_EQ(locationHash.memory_bytes(), 0u);
+	locationHash.add(&sightings[0], {1.0f, 1.0f});
+	EXPECT_EQ(locationHash.size(), 1u);
+}
+
+TEST(BoundedLocationHashTest, MemoryBudgetTracksBucketCapacity)
+{
+	std::vector<Sighting> sightings(200);
+	Bounded               locationHash(std::numeric_limits<size_t>::max(), 4096);
+	size_t                evicted = 0;
+	locationHash.set_eviction_callback([&](const auto &, const auto & entries) { evicted += entries.size(); });
+
+	std::mt19937                          rng(17);
+	std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+	for (auto & sighting : sightings) {
+		locationHash.add(&sighting, {coordinate(rng), coordinate(rng)});
+		EXPECT_LE(locationHash.memory_bytes(), 4096u);
+	}
+	EXPECT_GT(evicted, 0u);
+	EXPECT_EQ(locationHash.size() + evicted, sightings.size());
+}
+
+TEST(BoundedLocationHashTest, ChurnMatchesAMirrorOfWhatWasKept)
+{
+	constexpr size_t                            count = 400;
+	Bounded                                     bounded(150);
+	LocationHash<precision, float, 2, Sighting> mirror;
+	std::vector<Sighting>                       sightings(count);
+	std::vector<std::array<float, 2>>           positions(count);
+	std::vector<bool>                           present(count, false);
+	std::mt19937                                rng(31);
+	std::uniform_real_distribution<float>       coordinate(-200.0f, 200.0f);
+	std::uniform_real_distribution<float>       step(-10.0f, 10.0f);
+
+	// evicted entries leave the mirror too
+	bounded.set_eviction_callback([&](const auto &, const auto & entries) {
+		for (const auto & [coordinates, object] : entries) {
+			mirror.remove(object, coordinates);
+			present[object->id] = false;
+		}
+	});
+
+	const auto sorted = [](std::vector<Sighting *> objects) {
+		std::sort(objects.begin(), objects.end());
+		return objects;
+	};
+	std::vector<Sighting *> bounded_result;
+	std::vector<Sighting *> mirror_result;
+	for (size_t i = 0; i < 20000; ++i) {
+		const size_t id  = rng() % count;
+		sightings[id].id = id;
+		if (!present[id]) {
+			positions[id] = {coordinate(rng), coordinate(rng)};
+			mirror.add(&sightings[id], positions[id]);
+			present[id] = true;
+			bounded.add(&sightings[id], positions[id], static_cast<unsigned>(rng() % 3));
+		} else if (rng() % 4 == 0) {
+			ASSERT_TRUE(bounded.remove(&sightings[id], positions[id]));
+			mirror.remove(&sightings[id], positions[id]);
+			present[id] = false;
+		} else {
+			const std::array<float, 2> to = {positions[id][0] + step(rng), positions[id][1] + step(rng)};
+			mirror.remove(&sightings[id], positions[id]);
+			mirror.add(&sightings[id], to);
+			ASSERT_TRUE(bounded.move(&sightings[id], positions[id], to));
+			positions[id] = to;
+		}
+		ASSERT_LE(bounded.size(), 150u + 4u); // the cell just added to may hold a few more
+
+		if (i % 200 == 0) {
+			const std::array<float, 2> center = {coordinate(rng), coordinate(rng)};
+			query_bounding_box(bounded, {center[0] - 40.0f, center[1] - 40.0f}, {center[0] + 40.0f, center[1] + 40.0f},
+			                   bounded_result);
+			query_bounding_box(mirror, {center[0] - 40.0f, center[1] - 40.0f}, {center[0] + 40.0f, center[1] + 40.0f},
+			                   mirror_result);
+			EXPECT_EQ(sorted(bounded_result), sorted(mirror_result));
+			query_within_distance(bounded, center, 50.0f, bounded_result);
+			query_within_distance(mirror, center, 50.0f, mirror_result);
+			EXPECT_EQ(sorted(bounded_result), sorted(mirror_result));
+			EXPECT_EQ(query_nearest(bounded, center, 3), query_nearest(mirror, center, 3));
+		}
+	}
+	EXPECT_GT(bounded.evicted_cells(), 0u);
+}
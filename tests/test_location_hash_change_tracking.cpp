@@ -0,0 +1,166 @@
+#include "lochash/location_hash_change_tracking.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Tracked              = ChangeTrackingLocationHash<precision, float, 2, Entity, int64_t, 4>;
+	using Point                = std::array<float, 2>;
+	using Key                  = Tracked::QuantizedCoordinateType;
+
+	// Every cell changed_since reports, with its entries at the time of the call.
+	std::map<std::array<int64_t, 2>, std::vector<Entity *>> changes_of(const Tracked & locationHash,
+	                                                                   const Point & lower, const Point & upper,
+	                                                                   uint64_t since, bool * incremental = nullptr)
+	{
+		std::map<std::array<int64_t, 2>, std::vector<Entity *>> changes;
+		const auto record = [&](const Key & key, auto entries, uint64_t) {
+			auto & objects = changes[{key.quantized_[0], key.quantized_[1]}];
+			for (const auto & [coordinates, object] : entries) {
+				objects.push_back(object);
+			}
+		};
+		const bool result = locationHash.changed_since(lower, upper, since, record);
+		if (incremental != nullptr) {
+			*incremental = result;
+		}
+		return changes;
+	}
+} // namespace
+
+TEST(ChangeTrackingLocationHashTest, ReportsChangedCellsAndRemovals)
+{
+	Entity  a{0}, b{1}, c{2};
+	Tracked locationHash;
+	locationHash.add(&a, {1.0f, 1.0f});
+	locationHash.add(&b, {100.0f, 1.0f});
+	locationHash.add(&c, {1000.0f, 1.0f});
+	EXPECT_EQ(locationHash.version(), 3u);
+	EXPECT_EQ(locationHash.size(), 3u);
+	const uint64_t synced = locationHash.version();
+
+	EXPECT_TRUE(changes_of(locationHash, {-2000.0f, -2000.0f}, {2000.0f, 2000.0f}, synced).empty());
+
+	// a move within a cell updates the coordinates and counts as a change
+	EXPECT_TRUE(locationHash.move(&a, {1.0f, 1.0f}, {2.0f, 2.0f}));
+	EXPECT_EQ(locationHash.query({0.0f, 0.0f})[0].first, (Point{2.0f, 2.0f}));
+	EXPECT_TRUE(locationHash.remove(&b, {100.0f, 1.0f}));
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+	EXPECT_EQ(locationHash.tracked_cell_count(), 3u);
+
+	bool       incremental = false;
+	const auto changes     = changes_of(locationHash, {-2000.0f, -2000.0f}, {2000.0f, 2000.0f}, synced, &incremental);
+	EXPECT_TRUE(incremental);
+	ASSERT_EQ(changes.size(), 2u);
+	EXPECT_EQ(changes.at({0, 0}), std::vector<Entity *>{&a});
+	EXPECT_TRUE(changes.at({96, 0}).empty());
+
+	// restricted to a region, and nothing is reported for a stale cell outside it
+	EXPECT_EQ(changes_of(locationHash, {-10.0f, -10.0f}, {10.0f, 10.0f}, synced).size(), 1u);
+	EXPECT_TRUE(changes_of(locationHash, {900.0f, -10.0f}, {1100.0f, 10.0f}, synced).empty());
+	EXPECT_TRUE(changes_of(locationHash, {10.0f, 10.0f}, {-10.0f, -10.0f}, 0).empty());
+
+	EXPECT_FALSE(locationHash.remove(&b, {100.0f, 1.0f}));
+	EXPECT_FALSE(locationHash.remove(&c, {1.0f, 1.0f}));
+	EXPECT_FALSE(locationHash.move(&b, {1.0f, 1.0f}, {3.0f, 3.0f}));
+	EXPECT_FALSE(locationHash.move(&b, {500.0f, 1.0f}, {3.0f, 3.0f}));
+	EXPECT_FALSE(locationHash.move(&b, {1.0f, 1.0f}, {300.0f, 3.0f}));
+}
+
+TEST(ChangeTrackingLocationHashTest, ForgettingTombstonesForcesAFullResync)
+{
+	Entity  a{0}, b{1};
+	Tracked locationHash;
+	locationHash.add(&a, {1.0f, 1.0f});
+	locationHash.add(&b, {100.0f, 1.0f});
+	const uint64_t old_client = locationHash.version();
+	locationHash.remove(&b, {100.0f, 1.0f});
+	const uint64_t recent_client = locationHash.version();
+
+	locationHash.forget_before(recent_client);
+	EXPECT_EQ(locationHash.horizon(), recent_client);
+	EXPECT_EQ(locationHash.tracked_cell_count(), 1u);
+
+	bool incremental = true;
+	auto changes     = changes_of(locationHash, {-200.0f, -200.0f}, {200.0f, 200.0f}, old_client, &incremental);
+	EXPECT_FALSE(incremental);
+	EXPECT_EQ(changes.size(), 1u);
+	EXPECT_EQ(changes.at({0, 0}), std::vector<Entity *>{&a});
+
+	changes = changes_of(locationHash, {-200.0f, -200.0f}, {200.0f, 200.0f}, recent_client, &incremental);
+	EXPECT_TRUE(incremental);
+	EXPECT_TRUE(changes.empty());
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.horizon(), locationHash.version());
+	EXPECT_TRUE(changes_of(locationHash, {-200.0f, -200.0f}, {200.0f, 200.0f}, recent_client).empty());
+}
+
+TEST(ChangeTrackingLocationHashTest, ChangedSinceMatchesBruteForceForSmallAndLargeRegions)
+{
+	std::vector<Entity>                   entities(500);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(17);
+	std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+	std::uniform_real_distribution<float> step(-30.0f, 30.0f);
+	std::uniform_int_distribution<size_t> pick(0, entities.size() - 1);
+
+	Tracked locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		locationHash.add(&entities[i], positions[i]);
+	}
+	const uint64_t since = locationHash.version();
+
+	std::vector<Key> touched;
+	for (int update = 0; update < 60; ++update) {
+		const size_t i    = pick(rng);
+		const Point  next = {positions[i][0] + step(rng), positions[i][1] + step(rng)};
+		touched.emplace_back(positions[i]);
+		touched.emplace_back(next);
+		EXPECT_TRUE(locationHash.move(&entities[i], positions[i], next));
+		positions[i] = next;
+	}
+
+	// a small region walks its blocks, one larger than the tracked set scans the block map instead
+	for (const float half_extent : {100.0f, 100000.0f}) {
+		const Point lower{-half_extent, -half_extent + 20.0f};
+		const Point upper{half_extent, half_extent + 20.0f};
+		const Key   lower_key(lower);
+		const Key   upper_key(upper);
+
+		std::map<std::array<int64_t, 2>, std::vector<Entity *>> expected;
+		for (const auto & key : touched) {
+			if (lower_key.quantized_[0] <= key.quantized_[0] && key.quantized_[0] <= upper_key.quantized_[0] &&
+			    lower_key.quantized_[1] <= key.quantized_[1] && key.quantized_[1] <= upper_key.quantized_[1]) {
+				auto & objects = expected[{key.quantized_[0], key.quantized_[1]}];
+				objects.clear();
+				for (const auto & [coordinates, object] : locationHash.find(key)) {
+					objects.push_back(object);
+				}
+			}
+		}
+		EXPECT_EQ(changes_of(locationHash, lower, upper, since), expected);
+	}
+
+	std::vector<Entity *> found;
+	query_within_distance(locationHash, Point{0.0f, 0.0f}, 150.0f, found);
+	const auto within = static_cast<size_t>(std::count_if(positions.begin(), positions.end(), [](const Point & p) {
+		return p[0] * p[0] + p[1] * p[1] <= 150.0f * 150.0f;
+	}));
+	EXPECT_EQ(found.size(), within);
+	query_bounding_box(locationHash, Point{-1000.0f, -1000.0f}, Point{1000.0f, 1000.0f}, found);
+	EXPECT_EQ(found.size(), entities.size());
+	EXPECT_EQ(query_nearest(locationHash, positions[3], 1), std::vector<Entity *>{&entities[3]});
+}
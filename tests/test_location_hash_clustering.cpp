@@ -0,0 +1,291 @@
+#include "lochash/location_hash_clustering.hpp"
+#include "gtest/gtest.h"
+#include <map>
+#include <random>
+#include <set>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Grid                 = CellGrid<precision, float, 2, Entity>;
+	using Point                = std::array<float, 2>;
+
+	// Blobs of points with some uniform noise between them.
+	Index scatter(std::vector<Entity> & entities, uint32_t seed)
+	{
+		std::mt19937                          rng(seed);
+		std::uniform_real_distribution<float> anywhere(-400.0f, 400.0f);
+		std::normal_distribution<float>       around(0.0f, 12.0f);
+		Index                                 locationHash;
+		Point                                 center{};
+		for (size_t i = 0; i < entities.size(); ++i) {
+			entities[i].id = static_cast<int>(i);
+			if (i % 100 == 0) {
+				center = {anywhere(rng), anywhere(rng)};
+			}
+			const Point position = i % 5 == 0 ? Point{anywhere(rng), anywhere(rng)}
+			                                  : Point{center[0] + around(rng), center[1] + around(rng)};
+			locationHash.add(&entities[i], position);
+		}
+		return locationHash;
+	}
+
+	// Checks a clustering against the definition of DBSCAN by comparing every pair of entries. Border points may
+	// join any cluster with a core point within eps, so only that is checked for them.
+	void expect_dbscan(const Grid & grid, const Clustering & clustering, float eps, size_t min_points)
+	{
+		const size_t size = grid.size();
+
+		const auto within = [&](size_t a, size_t b) {
+			return calculate_distance_squared(grid.coordinates(a), grid.coordinates(b)) <= eps * eps;
+		};
+		ASSERT_EQ(clustering.labels.size(), size);
+
+		std::vector<bool> core(size);
+		for (size_t i = 0; i < size; ++i) {
+			size_t neighbours = 0;
+			for (size_t j = 0; j < size; ++j) {
+				neighbours += within(i, j);
+			}
+			core[i] = neighbours >= min_points;
+		}
+		EXPECT_EQ(clustering.core, core);
+
+		// core points within eps must share a label, and the labels of core points must be connected that way
+		std::map<int32_t, std::set<size_t>> members;
+		for (size_t i = 0; i < size; ++i) {
+			if (!core[i]) {
+				continue;
+			}
+			ASSERT_NE(clustering.labels[i], Clustering::noise);
+			members[clustering.labels[i]].insert(i);
+			for (size_t j = i + 1; j < size; ++j) {
+				if (core[j] && within(i, j)) {
+					EXPECT_EQ(clustering.labels[i], clustering.labels[j]);
+				}
+			}
+		}
+		for (const auto & [label, cluster] : members) {
+			std::set<size_t>    reached{*cluster.begin()};
+			std::vector<size_t> frontier{*cluster.begin()};
+			while (!frontier.empty()) {
+				const size_t i = frontier.back();
+				frontier.pop_back();
+				for (size_t j : cluster) {
+					if (!reached.count(j) && within(i, j)) {
+						reached.insert(j);
+						frontier.push_back(j);
+					}
+				}
+			}
+			EXPECT_EQ(reached.size(), cluster.size());
+		}
+		EXPECT_EQ(members.size(), clustering.cluster_count);
+
+		for (size_t i = 0; i < size; ++i) {
+			if (core[i]) {
+				continue;
+			}
+			bool near_core = false;
+			bool joined    = false;
+			for (size_t j = 0; j < size; ++j) {
+				if (core[j] && within(i, j)) {
+					near_core = true;
+					joined    = joined || clustering.labels[j] == clustering.labels[i];
+				}
+			}
+			EXPECT_EQ(clustering.labels[i] != Clustering::noise, near_core);
+			EXPECT_EQ(joined, near_core);
+		}
+
+		// clusters are numbered in order of their first entry
+		int32_t next = 0;
+		for (int32_t label : clustering.labels) {
+			if (label == next) {
+				++next;
+			}
+			EXPECT_LT(label, next);
+		}
+	}
+} // namespace
+
+TEST(CellGridTest, CellPairsCoverEveryCloseEntryPairOnce)
+{
+	std::vector<Entity> entities(600);
+	const Index         locationHash = scatter(entities, 37);
+	const Grid          grid(locationHash);
+	EXPECT_EQ(grid.size(), entities.size());
+	EXPECT_EQ(grid.cell_count(), locationHash.get_data().size());
+
+	std::set<const Entity *> seen;
+	for (const auto & cell : grid.cells()) {
+		ASSERT_EQ(grid.find(cell.key), &cell);
+		for (size_t i = cell.first; i < cell.first + cell.count; ++i) {
+			EXPECT_EQ(Grid::QuantizedCoordinateType(grid.coordinates(i)), cell.key);
+			seen.insert(grid.object(i));
+		}
+	}
+	EXPECT_EQ(seen.size(), entities.size());
+
+	for (const float distance : {5.0f, 16.0f, 40.0f}) {
+		std::set<std::pair<const Grid::Cell *, const Grid::Cell *>> pairs;
+		grid.for_each_cell_pair(distance, [&](const Grid::Cell & a, const Grid::Cell & b) {
+			EXPECT_TRUE(pairs.insert({std::min(&a, &b), std::max(&a, &b)}).second);
+			EXPECT_LE(Grid::min_distance_squared(a, b), distance * distance);
+		});
+		for (size_t i = 0; i < grid.size(); ++i) {
+			for (size_t j = 0; j < grid.size(); ++j) {
+				if (calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)) > distance * distance) {
+					continue;
+				}
+				const auto * a = grid.find(Grid::QuantizedCoordinateType(grid.coordinates(i)));
+				const auto * b = grid.find(Grid::QuantizedCoordinateType(grid.coordinates(j)));
+				EXPECT_TRUE(pairs.count({std::min(a, b), std::max(a, b)}));
+				EXPECT_LE(calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)),
+				          Grid::max_distance_squared(*a, *b));
+			}
+		}
+
+		// ranges of cells sharing one stencil visit the same pairs between them
+		const auto stencil = Grid::pair_stencil(distance);
+		size_t     visited = 0;
+		for (size_t first = 0; first < grid.cell_count(); first += 7) {
+			grid.for_each_cell_pair(stencil, first, std::min(first + 7, grid.cell_count()),
+			                        [&](const Grid::Cell & a, const Grid::Cell & b) {
+				                        EXPECT_TRUE(pairs.count({std::min(&a, &b), std::max(&a, &b)}));
+				                        ++visited;
+			                        });
+		}
+		EXPECT_EQ(visited, pairs.size());
+	}
+
+	const Grid empty{Index()};
+	EXPECT_TRUE(empty.empty());
+	size_t visits = 0;
+	empty.for_each_cell_pair(10.0f, [&](const auto &, const auto &) { ++visits; });
+	EXPECT_EQ(visits, 0u);
+}
+
+TEST(CellGridTest, ParallelRangesCoverEachItemOnceAndRethrow)
+{
+	std::vector<std::atomic<int>> visits(1000);
+	detail::parallel_for_ranges(visits.size(), 7, 4, [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			++visits[i];
+		}
+	});
+	EXPECT_TRUE(std::all_of(visits.begin(), visits.end(), [](const auto & count) { return count == 1; }));
+
+	const auto stop_halfway = [](size_t first, size_t) {
+		if (first >= 500) {
+			throw std::runtime_error("stop");
+		}
+	};
+	EXPECT_THROW(detail::parallel_for_ranges(visits.size(), 7, 4, stop_halfway), std::runtime_error);
+}
+
+TEST(ClusteringTest, DbscanMatchesTheDefinition)
+{
+	std::vector<Entity> entities(1500);
+	const Index         locationHash = scatter(entities, 41);
+	const Grid          grid(locationHash);
+
+	// eps below and above the cell diagonal of 16 * sqrt(2), so both the per-point and the per-cell paths run
+	for (const auto & [eps, min_points] : {std::pair{6.0f, size_t(4)}, std::pair{12.0f, size_t(10)},
+	                                       std::pair{24.0f, size_t(6)}, std::pair{40.0f, size_t(30)}}) {
+		SCOPED_TRACE(eps);
+		const Clustering clustering = dbscan(grid, eps, min_points);
+		expect_dbscan(grid, clustering, eps, min_points);
+		EXPECT_GT(clustering.cluster_count, 0u);
+	}
+
+	// with min_points of one every entry is core, and with an unreachable count every entry is noise
+	const Clustering all_core = dbscan(grid, 24.0f, 1);
+	expect_dbscan(grid, all_core, 24.0f, 1);
+	const Clustering all_noise = dbscan(grid, 24.0f, entities.size() + 1);
+	EXPECT_EQ(all_noise.cluster_count, 0u);
+	EXPECT_TRUE(std::all_of(all_noise.labels.begin(), all_noise.labels.end(),
+	                        [](int32_t label) { return label == Clustering::noise; }));
+
+	EXPECT_TRUE(dbscan(Grid{Index()}, 24.0f, 3).labels.empty());
+}
+
+TEST(ClusteringTest, DbscanOnIntegerCoordinatesInThreeDimensions)
+{
+	using Index3 = LocationHash<4, int, 3, Entity>;
+	using Grid3  = CellGrid<4, int, 3, Entity>;
+	std::vector<Entity>                entities(800);
+	std::mt19937                       rng(43);
+	std::uniform_int_distribution<int> coordinate(-30, 30);
+	Index3                             locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		locationHash.add(&entities[i], {coordinate(rng), coordinate(rng), coordinate(rng) / 3});
+	}
+	const Grid3 grid(locationHash);
+
+	for (const int eps : {2, 5, 8}) {
+		const Clustering clustering = dbscan(grid, eps, 6);
+		ASSERT_EQ(clustering.labels.size(), grid.size());
+		for (size_t i = 0; i < grid.size(); ++i) {
+			size_t neighbours = 0;
+			for (size_t j = 0; j < grid.size(); ++j) {
+				neighbours += calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)) <= eps * eps;
+			}
+			EXPECT_EQ(clustering.core[i], neighbours >= 6);
+			for (size_t j = 0; j < i; ++j) {
+				if (clustering.core[i] && clustering.core[j] &&
+				    calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)) <= eps * eps) {
+					EXPECT_EQ(clustering.labels[i], clustering.labels[j]);
+				}
+			}
+		}
+	}
+}
+
+TEST(ClusteringTest, ConnectedComponentsMatchABreadthFirstSearch)
+{
+	std::vector<Entity> entities(1500);
+	const Index         locationHash = scatter(entities, 47);
+	const Grid          grid(locationHash);
+
+	for (const float distance : {4.0f, 10.0f, 24.0f, 60.0f}) {
+		SCOPED_TRACE(distance);
+		std::vector<uint32_t> expected(grid.size(), std::numeric_limits<uint32_t>::max());
+		uint32_t              count = 0;
+		for (size_t start = 0; start < grid.size(); ++start) {
+			if (expected[start] != std::numeric_limits<uint32_t>::max()) {
+				continue;
+			}
+			expected[start] = count;
+			std::vector<size_t> frontier{start};
+			while (!frontier.empty()) {
+				const size_t i = frontier.back();
+				frontier.pop_back();
+				for (size_t j = 0; j < grid.size(); ++j) {
+					if (expected[j] == std::numeric_limits<uint32_t>::max() &&
+					    calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)) <= distance * distance) {
+						expected[j] = count;
+						frontier.push_back(j);
+					}
+				}
+			}
+			++count;
+		}
+
+		for (const size_t threads : {size_t(1), size_t(4)}) {
+			const Components components = connected_components(grid, distance, threads);
+			EXPECT_EQ(components.labels, expected);
+			EXPECT_EQ(components.component_count, count);
+		}
+	}
+
+	EXPECT_TRUE(connected_components(Grid{Index()}, 10.0f).labels.empty());
+}
@@ -0,0 +1,240 @@
+#include "lochash/location_hash_bounded.hpp"
+#include "lochash/location_hash_query_bounding_box.hpp"
+#include "lochash/location_hash_query_distance_squared.hpp"
+#include "lochash/lochash.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <memory>
+#include <random>
+
+using namespace lochash;
+
+// ----------------------------------------------------------------------------
+// Complexity regression suite. Each operation is timed as a fixed batch at
+// increasing object counts while the object density stays constant, so the
+// number of objects per bucket does not change. Every operation should then
+// be O(1) per call (O(k) in the objects it touches); an accidental O(n) path
+// grows with the index and is reported as such. Each batch is timed against
+// plain lookups of the cells it uses, so the index slowing down as a whole
+// when it outgrows the caches is not mistaken for growth of the operation.
+// Growth up to O(log n) is tolerated: on a loaded machine the noise left after
+// the baseline is divided out can be classified as O(log n), while an O(n)
+// path is still reported.
+
+namespace
+{
+	struct ComplexityObject {
+		size_t id;
+	};
+
+	constexpr size_t precision         = 16;
+	constexpr size_t batch_size        = 500;
+	constexpr size_t canary_batch_size = 100;
+	constexpr size_t repetitions       = 5;
+	constexpr float  area_per_object   = 64.0f; // about four objects per 16x16 bucket
+	constexpr size_t largest_index     = 16000;
+	using ComplexityHash               = LocationHash<precision, float, 2, ComplexityObject>;
+	using BoundedComplexityHash        = BoundedLocationHash<precision, float, 2, ComplexityObject>;
+	using Position                     = std::array<float, 2>;
+	const std::vector<size_t> indices  = {1000, 2000, 4000, 8000, largest_index};
+
+	float world_size(size_t count) { return std::sqrt(static_cast<float>(count) * area_per_object); }
+
+	// Positions are generated per index size so the density stays fixed, and the first `count` are the index.
+	struct Workload {
+		std::vector<ComplexityObject> objects;
+		std::vector<Position>         positions;
+		std::vector<Position>         targets; // where batched operations go
+		ComplexityHash                hash;
+
+		void build(size_t count)
+		{
+			std::mt19937                          rng(static_cast<unsigned>(count));
+			std::uniform_real_distribution<float> dist(0.0f, world_size(count));
+			objects.resize(count + batch_size);
+			positions.resize(count + batch_size);
+			targets.resize(batch_size);
+			for (size_t i = 0; i < objects.size(); ++i) {
+				objects[i].id = i;
+				positions[i]  = {dist(rng), dist(rng)};
+			}
+			for (auto & target : targets) {
+				target = {dist(rng), dist(rng)};
+			}
+
+			// Fill with the batch included and then take it back out, so the map has already grown its bucket
+			// array and the timed batch does not include a one-off rehash.
+			hash.clear();
+			for (size_t i = 0; i < objects.size(); ++i) {
+				hash.add(&objects[i], positions[i]);
+			}
+			for (size_t i = count; i < objects.size(); ++i) {
+				hash.remove(&objects[i], positions[i]);
+			}
+		}
+
+		// The baseline for a batch: finding the same cells in the map underneath, which is O(1) by construction.
+		void look_up(const Position * first, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i) {
+				touched += hash.get_data().count(ComplexityHash::QuantizedCoordinateType(first[i]));
+			}
+		}
+
+		size_t touched = 0;
+	};
+
+	void expect_sublinear(Complexity complexity, const char * operation)
+	{
+		const Complexity expected = Complexity::OLogN;
+		EXPECT_LE(complexity, expected) << operation << " reported " << to_string(complexity)
+		                                << ", expected no worse than " << to_string(expected);
+		EXPECT_NE(complexity, Complexity::ERROR) << operation << " could not be measured";
+	}
+} // namespace
+
+TEST(LocationHashComplexityTest, AddIsConstant)
+{
+	Workload workload;
+	expect_sublinear(measure_time_complexity([&](size_t count) { workload.build(count); },
+	                                         [&](size_t count) {
+		                                         for (size_t i = count; i < count + batch_size; ++i) {
+			                                         workload.hash.add(&workload.objects[i], workload.positions[i]);
+		                                         }
+	                                         },
+	                                         [&](size_t count) {
+		                                         workload.look_up(&workload.positions[count], batch_size);
+	                                         },
+	                                         indices, repetitions),
+	                 "add");
+}
+
+TEST(LocationHashComplexityTest, MoveIsConstant)
+{
+	Workload workload;
+	expect_sublinear(measure_time_complexity([&](size_t count) { workload.build(count); },
+	                                         [&](size_t) {
+		                                         for (size_t i = 0; i < batch_size; ++i) {
+			                                         workload.hash.move(&workload.objects[i], workload.positions[i],
+			                                                            workload.targets[i]);
+		                                         }
+	                                         },
+	                                         [&](size_t) {
+		                                         workload.look_up(workload.positions.data(), batch_size);
+		                                         workload.look_up(workload.targets.data(), batch_size);
+	                                         },
+	                                         indices, repetitions),
+	                 "move");
+}
+
+TEST(LocationHashComplexityTest, RemoveIsConstant)
+{
+	Workload workload;
+	expect_sublinear(measure_time_complexity([&](size_t count) { workload.build(count); },
+	                                         [&](size_t) {
+		                                         for (size_t i = 0; i < batch_size; ++i) {
+			                                         workload.hash.remove(&workload.objects[i], workload.positions[i]);
+		                                         }
+	                                         },
+	                                         [&](size_t) { workload.look_up(workload.positions.data(), batch_size); },
+	                                         indices, repetitions),
+	                 "remove");
+}
+
+TEST(LocationHashComplexityTest, QueryIsConstant)
+{
+	Workload workload;
+	size_t   found = 0;
+	expect_sublinear(measure_time_complexity([&](size_t count) { workload.build(count); },
+	                                         [&](size_t) {
+		                                         for (const auto & target : workload.targets) {
+			                                         found += workload.hash.query(target).size();
+		                                         }
+	                                         },
+	                                         [&](size_t) { workload.look_up(workload.targets.data(), batch_size); },
+	                                         indices, repetitions),
+	                 "query");
+	EXPECT_GT(found, 0u);
+}
+
+TEST(LocationHashComplexityTest, QueryWithinDistanceIsConstant)
+{
+	Workload                        workload;
+	std::vector<ComplexityObject *> result;
+	size_t                          found = 0;
+	expect_sublinear(measure_time_complexity([&](size_t count) { workload.build(count); },
+	                                         [&](size_t) {
+		                                         for (const auto & target : workload.targets) {
+			                                         query_within_distance(workload.hash, target, 32.0f, result);
+			                                         found += result.size();
+		                                         }
+	                                         },
+	                                         [&](size_t) { workload.look_up(workload.targets.data(), batch_size); },
+	                                         indices, repetitions),
+	                 "query_within_distance");
+	EXPECT_GT(found, 0u);
+}
+
+// A full BoundedLocationHash evicts on every add, so this times the recency bookkeeping and victim selection. The
+// baseline queries the same cells.
+TEST(LocationHashComplexityTest, BoundedAddWithEvictionIsConstant)
+{
+	Workload                               workload;
+	std::unique_ptr<BoundedComplexityHash> bounded;
+	expect_sublinear(measure_time_complexity(
+	                     [&](size_t count) {
+		                     workload.build(count);
+		                     bounded = std::make_unique<BoundedComplexityHash>(count);
+		                     for (size_t i = 0; i < count; ++i) {
+			                     bounded->add(&workload.objects[i], workload.positions[i],
+			                                  static_cast<unsigned>(i % 4));
+		                     }
+	                     },
+	                     [&](size_t count) {
+		                     for (size_t i = count; i < count + batch_size; ++i) {
+			                     bounded->add(&workload.objects[i], workload.positions[i]);
+		                     }
+	                     },
+	                     [&](size_t count) {
+		                     for (size_t i = count; i < count + batch_size; ++i) {
+			                     workload.touched += bounded->query(workload.positions[i]).size();
+		                     }
+	                     },
+	                     indices, repetitions),
+	                 "bounded add with eviction");
+	EXPECT_GT(bounded->evicted_cells(), 0u);
+}
+
+// Canary: when every object shares one bucket, remove() degenerates into a linear scan of that bucket. The suite
+// must report it, or the tests above would pass even if the measurements could not see O(n) behavior. It is measured
+// against the same kind of baseline as the tests above, so it also shows that the baseline does not hide it.
+TEST(LocationHashComplexityTest, DetectsLinearBucketScan)
+{
+	std::vector<ComplexityObject> objects(largest_index);
+	ComplexityHash                hash;
+	const Position                crowded = {1.0f, 1.0f};
+
+	size_t           found      = 0;
+	const Complexity complexity = measure_time_complexity(
+	    [&](size_t count) {
+		    hash.clear();
+		    for (size_t i = 0; i < count; ++i) {
+			    hash.add(&objects[i], crowded);
+		    }
+	    },
+	    [&](size_t count) {
+		    // the most recently added objects sit at the back of the bucket, so each remove scans all of it
+		    for (size_t i = 0; i < canary_batch_size; ++i) {
+			    hash.remove(&objects[count - 1 - i], crowded);
+		    }
+	    },
+	    [&](size_t) {
+		    for (size_t i = 0; i < canary_batch_size; ++i) {
+			    found += hash.get_data().count(ComplexityHash::QuantizedCoordinateType(crowded));
+		    }
+	    },
+	    indices, repetitions);
+
+	EXPECT_GE(complexity, Complexity::ON) << "single-bucket remove reported " << to_string(complexity);
+}
@@ -0,0 +1,169 @@
+#include "lochash/location_hash_compressing.hpp"
+#include "gtest/gtest.h"
+#include <map>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Resident {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using Compressing          = CompressingLocationHash<precision, float, 2, Resident>;
+
+	template <typename Bucket>
+	std::vector<std::pair<std::array<float, 2>, Resident *>> entries_of(const Bucket & bucket)
+	{
+		return {bucket.begin(), bucket.end()};
+	}
+} // namespace
+
+TEST(CompressingLocationHashTest, CompressesColdCellsAndExpandsThemOnAccess)
+{
+	std::vector<Resident> residents(40);
+	Compressing           locationHash;
+	for (size_t i = 0; i < residents.size(); ++i) {
+		residents[i].id = i;
+		// half in a cell that stays busy, half in one that goes cold
+		locationHash.add(&residents[i], {static_cast<float>(i % 2) * 96.0f + static_cast<float>(i) * 0.15f, 100.0f});
+	}
+	const auto cold_before = entries_of(locationHash.query({96.0f, 100.0f}));
+	for (int i = 0; i < 3; ++i) {
+		locationHash.advance_epoch();
+		locationHash.query({0.0f, 100.0f});
+	}
+	EXPECT_EQ(locationHash.epoch(), 3u);
+
+	EXPECT_EQ(locationHash.compress_cold(2), 1u);
+	EXPECT_EQ(locationHash.compress_cold(2), 0u); // already compressed
+	auto statistics = locationHash.statistics();
+	EXPECT_EQ(statistics.compressions, 1u);
+	EXPECT_EQ(statistics.compressed_cells, 1u);
+	EXPECT_EQ(statistics.raw_bytes, 20 * sizeof(Compressing::Entry));
+	EXPECT_GT(statistics.bytes_saved(), statistics.raw_bytes / 2);
+	EXPECT_EQ(locationHash.size(), residents.size());
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+
+	// exact coordinates and bucket order survive
+	EXPECT_EQ(entries_of(locationHash.query({96.0f, 100.0f})), cold_before);
+	statistics = locationHash.statistics();
+	EXPECT_EQ(statistics.decompressions, 1u);
+	EXPECT_EQ(statistics.compressed_cells, 0u);
+	EXPECT_EQ(statistics.bytes_saved(), 0u);
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+}
+
+TEST(CompressingLocationHashTest, UpdatesExpandCompressedCells)
+{
+	Resident    a{1}, b{2}, c{3};
+	Compressing locationHash;
+	locationHash.add(&a, {209.0f, 209.0f});
+	locationHash.add(&b, {210.0f, 210.0f});
+	locationHash.add(&c, {240.0f, 210.0f});
+
+	ASSERT_EQ(locationHash.compress_cold(0), 2u);
+	EXPECT_TRUE(locationHash.move(&a, {209.0f, 209.0f}, {211.0f, 211.0f})); // within the bucket
+	EXPECT_EQ(entries_of(locationHash.query({208.0f, 208.0f}))[0].first, (std::array<float, 2>{211.0f, 211.0f}));
+
+	ASSERT_EQ(locationHash.compress_cold(0), 1u);
+	EXPECT_FALSE(locationHash.move(&c, {209.0f, 209.0f}, {210.0f, 209.0f}));
+	EXPECT_FALSE(locationHash.move(&c, {-100.0f, 1.0f}, {-101.0f, 1.0f}));
+	EXPECT_FALSE(locationHash.remove(&c, {209.0f, 209.0f}));
+	EXPECT_FALSE(locationHash.remove(&c, {-100.0f, 1.0f}));
+	EXPECT_TRUE(locationHash.move(&b, {210.0f, 210.0f}, {241.0f, 210.0f}));
+	EXPECT_EQ(locationHash.query({240.0f, 208.0f}).size(), 2u);
+
+	ASSERT_EQ(locationHash.compress_cold(0), 2u);
+	locationHash.add(&b, {213.0f, 213.0f});
+	EXPECT_EQ(locationHash.query({208.0f, 208.0f}).size(), 2u);
+	EXPECT_EQ(locationHash.statistics().compressed_cells, 1u);
+	EXPECT_TRUE(locationHash.query({-100.0f, 0.0f}).empty());
+}
+
+TEST(CompressingLocationHashTest, RoundTripsIntegerAndExtremeCoordinates)
+{
+	CompressingLocationHash<precision, int32_t, 3, Resident> integers;
+	Resident                                                  residents[3] = {{0}, {1}, {2}};
+	integers.add(&residents[0], {-17, 4, 1 << 30});
+	integers.add(&residents[1], {-31, 15, (1 << 30) + 15});
+	integers.add(&residents[2], {-20, 0, 1 << 30});
+	const auto bucket = integers.query({-17, 4, 1 << 30});
+	const auto before = std::vector(bucket.begin(), bucket.end());
+	ASSERT_EQ(integers.compress_cold(0), 1u);
+	const auto after = integers.query({-17, 4, 1 << 30});
+	EXPECT_TRUE(std::equal(before.begin(), before.end(), after.begin(), after.end()));
+
+	// a cell whose packed form would not be smaller is left alone
+	CompressingLocationHash<precision, double, 1, Resident> sparse;
+	const auto far_pointer = reinterpret_cast<Resident *>(uintptr_t(1) << (sizeof(uintptr_t) * 8 - 2));
+	sparse.add(far_pointer, {-1e-300});
+	EXPECT_EQ(sparse.compress_cold(0), 0u);
+	EXPECT_EQ(sparse.statistics().compressed_cells, 0u);
+}
+
+TEST(CompressingLocationHashTest, ChurnWithCompressionMatchesLocationHash)
+{
+	constexpr size_t                            count = 300;
+	Compressing                                 compressing;
+	LocationHash<precision, float, 2, Resident> reference;
+	std::vector<Resident>                       residents(count);
+	std::vector<std::array<float, 2>>           positions(count);
+	std::vector<bool>                           present(count, false);
+	std::mt19937                                rng(21);
+	std::uniform_real_distribution<float>       coordinate(-300.0f, 300.0f);
+	std::uniform_real_distribution<float>       step(-6.0f, 6.0f);
+
+	const auto sorted = [](std::vector<Resident *> objects) {
+		std::sort(objects.begin(), objects.end());
+		return objects;
+	};
+	std::vector<Resident *> compressing_result;
+	std::vector<Resident *> reference_result;
+	for (size_t i = 0; i < 12000; ++i) {
+		// only a small area is active at a time, so the rest goes cold
+		const size_t id  = ((i / 2000) * 40 + rng() % 80) % count;
+		residents[id].id = id;
+		if (!present[id]) {
+			positions[id] = {coordinate(rng), coordinate(rng)};
+			compressing.add(&residents[id], positions[id]);
+			reference.add(&residents[id], positions[id]);
+			present[id] = true;
+		} else if (rng() % 5 == 0) {
+			ASSERT_TRUE(compressing.remove(&residents[id], positions[id]));
+			reference.remove(&residents[id], positions[id]);
+			present[id] = false;
+		} else {
+			const std::array<float, 2> to = {positions[id][0] + step(rng), positions[id][1] + step(rng)};
+			ASSERT_TRUE(compressing.move(&residents[id], positions[id], to));
+			reference.remove(&residents[id], positions[id]);
+			reference.add(&residents[id], to);
+			positions[id] = to;
+		}
+
+		if (i % 100 == 99) {
+			compressing.advance_epoch();
+			compressing.compress_cold(3);
+
+			const std::array<float, 2> center = {coordinate(rng), coordinate(rng)};
+			query_bounding_box(compressing, {center[0] - 50.0f, center[1] - 50.0f},
+			                   {center[0] + 50.0f, center[1] + 50.0f}, compressing_result);
+			query_bounding_box(reference, {center[0] - 50.0f, center[1] - 50.0f},
+			                   {center[0] + 50.0f, center[1] + 50.0f}, reference_result);
+			EXPECT_EQ(sorted(compressing_result), sorted(reference_result));
+			query_within_distance(compressing, center, 60.0f, compressing_result);
+			query_within_distance(reference, center, 60.0f, reference_result);
+			EXPECT_EQ(sorted(compressing_result), sorted(reference_result));
+			EXPECT_EQ(query_nearest(compressing, center, 3), query_nearest(reference, center, 3));
+		}
+	}
+	EXPECT_EQ(compressing.size(), static_cast<size_t>(std::count(present.begin(), present.end(), true)));
+	EXPECT_GT(compressing.statistics().compressions, 0u);
+	EXPECT_GT(compressing.statistics().decompressions, 0u);
+	EXPECT_GT(compressing.statistics().compressed_cells, 0u);
+}
@@ -0,0 +1,289 @@
+#include "lochash/location_hash_disk.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	constexpr size_t precision = 16;
+	using DiskHash             = DiskLocationHash<precision, float, 2, uint64_t, int64_t, 4>;
+	using Point                = std::array<float, 2>;
+
+	std::vector<uint64_t> brute_force_box(const std::vector<Point> & positions, const std::vector<bool> & present,
+	                                      const Point & lower, const Point & upper)
+	{
+		std::vector<uint64_t> ids;
+		for (uint64_t id = 0; id < positions.size(); ++id) {
+			if (present[id] && detail::within_bounds(positions[id], lower, upper)) {
+				ids.push_back(id);
+			}
+		}
+		return ids;
+	}
+
+	std::vector<uint64_t> ids_of(const std::vector<DiskHash::Entry> & entries)
+	{
+		std::vector<uint64_t> ids;
+		for (const auto & entry : entries) {
+			ids.push_back(entry.payload);
+		}
+		std::sort(ids.begin(), ids.end());
+		return ids;
+	}
+} // namespace
+
+TEST(DiskLocationHashTest, PersistsAcrossReopen)
+{
+	TempFile file("lochash_test_disk_persist.bin");
+	{
+		DiskHash locationHash(file.path());
+		EXPECT_TRUE(locationHash.empty());
+		locationHash.add(1, {1.0f, 1.0f});
+		locationHash.add(2, {2.0f, 3.0f});
+		locationHash.add(3, {40.0f, 3.0f});
+		EXPECT_EQ(locationHash.size(), 3u);
+		EXPECT_EQ(locationHash.cell_count(), 2u);
+	}
+
+	DiskHash locationHash(file.path());
+	EXPECT_EQ(locationHash.size(), 3u);
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+	ASSERT_EQ(locationHash.query({0.0f, 0.0f}).size(), 2u);
+	EXPECT_EQ(locationHash.query({0.0f, 0.0f})[1].payload, 2u);
+	EXPECT_EQ(locationHash.query({0.0f, 0.0f})[1].coordinates, (Point{2.0f, 3.0f}));
+	EXPECT_TRUE(locationHash.query({-100.0f, 0.0f}).empty());
+
+	std::vector<DiskHash::Entry> result;
+	query_within_distance(locationHash, {40.0f, 4.0f}, 2.0f, result);
+	ASSERT_EQ(result.size(), 1u);
+	EXPECT_EQ(result[0].payload, 3u);
+}
+
+TEST(DiskLocationHashTest, UpdatesMatchBruteForceWithASmallCache)
+{
+	TempFile file("lochash_test_disk_churn.bin");
+
+	constexpr size_t                      count = 3000;
+	std::vector<Point>                    positions(count);
+	std::vector<bool>                     present(count, false);
+	std::mt19937                          rng(5);
+	std::uniform_real_distribution<float> coordinate(0.0f, 400.0f);
+	std::uniform_real_distribution<float> step(-24.0f, 24.0f);
+
+	{
+		DiskHash locationHash(file.path(), 16);
+		for (uint64_t id = 0; id < count; ++id) {
+			positions[id] = {coordinate(rng), coordinate(rng)};
+			locationHash.add(id, positions[id]);
+			present[id] = true;
+		}
+		for (size_t i = 0; i < 6000; ++i) {
+			const uint64_t id = rng() % count;
+			if (!present[id]) {
+				positions[id] = {coordinate(rng), coordinate(rng)};
+				locationHash.add(id, positions[id]);
+				present[id] = true;
+			} else if (rng() % 3 == 0) {
+				ASSERT_TRUE(locationHash.remove(id, positions[id]));
+				present[id] = false;
+			} else {
+				const Point to = {positions[id][0] + step(rng), positions[id][1] + step(rng)};
+				ASSERT_TRUE(locationHash.move(id, positions[id], to));
+				positions[id] = to;
+			}
+			ASSERT_LE(locationHash.cached_cell_count(), 16u);
+		}
+		EXPECT_FALSE(locationHash.remove(count + 1, positions[0]));
+		EXPECT_FALSE(locationHash.remove(0, {-1000.0f, -1000.0f}));
+		EXPECT_FALSE(locationHash.move(count + 1, positions[0], positions[0]));
+		EXPECT_FALSE(locationHash.move(count + 1, {-1000.0f, -1000.0f}, {-1001.0f, -1000.0f}));
+		EXPECT_FALSE(locationHash.move(count + 1, positions[0], {-1000.0f, -1000.0f}));
+		EXPECT_GT(locationHash.statistics().writes, 0u);
+	}
+
+	DiskHash locationHash(file.path(), 64);
+	EXPECT_EQ(locationHash.size(), static_cast<size_t>(std::count(present.begin(), present.end(), true)));
+
+	std::vector<DiskHash::Entry> result;
+	for (size_t i = 0; i < 40; ++i) {
+		const Point center = {coordinate(rng), coordinate(rng)};
+		const Point lower  = {center[0] - 60.0f, center[1] - 60.0f};
+		const Point upper  = {center[0] + 60.0f, center[1] + 60.0f};
+		query_bounding_box(locationHash, lower, upper, result);
+		EXPECT_EQ(ids_of(result), brute_force_box(positions, present, lower, upper));
+	}
+}
+
+TEST(DiskLocationHashTest, PrefetchCoalescesAdjacentCells)
+{
+	TempFile file("lochash_test_disk_prefetch.bin");
+	{
+		// one entry per cell, written in order, so neighbouring cells have adjacent extents
+		DiskHash locationHash(file.path());
+		for (uint64_t id = 0; id < 8; ++id) {
+			locationHash.add(id, {static_cast<float>(id * precision) + 1.0f, 1.0f});
+		}
+	}
+
+	DiskHash                     locationHash(file.path());
+	std::vector<DiskHash::Entry> result;
+	query_bounding_box(locationHash, {0.0f, 0.0f}, {200.0f, 8.0f}, result);
+	EXPECT_EQ(result.size(), 8u);
+	EXPECT_EQ(locationHash.statistics().misses, 8u);
+	EXPECT_LT(locationHash.statistics().reads, 8u);
+
+	// a second query is served from the cache
+	query_bounding_box(locationHash, {0.0f, 0.0f}, {200.0f, 8.0f}, result);
+	EXPECT_EQ(locationHash.statistics().misses, 8u);
+	EXPECT_GE(locationHash.statistics().hits, 8u);
+}
+
+TEST(DiskLocationHashTest, GrowingCellsMoveAndReuseExtents)
+{
+	TempFile file("lochash_test_disk_grow.bin");
+	{
+		DiskHash locationHash(file.path(), 1);
+		for (uint64_t id = 0; id < 40; ++id) {
+			locationHash.add(id, {1.0f, 1.0f});    // one cell growing past its extent
+			locationHash.add(id, {100.0f, 1.0f}); // evicts it every time
+		}
+		for (uint64_t id = 0; id < 40; ++id) {
+			ASSERT_TRUE(locationHash.remove(id, {100.0f, 1.0f}));
+		}
+		EXPECT_EQ(locationHash.cell_count(), 1u);
+		locationHash.flush(); // extents freed above are reused only once no directory in the file points at them
+		for (uint64_t id = 0; id < 40; ++id) {
+			locationHash.add(id, {300.0f, 1.0f}); // fits in extents freed above
+		}
+	}
+	const auto size = std::filesystem::file_size(file.path());
+
+	DiskHash locationHash(file.path());
+	EXPECT_EQ(locationHash.query({1.0f, 1.0f}).size(), 40u);
+	EXPECT_EQ(locationHash.query({300.0f, 1.0f}).size(), 40u);
+	EXPECT_TRUE(locationHash.query({100.0f, 1.0f}).empty());
+	locationHash.flush();
+	EXPECT_EQ(std::filesystem::file_size(file.path()), size);
+}
+
+// A second instance opening the file sees what a crash would leave: the state of the last flush, even after cells
+// were added at the end of the file, emptied or moved by evictions since.
+TEST(DiskLocationHashTest, FileKeepsTheLastFlushUntilTheNext)
+{
+	TempFile   file("lochash_test_disk_between_flushes.bin");
+	const auto position = [](uint64_t id) { return Point{static_cast<float>(id) * 20.0f, 1.0f}; };
+
+	DiskHash locationHash(file.path(), 1);
+	for (uint64_t id = 0; id < 20; ++id) {
+		locationHash.add(id, position(id));
+	}
+	locationHash.flush();
+
+	for (uint64_t id = 0; id < 10; ++id) {
+		ASSERT_TRUE(locationHash.remove(id, position(id)));
+	}
+	for (uint64_t id = 20; id < 60; ++id) {
+		locationHash.add(id, position(id)); // new cells, each written back as the next evicts it
+	}
+	for (uint64_t id = 100; id < 120; ++id) {
+		locationHash.add(id, position(15)); // outgrows its extent and moves
+		locationHash.add(id, position(id));
+	}
+
+	{
+		DiskHash flushed(file.path());
+		EXPECT_EQ(flushed.size(), 20u);
+		EXPECT_EQ(flushed.cell_count(), 20u);
+		for (uint64_t id = 0; id < 20; ++id) {
+			ASSERT_EQ(flushed.query(position(id)).size(), 1u) << id;
+			EXPECT_EQ(flushed.query(position(id))[0].payload, id);
+		}
+	}
+
+	locationHash.flush();
+	DiskHash reopened(file.path());
+	EXPECT_EQ(reopened.size(), locationHash.size());
+	EXPECT_EQ(reopened.query(position(15)).size(), 21u);
+	EXPECT_TRUE(reopened.query(position(5)).empty());
+}
+
+TEST(DiskLocationHashTest, ReleasedExtentsCoalesce)
+{
+	TempFile file("lochash_test_disk_coalesce.bin");
+	DiskHash locationHash(file.path());
+	for (uint64_t id = 0; id < 8; ++id) {
+		locationHash.add(id, {static_cast<float>(id) * 20.0f, 1.0f}); // one page each, side by side
+	}
+	locationHash.flush();
+	for (uint64_t id = 0; id < 8; ++id) {
+		ASSERT_TRUE(locationHash.remove(id, {static_cast<float>(id) * 20.0f, 1.0f}));
+	}
+	locationHash.flush();
+	const auto size = std::filesystem::file_size(file.path());
+
+	// eight pages' worth fits only where the eight single pages were merged back into one extent
+	for (uint64_t id = 0; id < 32; ++id) {
+		locationHash.add(id, {1.0f, 1.0f});
+	}
+	locationHash.flush();
+	EXPECT_EQ(std::filesystem::file_size(file.path()), size);
+}
+
+TEST(DiskLocationHashTest, RejectsMismatchedFiles)
+{
+	TempFile file("lochash_test_disk_mismatch.bin");
+	{
+		DiskHash locationHash(file.path());
+		locationHash.add(1, {1.0f, 1.0f});
+	}
+	using Other = DiskLocationHash<precision, double, 2, uint64_t>;
+	EXPECT_THROW(Other other(file.path()), std::system_error);
+
+	const auto missing_directory = std::filesystem::temp_directory_path() / "lochash_no_such_directory" / "index.bin";
+	EXPECT_THROW(DiskHash missing(missing_directory.string()), std::system_error);
+}
+
+TEST(DiskLocationHashTest, RejectsCorruptDirectories)
+{
+	TempFile file("lochash_test_disk_corrupt.bin");
+	{
+		DiskHash locationHash(file.path());
+		locationHash.add(1, {1.0f, 1.0f});
+		locationHash.add(2, {100.0f, 1.0f});
+	}
+
+	// The header holds the page count at byte 48 and the directory's first page at byte 56. The directory starts
+	// with the first cell's key, followed by its first page.
+	constexpr uint64_t header_bytes = 80;
+	constexpr uint64_t page_bytes   = 4 * sizeof(DiskHash::Entry);
+	const auto         read_word    = [&](uint64_t offset) {
+		uint64_t      word = 0;
+		std::ifstream in(file.path(), std::ios::binary);
+		in.seekg(static_cast<std::streamoff>(offset));
+		in.read(reinterpret_cast<char *>(&word), sizeof(word));
+		return word;
+	};
+	const auto write_word = [&](uint64_t offset, uint64_t word) {
+		std::fstream out(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+		out.seekp(static_cast<std::streamoff>(offset));
+		out.write(reinterpret_cast<const char *>(&word), sizeof(word));
+	};
+	const uint64_t page_count       = read_word(48);
+	const uint64_t first_page_field = header_bytes + read_word(56) * page_bytes + 2 * sizeof(int64_t);
+	const uint64_t first_page       = read_word(first_page_field);
+
+	write_word(first_page_field, page_count); // an extent past the last page
+	EXPECT_THROW(DiskHash corrupt(file.path()), std::system_error);
+
+	write_word(first_page_field, first_page);
+	write_word(48, 0); // the directory itself past the last page
+	EXPECT_THROW(DiskHash corrupt(file.path()), std::system_error);
+
+	write_word(48, page_count);
+	DiskHash restored(file.path());
+	EXPECT_EQ(restored.size(), 2u);
+}
@@ -0,0 +1,91 @@
+#include "lochash/location_hash.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Point                = std::array<float, 2>;
+
+	std::vector<Entity *> all_of(const Index & locationHash)
+	{
+		std::vector<Entity *> objects;
+		for (const auto & [key, bucket] : locationHash.get_data()) {
+			for (const auto & [coordinates, object] : bucket) {
+				objects.push_back(object);
+			}
+		}
+		std::sort(objects.begin(), objects.end());
+		return objects;
+	}
+} // namespace
+
+TEST(LocationHashEraseTest, ClearRegionRemovesExactlyTheEntriesInTheBox)
+{
+	std::vector<Entity>                   entities(1500);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(37);
+	std::uniform_real_distribution<float> coordinate(-400.0f, 400.0f);
+	Index                                 locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		locationHash.add(&entities[i], positions[i]);
+	}
+
+	// a small box enumerates its cells, one larger than the occupied set scans the map
+	const std::vector<std::pair<Point, Point>> boxes = {{{-57.3f, -20.5f}, {61.9f, 88.1f}},
+	                                                    {{-100000.0f, 150.5f}, {100000.0f, 100000.0f}},
+	                                                    {{5.0f, 5.0f}, {-5.0f, -5.0f}}};
+	std::vector<bool>                          cleared(entities.size(), false);
+	for (const auto & [lower, upper] : boxes) {
+		std::vector<Entity *> expected;
+		for (size_t i = 0; i < entities.size(); ++i) {
+			const bool inside = lower[0] <= positions[i][0] && positions[i][0] <= upper[0] &&
+			                    lower[1] <= positions[i][1] && positions[i][1] <= upper[1];
+			cleared[i]        = cleared[i] || inside;
+			if (!cleared[i]) {
+				expected.push_back(&entities[i]);
+			}
+		}
+
+		const size_t before  = all_of(locationHash).size();
+		const size_t removed = locationHash.clear_region(lower, upper);
+		EXPECT_EQ(all_of(locationHash), expected);
+		EXPECT_EQ(removed, before - expected.size());
+		for (const auto & [key, bucket] : locationHash.get_data()) {
+			EXPECT_FALSE(bucket.empty());
+		}
+	}
+}
+
+TEST(LocationHashEraseTest, EraseIfCompactsBucketsAndDropsEmptyOnes)
+{
+	std::vector<Entity> entities(200);
+	Index               locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		locationHash.add(&entities[i], {static_cast<float>(i % 20) * 4.0f, static_cast<float>(i / 20) * 40.0f});
+	}
+	const size_t cells = locationHash.get_data().size();
+
+	// every row with an odd y empties its cells; the rest lose their odd ids
+	const size_t removed = locationHash.erase_if([](const Point & coordinates, const Entity * entity) {
+		return static_cast<int>(coordinates[1] / 40.0f) % 2 == 1 || entity->id % 2 == 1;
+	});
+	EXPECT_EQ(removed, 150u);
+	EXPECT_EQ(locationHash.get_data().size(), cells / 2);
+	for (const Entity * entity : all_of(locationHash)) {
+		EXPECT_EQ(entity->id % 2, 0);
+		EXPECT_EQ((entity->id / 20) % 2, 0);
+	}
+	EXPECT_EQ(locationHash.erase_if([](const auto &, const auto *) { return false; }), 0u);
+}
@@ -0,0 +1,185 @@
+#include "lochash/location_hash_fixed.hpp"
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct RealTimeObject {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+
+	template <typename Bucket>
+	std::vector<RealTimeObject *> objects_in(const Bucket & bucket)
+	{
+		std::vector<RealTimeObject *> objects;
+		for (const auto & [coordinates, object] : bucket) {
+			objects.push_back(object);
+		}
+		return objects;
+	}
+} // namespace
+
+TEST(FixedLocationHashTest, AddQueryRemove)
+{
+	FixedLocationHash<precision, float, 2, RealTimeObject, 4, 8> locationHash;
+	RealTimeObject                                               a{1}, b{2}, c{3};
+
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.add(&a, {1.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&b, {2.0f, 3.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&c, {40.0f, 3.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.size(), 3u);
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+
+	// buckets keep insertion order
+	EXPECT_EQ(objects_in(locationHash.query({0.0f, 0.0f})), (std::vector<RealTimeObject *>{&a, &b}));
+	EXPECT_TRUE(locationHash.query({-100.0f, 0.0f}).empty());
+
+	EXPECT_EQ(locationHash.remove(&c, {0.0f, 0.0f}), FixedCapacityResult::not_found);
+	EXPECT_EQ(locationHash.remove(&c, {-100.0f, 0.0f}), FixedCapacityResult::not_found);
+	EXPECT_EQ(locationHash.remove(&a, {1.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(objects_in(locationHash.query({0.0f, 0.0f})), (std::vector<RealTimeObject *>{&b}));
+	EXPECT_EQ(locationHash.remove(&b, {2.0f, 3.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.cell_count(), 1u);
+
+	size_t buckets = 0;
+	locationHash.for_each_bucket([&](const auto & key, const auto & bucket) {
+		EXPECT_EQ(key.quantized_[0], 32);
+		EXPECT_EQ(bucket.size(), 1u);
+		++buckets;
+	});
+	EXPECT_EQ(buckets, 1u);
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+	EXPECT_TRUE(locationHash.query({40.0f, 3.0f}).empty());
+}
+
+TEST(FixedLocationHashTest, ReportsExhaustionWithoutChanges)
+{
+	FixedLocationHash<precision, float, 2, RealTimeObject, 2, 3> locationHash;
+	RealTimeObject                                               objects[4] = {{0}, {1}, {2}, {3}};
+
+	EXPECT_EQ(locationHash.add(&objects[0], {1.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&objects[1], {20.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&objects[2], {40.0f, 1.0f}), FixedCapacityResult::cell_capacity_exhausted);
+	EXPECT_EQ(locationHash.add(&objects[2], {2.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&objects[3], {3.0f, 1.0f}), FixedCapacityResult::entry_capacity_exhausted);
+	EXPECT_EQ(locationHash.size(), 3u);
+
+	// moving out of a shared bucket into a third one needs a cell that is not there
+	EXPECT_EQ(locationHash.move(&objects[0], {1.0f, 1.0f}, {40.0f, 1.0f}),
+	          FixedCapacityResult::cell_capacity_exhausted);
+	EXPECT_EQ(objects_in(locationHash.query({1.0f, 1.0f})),
+	          (std::vector<RealTimeObject *>{&objects[0], &objects[2]}));
+
+	// moving the only entry out of a bucket frees the cell it needs
+	EXPECT_EQ(locationHash.move(&objects[1], {20.0f, 1.0f}, {40.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_TRUE(locationHash.query({20.0f, 1.0f}).empty());
+	EXPECT_EQ(objects_in(locationHash.query({40.0f, 1.0f})), (std::vector<RealTimeObject *>{&objects[1]}));
+
+	EXPECT_EQ(locationHash.move(&objects[3], {1.0f, 1.0f}, {40.0f, 1.0f}), FixedCapacityResult::not_found);
+	EXPECT_EQ(locationHash.move(&objects[3], {1.0f, 1.0f}, {2.0f, 1.0f}), FixedCapacityResult::not_found);
+	EXPECT_EQ(locationHash.move(&objects[3], {-80.0f, 1.0f}, {2.0f, 1.0f}), FixedCapacityResult::not_found);
+
+	// a freed entry is reused
+	EXPECT_EQ(locationHash.remove(&objects[2], {2.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.add(&objects[3], {41.0f, 1.0f}), FixedCapacityResult::ok);
+}
+
+TEST(FixedLocationHashTest, MoveWithinBucketUpdatesCoordinates)
+{
+	FixedLocationHash<precision, float, 2, RealTimeObject, 4, 4> locationHash;
+	RealTimeObject                                               a{1};
+	ASSERT_EQ(locationHash.add(&a, {1.0f, 1.0f}), FixedCapacityResult::ok);
+	EXPECT_EQ(locationHash.move(&a, {1.0f, 1.0f}, {9.0f, 9.0f}), FixedCapacityResult::ok);
+
+	std::vector<RealTimeObject *> result;
+	query_within_distance(locationHash, {9.0f, 9.0f}, 0.5f, result);
+	EXPECT_EQ(result, std::vector<RealTimeObject *>{&a});
+	query_bounding_box(locationHash, {0.0f, 0.0f}, {2.0f, 2.0f}, result);
+	EXPECT_TRUE(result.empty());
+}
+
+TEST(FixedLocationHashTest, ChurnMatchesLocationHash)
+{
+	constexpr size_t count = 400;
+	using Fixed            = FixedLocationHash<precision, float, 2, RealTimeObject, 2048, count>;
+	auto                                              fixed = std::make_unique<Fixed>();
+	LocationHash<precision, float, 2, RealTimeObject> dynamic;
+
+	std::vector<RealTimeObject>           objects(count);
+	std::vector<std::array<float, 2>>     positions(count);
+	std::vector<bool>                     present(count, false);
+	std::mt19937                          rng(11);
+	std::uniform_real_distribution<float> coordinate(-256.0f, 256.0f);
+	std::uniform_real_distribution<float> step(-20.0f, 20.0f);
+
+	for (size_t i = 0; i < 20000; ++i) {
+		const size_t id = rng() % count;
+		objects[id].id  = id;
+		if (!present[id]) {
+			positions[id] = {coordinate(rng), coordinate(rng)};
+			ASSERT_EQ(fixed->add(&objects[id], positions[id]), FixedCapacityResult::ok);
+			dynamic.add(&objects[id], positions[id]);
+			present[id] = true;
+		} else if (rng() % 4 == 0) {
+			ASSERT_EQ(fixed->remove(&objects[id], positions[id]), FixedCapacityResult::ok);
+			dynamic.remove(&objects[id], positions[id]);
+			present[id] = false;
+		} else {
+			const std::array<float, 2> to = {positions[id][0] + step(rng), positions[id][1] + step(rng)};
+			ASSERT_EQ(fixed->move(&objects[id], positions[id], to), FixedCapacityResult::ok);
+			// LocationHash keeps the old coordinates on a move within a bucket, so re-add to compare positions
+			dynamic.remove(&objects[id], positions[id]);
+			dynamic.add(&objects[id], to);
+			positions[id] = to;
+		}
+	}
+
+	ASSERT_EQ(fixed->cell_count(), dynamic.get_data().size());
+	size_t entries = 0;
+	for (const auto & [key, bucket] : dynamic.get_data()) {
+		const auto fixed_bucket = fixed->find(key);
+		ASSERT_EQ(fixed_bucket.size(), bucket.size());
+		std::multimap<RealTimeObject *, std::array<float, 2>> expected;
+		std::multimap<RealTimeObject *, std::array<float, 2>> actual;
+		for (const auto & [coordinates, object] : bucket) {
+			expected.emplace(object, coordinates);
+		}
+		for (const auto & [coordinates, object] : fixed_bucket) {
+			actual.emplace(object, coordinates);
+		}
+		EXPECT_EQ(actual, expected);
+		entries += bucket.size();
+	}
+	EXPECT_EQ(fixed->size(), entries);
+
+	const auto sorted = [](std::vector<RealTimeObject *> objects) {
+		std::sort(objects.begin(), objects.end());
+		return objects;
+	};
+	std::vector<RealTimeObject *>            fixed_result;
+	std::vector<RealTimeObject *>            dynamic_result;
+	NearestCandidates<float, RealTimeObject> candidates;
+	for (size_t i = 0; i < 50; ++i) {
+		const std::array<float, 2> center = {coordinate(rng), coordinate(rng)};
+		query_bounding_box(*fixed, {center[0] - 40.0f, center[1] - 40.0f}, {center[0] + 40.0f, center[1] + 40.0f},
+		                   fixed_result);
+		query_bounding_box(dynamic, {center[0] - 40.0f, center[1] - 40.0f}, {center[0] + 40.0f, center[1] + 40.0f},
+		                   dynamic_result);
+		EXPECT_EQ(sorted(fixed_result), sorted(dynamic_result));
+		query_within_distance(*fixed, center, 30.0f, fixed_result);
+		query_within_distance(dynamic, center, 30.0f, dynamic_result);
+		EXPECT_EQ(sorted(fixed_result), sorted(dynamic_result));
+		query_nearest(*fixed, center, 4, fixed_result, candidates);
+		EXPECT_EQ(fixed_result, query_nearest(dynamic, center, 4));
+	}
+}
@@ -0,0 +1,183 @@
+#include "lochash/location_hash_hotspots.hpp"
+#include "gtest/gtest.h"
+
+using namespace lochash;
+
+namespace
+{
+	struct HotObject {
+		size_t id;
+	};
+
+	constexpr size_t region_precision = 64;
+	using Tracker                     = HotspotTracker<region_precision, float, 2>;
+} // namespace
+
+TEST(HotspotTrackerTest, CountsActivityPerCell)
+{
+	Tracker hotspots;
+	hotspots.record_add({1.0f, 1.0f});
+	hotspots.record_add({63.0f, 10.0f}); // same 64x64 region
+	hotspots.record_move({70.0f, 10.0f});
+
+	const auto first = hotspots.activity({0.0f, 0.0f});
+	EXPECT_DOUBLE_EQ(first[static_cast<size_t>(Activity::add)], 2.0);
+	EXPECT_DOUBLE_EQ(first[static_cast<size_t>(Activity::move)], 0.0);
+
+	const auto second = hotspots.activity({100.0f, 60.0f});
+	EXPECT_DOUBLE_EQ(second[static_cast<size_t>(Activity::move)], 1.0);
+
+	const auto untouched = hotspots.activity({-500.0f, 0.0f});
+	EXPECT_DOUBLE_EQ(untouched[0] + untouched[1] + untouched[2], 0.0);
+	EXPECT_EQ(hotspots.cell_count(), 2u);
+
+	hotspots.clear();
+	EXPECT_EQ(hotspots.cell_count(), 0u);
+}
+
+TEST(HotspotTrackerTest, DecaysByHalfLife)
+{
+	Tracker hotspots(10.0);
+	for (size_t i = 0; i < 8; ++i) {
+		hotspots.record_add({1.0f, 1.0f});
+	}
+	EXPECT_EQ(hotspots.now(), 0u);
+
+	hotspots.advance(10);
+	EXPECT_EQ(hotspots.now(), 10u);
+	EXPECT_NEAR(hotspots.activity({1.0f, 1.0f})[0], 4.0, 1e-9);
+
+	// decay is applied before new events are added
+	hotspots.record_add({1.0f, 1.0f});
+	hotspots.advance(20);
+	EXPECT_NEAR(hotspots.activity({1.0f, 1.0f})[0], 5.0 / 4.0, 1e-9);
+
+	// a steady rate settles at rate / (1 - decay per tick)
+	Tracker steady(10.0);
+	for (size_t tick = 0; tick < 1000; ++tick) {
+		steady.record_add({1.0f, 1.0f});
+		steady.advance();
+	}
+	EXPECT_NEAR(steady.activity({1.0f, 1.0f})[0] * (1.0 - std::pow(0.5, 0.1)), std::pow(0.5, 0.1), 1e-6);
+}
+
+TEST(HotspotTrackerTest, RanksHottestCellsFirst)
+{
+	Tracker hotspots(100.0);
+	// region (0,0): 5 adds long ago; region (64,0): 3 moves now; region (128,0): 3 queries now
+	for (size_t i = 0; i < 5; ++i) {
+		hotspots.record_add({1.0f, 1.0f});
+	}
+	hotspots.advance(100);
+	for (size_t i = 0; i < 3; ++i) {
+		hotspots.record_move({65.0f, 1.0f});
+		hotspots.record(Tracker::Key(std::array<float, 2>{129.0f, 1.0f}), Activity::query);
+	}
+
+	const auto all = hotspots.top_hotspots(10);
+	ASSERT_EQ(all.size(), 3u);
+	// the two tied regions come first, ordered by key, then the decayed one
+	EXPECT_EQ(all[0].key.quantized_[0], 64);
+	EXPECT_EQ(all[1].key.quantized_[0], 128);
+	EXPECT_EQ(all[2].key.quantized_[0], 0);
+	EXPECT_DOUBLE_EQ(all[0].score, 3.0);
+	EXPECT_NEAR(all[2].score, 2.5, 1e-9);
+	EXPECT_NEAR(all[2].activity[static_cast<size_t>(Activity::add)], 2.5, 1e-9);
+
+	// weights pick what counts as hot
+	const auto by_queries = hotspots.top_hotspots(1, {0.0, 0.0, 1.0});
+	ASSERT_EQ(by_queries.size(), 1u);
+	EXPECT_EQ(by_queries[0].key.quantized_[0], 128);
+
+	EXPECT_TRUE(hotspots.top_hotspots(0).empty());
+}
+
+TEST(HotspotTrackerTest, PruneForgetsColdCells)
+{
+	Tracker hotspots(1.0);
+	hotspots.record_add({1.0f, 1.0f});
+	hotspots.advance(10);
+	hotspots.record(Tracker::Key(std::array<float, 2>{100.0f, 1.0f}), Activity::move, 4.0);
+
+	EXPECT_EQ(hotspots.prune(0.01), 1u);
+	EXPECT_EQ(hotspots.cell_count(), 1u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({100.0f, 1.0f})[static_cast<size_t>(Activity::move)], 4.0);
+}
+
+TEST(HotspotTrackerTest, TrackedQueriesMatchPlainQueries)
+{
+	LocationHash<16, float, 2, HotObject> locationHash;
+	HotObject                             obj1{1};
+	HotObject                             obj2{2};
+	locationHash.add(&obj1, {10.0f, 10.0f});
+	locationHash.add(&obj2, {100.0f, 10.0f});
+
+	Tracker                  hotspots;
+	std::vector<HotObject *> result;
+	query_bounding_box(locationHash, {0.0f, 0.0f}, {20.0f, 20.0f}, result, hotspots);
+	EXPECT_EQ(result, std::vector<HotObject *>{&obj1});
+	query_within_distance(locationHash, {100.0f, 10.0f}, 5.0f, result, hotspots);
+	EXPECT_EQ(result, std::vector<HotObject *>{&obj2});
+
+	EXPECT_DOUBLE_EQ(hotspots.activity({10.0f, 10.0f})[static_cast<size_t>(Activity::query)], 1.0);
+	EXPECT_DOUBLE_EQ(hotspots.activity({100.0f, 10.0f})[static_cast<size_t>(Activity::query)], 1.0);
+	EXPECT_EQ(hotspots.cell_count(), 2u);
+}
+
+TEST(HotspotTrackerTest, QueriesCountOnlyOccupiedCells)
+{
+	LocationHash<16, float, 2, HotObject> locationHash;
+	HotObject                             obj1{1};
+	HotObject                             obj2{2};
+	HotObject                             obj3{3};
+	locationHash.add(&obj1, {10.0f, 10.0f});
+	locationHash.add(&obj2, {40.0f, 10.0f}); // another bucket in the same 64x64 region
+	locationHash.add(&obj3, {-100.0f, 10.0f});
+
+	// the box overlaps hundreds of regions, but only the two that hold objects are tracked, each counted once
+	Tracker                  hotspots;
+	std::vector<HotObject *> result;
+	query_bounding_box(locationHash, {-1000.0f, -1000.0f}, {1000.0f, 1000.0f}, result, hotspots);
+	EXPECT_EQ(result.size(), 3u);
+	EXPECT_EQ(hotspots.cell_count(), 2u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({10.0f, 10.0f})[static_cast<size_t>(Activity::query)], 1.0);
+	EXPECT_DOUBLE_EQ(hotspots.activity({-100.0f, 10.0f})[static_cast<size_t>(Activity::query)], 1.0);
+
+	query_within_distance(locationHash, {0.0f, 0.0f}, 5000.0f, result, hotspots);
+	EXPECT_EQ(result.size(), 3u);
+	EXPECT_EQ(hotspots.cell_count(), 2u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({10.0f, 10.0f})[static_cast<size_t>(Activity::query)], 2.0);
+
+	// a query that finds nothing tracks nothing
+	query_bounding_box(locationHash, {500.0f, 500.0f}, {900.0f, 900.0f}, result, hotspots);
+	EXPECT_TRUE(result.empty());
+	EXPECT_EQ(hotspots.cell_count(), 2u);
+}
+
+TEST(HotspotTrackerTest, TrackedAddAndMove)
+{
+	LocationHash<16, float, 2, HotObject> locationHash;
+	HotObject                             obj1{1};
+	HotObject                             obj2{2};
+
+	Tracker hotspots;
+	tracked_add(locationHash, &obj1, {10.0f, 10.0f}, hotspots);
+	tracked_add(locationHash, &obj2, {20.0f, 10.0f}, hotspots);
+	EXPECT_EQ(locationHash.query({10.0f, 10.0f}).size(), 1u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({10.0f, 10.0f})[static_cast<size_t>(Activity::add)], 2.0);
+
+	EXPECT_TRUE(tracked_move(locationHash, &obj1, {10.0f, 10.0f}, {100.0f, 10.0f}, hotspots));
+	EXPECT_EQ(locationHash.query({100.0f, 10.0f}).size(), 1u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({100.0f, 10.0f})[static_cast<size_t>(Activity::move)], 1.0);
+
+	// a move of an object that is not there changes nothing and is not counted
+	EXPECT_FALSE(tracked_move(locationHash, &obj1, {10.0f, 10.0f}, {200.0f, 10.0f}, hotspots));
+	EXPECT_DOUBLE_EQ(hotspots.activity({200.0f, 10.0f})[static_cast<size_t>(Activity::move)], 0.0);
+
+	// a move within one cell keeps the object where it is in the index but is counted
+	EXPECT_TRUE(tracked_move(locationHash, &obj2, {20.0f, 10.0f}, {21.0f, 11.0f}, hotspots));
+	EXPECT_EQ(locationHash.query({21.0f, 11.0f}).size(), 1u);
+	EXPECT_DOUBLE_EQ(hotspots.activity({21.0f, 11.0f})[static_cast<size_t>(Activity::move)], 1.0);
+	EXPECT_FALSE(tracked_move(locationHash, &obj1, {20.0f, 10.0f}, {22.0f, 10.0f}, hotspots));
+	EXPECT_DOUBLE_EQ(hotspots.activity({22.0f, 10.0f})[static_cast<size_t>(Activity::move)], 1.0);
+}
@@ -0,0 +1,103 @@
+#include "lochash/location_hash_kinetic.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Kinetic              = KineticLocationHash<precision, double, 2, Entity>;
+	using Point                = std::array<double, 2>;
+} // namespace
+
+TEST(KineticLocationHashTest, QueriesEvaluateExtrapolatedPositions)
+{
+	Entity  runner{0}, statue{1};
+	Kinetic locationHash(4.0);
+	locationHash.update(&runner, {0.0, 0.0}, {10.0, 0.0}, 0.0);
+	locationHash.update(&statue, {50.0, 50.0}, {0.0, 0.0}, 0.0);
+	EXPECT_EQ(locationHash.size(), 2u);
+
+	std::vector<Entity *> found;
+	query_within_distance(locationHash, Point{30.0, 0.0}, 1.0, 3.0, found);
+	EXPECT_EQ(found, std::vector<Entity *>{&runner});
+	query_within_distance(locationHash, Point{30.0, 0.0}, 1.0, 1.0, found);
+	EXPECT_TRUE(found.empty());
+
+	// reported once, though the runner is indexed in every cell it sweeps through
+	query_bounding_box(locationHash, Point{-100.0, -100.0}, Point{100.0, 100.0}, 2.0, found);
+	EXPECT_EQ(found.size(), 2u);
+	EXPECT_GT(locationHash.cell_count(), 2u);
+
+	// only the moving entry expires
+	EXPECT_EQ(locationHash.refresh(4.0), 0u);
+	EXPECT_EQ(locationHash.refresh(1000.0), 1u);
+	EXPECT_EQ(locationHash.motion(&runner)->position, (Point{10000.0, 0.0}));
+	EXPECT_EQ(locationHash.motion(&statue)->time, 0.0);
+	query_bounding_box(locationHash, Point{10000.0, -1.0}, Point{10010.0, 1.0}, 1001.0, found);
+	EXPECT_EQ(found, std::vector<Entity *>{&runner});
+
+	// a velocity change re-indexes from the new motion
+	locationHash.update(&runner, {0.0, 0.0}, {0.0, -5.0}, 1000.0);
+	query_within_distance(locationHash, Point{0.0, -10.0}, 0.5, 1002.0, found);
+	EXPECT_EQ(found, std::vector<Entity *>{&runner});
+	EXPECT_EQ(locationHash.refresh(2000.0), 1u); // the expiry queued before the update is skipped
+
+	EXPECT_TRUE(locationHash.remove(&runner));
+	EXPECT_FALSE(locationHash.remove(&runner));
+	EXPECT_EQ(locationHash.motion(&runner), nullptr);
+	EXPECT_EQ(locationHash.cell_count(), 1u);
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+	EXPECT_EQ(locationHash.refresh(5000.0), 0u);
+	EXPECT_EQ(locationHash.horizon(), 4.0);
+}
+
+TEST(KineticLocationHashTest, MatchesBruteForceAcrossRefreshes)
+{
+	std::vector<Entity>                    entities(300);
+	std::vector<Kinetic::Motion>           motions(entities.size());
+	std::mt19937                           rng(23);
+	std::uniform_real_distribution<double> coordinate(-300.0, 300.0);
+	std::uniform_real_distribution<double> speed(-12.0, 12.0);
+	std::uniform_int_distribution<size_t>  pick(0, entities.size() - 1);
+
+	Kinetic locationHash(2.5);
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		motions[i]     = {{coordinate(rng), coordinate(rng)}, {speed(rng), speed(rng)}, 0.0};
+		locationHash.update(&entities[i], motions[i].position, motions[i].velocity, 0.0);
+	}
+
+	std::vector<Entity *> found;
+	for (double now = 0.0; now < 20.0; now += 0.75) {
+		locationHash.refresh(now);
+		for (int change = 0; change < 10; ++change) {
+			const size_t i = pick(rng);
+			motions[i]     = {motions[i].position_at(now), {speed(rng), speed(rng)}, now};
+			locationHash.update(&entities[i], motions[i].position, motions[i].velocity, now);
+		}
+
+		const Point center{coordinate(rng), coordinate(rng)};
+		query_within_distance(locationHash, center, 90.0, now, found);
+		std::vector<Entity *> expected;
+		for (size_t i = 0; i < entities.size(); ++i) {
+			const auto position = motions[i].position_at(now);
+			const auto dx = position[0] - center[0], dy = position[1] - center[1];
+			if (dx * dx + dy * dy <= 90.0 * 90.0) {
+				expected.push_back(&entities[i]);
+			}
+		}
+		std::sort(found.begin(), found.end());
+		std::sort(expected.begin(), expected.end());
+		EXPECT_EQ(found, expected) << "at time " << now;
+	}
+}
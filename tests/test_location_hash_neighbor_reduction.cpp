@@ -0,0 +1,87 @@
+#include "lochash/location_hash_neighbor_reduction.hpp"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Boid {
+		std::array<float, 2> velocity;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Boid>;
+	using Grid                 = CellGrid<precision, float, 2, Boid>;
+	using Point                = std::array<float, 2>;
+
+	// What a boid needs from its neighbours: how many there are, their summed velocity and a repulsion.
+	struct Flock {
+		size_t neighbours = 0;
+		Point  velocity{};
+		Point  push{};
+	};
+} // namespace
+
+TEST(NeighborReductionTest, SymmetricPairsMatchAPerEntryScan)
+{
+	std::vector<Boid>                     boids(1200);
+	std::mt19937                          rng(53);
+	std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> speed(-1.0f, 1.0f);
+	Index                                 locationHash;
+	for (auto & boid : boids) {
+		boid.velocity = {speed(rng), speed(rng)};
+		locationHash.add(&boid, {coordinate(rng), coordinate(rng)});
+	}
+	const Grid grid(locationHash);
+
+	for (const float radius : {5.0f, 16.0f, 30.0f}) {
+		SCOPED_TRACE(radius);
+		size_t kernel_calls = 0;
+
+		const auto steer = [&](size_t i, size_t j, float distance_squared, Flock & at_i, Flock & at_j) {
+			EXPECT_NE(i, j);
+			EXPECT_LE(distance_squared, radius * radius);
+			++kernel_calls;
+			++at_i.neighbours;
+			++at_j.neighbours;
+			for (size_t axis = 0; axis < 2; ++axis) {
+				at_i.velocity[axis] += grid.object(j)->velocity[axis];
+				at_j.velocity[axis] += grid.object(i)->velocity[axis];
+				const float away = grid.coordinates(i)[axis] - grid.coordinates(j)[axis];
+				at_i.push[axis] += away;
+				at_j.push[axis] -= away;
+			}
+		};
+		const auto flock = reduce_neighbors(grid, radius, Flock{}, steer);
+		ASSERT_EQ(flock.size(), grid.size());
+
+		size_t pairs = 0;
+		for (size_t i = 0; i < grid.size(); ++i) {
+			Flock expected;
+			for (size_t j = 0; j < grid.size(); ++j) {
+				if (i == j || calculate_distance_squared(grid.coordinates(i), grid.coordinates(j)) > radius * radius) {
+					continue;
+				}
+				++expected.neighbours;
+				for (size_t axis = 0; axis < 2; ++axis) {
+					expected.velocity[axis] += grid.object(j)->velocity[axis];
+					expected.push[axis] += grid.coordinates(i)[axis] - grid.coordinates(j)[axis];
+				}
+			}
+			pairs += expected.neighbours;
+			EXPECT_EQ(flock[i].neighbours, expected.neighbours);
+			for (size_t axis = 0; axis < 2; ++axis) {
+				EXPECT_NEAR(flock[i].velocity[axis], expected.velocity[axis], 1e-3f);
+				EXPECT_NEAR(flock[i].push[axis], expected.push[axis], 1e-2f);
+			}
+		}
+		// each pair is counted from both ends above, but the kernel ran once for it
+		EXPECT_EQ(kernel_calls * 2, pairs);
+		EXPECT_GT(kernel_calls, 0u);
+	}
+
+	const auto none = reduce_neighbors(Grid{Index()}, 10.0f, 0, [](size_t, size_t, float, int &, int &) {});
+	EXPECT_TRUE(none.empty());
+}
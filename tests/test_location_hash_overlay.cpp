@@ -0,0 +1,117 @@
+#include "lochash/location_hash_overlay.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Overlay              = LocationHashOverlay<precision, float, 2, Entity>;
+	using Point                = std::array<float, 2>;
+} // namespace
+
+TEST(LocationHashOverlayTest, ChangesAreVisibleThroughTheOverlayOnly)
+{
+	Entity a{0}, b{1}, c{2};
+	Index  base;
+	base.add(&a, {1.0f, 1.0f});
+	base.add(&b, {100.0f, 1.0f});
+	const auto original = contents_of(base);
+
+	Overlay overlay(base);
+	EXPECT_FALSE(overlay.has_changes());
+	overlay.add(&c, {2.0f, 2.0f});
+	EXPECT_TRUE(overlay.move(&b, {100.0f, 1.0f}, {-100.0f, 1.0f}));
+	EXPECT_TRUE(overlay.move(&a, {1.0f, 1.0f}, {3.0f, 3.0f}));
+	EXPECT_EQ(overlay.touched_cell_count(), 3u);
+
+	EXPECT_EQ(overlay.query({0.0f, 0.0f}).size(), 2u);
+	EXPECT_TRUE(overlay.query({100.0f, 1.0f}).empty());
+	EXPECT_EQ(overlay.query({-100.0f, 1.0f}).size(), 1u);
+	EXPECT_EQ(overlay.cell_count(), 2u);
+	EXPECT_EQ(contents_of(base), original);
+
+	std::vector<Entity *> found;
+	query_within_distance(overlay, Point{0.0f, 0.0f}, 5.0f, found);
+	std::sort(found.begin(), found.end(), [](Entity * x, Entity * y) { return x->id < y->id; });
+	EXPECT_EQ(found, (std::vector<Entity *>{&a, &c}));
+	query_bounding_box(overlay, Point{-110.0f, -10.0f}, Point{-90.0f, 10.0f}, found);
+	EXPECT_EQ(found, std::vector<Entity *>{&b});
+	EXPECT_EQ(query_nearest(overlay, Point{3.0f, 3.0f}, 1), std::vector<Entity *>{&a});
+
+	overlay.discard();
+	EXPECT_FALSE(overlay.has_changes());
+	EXPECT_EQ(overlay.cell_count(), 2u);
+	EXPECT_EQ(overlay.query({100.0f, 1.0f}).size(), 1u);
+	EXPECT_EQ(contents_of(base), original);
+}
+
+TEST(LocationHashOverlayTest, MissesDoNotTouchCells)
+{
+	Entity a{0}, b{1};
+	Index  base;
+	base.add(&a, {1.0f, 1.0f});
+
+	Overlay overlay(base);
+	EXPECT_FALSE(overlay.remove(&b, {1.0f, 1.0f}));
+	EXPECT_FALSE(overlay.remove(&a, {100.0f, 1.0f}));
+	EXPECT_FALSE(overlay.move(&b, {1.0f, 1.0f}, {2.0f, 2.0f}));
+	EXPECT_FALSE(overlay.move(&b, {1.0f, 1.0f}, {200.0f, 2.0f}));
+	EXPECT_FALSE(overlay.has_changes());
+
+	EXPECT_TRUE(overlay.remove(&a, {1.0f, 1.0f}));
+	EXPECT_EQ(overlay.cell_count(), 0u);
+	EXPECT_TRUE(query_nearest(overlay, Point{0.0f, 0.0f}, 3).empty());
+	EXPECT_EQ(&overlay.base(), &base);
+}
+
+TEST(LocationHashOverlayTest, CommitMatchesApplyingTheChangesDirectly)
+{
+	std::vector<Entity>                   entities(300);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(11);
+	std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+	std::uniform_real_distribution<float> step(-24.0f, 24.0f);
+	std::uniform_int_distribution<size_t> pick(0, entities.size() - 1);
+
+	Index base;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		base.add(&entities[i], positions[i]);
+	}
+
+	Index   expected = base;
+	Overlay overlay(base);
+	for (int update = 0; update < 200; ++update) {
+		const size_t i    = pick(rng);
+		const Point  next = {positions[i][0] + step(rng), positions[i][1] + step(rng)};
+		EXPECT_TRUE(overlay.move(&entities[i], positions[i], next));
+		expected.remove(&entities[i], positions[i]);
+		expected.add(&entities[i], next);
+		positions[i] = next;
+	}
+	Entity extra{-1};
+	overlay.add(&extra, {500.0f, 500.0f});
+	expected.add(&extra, {500.0f, 500.0f});
+	EXPECT_TRUE(overlay.remove(&entities[0], positions[0]));
+	expected.remove(&entities[0], positions[0]);
+
+	EXPECT_EQ(overlay.cell_count(), expected.get_data().size());
+	EXPECT_EQ(query_nearest(overlay, Point{0.0f, 0.0f}, 10), query_nearest(expected, Point{0.0f, 0.0f}, 10));
+	// far from everything, so the search scans the buckets instead of probing rings
+	EXPECT_EQ(query_nearest(overlay, Point{1.0e6f, -1.0e6f}, 10), query_nearest(expected, Point{1.0e6f, -1.0e6f}, 10));
+
+	overlay.commit();
+	EXPECT_FALSE(overlay.has_changes());
+	EXPECT_EQ(contents_of(base), contents_of(expected));
+	EXPECT_EQ(base.get_data().size(), expected.get_data().size());
+}
@@ -110,14 +110,19 @@ TEST(LocationHelpersTest, QueryBoundingBoxComplexity)
 			locationHash.add(&test_objects[i], {x, y});
 		}
 	};
+	size_t     found      = 0;
 	Complexity complexity = measure_time_complexity(
 	    setup,
 	    [&](size_t) {
 		    query_bounding_box(locationHash, {-50.0f, -50.0f}, {50.0f, 50.0f});
 	    },
+	    [&](size_t) {
+		    found += find_cells_in_range<precision, float, 2>(locationHash, {-50.0f, -50.0f}, {50.0f, 50.0f});
+	    },
 	    {10, 100, 1000}, 5);
 
 	const Complexity expectedComplexity = Complexity::O1;
+	EXPECT_NE(complexity, Complexity::ERROR);
 	EXPECT_LE(complexity, expectedComplexity)
 	    << "QueryBoundingBoxComplexityLabmdas test failed. Expected complexity threshold not met. Reported complexity: "
 	    << to_string(complexity) << " Expected complexity: " << to_string(expectedComplexity);
@@ -78,14 +78,19 @@ TEST(LocationHelpersTest, QueryDistanceComplexity)
 			locationHash.add(&test_objects[i], {x, y});
 		}
 	};
+	size_t     found      = 0;
 	Complexity complexity = measure_time_complexity(
 	    setup,
 	    [&](size_t) {
 		    query_within_distance(locationHash, {0.0f, 0.0f}, 500.0f);
 	    },
+	    [&](size_t) {
+		    found += find_cells_in_range<precision, float, 2>(locationHash, {-500.0f, -500.0f}, {500.0f, 500.0f});
+	    },
 	    {10, 100, 1000}, 5);
 
 	const Complexity expectedComplexity = Complexity::O1;
+	EXPECT_NE(complexity, Complexity::ERROR);
 	EXPECT_LE(complexity, expectedComplexity)
 	    << "QueryBoundingBoxComplexityLabmdas test failed. Expected complexity threshold not met. Reported complexity: "
 	    << to_string(complexity) << " Expected complexity: " << to_string(expectedComplexity);
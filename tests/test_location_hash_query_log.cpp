@@ -0,0 +1,173 @@
+#include "lochash/location_hash_query_log.hpp"
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+
+using namespace lochash;
+
+namespace
+{
+	struct LoggedObject {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using LoggedHash           = LocationHash<precision, float, 2, LoggedObject>;
+
+	// only the probe threshold can trigger, so the tests do not depend on timing
+	template <typename Log>
+	void log_by_cells_only(Log & log, size_t cells)
+	{
+		log.set_thresholds(std::chrono::hours(1), cells);
+	}
+} // namespace
+
+TEST(SlowQueryLogTest, RecordsCostBreakdownOfSlowQueries)
+{
+	LoggedHash   locationHash;
+	LoggedObject obj1{1};
+	LoggedObject obj2{2};
+	LoggedObject obj3{3};
+	locationHash.add(&obj1, {1.0f, 1.0f});
+	locationHash.add(&obj2, {2.0f, 2.0f});
+	locationHash.add(&obj3, {40.0f, 40.0f});
+
+	SlowQueryLog<float, 2> slowQueries;
+	log_by_cells_only(slowQueries, 9);
+	std::vector<LoggedObject *> result;
+
+	// 2x2 cells: under the threshold, not logged
+	query_bounding_box(locationHash, {0.0f, 0.0f}, {20.0f, 20.0f}, result, slowQueries);
+	EXPECT_EQ(result.size(), 2u);
+	EXPECT_EQ(slowQueries.drain([](const auto &) {}), 0u);
+
+	// 4x4 cells, two of them occupied, three candidates of which one is outside the box
+	const uint_least32_t line = __LINE__ + 1;
+	query_bounding_box(locationHash, {1.5f, 1.5f}, {50.0f, 50.0f}, result, slowQueries);
+	EXPECT_EQ(result.size(), 2u);
+
+	std::vector<SlowQueryLog<float, 2>::Record> records;
+	EXPECT_EQ(slowQueries.drain([&](const auto & record) { records.push_back(record); }), 1u);
+	ASSERT_EQ(records.size(), 1u);
+	const auto & record = records[0];
+	EXPECT_EQ(record.shape, QueryShape::bounding_box);
+	EXPECT_EQ(record.lower_bounds[0], 1.5f);
+	EXPECT_EQ(record.upper_bounds[1], 50.0f);
+	EXPECT_EQ(record.cells_enumerated, 16u);
+	EXPECT_EQ(record.cells_hit, 2u);
+	EXPECT_EQ(record.candidates_tested, 3u);
+	EXPECT_EQ(record.results_returned, 2u);
+	EXPECT_EQ(record.line, line);
+	EXPECT_NE(std::string(record.file).find("test_location_hash_query_log"), std::string::npos);
+	EXPECT_NE(std::string(record.function).find("RecordsCostBreakdownOfSlowQueries"), std::string::npos);
+
+	// within_distance records its radius and the box it enumerated
+	query_within_distance(locationHash, {0.0f, 0.0f}, 40.0f, result, slowQueries);
+	EXPECT_EQ(result.size(), 2u);
+	records.clear();
+	slowQueries.drain([&](const auto & logged) { records.push_back(logged); });
+	ASSERT_EQ(records.size(), 1u);
+	EXPECT_EQ(records[0].shape, QueryShape::within_distance);
+	EXPECT_EQ(records[0].radius, 40.0f);
+	EXPECT_EQ(records[0].lower_bounds[0], -40.0f);
+	EXPECT_EQ(records[0].cells_hit, 2u);
+	EXPECT_EQ(records[0].candidates_tested, 3u);
+	EXPECT_EQ(records[0].results_returned, 2u);
+
+	// a zero latency threshold logs everything, however small
+	slowQueries.set_thresholds(std::chrono::nanoseconds(0), 1000000);
+	EXPECT_EQ(slowQueries.duration_threshold(), std::chrono::nanoseconds(0));
+	EXPECT_EQ(slowQueries.cells_threshold(), 1000000u);
+	query_within_distance(locationHash, {1.0f, 1.0f}, 1.0f, result, slowQueries);
+	EXPECT_EQ(slowQueries.drain([](const auto &) {}), 1u);
+}
+
+TEST(SlowQueryLogTest, InstrumentedQueriesMatchPlainQueries)
+{
+	LoggedHash                locationHash;
+	std::vector<LoggedObject> objects(200);
+	for (size_t i = 0; i < objects.size(); ++i) {
+		objects[i].id = i;
+		locationHash.add(&objects[i], {static_cast<float>(i % 20) * 7.0f, static_cast<float>(i / 20) * 7.0f});
+	}
+
+	SlowQueryLog<float, 2>      slowQueries;
+	std::vector<LoggedObject *> logged;
+	query_bounding_box(locationHash, {10.0f, 10.0f}, {60.0f, 45.0f}, logged, slowQueries);
+	EXPECT_EQ(logged, query_bounding_box(locationHash, {10.0f, 10.0f}, {60.0f, 45.0f}));
+	query_within_distance(locationHash, {50.0f, 30.0f}, 25.0f, logged, slowQueries);
+	EXPECT_EQ(logged, query_within_distance(locationHash, {50.0f, 30.0f}, 25.0f));
+}
+
+TEST(SlowQueryLogTest, DropsWhenFullAndDrainsOldestFirst)
+{
+	SlowQueryLog<float, 2, 4> slowQueries;
+	log_by_cells_only(slowQueries, 1);
+
+	QueryRecord<float, 2> record;
+	for (size_t i = 1; i <= 6; ++i) {
+		record.cells_enumerated = i;
+		EXPECT_EQ(slowQueries.record_if_slow(record), i <= 4);
+	}
+	EXPECT_EQ(slowQueries.dropped(), 2u);
+
+	// below the threshold is never logged, and not counted as dropped
+	record.cells_enumerated = 0;
+	EXPECT_FALSE(slowQueries.record_if_slow(record));
+	EXPECT_EQ(slowQueries.dropped(), 2u);
+
+	std::vector<size_t> order;
+	slowQueries.drain([&](const auto & logged) { order.push_back(logged.cells_enumerated); });
+	EXPECT_EQ(order, (std::vector<size_t>{1, 2, 3, 4}));
+
+	// the ring is reusable after draining
+	record.cells_enumerated = 7;
+	EXPECT_TRUE(slowQueries.record_if_slow(record));
+	order.clear();
+	slowQueries.drain([&](const auto & logged) { order.push_back(logged.cells_enumerated); });
+	EXPECT_EQ(order, (std::vector<size_t>{7}));
+}
+
+TEST(SlowQueryLogTest, ConcurrentProducersAndDrainer)
+{
+	constexpr size_t           producers  = 4;
+	constexpr size_t           per_thread = 5000;
+	SlowQueryLog<float, 2, 64> slowQueries;
+	log_by_cells_only(slowQueries, 1);
+
+	std::atomic<bool>   done{false};
+	std::vector<size_t> seen(producers * per_thread, 0);
+	size_t              drained = 0;
+	const auto          collect = [&](const auto & logged) {
+		++seen[logged.cells_enumerated - 1];
+		++drained;
+	};
+
+	std::thread drainer([&]() {
+		while (!done.load()) {
+			slowQueries.drain(collect);
+		}
+		slowQueries.drain(collect);
+	});
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < producers; ++t) {
+		threads.emplace_back([&, t]() {
+			QueryRecord<float, 2> record;
+			for (size_t i = 0; i < per_thread; ++i) {
+				record.cells_enumerated = t * per_thread + i + 1;
+				slowQueries.record_if_slow(record);
+			}
+		});
+	}
+	for (auto & thread : threads) {
+		thread.join();
+	}
+	done.store(true);
+	drainer.join();
+
+	// every record was either delivered exactly once or counted as dropped
+	EXPECT_EQ(drained + slowQueries.dropped(), producers * per_thread);
+	for (const size_t count : seen) {
+		EXPECT_LE(count, 1u);
+	}
+}
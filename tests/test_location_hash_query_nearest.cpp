@@ -0,0 +1,143 @@
+#include "lochash/location_hash_query_nearest.hpp"
+#include "lochash/lochash.hpp"
+#include "gtest/gtest.h"
+#include <random>
+#include <set>
+
+using namespace lochash;
+
+struct TestObject {
+	size_t      id;
+	std::string name;
+};
+
+TEST(QuantizedCoordinateShellTest, VisitsEachCellOnTheShellOnce)
+{
+	constexpr size_t                               precision = 4;
+	const QuantizedCoordinate<precision, float, 3> center(std::array<float, 3>{0.0f, 0.0f, 0.0f});
+	std::set<std::array<int64_t, 3>>               visited;
+	size_t                                         calls = 0;
+
+	for_each_quantized_coordinate_in_shell<precision, float, 3>(center, 0, [&](const auto & key) {
+		visited.insert(key.quantized_);
+		++calls;
+	});
+	EXPECT_EQ(calls, 1u);
+
+	for_each_quantized_coordinate_in_shell<precision, float, 3>(center, 2, [&](const auto & key) {
+		visited.insert(key.quantized_);
+		++calls;
+		int64_t chebyshev = 0;
+		for (const auto value : key.quantized_) {
+			chebyshev = std::max(chebyshev, std::abs(value));
+		}
+		EXPECT_EQ(chebyshev, 8);
+	});
+
+	// 5^3 - 3^3 cells on the ring 2 shell, plus the center from ring 0
+	EXPECT_EQ(calls, 1u + 98u);
+	EXPECT_EQ(visited.size(), calls);
+}
+
+TEST(LocationHashQueryNearestTest, ReturnsNearestFirst)
+{
+	constexpr size_t                              precision = 16;
+	LocationHash<precision, float, 2, TestObject> locationHash;
+
+	TestObject obj1{1, "Object1"};
+	TestObject obj2{2, "Object2"};
+	TestObject obj3{3, "Object3"};
+	TestObject obj4{4, "Object4"};
+
+	locationHash.add(&obj1, {1.0f, 1.0f});
+	locationHash.add(&obj2, {40.0f, 0.0f});
+	locationHash.add(&obj3, {-100.0f, 90.0f});
+	locationHash.add(&obj4, {20.0f, 0.0f});
+
+	const auto result = query_nearest(locationHash, {0.0f, 0.0f}, 3);
+	ASSERT_EQ(result.size(), 3);
+	EXPECT_EQ(result[0], &obj1);
+	EXPECT_EQ(result[1], &obj4);
+	EXPECT_EQ(result[2], &obj2);
+
+	// asking for more than exist returns everything, still ordered
+	const auto all = query_nearest(locationHash, {0.0f, 0.0f}, 10);
+	ASSERT_EQ(all.size(), 4);
+	EXPECT_EQ(all[3], &obj3);
+
+	EXPECT_TRUE(query_nearest(locationHash, {0.0f, 0.0f}, 0).empty());
+
+	LocationHash<precision, float, 2, TestObject> emptyHash;
+	EXPECT_TRUE(query_nearest(emptyHash, {0.0f, 0.0f}, 3).empty());
+}
+
+TEST(LocationHashQueryNearestTest, MatchesBruteForce)
+{
+	constexpr size_t                              precision = 8;
+	LocationHash<precision, float, 2, TestObject> locationHash;
+
+	std::mt19937                          rng(42);
+	std::uniform_real_distribution<float> dist(-200.0f, 200.0f);
+
+	std::vector<TestObject>           objects(500);
+	std::vector<std::array<float, 2>> positions(objects.size());
+	for (size_t i = 0; i < objects.size(); ++i) {
+		objects[i].id = i;
+		positions[i]  = {dist(rng), dist(rng)};
+		locationHash.add(&objects[i], positions[i]);
+	}
+
+	for (size_t q = 0; q < 20; ++q) {
+		const std::array<float, 2> center = {dist(rng), dist(rng)};
+		constexpr size_t           k      = 5;
+
+		std::vector<float> expected;
+		for (const auto & position : positions) {
+			expected.push_back(calculate_distance_squared<float, 2>(position, center));
+		}
+		std::sort(expected.begin(), expected.end());
+
+		const auto result = query_nearest(locationHash, center, k);
+		ASSERT_EQ(result.size(), k);
+		for (size_t i = 0; i < k; ++i) {
+			const float actual = calculate_distance_squared<float, 2>(positions[result[i]->id], center);
+			EXPECT_FLOAT_EQ(actual, expected[i]);
+		}
+	}
+}
+
+// A center far from everything would take billions of probes of empty rings to reach the data; the search falls
+// back to scanning the occupied buckets instead, and must still find the same nearest objects.
+TEST(LocationHashQueryNearestTest, FarFromAllData)
+{
+	constexpr size_t                              precision = 16;
+	LocationHash<precision, float, 2, TestObject> locationHash;
+
+	std::mt19937                          rng(7);
+	std::uniform_real_distribution<float> dist(-200.0f, 200.0f);
+
+	std::vector<TestObject>           objects(300);
+	std::vector<std::array<float, 2>> positions(objects.size());
+	for (size_t i = 0; i < objects.size(); ++i) {
+		objects[i].id = i;
+		positions[i]  = {dist(rng), dist(rng)};
+		locationHash.add(&objects[i], positions[i]);
+	}
+
+	for (const std::array<float, 2> center : {std::array<float, 2>{1.0e6f, -1.0e6f}, {-3.0e5f, 150.0f}}) {
+		constexpr size_t k = 7;
+
+		std::vector<float> expected;
+		for (const auto & position : positions) {
+			expected.push_back(calculate_distance_squared<float, 2>(position, center));
+		}
+		std::sort(expected.begin(), expected.end());
+
+		const auto result = query_nearest(locationHash, center, k);
+		ASSERT_EQ(result.size(), k);
+		for (size_t i = 0; i < k; ++i) {
+			const float actual = calculate_distance_squared<float, 2>(positions[result[i]->id], center);
+			EXPECT_FLOAT_EQ(actual, expected[i]);
+		}
+	}
+}
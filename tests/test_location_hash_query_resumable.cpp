@@ -0,0 +1,125 @@
+#include "lochash/location_hash_query_resumable.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <random>
+#include <set>
+#include <span>
+#include <stdexcept>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Cursor               = QueryCursor<precision, float, 2>;
+	using Point                = std::array<float, 2>;
+} // namespace
+
+TEST(ResumableQueryTest, CursorVisitsEachCellOfTheBoxOnceNearestFirst)
+{
+	for (const Point origin : {Point{0.0f, 0.0f}, Point{70.0f, -20.0f}, Point{-500.0f, 300.0f}}) {
+		Cursor cursor({-40.0f, -60.0f}, {100.0f, 30.0f}, origin);
+		const Cursor::QuantizedCoordinateType center(origin);
+
+		// every cell reports as occupied, so the visitor sees the whole walk
+		const std::array<int, 1>         occupied{};
+		std::set<std::array<int64_t, 2>> seen;
+		int64_t                          last_ring = 0;
+		const auto                       visit     = [&](const auto & key, const auto &) {
+			EXPECT_TRUE(seen.insert({key.quantized_[0], key.quantized_[1]}).second);
+			const auto ring = std::max(std::abs(key.quantized_[0] - center.quantized_[0]),
+			                           std::abs(key.quantized_[1] - center.quantized_[1])) /
+			                  int64_t(precision);
+			EXPECT_GE(ring, last_ring);
+			last_ring = ring;
+		};
+		EXPECT_TRUE(cursor.resume([&](const auto &) { return std::span<const int>(occupied); }, QueryBudget{}, visit));
+
+		// x keys -48 to 96, y keys -64 to 16
+		EXPECT_EQ(seen.size(), 10u * 6u);
+		EXPECT_EQ(cursor.probes(), 10u * 6u);
+		for (const auto & key : seen) {
+			EXPECT_TRUE(-48 <= key[0] && key[0] <= 96 && -64 <= key[1] && key[1] <= 16);
+		}
+		EXPECT_TRUE(cursor.done());
+	}
+
+	Cursor empty({10.0f, 10.0f}, {-10.0f, -10.0f}, {0.0f, 0.0f});
+	EXPECT_TRUE(empty.done());
+}
+
+TEST(ResumableQueryTest, BudgetedQueriesResumeToTheFullResult)
+{
+	std::vector<Entity>                   entities(2000);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(29);
+	std::uniform_real_distribution<float> coordinate(-1000.0f, 1000.0f);
+	Index                                 locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		locationHash.add(&entities[i], positions[i]);
+	}
+
+	const Point center{100.0f, -50.0f};
+	const float radius = 600.0f;
+	auto        expected = query_within_distance(locationHash, center, radius);
+	std::sort(expected.begin(), expected.end());
+
+	Cursor                cursor = Cursor::around(center, radius);
+	std::vector<Entity *> partial;
+	std::vector<Entity *> found;
+	size_t                calls = 0;
+	while (!query_within_distance(locationHash, cursor, QueryBudget{100}, partial)) {
+		found.insert(found.end(), partial.begin(), partial.end());
+		++calls;
+		ASSERT_LT(calls, 1000u);
+	}
+	found.insert(found.end(), partial.begin(), partial.end());
+	EXPECT_GT(calls, 10u);
+	std::sort(found.begin(), found.end());
+	EXPECT_EQ(found, expected);
+
+	// the first 25 probes cover the center cell and the two rings around it, so they find only nearby results
+	Cursor nearest_first = Cursor::around(center, radius);
+	EXPECT_FALSE(query_within_distance(locationHash, nearest_first, QueryBudget{25}, partial));
+	EXPECT_FALSE(partial.empty());
+	for (Entity * entity : partial) {
+		const auto & position = positions[static_cast<size_t>(entity->id)];
+		EXPECT_LE(std::abs(position[0] - center[0]), 3.0f * precision);
+		EXPECT_LE(std::abs(position[1] - center[1]), 3.0f * precision);
+	}
+
+	const Point lower{-300.0f, -200.0f};
+	const Point upper{500.0f, 700.0f};
+	auto        box_expected = query_bounding_box(locationHash, lower, upper);
+	std::sort(box_expected.begin(), box_expected.end());
+	Cursor box(lower, upper, {900.0f, 900.0f});
+	found.clear();
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+	while (!query_bounding_box(locationHash, box, QueryBudget{500, deadline}, partial)) {
+		found.insert(found.end(), partial.begin(), partial.end());
+	}
+	found.insert(found.end(), partial.begin(), partial.end());
+	std::sort(found.begin(), found.end());
+	EXPECT_EQ(found, box_expected);
+
+	// an expired deadline stops a query after its first few probes
+	Cursor late(lower, upper, center);
+	EXPECT_FALSE(query_bounding_box(locationHash, late, QueryBudget{std::numeric_limits<size_t>::max(),
+	                                                                std::chrono::steady_clock::now()},
+	                                partial));
+	EXPECT_EQ(late.probes(), 16u);
+
+	// a box cursor has no radius, so it cannot drive a distance query
+	Cursor unbounded(lower, upper, center);
+	EXPECT_FALSE(unbounded.has_radius());
+	EXPECT_TRUE(Cursor::around(center, radius).has_radius());
+	EXPECT_THROW(query_within_distance(locationHash, unbounded, QueryBudget{}, partial), std::invalid_argument);
+	EXPECT_EQ(unbounded.probes(), 0u);
+}
@@ -0,0 +1,86 @@
+#include "lochash/location_hash.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Point                = std::array<float, 2>;
+} // namespace
+
+TEST(LocationHashSpliceTest, ExtractAndInsertMoveBucketsWithoutCopying)
+{
+	Entity a{0}, b{1}, c{2};
+	Index  source;
+	source.add(&a, {1.0f, 1.0f});
+	source.add(&b, {2.0f, 2.0f});
+	const auto * entries = source.query({1.0f, 1.0f}).data();
+
+	Index target;
+	target.insert(source.extract(Index::QuantizedCoordinateType(Point{1.0f, 1.0f})));
+	EXPECT_TRUE(source.get_data().empty());
+	EXPECT_EQ(target.query({1.0f, 1.0f}).size(), 2u);
+	EXPECT_EQ(target.query({1.0f, 1.0f}).data(), entries); // the same storage, not a copy
+
+	// an occupied cell gains the node's entries
+	source.add(&c, {3.0f, 3.0f});
+	target.insert(source.extract(Index::QuantizedCoordinateType(Point{3.0f, 3.0f})));
+	EXPECT_EQ(target.query({1.0f, 1.0f}).size(), 3u);
+	EXPECT_EQ(target.get_data().size(), 1u);
+
+	// extracting an unoccupied cell gives an empty node, which insert ignores
+	auto missing = source.extract(Index::QuantizedCoordinateType(Point{500.0f, 500.0f}));
+	EXPECT_TRUE(missing.empty());
+	target.insert(std::move(missing));
+	EXPECT_EQ(target.get_data().size(), 1u);
+}
+
+TEST(LocationHashSpliceTest, SplitAndMergeRoundTrip)
+{
+	std::vector<Entity>                   entities(400);
+	std::mt19937                          rng(31);
+	std::uniform_real_distribution<float> coordinate(-300.0f, 300.0f);
+	Index                                 locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		locationHash.add(&entities[i], {coordinate(rng), coordinate(rng)});
+	}
+	const auto original = contents_of(locationHash);
+	const auto cells    = locationHash.get_data().size();
+
+	// a plane at x = 40 moves the cells from key 32 upward
+	Index east = locationHash.split_by(0, 40.0f);
+	for (const auto & [key, bucket] : east.get_data()) {
+		EXPECT_GE(key.quantized_[0], 32);
+	}
+	for (const auto & [key, bucket] : locationHash.get_data()) {
+		EXPECT_LT(key.quantized_[0], 32);
+	}
+	EXPECT_EQ(east.get_data().size() + locationHash.get_data().size(), cells);
+
+	Index north = locationHash.split_by([](const auto & key) { return key.quantized_[1] >= 0; });
+	for (const auto & [key, bucket] : north.get_data()) {
+		EXPECT_GE(key.quantized_[1], 0);
+	}
+
+	locationHash.merge(east);
+	locationHash.merge(north);
+	EXPECT_TRUE(east.get_data().empty());
+	EXPECT_TRUE(north.get_data().empty());
+	EXPECT_EQ(contents_of(locationHash), original);
+	EXPECT_EQ(locationHash.get_data().size(), cells);
+
+	// merging overlapping indexes appends to the shared cells
+	Index copy = locationHash;
+	locationHash.merge(copy);
+	EXPECT_EQ(locationHash.get_data().size(), cells);
+	EXPECT_EQ(contents_of(locationHash).size(), 2 * original.size());
+}
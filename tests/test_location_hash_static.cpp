@@ -0,0 +1,155 @@
+#include "lochash/location_hash_static.hpp"
+#include "gtest/gtest.h"
+#include <array>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct SpawnPoint {
+		size_t id;
+	};
+
+	constexpr size_t precision = 16;
+
+	constexpr SpawnPoint spawns[] = {{0}, {1}, {2}, {3}, {4}};
+
+	using SpawnIndex = StaticLocationHash<precision, float, 2, const SpawnPoint, 5>;
+
+	// Built entirely by the compiler.
+	constexpr SpawnIndex spawn_index({{
+	    {{40.0f, 40.0f}, &spawns[0]},
+	    {{1.0f, 2.0f}, &spawns[1]},
+	    {{-3.0f, 5.0f}, &spawns[2]},
+	    {{3.0f, 4.0f}, &spawns[3]},
+	    {{-100.0f, 7.5f}, &spawns[4]},
+	}});
+
+	static_assert(spawn_index.size() == 5);
+	static_assert(spawn_index.cell_count() == 4);
+	static_assert(spawn_index.query({0.0f, 0.0f}).size() == 2);
+	static_assert(spawn_index.query({0.0f, 0.0f})[0].second == &spawns[1]); // bucket keeps the given order
+	static_assert(spawn_index.query({0.0f, 0.0f})[1].second == &spawns[3]);
+	static_assert(spawn_index.query({200.0f, 200.0f}).empty());
+
+	// Compile-time quantization must agree with the run-time conversion it replaces, ties included.
+	static_assert(real_to_int<float, int64_t>(2.5f) == 2);
+	static_assert(real_to_int<float, int64_t>(3.5f) == 4);
+	static_assert(real_to_int<float, int64_t>(-2.5f) == -2);
+	static_assert(real_to_int<double, int32_t>(-3.6) == -4);
+	static_assert(real_to_int<double, int64_t>(7.4) == 7);
+
+	// Beyond the int32 range, where a 32-bit conversion would overflow.
+	constexpr std::array<float, 6>  large_floats  = {2147483648.0f, -2147483904.0f, 3.0e9f, -7.5e9f, 1.0e15f, -4.0e17f};
+	constexpr std::array<double, 6> large_doubles = {2147483648.5, -2147483649.5, 3.0e9 + 0.25, -7.5e9 - 0.75,
+	                                                 4503599627370495.5, -1.0e17};
+
+	template <typename RealType, size_t Count>
+	constexpr std::array<int64_t, Count> keys_of(const std::array<RealType, Count> & values)
+	{
+		std::array<int64_t, Count> keys{};
+		for (size_t i = 0; i < Count; ++i) {
+			keys[i] = quantize_value<RealType, precision, int64_t>(values[i]);
+		}
+		return keys;
+	}
+
+	constexpr auto large_float_keys  = keys_of(large_floats);
+	constexpr auto large_double_keys = keys_of(large_doubles);
+} // namespace
+
+TEST(StaticLocationHashTest, CompileTimeQuantizationMatchesRunTime)
+{
+	for (const float value : {-17.5f, -16.5f, -8.49f, -0.5f, 0.0f, 0.5f, 1.5f, 15.5f, 16.0f, 1000.25f}) {
+		volatile float runtime_value = value; // keep the conversion out of constant evaluation
+		EXPECT_EQ((round_half_to_even<float, int64_t>(value)), (real_to_int<float, int64_t>(runtime_value)))
+		    << value;
+		EXPECT_EQ((round_half_to_even<float, int32_t>(value)), (real_to_int<float, int32_t>(runtime_value)))
+		    << value;
+	}
+}
+
+TEST(StaticLocationHashTest, CompileTimeKeysMatchRunTimeForLargeValues)
+{
+	for (size_t i = 0; i < large_floats.size(); ++i) {
+		volatile float runtime_value = large_floats[i];
+		EXPECT_EQ(large_float_keys[i], (quantize_value<float, precision, int64_t>(runtime_value))) << large_floats[i];
+	}
+	for (size_t i = 0; i < large_doubles.size(); ++i) {
+		volatile double runtime_value = large_doubles[i];
+		EXPECT_EQ(large_double_keys[i], (quantize_value<double, precision, int64_t>(runtime_value)))
+		    << large_doubles[i];
+	}
+}
+
+TEST(StaticLocationHashTest, QueriesCompileTimeIndex)
+{
+	const auto box = query_bounding_box(spawn_index, {-4.0f, 0.0f}, {4.0f, 6.0f});
+	ASSERT_EQ(box.size(), 3u);
+	EXPECT_NE(std::find(box.begin(), box.end(), &spawns[1]), box.end());
+	EXPECT_NE(std::find(box.begin(), box.end(), &spawns[2]), box.end());
+	EXPECT_NE(std::find(box.begin(), box.end(), &spawns[3]), box.end());
+
+	const auto near = query_within_distance(spawn_index, {40.0f, 41.0f}, 2.0f);
+	ASSERT_EQ(near.size(), 1u);
+	EXPECT_EQ(near[0], &spawns[0]);
+
+	const auto nearest = query_nearest(spawn_index, {-90.0f, 0.0f}, 2);
+	ASSERT_EQ(nearest.size(), 2u);
+	EXPECT_EQ(nearest[0], &spawns[4]);
+	EXPECT_EQ(nearest[1], &spawns[2]);
+
+	// cells are ordered by key and cover every entry once
+	size_t covered = 0;
+	for (size_t i = 0; i < spawn_index.cells().size(); ++i) {
+		if (i > 0) {
+			EXPECT_TRUE(spawn_index.cells()[i - 1].key < spawn_index.cells()[i].key);
+		}
+		covered += spawn_index.cells()[i].count;
+	}
+	EXPECT_EQ(covered, spawn_index.entries().size());
+}
+
+TEST(StaticLocationHashTest, MatchesLocationHash)
+{
+	constexpr size_t        count = 500;
+	std::vector<SpawnPoint> objects(count);
+	std::array<std::pair<std::array<float, 2>, SpawnPoint *>, count> entries;
+	LocationHash<precision, float, 2, SpawnPoint>                    dynamic;
+
+	std::mt19937                          rng(7);
+	std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+	for (size_t i = 0; i < count; ++i) {
+		objects[i].id = i;
+		entries[i]    = {{coordinate(rng), coordinate(rng)}, &objects[i]};
+		dynamic.add(entries[i].second, entries[i].first);
+	}
+	const auto index = std::make_unique<StaticLocationHash<precision, float, 2, SpawnPoint, count>>(entries);
+	EXPECT_EQ(index->cell_count(), dynamic.get_data().size());
+
+	const auto sorted = [](std::vector<SpawnPoint *> objects) {
+		std::sort(objects.begin(), objects.end());
+		return objects;
+	};
+	for (size_t i = 0; i < 50; ++i) {
+		const std::array<float, 2> center = {coordinate(rng), coordinate(rng)};
+		EXPECT_EQ(sorted(query_bounding_box(*index, {center[0] - 30.0f, center[1] - 20.0f},
+		                                    {center[0] + 30.0f, center[1] + 20.0f})),
+		          sorted(query_bounding_box(dynamic, {center[0] - 30.0f, center[1] - 20.0f},
+		                                    {center[0] + 30.0f, center[1] + 20.0f})));
+		EXPECT_EQ(sorted(query_within_distance(*index, center, 25.0f)),
+		          sorted(query_within_distance(dynamic, center, 25.0f)));
+		EXPECT_EQ(query_nearest(*index, center, 5), query_nearest(dynamic, center, 5));
+	}
+}
+
+TEST(StaticLocationHashTest, Empty)
+{
+	constexpr StaticLocationHash<precision, float, 3, const SpawnPoint, 0> empty_index({});
+	static_assert(empty_index.empty());
+	EXPECT_EQ(empty_index.cell_count(), 0u);
+	EXPECT_TRUE(query_bounding_box(empty_index, {0.0f, 0.0f, 0.0f}, {100.0f, 100.0f, 100.0f}).empty());
+	EXPECT_TRUE(query_within_distance(empty_index, {0.0f, 0.0f, 0.0f}, 100.0f).empty());
+	EXPECT_TRUE(query_nearest(empty_index, {0.0f, 0.0f, 0.0f}, 3).empty());
+}
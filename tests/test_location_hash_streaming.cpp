@@ -0,0 +1,157 @@
+#include "lochash/location_hash_streaming.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		uint32_t id;
+	};
+
+	constexpr size_t precision = 16;
+	using Index                = LocationHash<precision, float, 2, Entity>;
+	using Snapshot             = RegionSnapshot<precision, float, 2, uint32_t>;
+	using Streamer             = RegionStreamer<precision, float, 2, Entity, uint32_t>;
+	using Point                = std::array<float, 2>;
+
+	const auto id_of = [](const Entity * entity) { return entity->id; };
+} // namespace
+
+TEST(RegionStreamingTest, UnloadAndLoadRegionMoveWholeBuckets)
+{
+	Entity inside{0}, edge{1}, outside{2};
+	Index  locationHash;
+	locationHash.add(&inside, {20.0f, 20.0f});
+	locationHash.add(&edge, {47.0f, 20.0f}); // outside the box, but in a cell it overlaps
+	locationHash.add(&outside, {100.0f, 20.0f});
+
+	auto region = locationHash.unload_region({16.0f, 16.0f}, {40.0f, 40.0f});
+	EXPECT_EQ(region.size(), 2u);
+	EXPECT_EQ(locationHash.get_data().size(), 1u);
+	EXPECT_TRUE(locationHash.query({20.0f, 20.0f}).empty());
+
+	// a cell occupied in the meantime keeps its entries and gains the loaded ones
+	Entity newcomer{3};
+	locationHash.add(&newcomer, {21.0f, 21.0f});
+	locationHash.load_region(std::move(region));
+	EXPECT_TRUE(region.empty());
+	EXPECT_EQ(locationHash.query({20.0f, 20.0f}).size(), 2u);
+	EXPECT_EQ(locationHash.query({47.0f, 20.0f}).size(), 1u);
+	EXPECT_EQ(locationHash.get_data().size(), 3u);
+
+	EXPECT_TRUE(locationHash.unload_region({40.0f, 40.0f}, {16.0f, 16.0f}).empty());
+}
+
+TEST(RegionStreamingTest, UnloadRegionMatchesBruteForceForSmallAndLargeRegions)
+{
+	std::vector<Entity>                   entities(500);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(3);
+	std::uniform_real_distribution<float> coordinate(-400.0f, 400.0f);
+	Index                                 locationHash;
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = i;
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		locationHash.add(&entities[i], positions[i]);
+	}
+
+	// a small region enumerates its cells, one larger than the occupied set scans the map instead
+	for (const float half_extent : {30.0f, 10000.0f}) {
+		Index      copy = locationHash;
+		const auto keys = copy.get_data().size();
+		const auto region =
+		    copy.unload_region({-half_extent, -half_extent - 8.0f}, {half_extent, half_extent - 8.0f});
+
+		size_t moved = 0;
+		for (const auto & [key, bucket] : region) {
+			EXPECT_EQ(locationHash.get_data().at(key), bucket);
+			EXPECT_EQ(copy.get_data().count(key), 0u);
+			moved += 1;
+		}
+		EXPECT_EQ(copy.get_data().size() + moved, keys);
+
+		const Index::QuantizedCoordinateType lower(Point{-half_extent, -half_extent - 8.0f});
+		const Index::QuantizedCoordinateType upper(Point{half_extent, half_extent - 8.0f});
+		for (const auto & [key, bucket] : copy.get_data()) {
+			const bool inside = lower.quantized_[0] <= key.quantized_[0] && key.quantized_[0] <= upper.quantized_[0] &&
+			                    lower.quantized_[1] <= key.quantized_[1] && key.quantized_[1] <= upper.quantized_[1];
+			EXPECT_FALSE(inside);
+		}
+	}
+}
+
+TEST(RegionStreamingTest, SnapshotRoundTripsThroughAFile)
+{
+	TempFile            file("lochash_test_region_snapshot.bin");
+	std::vector<Entity> entities(64);
+	Index               original;
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = i;
+		original.add(&entities[i], {static_cast<float>(i % 8) * 10.0f, static_cast<float>(i / 8) * 10.0f});
+	}
+
+	Snapshot::capture(original.get_data(), id_of).save(file.path());
+	EXPECT_FALSE(std::filesystem::exists(file.path() + ".partial"));
+
+	Index restored;
+	Snapshot::read(file.path()).restore(restored, [&](uint32_t id) { return &entities[id]; });
+	EXPECT_EQ(contents_of(restored), contents_of(original));
+	EXPECT_EQ(restored.get_data().size(), original.get_data().size());
+}
+
+TEST(RegionStreamingTest, SnapshotRejectsMismatchedOrDamagedFiles)
+{
+	TempFile file("lochash_test_region_damaged.bin");
+	Entity   entity{7};
+	Index    locationHash;
+	locationHash.add(&entity, {1.0f, 1.0f});
+	Snapshot::capture(locationHash.get_data(), id_of).save(file.path());
+
+	using Other = RegionSnapshot<precision, double, 2, uint32_t>;
+	EXPECT_THROW(Other::read(file.path()), std::system_error);
+
+	std::filesystem::resize_file(file.path(), std::filesystem::file_size(file.path()) - 1);
+	EXPECT_THROW(Snapshot::read(file.path()), std::system_error);
+
+	EXPECT_THROW(Snapshot::read(file.path() + ".missing"), std::system_error);
+}
+
+TEST(RegionStreamingTest, StreamerUnloadsAndLoadsInTheBackground)
+{
+	TempFile                              west("lochash_test_region_west.bin");
+	TempFile                              east("lochash_test_region_east.bin");
+	std::vector<Entity>                   entities(200);
+	std::mt19937                          rng(9);
+	std::uniform_real_distribution<float> coordinate(-200.0f, 200.0f);
+	Index                                 locationHash;
+	for (uint32_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = i;
+		locationHash.add(&entities[i], {coordinate(rng), coordinate(rng)});
+	}
+	const auto original = contents_of(locationHash);
+
+	Streamer streamer;
+	size_t   unloaded = streamer.unload_region(locationHash, {-256.0f, -256.0f}, {-0.5f, 256.0f}, west.path(), id_of);
+	unloaded += streamer.unload_region(locationHash, {0.0f, -256.0f}, {256.0f, 256.0f}, east.path(), id_of);
+	EXPECT_EQ(unloaded, entities.size());
+	EXPECT_TRUE(locationHash.get_data().empty());
+
+	// loads queued behind the saves read what those saves wrote
+	streamer.request_load(west.path());
+	streamer.request_load(east.path());
+	streamer.wait_idle();
+
+	const auto resolve = [&](uint32_t id) { return &entities[id]; };
+	EXPECT_EQ(streamer.apply_loaded(locationHash, resolve, 1), 1u);
+	EXPECT_EQ(streamer.apply_loaded(locationHash, resolve), 1u);
+	EXPECT_EQ(streamer.apply_loaded(locationHash, resolve), 0u);
+	EXPECT_EQ(contents_of(locationHash), original);
+
+	streamer.request_load(west.path() + ".missing");
+	streamer.wait_idle();
+	EXPECT_THROW(streamer.apply_loaded(locationHash, resolve), std::system_error);
+	EXPECT_EQ(streamer.apply_loaded(locationHash, resolve), 0u);
+}
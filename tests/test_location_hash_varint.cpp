@@ -0,0 +1,56 @@
+#include "lochash/location_hash_varint.hpp"
+#include "gtest/gtest.h"
+#include <cmath>
+#include <limits>
+
+using namespace lochash::detail;
+
+TEST(VarintTest, ZigzagKeepsSmallMagnitudesSmall)
+{
+	EXPECT_EQ(zigzag_encode(0), 0u);
+	EXPECT_EQ(zigzag_encode(-1), 1u);
+	EXPECT_EQ(zigzag_encode(1), 2u);
+	EXPECT_EQ(zigzag_encode(-2), 3u);
+	for (const int64_t value : {int64_t(0), int64_t(-1), int64_t(12345), std::numeric_limits<int64_t>::min(),
+	                            std::numeric_limits<int64_t>::max()}) {
+		EXPECT_EQ(zigzag_decode(zigzag_encode(value)), value);
+	}
+}
+
+TEST(VarintTest, VarintsRoundTripWithSevenBitsPerByte)
+{
+	std::vector<uint8_t> bytes;
+	append_varint(bytes, 0);
+	append_varint(bytes, 127);
+	EXPECT_EQ(bytes.size(), 2u);
+	append_varint(bytes, 128);
+	EXPECT_EQ(bytes.size(), 4u);
+	append_varint(bytes, std::numeric_limits<uint64_t>::max());
+	EXPECT_EQ(bytes.size(), 14u);
+
+	const uint8_t * in = bytes.data();
+	EXPECT_EQ(read_varint(in), 0u);
+	EXPECT_EQ(read_varint(in), 127u);
+	EXPECT_EQ(read_varint(in), 128u);
+	EXPECT_EQ(read_varint(in), std::numeric_limits<uint64_t>::max());
+	EXPECT_EQ(in, bytes.data() + bytes.size());
+}
+
+TEST(VarintTest, DeltasAreExactForAnyType)
+{
+	std::vector<uint8_t> bytes;
+	append_delta(bytes, 100.25f, 100.0f);
+	EXPECT_LE(bytes.size(), 3u); // nearby floats share their high bits
+	append_delta(bytes, -0.0f, 3.5f);
+	append_delta(bytes, std::numeric_limits<double>::denorm_min(), -1e300);
+	append_delta(bytes, int8_t(-128), int8_t(127));
+	append_delta(bytes, uint16_t(0), uint16_t(65535));
+
+	const uint8_t * in = bytes.data();
+	EXPECT_EQ(read_delta(in, 100.0f), 100.25f);
+	EXPECT_TRUE(std::signbit(read_delta(in, 3.5f)));
+	EXPECT_EQ(read_delta(in, -1e300), std::numeric_limits<double>::denorm_min());
+	EXPECT_EQ(read_delta(in, int8_t(127)), int8_t(-128));
+	EXPECT_EQ(read_delta(in, uint16_t(65535)), uint16_t(0));
+	EXPECT_EQ(in, bytes.data() + bytes.size());
+}
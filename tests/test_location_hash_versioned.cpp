@@ -0,0 +1,183 @@
+#include "lochash/location_hash_versioned.hpp"
+#include "test_helpers.hpp"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+using namespace lochash;
+
+namespace
+{
+	struct Entity {
+		int id;
+	};
+
+	constexpr size_t precision = 16;
+	using Versioned            = VersionedLocationHash<precision, float, 2, Entity>;
+	using Reference            = LocationHash<precision, float, 2, Entity>;
+	using Point                = std::array<float, 2>;
+
+	std::multimap<Entity *, Point> contents_of(const Versioned & locationHash)
+	{
+		std::multimap<Entity *, Point> contents;
+		locationHash.for_each_bucket([&](const auto &, const auto & bucket) {
+			for (const auto & [coordinates, object] : bucket) {
+				contents.emplace(object, coordinates);
+			}
+		});
+		return contents;
+	}
+} // namespace
+
+TEST(VersionedLocationHashTest, AddRemoveMoveAndFind)
+{
+	Entity    a{0}, b{1}, c{2};
+	Versioned locationHash;
+	EXPECT_TRUE(locationHash.empty());
+	locationHash.add(&a, {1.0f, 1.0f});
+	locationHash.add(&b, {2.0f, 2.0f});
+	locationHash.add(&c, {100.0f, 1.0f});
+	EXPECT_EQ(locationHash.size(), 3u);
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+	EXPECT_EQ(locationHash.query({0.0f, 0.0f}).size(), 2u);
+
+	// a move within the bucket updates the stored coordinates
+	EXPECT_TRUE(locationHash.move(&a, {1.0f, 1.0f}, {3.0f, 3.0f}));
+	EXPECT_EQ(locationHash.query({0.0f, 0.0f})[0].first, (Point{3.0f, 3.0f}));
+	EXPECT_FALSE(locationHash.move(&c, {1.0f, 1.0f}, {2.0f, 2.0f}));
+	EXPECT_FALSE(locationHash.move(&c, {1.0f, 1.0f}, {200.0f, 2.0f}));
+
+	EXPECT_TRUE(locationHash.move(&c, {100.0f, 1.0f}, {-100.0f, 1.0f}));
+	EXPECT_TRUE(locationHash.query({100.0f, 1.0f}).empty());
+	EXPECT_EQ(locationHash.query({-100.0f, 1.0f}).size(), 1u);
+	EXPECT_EQ(locationHash.cell_count(), 2u);
+
+	EXPECT_FALSE(locationHash.remove(&c, {1.0f, 1.0f}));
+	EXPECT_TRUE(locationHash.remove(&c, {-100.0f, 1.0f}));
+	EXPECT_EQ(locationHash.size(), 2u);
+	EXPECT_EQ(locationHash.cell_count(), 1u);
+
+	locationHash.clear();
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+	EXPECT_TRUE(locationHash.query({0.0f, 0.0f}).empty());
+}
+
+TEST(VersionedLocationHashTest, CopiesAreIndependentVersions)
+{
+	Entity    a{0}, b{1};
+	Versioned current;
+	current.add(&a, {1.0f, 1.0f});
+
+	const Versioned before = current;
+	EXPECT_TRUE(before.shares_root_with(current));
+
+	current.add(&b, {2.0f, 2.0f});
+	current.move(&a, {1.0f, 1.0f}, {50.0f, 50.0f});
+	EXPECT_FALSE(before.shares_root_with(current));
+	EXPECT_EQ(before.size(), 1u);
+	EXPECT_EQ(before.query({1.0f, 1.0f}).size(), 1u);
+	EXPECT_EQ(before.query({1.0f, 1.0f})[0].first, (Point{1.0f, 1.0f}));
+	EXPECT_TRUE(before.query({50.0f, 50.0f}).empty());
+
+	// rolling back is an assignment
+	current = before;
+	EXPECT_TRUE(current.shares_root_with(before));
+	EXPECT_EQ(contents_of(current), contents_of(before));
+}
+
+TEST(VersionedLocationHashTest, RollbackMatchesFullCopiesUnderRandomChurn)
+{
+	std::vector<Entity>                   entities(400);
+	std::vector<Point>                    positions(entities.size());
+	std::mt19937                          rng(5);
+	std::uniform_real_distribution<float> coordinate(-300.0f, 300.0f);
+	std::uniform_real_distribution<float> step(-20.0f, 20.0f);
+	std::uniform_int_distribution<size_t> pick(0, entities.size() - 1);
+
+	Versioned versioned;
+	Reference reference;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		entities[i].id = static_cast<int>(i);
+		positions[i]   = {coordinate(rng), coordinate(rng)};
+		versioned.add(&entities[i], positions[i]);
+		reference.add(&entities[i], positions[i]);
+	}
+
+	std::vector<Versioned>          versions;
+	std::vector<Reference>          copies;
+	std::vector<std::vector<Point>> position_history;
+	for (int tick = 0; tick < 30; ++tick) {
+		versions.push_back(versioned);
+		copies.push_back(reference);
+		position_history.push_back(positions);
+		for (int update = 0; update < 40; ++update) {
+			const size_t i    = pick(rng);
+			const Point  next = {positions[i][0] + step(rng), positions[i][1] + step(rng)};
+			EXPECT_TRUE(versioned.move(&entities[i], positions[i], next));
+			reference.remove(&entities[i], positions[i]);
+			reference.add(&entities[i], next);
+			positions[i] = next;
+		}
+		EXPECT_EQ(contents_of(versioned), contents_of(reference));
+		EXPECT_EQ(versioned.cell_count(), reference.get_data().size());
+	}
+
+	for (size_t back : {size_t(1), size_t(7), versions.size()}) {
+		versioned = versions[versions.size() - back];
+		positions = position_history[versions.size() - back];
+		EXPECT_EQ(contents_of(versioned), contents_of(copies[versions.size() - back]));
+		EXPECT_EQ(versioned.size(), entities.size());
+
+		std::vector<Entity *> expected;
+		std::vector<Entity *> actual;
+		query_within_distance(copies[versions.size() - back], Point{0.0f, 0.0f}, 120.0f, expected);
+		query_within_distance(versioned, Point{0.0f, 0.0f}, 120.0f, actual);
+		std::sort(expected.begin(), expected.end());
+		std::sort(actual.begin(), actual.end());
+		EXPECT_EQ(actual, expected);
+
+		query_bounding_box(copies[versions.size() - back], Point{-50.0f, -80.0f}, Point{90.0f, 10.0f}, expected);
+		query_bounding_box(versioned, Point{-50.0f, -80.0f}, Point{90.0f, 10.0f}, actual);
+		std::sort(expected.begin(), expected.end());
+		std::sort(actual.begin(), actual.end());
+		EXPECT_EQ(actual, expected);
+
+		EXPECT_EQ(query_nearest(versioned, Point{10.0f, -10.0f}, 5),
+		          query_nearest(copies[versions.size() - back], Point{10.0f, -10.0f}, 5));
+
+		// a restored version can be modified without disturbing the versions it shares nodes with
+		versioned.remove(&entities[0], positions[0]);
+	}
+	EXPECT_EQ(contents_of(versions.front()), contents_of(copies.front()));
+}
+
+TEST(VersionedLocationHashTest, RemovingEveryCellEmptiesTheTrie)
+{
+	std::vector<Entity> entities(2000);
+	const auto          position_of = [](size_t i) {
+		return Point{static_cast<float>(i % 50) * 16.0f, static_cast<float>(i / 50) * 16.0f};
+	};
+	Versioned locationHash;
+	for (size_t i = 0; i < entities.size(); ++i) {
+		locationHash.add(&entities[i], position_of(i));
+	}
+	EXPECT_EQ(locationHash.cell_count(), entities.size());
+	const Versioned full = locationHash;
+
+	for (size_t i = 0; i < entities.size(); ++i) {
+		EXPECT_TRUE(locationHash.remove(&entities[i], position_of(i)));
+		if (i == entities.size() / 2) {
+			EXPECT_EQ(locationHash.cell_count(), entities.size() - i - 1);
+		}
+	}
+	EXPECT_TRUE(locationHash.empty());
+	EXPECT_EQ(locationHash.cell_count(), 0u);
+	size_t visited = 0;
+	locationHash.for_each_bucket([&](const auto &, const auto &) { ++visited; });
+	EXPECT_EQ(visited, 0u);
+
+	EXPECT_EQ(full.size(), entities.size());
+	EXPECT_EQ(full.query({16.0f, 32.0f}).size(), 1u);
+}